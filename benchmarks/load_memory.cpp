@@ -0,0 +1,93 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <helpers/path_helper.hpp>
+#include <helpers/timing.hpp>
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+// Returns the peak resident set size of this process in kilobytes, or zero
+// where that isn't available.
+long peak_rss()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Load the large benchmark file count times, reporting the total time spent
+// loading and destroying the workbooks. Peak RSS is only meaningful for the
+// first configuration run by a process, so pass "pooled" to measure that one.
+void timer(bool pooled, std::size_t count)
+{
+    using xlnt::benchmarks::current_time;
+
+    const auto path = path_helper::benchmark_file("large.xlsx");
+    xlnt::load_options options;
+    options.pooled_memory = pooled;
+
+    std::size_t load_time = 0;
+    std::size_t free_time = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto start = current_time();
+        std::unique_ptr<xlnt::workbook> wb(new xlnt::workbook());
+        wb->load(path, options);
+        load_time += current_time() - start;
+
+        start = current_time();
+        wb.reset();
+        free_time += current_time() - start;
+    }
+
+    std::cout << (pooled ? "pooled" : "heap") << " load: " << load_time / count << " ms, free: "
+              << free_time / count << " ms, peak RSS: " << peak_rss() << " kB" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const auto pooled = argc > 1 && std::strcmp(argv[1], "pooled") == 0;
+    timer(pooled, 3);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <helpers/timing.hpp>
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+// Build and save a small report: one sheet of ten rows with a label and nine
+// numbers each. This is dominated by the fixed cost of each file rather than
+// by the cells.
+void report(std::vector<std::uint8_t> &bytes)
+{
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+
+    for (xlnt::row_t row = 1; row <= 10; ++row)
+    {
+        ws.cell(1, row).value("Item " + std::to_string(row));
+
+        for (xlnt::column_t::index_t column = 2; column <= 10; ++column)
+        {
+            ws.cell(column, row).value(static_cast<int>(row * column));
+        }
+    }
+
+    bytes.clear();
+    wb.save(bytes);
+}
+
+// Report the best of three runs of count saves as files per second.
+void timer(std::size_t count)
+{
+    using xlnt::benchmarks::current_time;
+
+    const auto repeat = std::size_t(3);
+    auto time = std::numeric_limits<std::size_t>::max();
+    std::vector<std::uint8_t> bytes;
+
+    std::cout << count << " files of 100 cells" << std::endl;
+
+    for (std::size_t i = 0; i < repeat; i++)
+    {
+        auto start = current_time();
+
+        for (std::size_t file = 0; file < count; ++file)
+        {
+            report(bytes);
+        }
+
+        time = std::min(current_time() - start, time);
+    }
+
+    std::cout << count * 1000.0 / static_cast<double>(std::max(time, std::size_t(1))) << " files/s" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    timer(100);
+    timer(1000);
+
+    return 0;
+}
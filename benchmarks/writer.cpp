@@ -58,6 +58,28 @@ void writer(int cols, int rows)
     wb.save(filename);
 }
 
+// The same as writer, but filling each row through a row_writer rather than
+// looking up every cell by reference.
+void append_writer(int cols, int rows)
+{
+    xlnt::workbook wb;
+    auto ws = wb.create_sheet();
+    auto writer = ws.append_rows();
+
+    for (int index = 0; index < rows; index++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            writer.append(i);
+        }
+
+        writer.next_row();
+    }
+
+    auto filename = "benchmark.xlsx";
+    wb.save(filename);
+}
+
 // Create a timeit call to a function and pass in keyword arguments.
 // The function is called twice, once using the standard workbook, then with the optimised one.
 // Time from the best of three is taken.
@@ -91,5 +113,12 @@ int main()
     timer(&writer, 10, 10000);
     timer(&writer, 4000, 1000);
 
+    timer(&append_writer, 100, 100);
+    timer(&append_writer, 1000, 100);
+    timer(&append_writer, 4000, 100);
+    timer(&append_writer, 8192, 100);
+    timer(&append_writer, 10, 10000);
+    timer(&append_writer, 4000, 1000);
+
     return 0;
 }
@@ -0,0 +1,762 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+#include <xlntarrow.hpp>
+
+namespace {
+
+/// <summary>
+/// Throws an xlnt::exception describing status if it isn't OK.
+/// </summary>
+void check(const arrow::Status &status)
+{
+    if (!status.ok())
+    {
+        throw xlnt::exception(status.ToString());
+    }
+}
+
+/// <summary>
+/// Calls f(i) for every i in [0, count) on up to max_threads threads including
+/// the calling one. The first exception thrown by f is rethrown after all
+/// threads have finished.
+/// </summary>
+template<typename F>
+void parallel_for(std::size_t count, std::size_t max_threads, F f)
+{
+    if (max_threads == 0)
+    {
+        max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto work = [&]()
+    {
+        for (auto i = next++; i < count; i = next++)
+        {
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (auto i = std::size_t(1); i < std::min(max_threads, count); ++i)
+    {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+double unix_epoch_serial(xlnt::calendar base_date)
+{
+    return static_cast<double>(xlnt::date(1970, 1, 1).to_number(base_date));
+}
+
+double units_per_day(const arrow::DataType &type)
+{
+    switch (static_cast<const arrow::TimestampType &>(type).unit())
+    {
+    case arrow::TimeUnit::SECOND: return 86400.0;
+    case arrow::TimeUnit::MILLI: return 86400.0 * 1e3;
+    case arrow::TimeUnit::MICRO: return 86400.0 * 1e6;
+    default: return 86400.0 * 1e9;
+    }
+}
+
+/// <summary>
+/// Throws unsupported unless every field of schema has a type that can be
+/// converted to and from cells.
+/// </summary>
+void check_types(const arrow::Schema &schema)
+{
+    for (const auto &field : schema.fields())
+    {
+        switch (field->type()->id())
+        {
+        case arrow::Type::NA:
+        case arrow::Type::BOOL:
+        case arrow::Type::UINT8:
+        case arrow::Type::INT8:
+        case arrow::Type::UINT16:
+        case arrow::Type::INT16:
+        case arrow::Type::UINT32:
+        case arrow::Type::INT32:
+        case arrow::Type::UINT64:
+        case arrow::Type::INT64:
+        case arrow::Type::FLOAT:
+        case arrow::Type::DOUBLE:
+        case arrow::Type::DATE32:
+        case arrow::Type::DATE64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::STRING:
+            continue;
+
+        case arrow::Type::DICTIONARY:
+        {
+            const auto &type = static_cast<const arrow::DictionaryType &>(*field->type());
+            if (type.dictionary()->type_id() == arrow::Type::STRING) continue;
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        throw xlnt::unsupported("field \"" + field->name() + "\" has type "
+            + field->type()->ToString() + " which can't be converted to cells");
+    }
+}
+
+bool is_number(xlnt::cell_type type)
+{
+    return type == xlnt::cell_type::number || type == xlnt::cell_type::date;
+}
+
+bool is_date(const xlnt::frozen_worksheet &ws, const xlnt::cell_reference &reference)
+{
+    return ws.data_type(reference) == xlnt::cell_type::date || ws.is_date(reference);
+}
+
+/// <summary>
+/// Returns the (fractional) number of days between the UNIX epoch and the
+/// numeric cell at reference. This doesn't depend on the workbook's calendar.
+/// </summary>
+double days_since_epoch(const xlnt::frozen_worksheet &ws, const xlnt::cell_reference &reference)
+{
+    static const auto epoch = unix_epoch_serial(xlnt::calendar::windows_1900);
+    const auto serial = ws.value<xlnt::datetime>(reference).to_number(xlnt::calendar::windows_1900);
+
+    return static_cast<double>(serial) - epoch;
+}
+
+/// <summary>
+/// Returns the non-empty cell at reference as text. Dates are ISO 8601
+/// formatted and other numbers use the General number format.
+/// </summary>
+std::string to_text(const xlnt::frozen_worksheet &ws, const xlnt::cell_reference &reference)
+{
+    const auto type = ws.data_type(reference);
+
+    if (type == xlnt::cell_type::boolean)
+    {
+        return ws.value<bool>(reference) ? "TRUE" : "FALSE";
+    }
+    else if (is_number(type) && is_date(ws, reference))
+    {
+        return ws.value<xlnt::datetime>(reference).to_iso_string();
+    }
+    else if (is_number(type))
+    {
+        static const auto general = xlnt::number_format::general();
+        return general.format(ws.value<long double>(reference), xlnt::calendar::windows_1900);
+    }
+
+    return ws.value<std::string>(reference);
+}
+
+/// <summary>
+/// The part of a worksheet that is converted: the header is in row 1, data in
+/// rows [2, last_row] and field i is read from column i + 1.
+/// </summary>
+struct sheet_extent
+{
+    explicit sheet_extent(const xlnt::frozen_worksheet &ws)
+        : last_column(ws.calculate_dimension().bottom_right().column()),
+          last_row(ws.calculate_dimension().bottom_right().row())
+    {
+    }
+
+    std::size_t num_columns() const
+    {
+        return static_cast<std::size_t>(last_column.index);
+    }
+
+    std::int64_t num_rows() const
+    {
+        return last_row < 2 ? 0 : static_cast<std::int64_t>(last_row - 1);
+    }
+
+    static xlnt::column_t column(std::size_t i)
+    {
+        return static_cast<xlnt::column_t::index_t>(i + 1);
+    }
+
+    xlnt::column_t last_column;
+    xlnt::row_t last_row;
+};
+
+/// <summary>
+/// Appends one element per data row of column to builder, calling append for
+/// cells with a value and appending null for the others, and returns the
+/// finished array. append returns the status of the append it made.
+/// </summary>
+template<typename Builder, typename F>
+std::shared_ptr<arrow::Array> build_column(Builder &builder, const xlnt::frozen_worksheet &ws,
+    const sheet_extent &extent, xlnt::column_t column, F append)
+{
+    check(builder.Reserve(extent.num_rows()));
+
+    for (auto row = xlnt::row_t(2); row <= extent.last_row; ++row)
+    {
+        const auto reference = xlnt::cell_reference(column, row);
+        check(ws.has_value(reference) ? append(reference) : builder.AppendNull());
+    }
+
+    std::shared_ptr<arrow::Array> result;
+    check(builder.Finish(&result));
+
+    return result;
+}
+
+template<typename T>
+std::shared_ptr<arrow::Array> read_numeric(const xlnt::frozen_worksheet &ws, const sheet_extent &extent,
+    xlnt::column_t column, const std::shared_ptr<arrow::DataType> &type)
+{
+    using value_type = typename T::c_type;
+    arrow::NumericBuilder<T> builder(type, arrow::default_memory_pool());
+
+    return build_column(builder, ws, extent, column, [&](const xlnt::cell_reference &reference)
+    {
+        const auto cell_type = ws.data_type(reference);
+
+        if (is_number(cell_type))
+        {
+            return builder.Append(static_cast<value_type>(ws.value<double>(reference)));
+        }
+        else if (cell_type == xlnt::cell_type::boolean)
+        {
+            return builder.Append(static_cast<value_type>(ws.value<bool>(reference) ? 1 : 0));
+        }
+
+        return builder.AppendNull();
+    });
+}
+
+// to_value(days) converts a number of days since the UNIX epoch to an element
+template<typename T, typename F>
+std::shared_ptr<arrow::Array> read_dates(const xlnt::frozen_worksheet &ws, const sheet_extent &extent,
+    xlnt::column_t column, const std::shared_ptr<arrow::DataType> &type, F to_value)
+{
+    arrow::NumericBuilder<T> builder(type, arrow::default_memory_pool());
+
+    return build_column(builder, ws, extent, column, [&](const xlnt::cell_reference &reference)
+    {
+        if (is_number(ws.data_type(reference)))
+        {
+            return builder.Append(to_value(days_since_epoch(ws, reference)));
+        }
+
+        return builder.AppendNull();
+    });
+}
+
+template<typename T>
+std::shared_ptr<arrow::Array> build_indices(const std::vector<std::int64_t> &codes,
+    std::int64_t dictionary_size, const std::shared_ptr<arrow::DataType> &type)
+{
+    using index_type = typename T::c_type;
+
+    if (dictionary_size > 0 && dictionary_size - 1 > std::numeric_limits<index_type>::max())
+    {
+        throw xlnt::exception("too many distinct strings for dictionary indices of type " + type->ToString());
+    }
+
+    arrow::NumericBuilder<T> builder(type, arrow::default_memory_pool());
+    check(builder.Reserve(static_cast<std::int64_t>(codes.size())));
+
+    for (auto code : codes)
+    {
+        check(code < 0 ? builder.AppendNull() : builder.Append(static_cast<index_type>(code)));
+    }
+
+    std::shared_ptr<arrow::Array> result;
+    check(builder.Finish(&result));
+
+    return result;
+}
+
+/// <summary>
+/// Returns the text of the cells of column dictionary-encoded against the
+/// distinct strings of the column in order of first appearance.
+/// </summary>
+std::shared_ptr<arrow::Array> read_dictionary(const xlnt::frozen_worksheet &ws, const sheet_extent &extent,
+    xlnt::column_t column, const std::shared_ptr<arrow::DataType> &index_type)
+{
+    arrow::StringBuilder values(arrow::default_memory_pool());
+    auto indices = std::unordered_map<std::string, std::int64_t>();
+    auto codes = std::vector<std::int64_t>();
+    codes.reserve(static_cast<std::size_t>(extent.num_rows()));
+
+    for (auto row = xlnt::row_t(2); row <= extent.last_row; ++row)
+    {
+        const auto reference = xlnt::cell_reference(column, row);
+
+        if (!ws.has_value(reference))
+        {
+            codes.push_back(-1);
+            continue;
+        }
+
+        auto text = to_text(ws, reference);
+        const auto match = indices.emplace(text, static_cast<std::int64_t>(indices.size()));
+
+        if (match.second)
+        {
+            check(values.Append(text));
+        }
+
+        codes.push_back(match.first->second);
+    }
+
+    std::shared_ptr<arrow::Array> dictionary;
+    check(values.Finish(&dictionary));
+
+    const auto size = dictionary->length();
+    std::shared_ptr<arrow::Array> index_array;
+
+    switch (index_type->id())
+    {
+    case arrow::Type::INT8: index_array = build_indices<arrow::Int8Type>(codes, size, index_type); break;
+    case arrow::Type::INT16: index_array = build_indices<arrow::Int16Type>(codes, size, index_type); break;
+    case arrow::Type::INT32: index_array = build_indices<arrow::Int32Type>(codes, size, index_type); break;
+    case arrow::Type::INT64: index_array = build_indices<arrow::Int64Type>(codes, size, index_type); break;
+    default: throw xlnt::unsupported("dictionary indices of type " + index_type->ToString());
+    }
+
+    return std::make_shared<arrow::DictionaryArray>(arrow::dictionary(index_type, dictionary), index_array);
+}
+
+std::shared_ptr<arrow::Array> read_column(const xlnt::frozen_worksheet &ws, const sheet_extent &extent,
+    xlnt::column_t column, const std::shared_ptr<arrow::DataType> &type)
+{
+    auto pool = arrow::default_memory_pool();
+
+    switch (type->id())
+    {
+    case arrow::Type::NA:
+        return std::make_shared<arrow::NullArray>(extent.num_rows());
+
+    case arrow::Type::BOOL:
+    {
+        arrow::BooleanBuilder builder(pool);
+        return build_column(builder, ws, extent, column, [&](const xlnt::cell_reference &reference)
+        {
+            const auto cell_type = ws.data_type(reference);
+
+            if (cell_type == xlnt::cell_type::boolean || is_number(cell_type))
+            {
+                return builder.Append(ws.value<double>(reference) != 0.0);
+            }
+
+            return builder.AppendNull();
+        });
+    }
+
+    case arrow::Type::UINT8: return read_numeric<arrow::UInt8Type>(ws, extent, column, type);
+    case arrow::Type::INT8: return read_numeric<arrow::Int8Type>(ws, extent, column, type);
+    case arrow::Type::UINT16: return read_numeric<arrow::UInt16Type>(ws, extent, column, type);
+    case arrow::Type::INT16: return read_numeric<arrow::Int16Type>(ws, extent, column, type);
+    case arrow::Type::UINT32: return read_numeric<arrow::UInt32Type>(ws, extent, column, type);
+    case arrow::Type::INT32: return read_numeric<arrow::Int32Type>(ws, extent, column, type);
+    case arrow::Type::UINT64: return read_numeric<arrow::UInt64Type>(ws, extent, column, type);
+    case arrow::Type::INT64: return read_numeric<arrow::Int64Type>(ws, extent, column, type);
+    case arrow::Type::FLOAT: return read_numeric<arrow::FloatType>(ws, extent, column, type);
+    case arrow::Type::DOUBLE: return read_numeric<arrow::DoubleType>(ws, extent, column, type);
+
+    case arrow::Type::DATE32:
+        return read_dates<arrow::Date32Type>(ws, extent, column, type,
+            [](double days) { return static_cast<std::int32_t>(std::floor(days)); });
+
+    case arrow::Type::DATE64:
+        return read_dates<arrow::Date64Type>(ws, extent, column, type,
+            [](double days) { return static_cast<std::int64_t>(std::floor(days)) * 86400000; });
+
+    case arrow::Type::TIMESTAMP:
+    {
+        const auto scale = units_per_day(*type);
+        return read_dates<arrow::TimestampType>(ws, extent, column, type,
+            [scale](double days) { return static_cast<std::int64_t>(std::llround(days * scale)); });
+    }
+
+    case arrow::Type::STRING:
+    {
+        arrow::StringBuilder builder(pool);
+        return build_column(builder, ws, extent, column, [&](const xlnt::cell_reference &reference)
+        {
+            return builder.Append(to_text(ws, reference));
+        });
+    }
+
+    case arrow::Type::DICTIONARY:
+        return read_dictionary(ws, extent, column,
+            static_cast<const arrow::DictionaryType &>(*type).index_type());
+
+    default:
+        throw xlnt::unsupported("conversion of cells to " + type->ToString());
+    }
+}
+
+std::shared_ptr<arrow::DataType> infer_type(const xlnt::frozen_worksheet &ws, const sheet_extent &extent,
+    xlnt::column_t column)
+{
+    auto booleans = false, numbers = false, dates = false, strings = false;
+
+    for (auto row = xlnt::row_t(2); row <= extent.last_row; ++row)
+    {
+        const auto reference = xlnt::cell_reference(column, row);
+        const auto type = ws.data_type(reference);
+
+        if (type == xlnt::cell_type::empty) continue;
+
+        if (type == xlnt::cell_type::boolean)
+        {
+            booleans = true;
+        }
+        else if (is_number(type))
+        {
+            (is_date(ws, reference) ? dates : numbers) = true;
+        }
+        else
+        {
+            strings = true;
+        }
+    }
+
+    if (strings && (booleans || numbers || dates))
+    {
+        return arrow::utf8();
+    }
+    else if (strings)
+    {
+        return read_dictionary(ws, extent, column, arrow::int32())->type();
+    }
+    else if (booleans && !numbers && !dates)
+    {
+        return arrow::boolean();
+    }
+    else if (dates && !numbers && !booleans)
+    {
+        return arrow::timestamp(arrow::TimeUnit::MILLI);
+    }
+    else if (booleans || numbers || dates)
+    {
+        return arrow::float64();
+    }
+
+    return arrow::null();
+}
+
+/// <summary>
+/// Writes one Arrow array into a worksheet column starting at first_row.
+/// Values are read straight out of the Arrow buffers; nulls leave the cell
+/// unset.
+/// </summary>
+class column_writer
+{
+public:
+    column_writer(xlnt::worksheet ws, xlnt::column_t column)
+        : ws_(ws),
+          column_(column)
+    {
+    }
+
+    void write(const std::shared_ptr<arrow::Array> &array, xlnt::row_t first_row)
+    {
+        first_row_ = first_row;
+
+        switch (array->type_id())
+        {
+        case arrow::Type::NA:
+            break;
+
+        case arrow::Type::BOOL:
+        {
+            auto values = std::static_pointer_cast<arrow::BooleanArray>(array);
+            write_each(*array, [&](xlnt::cell cell, std::int64_t i) { cell.value(values->Value(i)); });
+            break;
+        }
+
+        case arrow::Type::UINT8: write_numeric<arrow::UInt8Type>(array); break;
+        case arrow::Type::INT8: write_numeric<arrow::Int8Type>(array); break;
+        case arrow::Type::UINT16: write_numeric<arrow::UInt16Type>(array); break;
+        case arrow::Type::INT16: write_numeric<arrow::Int16Type>(array); break;
+        case arrow::Type::UINT32: write_numeric<arrow::UInt32Type>(array); break;
+        case arrow::Type::INT32: write_numeric<arrow::Int32Type>(array); break;
+        case arrow::Type::UINT64: write_numeric<arrow::UInt64Type>(array); break;
+        case arrow::Type::INT64: write_numeric<arrow::Int64Type>(array); break;
+        case arrow::Type::FLOAT: write_numeric<arrow::FloatType>(array); break;
+        case arrow::Type::DOUBLE: write_numeric<arrow::DoubleType>(array); break;
+
+        case arrow::Type::DATE32:
+        {
+            // days since the UNIX epoch
+            auto values = std::static_pointer_cast<arrow::Date32Array>(array);
+            write_dates(*array, xlnt::number_format::date_yyyymmdd2(),
+                [&](std::int64_t i) { return static_cast<double>(values->Value(i)); });
+            break;
+        }
+
+        case arrow::Type::DATE64:
+        {
+            // milliseconds since the UNIX epoch
+            auto values = std::static_pointer_cast<arrow::Date64Array>(array);
+            write_dates(*array, xlnt::number_format::date_yyyymmdd2(),
+                [&](std::int64_t i) { return static_cast<double>(values->Value(i)) / 86400000.0; });
+            break;
+        }
+
+        case arrow::Type::TIMESTAMP:
+        {
+            auto values = std::static_pointer_cast<arrow::TimestampArray>(array);
+            const auto scale = units_per_day(*array->type());
+
+            write_dates(*array, xlnt::number_format::date_datetime(),
+                [&](std::int64_t i) { return static_cast<double>(values->Value(i)) / scale; });
+            break;
+        }
+
+        case arrow::Type::STRING:
+        {
+            auto values = std::static_pointer_cast<arrow::StringArray>(array);
+            write_each(*array, [&](xlnt::cell cell, std::int64_t i) { cell.value(values->GetString(i)); });
+            break;
+        }
+
+        case arrow::Type::DICTIONARY:
+            write_dictionary(std::static_pointer_cast<arrow::DictionaryArray>(array));
+            break;
+
+        default:
+            throw xlnt::unsupported("conversion of " + array->type()->ToString() + " to cells");
+        }
+    }
+
+private:
+    template<typename F>
+    void write_each(const arrow::Array &array, F write_value)
+    {
+        for (auto i = std::int64_t(0); i < array.length(); ++i)
+        {
+            if (array.IsNull(i)) continue;
+
+            write_value(ws_.cell(column_, first_row_ + static_cast<xlnt::row_t>(i)), i);
+        }
+    }
+
+    template<typename T>
+    void write_numeric(const std::shared_ptr<arrow::Array> &array)
+    {
+        auto values = std::static_pointer_cast<arrow::NumericArray<T>>(array)->raw_values();
+        write_each(*array, [&](xlnt::cell cell, std::int64_t i) { cell.value(static_cast<double>(values[i])); });
+    }
+
+    // days_since_epoch(i) returns the value of element i in (fractional) days
+    // since the UNIX epoch. All cells in the column share one format.
+    template<typename F>
+    void write_dates(const arrow::Array &array, const xlnt::number_format &number_format, F days_since_epoch)
+    {
+        const auto epoch = unix_epoch_serial(ws_.workbook().base_date());
+        auto format = ws_.workbook().create_format().number_format(number_format, true);
+
+        write_each(array, [&](xlnt::cell cell, std::int64_t i)
+        {
+            cell.value(days_since_epoch(i) + epoch);
+            cell.format(format);
+        });
+    }
+
+    // Dictionary entries are converted once up front so each cell only costs
+    // a shared string table lookup.
+    void write_dictionary(const std::shared_ptr<arrow::DictionaryArray> &array)
+    {
+        if (array->dictionary()->type_id() != arrow::Type::STRING)
+        {
+            throw xlnt::unsupported("dictionary values of type " + array->dictionary()->type()->ToString());
+        }
+
+        auto dictionary = std::static_pointer_cast<arrow::StringArray>(array->dictionary());
+        auto strings = std::vector<xlnt::rich_text>();
+
+        for (auto i = std::int64_t(0); i < dictionary->length(); ++i)
+        {
+            strings.emplace_back(dictionary->GetString(i));
+        }
+
+        auto indices = array->indices();
+        auto index_at = [&indices](std::int64_t i) -> std::int64_t
+        {
+            switch (indices->type_id())
+            {
+            case arrow::Type::INT8: return std::static_pointer_cast<arrow::Int8Array>(indices)->Value(i);
+            case arrow::Type::INT16: return std::static_pointer_cast<arrow::Int16Array>(indices)->Value(i);
+            case arrow::Type::INT32: return std::static_pointer_cast<arrow::Int32Array>(indices)->Value(i);
+            default: return std::static_pointer_cast<arrow::Int64Array>(indices)->Value(i);
+            }
+        };
+
+        write_each(*array, [&](xlnt::cell cell, std::int64_t i) { cell.value(strings.at(static_cast<std::size_t>(index_at(i)))); });
+    }
+
+    xlnt::worksheet ws_;
+    xlnt::column_t column_;
+    xlnt::row_t first_row_ = 1;
+};
+
+} // namespace
+
+namespace xlnt {
+
+std::shared_ptr<arrow::Schema> infer_schema(const frozen_worksheet &ws)
+{
+    const auto extent = sheet_extent(ws);
+    auto fields = std::vector<std::shared_ptr<arrow::Field>>(extent.num_columns());
+
+    parallel_for(fields.size(), 0, [&](std::size_t i)
+    {
+        const auto column = extent.column(i);
+        const auto header = cell_reference(column, 1);
+        const auto name = ws.has_value(header) ? to_text(ws, header) : column.column_string();
+
+        fields[i] = arrow::field(name, infer_type(ws, extent, column));
+    });
+
+    return arrow::schema(fields);
+}
+
+std::shared_ptr<arrow::Schema> infer_schema(const worksheet &ws)
+{
+    const auto snapshot = ws.workbook().freeze();
+    return infer_schema(snapshot.sheet_by_title(ws.title()));
+}
+
+std::shared_ptr<arrow::Table> xlsx2arrow(const frozen_worksheet &ws,
+    std::shared_ptr<arrow::Schema> schema, std::size_t max_threads)
+{
+    check_types(*schema);
+
+    const auto extent = sheet_extent(ws);
+    const auto num_columns = static_cast<std::size_t>(schema->num_fields());
+    auto columns = std::vector<std::shared_ptr<arrow::Column>>(num_columns);
+
+    parallel_for(num_columns, max_threads, [&](std::size_t i)
+    {
+        const auto field = schema->field(static_cast<int>(i));
+        const auto array = read_column(ws, extent, extent.column(i), field->type());
+
+        // dictionary columns are encoded against their own strings
+        columns[i] = std::make_shared<arrow::Column>(
+            arrow::field(field->name(), array->type(), field->nullable()), array);
+    });
+
+    auto fields = std::vector<std::shared_ptr<arrow::Field>>();
+
+    for (const auto &column : columns)
+    {
+        fields.push_back(column->field());
+    }
+
+    return std::make_shared<arrow::Table>(arrow::schema(fields), columns);
+}
+
+std::shared_ptr<arrow::Table> xlsx2arrow(const frozen_worksheet &ws, std::size_t max_threads)
+{
+    return xlsx2arrow(ws, infer_schema(ws), max_threads);
+}
+
+std::shared_ptr<arrow::Table> xlsx2arrow(const worksheet &ws,
+    std::shared_ptr<arrow::Schema> schema, std::size_t max_threads)
+{
+    const auto snapshot = ws.workbook().freeze();
+    return xlsx2arrow(snapshot.sheet_by_title(ws.title()), schema, max_threads);
+}
+
+std::shared_ptr<arrow::Table> xlsx2arrow(const worksheet &ws, std::size_t max_threads)
+{
+    const auto snapshot = ws.workbook().freeze();
+    return xlsx2arrow(snapshot.sheet_by_title(ws.title()), max_threads);
+}
+
+void arrow2xlsx(const arrow::RecordBatch &batch, worksheet ws, row_t first_row)
+{
+    check_types(*batch.schema());
+
+    for (auto i = 0; i < batch.num_columns(); ++i)
+    {
+        column_writer(ws, static_cast<column_t::index_t>(i + 1)).write(batch.column(i), first_row);
+    }
+}
+
+void arrow2xlsx(const arrow::Table &table, worksheet ws)
+{
+    check_types(*table.schema());
+
+    for (auto i = 0; i < table.num_columns(); ++i)
+    {
+        const auto column = static_cast<column_t::index_t>(i + 1);
+        ws.cell(column, 1).value(table.column(i)->name());
+
+        auto writer = column_writer(ws, column);
+        auto row = row_t(2);
+
+        for (const auto &chunk : table.column(i)->data()->chunks())
+        {
+            writer.write(chunk, row);
+            row += static_cast<row_t>(chunk->length());
+        }
+    }
+}
+
+} // namespace xlnt
@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <arrow/api.h>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+class frozen_worksheet;
+class worksheet;
+
+/// <summary>
+/// Returns a schema for the data in ws. Column names are taken from the first
+/// row. Field i describes column i + 1 of ws, so the first field is always
+/// column A, as written by arrow2xlsx. Each column's type is the narrowest of
+/// boolean, float64, timestamp[ms] (for date formatted numbers) and utf8
+/// dictionary-encoded against the distinct strings of the column that holds
+/// every value below the header. Columns with no values are typed null.
+/// </summary>
+std::shared_ptr<arrow::Schema> infer_schema(const frozen_worksheet &ws);
+
+/// <summary>
+/// Returns infer_schema of ws in a snapshot of its workbook.
+/// </summary>
+std::shared_ptr<arrow::Schema> infer_schema(const worksheet &ws);
+
+/// <summary>
+/// Converts the data below the header row of ws into a table with the given
+/// schema, field i being read from column i + 1. Fields may be null, boolean,
+/// any integer or floating point type, date32, date64, timestamp, utf8 or
+/// utf8 dictionary-encoded with any index type. Other types throw unsupported
+/// before anything is read. Columns are built independently on up to
+/// max_threads threads (0 uses the hardware concurrency), which is safe since
+/// frozen worksheets may be read concurrently. Strings are copied into the
+/// table and dictionary columns are encoded against the distinct strings of
+/// the column in order of first appearance.
+/// </summary>
+std::shared_ptr<arrow::Table> xlsx2arrow(const frozen_worksheet &ws,
+    std::shared_ptr<arrow::Schema> schema, std::size_t max_threads = 0);
+
+/// <summary>
+/// Converts ws into a table using the schema returned by infer_schema(ws).
+/// </summary>
+std::shared_ptr<arrow::Table> xlsx2arrow(const frozen_worksheet &ws, std::size_t max_threads = 0);
+
+/// <summary>
+/// Converts ws as above, reading it from a snapshot of its workbook taken with
+/// workbook::freeze. The whole workbook is frozen, so to convert several of
+/// its sheets freeze it once and pass its frozen worksheets instead.
+/// </summary>
+std::shared_ptr<arrow::Table> xlsx2arrow(const worksheet &ws,
+    std::shared_ptr<arrow::Schema> schema, std::size_t max_threads = 0);
+
+/// <summary>
+/// Converts ws into a table using the schema returned by infer_schema(ws).
+/// </summary>
+std::shared_ptr<arrow::Table> xlsx2arrow(const worksheet &ws, std::size_t max_threads = 0);
+
+/// <summary>
+/// Writes the rows of batch into ws starting at first_row, column i of batch
+/// going to column i + 1. Nulls leave the corresponding cells unset. The
+/// header is not written. Columns may have the types accepted by xlsx2arrow
+/// except that dictionary values must be utf8; other types throw unsupported
+/// before anything is written.
+/// </summary>
+void arrow2xlsx(const arrow::RecordBatch &batch, worksheet ws, row_t first_row);
+
+/// <summary>
+/// Writes the column names of table to the first row of ws and its rows
+/// below that, so that xlsx2arrow(ws) reads the same columns back.
+/// </summary>
+void arrow2xlsx(const arrow::Table &table, worksheet ws);
+
+} // namespace xlnt
@@ -282,6 +282,11 @@ public:
     bool has_hyperlink() const;
 
     // computed formatting
+    //
+    // The computed_* accessors fill a cache in the workbook's stylesheet, so although
+    // they are const they must not be called from several threads at once, except
+    // between workbook::begin_concurrent_population and end_concurrent_population,
+    // when the cache is guarded by the population lock.
 
     /// <summary>
     /// Returns the alignment that should be used when displaying this cell
@@ -487,8 +492,8 @@ public:
     // merging
 
     /// <summary>
-    /// Returns true iff this cell has been merged with one or more
-    /// surrounding cells.
+    /// Returns true iff this cell is within a merged range of its worksheet
+    /// or has been marked as merged with merged(true).
     /// </summary>
     bool is_merged() const;
 
@@ -611,6 +616,7 @@ public:
     bool operator==(std::nullptr_t) const;
 
 private:
+    friend class row_writer;
     friend class style;
     friend class worksheet;
     friend class detail::xlsx_consumer;
@@ -623,6 +629,12 @@ private:
     /// </summary>
     class format modifiable_format();
 
+    /// <summary>
+    /// Gives the workbook of this cell a stylesheet of its own before the format
+    /// or style of this cell is changed, if it shares one with a copy of it.
+    /// </summary>
+    void detach_stylesheet();
+
     /// <summary>
     /// Delete the default zero-argument constructor.
     /// </summary>
@@ -0,0 +1,82 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <string>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Moves the relative references of a formula as if the formula was copied from
+/// one cell to another, as happens when a formula is filled or shared between
+/// cells. References to other sheets are moved as well, absolute rows and columns
+/// ($A$1) are not, and string literals and quoted sheet names are left alone.
+/// </summary>
+class XLNT_API formula_translator
+{
+public:
+    /// <summary>
+    /// Constructs a translator for formula, which is the formula of the cell at
+    /// origin. A leading '=' is kept if present.
+    /// </summary>
+    formula_translator(const std::string &formula, const cell_reference &origin);
+
+    /// <summary>
+    /// Returns the formula as it would be written in the cell at destination.
+    /// References that would move outside the sheet become #REF!.
+    /// </summary>
+    std::string translate(const cell_reference &destination) const;
+
+    /// <summary>
+    /// Returns the formula with its references to rows of the sheet titled sheet
+    /// renumbered as if count rows were inserted before row first, or -count rows
+    /// were deleted starting at first if count is negative. Unqualified references
+    /// are to sheet if local is true. Absolute references are renumbered too, ranges
+    /// grow or shrink when lines are inserted or deleted inside them, and references
+    /// to deleted cells become #REF!.
+    /// </summary>
+    std::string shift_rows(const std::string &sheet, bool local, row_t first, long long count) const;
+
+    /// <summary>
+    /// Returns the formula with its references to columns of the sheet titled
+    /// sheet renumbered as shift_rows does for rows.
+    /// </summary>
+    std::string shift_columns(const std::string &sheet, bool local, column_t first, long long count) const;
+
+private:
+    /// <summary>
+    /// The formula as written in the cell at origin_.
+    /// </summary>
+    std::string formula_;
+
+    /// <summary>
+    /// The cell formula_ belongs to.
+    /// </summary>
+    cell_reference origin_;
+};
+
+} // namespace xlnt
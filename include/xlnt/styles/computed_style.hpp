@@ -0,0 +1,76 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// The formatting a cell is displayed with, resolved from its format, the named
+/// style of the format and the defaults of the workbook. Workbooks keep one of
+/// these for each format so cells with the same format share it.
+/// </summary>
+class XLNT_API computed_style
+{
+public:
+    /// <summary>
+    /// The effective alignment.
+    /// </summary>
+    class alignment alignment;
+
+    /// <summary>
+    /// The effective border.
+    /// </summary>
+    class border border;
+
+    /// <summary>
+    /// The effective fill.
+    /// </summary>
+    class fill fill;
+
+    /// <summary>
+    /// The effective font.
+    /// </summary>
+    class font font;
+
+    /// <summary>
+    /// The effective number format.
+    /// </summary>
+    class number_format number_format;
+
+    /// <summary>
+    /// The effective protection.
+    /// </summary>
+    class protection protection;
+};
+
+} // namespace xlnt
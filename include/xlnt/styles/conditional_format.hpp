@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -38,6 +39,7 @@ class font;
 
 namespace detail {
 
+class conditional_format_evaluator;
 struct conditional_format_impl;
 struct stylesheet;
 class xlsx_consumer;
@@ -53,12 +55,93 @@ public:
 	static condition text_contains(const std::string &start);
 	static condition text_does_not_contain(const std::string &start);
 
+    /// <summary>
+    /// Matches cells whose value is less than the given number. Blank cells
+    /// are compared as zero and text or booleans are greater than any number.
+    /// </summary>
+    static condition less_than(double value);
+
+    /// <summary>
+    /// Matches cells whose value is less than or equal to the given number.
+    /// </summary>
+    static condition less_than_or_equal(double value);
+
+    /// <summary>
+    /// Matches cells whose value is equal to the given number.
+    /// </summary>
+    static condition equal(double value);
+
+    /// <summary>
+    /// Matches cells whose value is not equal to the given number.
+    /// </summary>
+    static condition not_equal(double value);
+
+    /// <summary>
+    /// Matches cells whose value is greater than or equal to the given number.
+    /// </summary>
+    static condition greater_than_or_equal(double value);
+
+    /// <summary>
+    /// Matches cells whose value is greater than the given number.
+    /// </summary>
+    static condition greater_than(double value);
+
+    /// <summary>
+    /// Matches cells whose value is between low and high, inclusive.
+    /// </summary>
+    static condition between(double low, double high);
+
+    /// <summary>
+    /// Matches cells whose value is not between low and high, inclusive.
+    /// </summary>
+    static condition not_between(double low, double high);
+
+    /// <summary>
+    /// Matches the numbers in the range that are among the rank highest, or the
+    /// highest rank percent if percent is true. Ties with the last of them match
+    /// too. Throws invalid_parameter if rank is zero or a percentage above 100.
+    /// </summary>
+    static condition top(std::size_t rank, bool percent = false);
+
+    /// <summary>
+    /// Matches the numbers in the range that are among the rank lowest, or the
+    /// lowest rank percent if percent is true.
+    /// </summary>
+    static condition bottom(std::size_t rank, bool percent = false);
+
+    /// <summary>
+    /// Matches the numbers in the range that are greater than their average.
+    /// </summary>
+    static condition above_average();
+
+    /// <summary>
+    /// Matches the numbers in the range that are less than their average.
+    /// </summary>
+    static condition below_average();
+
+    /// <summary>
+    /// Matches the values that occur more than once in the range, comparing
+    /// text without regard to case.
+    /// </summary>
+    static condition duplicate_values();
+
+    /// <summary>
+    /// Matches the values that occur exactly once in the range.
+    /// </summary>
+    static condition unique_values();
+
 private:
+	friend class detail::conditional_format_evaluator;
 	friend class detail::xlsx_producer;
 
 	enum class type
 	{
-		contains_text
+		contains_text,
+		cell_is,
+		top_n,
+		above_average,
+		duplicate_values,
+		unique_values
 	} type_;
 
 	enum class condition_operator
@@ -66,10 +149,30 @@ private:
 		starts_with,
 		ends_with,
 		contains,
-		does_not_contain
+		does_not_contain,
+		less_than,
+		less_than_or_equal,
+		equal,
+		not_equal,
+		greater_than_or_equal,
+		greater_than,
+		between,
+		not_between
 	} operator_;
 
 	std::string text_comparand_;
+
+	double number_comparand_ = 0.0;
+
+	// upper bound of between and not_between
+	double second_number_comparand_ = 0.0;
+
+	std::size_t rank_ = 0;
+
+	bool percent_ = false;
+
+	// top_n ranks from the lowest and above_average matches below the average
+	bool reversed_ = false;
 };
 
 /// <summary>
@@ -150,6 +253,7 @@ public:
 private:
     friend struct detail::stylesheet;
     friend class detail::xlsx_consumer;
+    friend class worksheet;
 
     /// <summary>
     ///
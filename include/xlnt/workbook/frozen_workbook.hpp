@@ -0,0 +1,99 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/worksheet/frozen_worksheet.hpp>
+
+namespace xlnt {
+
+enum class calendar;
+class workbook;
+
+namespace detail {
+struct frozen_workbook_impl;
+} // namespace detail
+
+/// <summary>
+/// An immutable snapshot of the cell values and formulas of a workbook, created
+/// by workbook::freeze(). Changes to the workbook after it was frozen aren't
+/// visible in the snapshot. Copying a frozen_workbook shares the snapshot rather
+/// than copying it, and a snapshot may be read from any number of threads at the
+/// same time without synchronization.
+/// </summary>
+class XLNT_API frozen_workbook
+{
+public:
+    /// <summary>
+    /// Returns the number of sheets in this workbook.
+    /// </summary>
+    std::size_t sheet_count() const;
+
+    /// <summary>
+    /// Returns the titles of the sheets in this workbook in order.
+    /// </summary>
+    std::vector<std::string> sheet_titles() const;
+
+    /// <summary>
+    /// Returns true if this workbook has a sheet with the given title.
+    /// </summary>
+    bool contains(const std::string &title) const;
+
+    /// <summary>
+    /// Returns the sheet at the given index. Throws invalid_parameter if there is
+    /// no such sheet.
+    /// </summary>
+    frozen_worksheet sheet_by_index(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the sheet with the given title. Throws key_not_found if there is no
+    /// such sheet.
+    /// </summary>
+    frozen_worksheet sheet_by_title(const std::string &title) const;
+
+    /// <summary>
+    /// Returns the date system used to convert numbers to dates and times.
+    /// </summary>
+    calendar base_date() const;
+
+private:
+    friend class workbook;
+
+    /// <summary>
+    /// Copies the cell values and formulas of source into a new snapshot.
+    /// </summary>
+    explicit frozen_workbook(const workbook &source);
+
+    /// <summary>
+    /// The shared snapshot.
+    /// </summary>
+    std::shared_ptr<const detail::frozen_workbook_impl> d_;
+};
+
+} // namespace xlnt
@@ -0,0 +1,110 @@
+// Copyright (c) 2016-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/utils/optional.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Options that control how much of an XLSX package workbook::load and
+/// streaming_workbook_reader::open read. The defaults read everything.
+/// Parts and elements that aren't selected are skipped without creating
+/// any objects for them.
+/// </summary>
+class XLNT_API load_options
+{
+public:
+    /// <summary>
+    /// If this is true, only the workbook, relationships, styles and shared strings
+    /// are parsed by workbook::load. The content of each worksheet is read the first
+    /// time it is accessed through workbook::sheet_by_title, sheet_by_index, sheet_by_id
+    /// or iteration. The package is kept open by the workbook until it is cleared or
+    /// loaded again.
+    /// When the workbook is saved, sheets that were never obtained through a non-const
+    /// workbook, an unchanged shared string table and unchanged images are copied from
+    /// the package still compressed, as are parts xlnt doesn't model. This doesn't apply
+    /// when values_only is set or resolve_shared_strings is cleared.
+    /// </summary>
+    bool lazy_sheets = false;
+
+    /// <summary>
+    /// Titles of the worksheets whose content should be read. Other worksheets are
+    /// still created, so sheet titles and order are preserved, but are left empty.
+    /// Every worksheet is read if this is empty.
+    /// </summary>
+    std::vector<std::string> sheets;
+
+    /// <summary>
+    /// The columns to read from each worksheet. Every column is read if this is empty.
+    /// </summary>
+    std::vector<column_t> columns;
+
+    /// <summary>
+    /// The first row to read from each worksheet.
+    /// </summary>
+    row_t first_row = 1;
+
+    /// <summary>
+    /// The last row to read from each worksheet. Every row from first_row onward is
+    /// read if this isn't set.
+    /// </summary>
+    optional<row_t> last_row;
+
+    /// <summary>
+    /// If this is true, only cell values are read. The stylesheet, cell formats,
+    /// formulae, comments and hyperlinks are skipped. Since number formats aren't
+    /// read, dates are read as plain numbers.
+    /// </summary>
+    bool values_only = false;
+
+    /// <summary>
+    /// If this is false, the shared string table isn't read and cells that refer to
+    /// it hold the index of their string in the table as a number instead.
+    /// </summary>
+    bool resolve_shared_strings = true;
+
+    /// <summary>
+    /// If this is false, images and the package thumbnail aren't read.
+    /// </summary>
+    bool images = true;
+
+    /// <summary>
+    /// If this is true, cells are allocated in large blocks owned by the workbook
+    /// rather than one at a time, which makes loading and destroying a workbook
+    /// with many cells faster. The blocks are only released when the workbook is
+    /// cleared or destroyed, so memory freed by erasing cells is reused for new
+    /// cells of the same workbook but not returned to the system. A pooled workbook
+    /// and its copies mustn't be modified or destroyed on different threads at the
+    /// same time.
+    /// </summary>
+    bool pooled_memory = false;
+};
+
+} // namespace xlnt
@@ -38,6 +38,7 @@ class parser;
 namespace xlnt {
 
 class cell;
+class load_options;
 template<typename T>
 class optional;
 class path;
@@ -67,7 +68,9 @@ public:
 
     /// <summary>
     /// Reads the next cell in the current worksheet and optionally returns it if
-    /// the last cell in the sheet has not yet been read.
+    /// the last cell in the sheet has not yet been read. Cells outside the rows
+    /// and columns selected by the load options are skipped, so this can return
+    /// an invalid cell if no selected cell remains even though has_cell() was true.
     /// </summary>
     cell read_cell();
 
@@ -118,6 +121,24 @@ public:
     /// </summary>
     void open(std::istream &stream);
 
+    /// <summary>
+    /// Interprets byte vector data as an XLSX file, reading only what options
+    /// asks for. load_options::lazy_sheets has no effect when streaming.
+    /// </summary>
+    void open(const std::vector<std::uint8_t> &data, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file, reading only what
+    /// options asks for. load_options::lazy_sheets has no effect when streaming.
+    /// </summary>
+    void open(const path &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets data in stream as an XLSX file, reading only what options
+    /// asks for. load_options::lazy_sheets has no effect when streaming.
+    /// </summary>
+    void open(std::istream &stream, const load_options &options);
+
     /// <summary>
     /// Holds the given streambuf internally, creates a std::istream backed
     /// by the given buffer, and calls open(std::istream &) with that stream.
@@ -125,7 +146,8 @@ public:
     void open(std::unique_ptr<std::streambuf> &&buffer);
 
     /// <summary>
-    /// Returns a vector of the titles of sheets in the workbook in order.
+    /// Returns a vector of the titles of sheets in the workbook in order. If
+    /// load_options::sheets was given to open, only those sheets are included.
     /// </summary>
     std::vector<std::string> sheet_titles();
 
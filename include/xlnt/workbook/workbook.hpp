@@ -52,6 +52,8 @@ class drawing;
 class fill;
 class font;
 class format;
+class frozen_workbook;
+class load_options;
 class rich_text;
 class manifest;
 class metadata_property;
@@ -79,6 +81,7 @@ namespace detail {
 
 struct stylesheet;
 struct workbook_impl;
+struct worksheet_impl;
 class xlsx_consumer;
 class xlsx_producer;
 
@@ -126,7 +129,8 @@ public:
 
     /// <summary>
     /// Default constructor. Constructs a workbook containing a single empty
-    /// worksheet using workbook::empty().
+    /// worksheet equivalent to workbook::empty(). The default workbook is only
+    /// built once and copied from then on, so this is cheap.
     /// </summary>
     workbook();
 
@@ -243,6 +247,39 @@ public:
     /// </summary>
     void clear();
 
+    /// <summary>
+    /// Returns this workbook to the state of a default-constructed workbook while
+    /// reusing the storage it has already allocated where possible. Any pimpl
+    /// wrapper classes (e.g. cell) pointing into this workbook will be invalid
+    /// after this is executed.
+    /// </summary>
+    void reset();
+
+    /// <summary>
+    /// Returns an immutable snapshot of the cell values and formulas of this
+    /// workbook which can be shared by any number of reader threads without
+    /// locking. Deferred sheets are loaded first. Later changes to this workbook
+    /// don't affect the snapshot.
+    /// </summary>
+    frozen_workbook freeze() const;
+
+    /// <summary>
+    /// Allows each worksheet of this workbook to be filled by a different thread
+    /// until end_concurrent_population is called. Strings are collected per sheet
+    /// and changes that cells make to styles, comments and the manifest are
+    /// serialized. Sheets must not be added, removed or shared between threads,
+    /// and formats must only be changed through cells, in the meantime.
+    /// </summary>
+    void begin_concurrent_population();
+
+    /// <summary>
+    /// Merges the strings collected by each worksheet since
+    /// begin_concurrent_population into the shared strings of this workbook in
+    /// sheet order, so the resulting indices don't depend on thread timing. This
+    /// is done automatically when the workbook is saved or frozen.
+    /// </summary>
+    void end_concurrent_population();
+
     // iterators
 
     /// <summary>
@@ -297,6 +334,12 @@ public:
     /// </summary>
     std::size_t sheet_count() const;
 
+    /// <summary>
+    /// Returns the number of cells with a formula in all sheets of this workbook.
+    /// This is kept up to date as formulas change rather than counted.
+    /// </summary>
+    std::size_t formula_count() const;
+
     // Metadata Properties
 
     /// <summary>
@@ -547,6 +590,30 @@ public:
     /// </summary>
     void load(std::istream &stream, const std::string &password);
 
+    /// <summary>
+    /// Interprets byte vector data as an XLSX file and sets the content of this
+    /// workbook to match that file, reading only what options asks for.
+    /// </summary>
+    void load(const std::vector<std::uint8_t> &data, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading only what options asks for.
+    /// </summary>
+    void load(const std::string &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading only what options asks for.
+    /// </summary>
+    void load(const xlnt::path &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets data in stream as an XLSX file and sets the content of this
+    /// workbook to match that file, reading only what options asks for.
+    /// </summary>
+    void load(std::istream &stream, const load_options &options);
+
     // View
 
     /// <summary>
@@ -747,6 +814,16 @@ public:
     /// </summary>
     void calculation_properties(const class calculation_properties &props);
 
+    /// <summary>
+    /// Evaluates the formulas of this workbook and stores their results as the
+    /// cached values of their cells, which are written to the file on save.
+    /// Formulas using functions other than SUM, AVERAGE, MIN, MAX, COUNT, IF and
+    /// VLOOKUP, or defined names, keep their cached values. Once this has been
+    /// called, later calls and saves only evaluate formulas that depend on a cell
+    /// whose value or formula has changed. Returns the number of formulas evaluated.
+    /// </summary>
+    std::size_t calculate();
+
     // Operators
 
     /// <summary>
@@ -778,6 +855,8 @@ public:
     bool operator!=(const workbook &rhs) const;
 
 private:
+    friend class cell;
+    friend class frozen_workbook;
     friend class streaming_workbook_reader;
     friend class worksheet;
     friend class detail::xlsx_consumer;
@@ -834,6 +913,19 @@ private:
     /// </summary>
     void update_sheet_properties();
 
+    /// <summary>
+    /// Reads the content of the worksheet held by impl if it was deferred by
+    /// loading with load_options::lazy_sheets. Does nothing otherwise.
+    /// </summary>
+    void load_deferred_sheet(detail::worksheet_impl &impl) const;
+
+    /// <summary>
+    /// Returns the stylesheet of this workbook for changing its formats or styles,
+    /// copying it first if it is shared with copies of this workbook so they
+    /// aren't affected. Cell handles obtained before may need to be looked up again.
+    /// </summary>
+    detail::stylesheet &modifiable_stylesheet();
+
     /// <summary>
     /// Swaps the data held in this workbook with workbook other.
     /// </summary>
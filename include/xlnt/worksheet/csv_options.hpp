@@ -0,0 +1,111 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Options that control how worksheet::import_csv splits its input into cells
+/// and what type of value each cell gets. The defaults read comma separated
+/// values with quoting as described in RFC 4180.
+/// </summary>
+class XLNT_API csv_options
+{
+public:
+    /// <summary>
+    /// The types a column can be read as.
+    /// </summary>
+    enum class column_type
+    {
+        /// the type is inferred from each value
+        inferred,
+        /// every value is a string
+        text,
+        /// a decimal number
+        number,
+        /// a decimal number, optionally followed by '%', shown as a percentage
+        percentage,
+        /// an ISO 8601 date such as 2017-03-31, optionally followed by a time
+        date,
+        /// a time of day such as 13:45 or 13:45:30.5
+        time,
+        /// TRUE or FALSE in any case
+        boolean
+    };
+
+    /// <summary>
+    /// The character between the values of a record. Set this to '\t' to read
+    /// tab separated values.
+    /// </summary>
+    char delimiter = ',';
+
+    /// <summary>
+    /// The character enclosing values that contain delimiters, line breaks or
+    /// the quote character itself, which is then written twice.
+    /// </summary>
+    char quote = '"';
+
+    /// <summary>
+    /// If this is true, the type of each value in a column that isn't listed in
+    /// column_types is inferred the same way cell::value(const std::string &, bool)
+    /// infers it, except that only decimal numbers are recognized, and ISO 8601
+    /// dates and booleans are recognized as well. Otherwise every such value is
+    /// read as a string.
+    /// </summary>
+    bool infer_types = true;
+
+    /// <summary>
+    /// The type of the values of the given columns, counting the first column of
+    /// the input as column A. Values that aren't valid for the type of their column
+    /// are read as strings.
+    /// </summary>
+    std::unordered_map<column_t, column_type> column_types;
+
+    /// <summary>
+    /// If this is true, a file is mapped into memory and parsed in place instead
+    /// of being read through a stream, where the platform supports it.
+    /// </summary>
+    bool memory_map = true;
+
+    /// <summary>
+    /// The number of threads that parse the input. Zero means one per hardware
+    /// thread. Cells are always added to the worksheet by the calling thread.
+    /// </summary>
+    std::size_t threads = 0;
+
+    /// <summary>
+    /// The approximate number of bytes of input each thread parses at a time.
+    /// Inputs smaller than this are parsed by the calling thread alone.
+    /// </summary>
+    std::size_t chunk_size = 1 << 22;
+};
+
+} // namespace xlnt
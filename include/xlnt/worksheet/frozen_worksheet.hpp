@@ -0,0 +1,140 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_type.hpp>
+
+namespace xlnt {
+
+class cell_reference;
+class frozen_workbook;
+class range_reference;
+
+namespace detail {
+struct frozen_workbook_impl;
+struct frozen_worksheet_impl;
+} // namespace detail
+
+/// <summary>
+/// A read-only view of one worksheet of a frozen_workbook. Cells are kept in an
+/// array sorted by row and then column, so a lookup is a binary search and no
+/// memory is allocated or written while reading. Any number of threads may read
+/// the same frozen_worksheet concurrently without locking. A frozen_worksheet is
+/// only valid while a frozen_workbook sharing its snapshot exists.
+/// </summary>
+class XLNT_API frozen_worksheet
+{
+public:
+    /// <summary>
+    /// Returns the title of this sheet.
+    /// </summary>
+    const std::string &title() const;
+
+    /// <summary>
+    /// Returns the number of cells stored in this sheet.
+    /// </summary>
+    std::size_t cell_count() const;
+
+    /// <summary>
+    /// Returns true if the cell at reference existed when the workbook was frozen.
+    /// </summary>
+    bool has_cell(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns the type of the value of the cell at reference, or cell_type::empty
+    /// if there is no such cell.
+    /// </summary>
+    cell_type data_type(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns true if the cell at reference has a value.
+    /// </summary>
+    bool has_value(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns true if the cell at reference is a number with a date or time
+    /// number format, as in cell::is_date.
+    /// </summary>
+    bool is_date(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns the value of the cell at reference as an instance of type T. The
+    /// same types as cell::value<T>() are supported except rich_text. Throws
+    /// invalid_parameter if there is no cell at reference.
+    /// </summary>
+    template <typename T>
+    T value(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns true if the cell at reference has a formula.
+    /// </summary>
+    bool has_formula(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns the formula of the cell at reference. Throws invalid_attribute if
+    /// the cell has no formula.
+    /// </summary>
+    const std::string &formula(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns the smallest range containing every cell of this sheet.
+    /// </summary>
+    range_reference calculate_dimension() const;
+
+private:
+    friend class frozen_workbook;
+
+    /// <summary>
+    /// Constructs a view of sheet d in the snapshot parent.
+    /// </summary>
+    frozen_worksheet(const detail::frozen_workbook_impl *parent, const detail::frozen_worksheet_impl *d);
+
+    /// <summary>
+    /// Returns the position of the cell at reference in the sorted cell array or
+    /// the number of cells if there is no such cell.
+    /// </summary>
+    std::size_t find(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Returns the position of the cell at reference, throwing invalid_parameter
+    /// if there is no such cell.
+    /// </summary>
+    std::size_t at(const cell_reference &reference) const;
+
+    /// <summary>
+    /// The snapshot this sheet belongs to.
+    /// </summary>
+    const detail::frozen_workbook_impl *parent_;
+
+    /// <summary>
+    /// The contents of this sheet.
+    /// </summary>
+    const detail::frozen_worksheet_impl *d_;
+};
+
+} // namespace xlnt
@@ -32,6 +32,7 @@
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/styles/alignment.hpp>
 #include <xlnt/styles/border.hpp>
+#include <xlnt/styles/computed_style.hpp>
 #include <xlnt/styles/conditional_format.hpp>
 #include <xlnt/styles/fill.hpp>
 #include <xlnt/styles/font.hpp>
@@ -41,6 +42,8 @@
 #include <xlnt/worksheet/major_order.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/range_statistics.hpp>
+#include <xlnt/worksheet/sort_key.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
 namespace xlnt {
@@ -260,6 +263,38 @@ public:
     /// </summary>
     void apply(std::function<void(class cell)> f);
 
+    /// <summary>
+    /// Returns the statistics of the numeric cells in this range. If parallel is
+    /// true, the rows of a large range are divided between several threads.
+    /// </summary>
+    range_statistics aggregate(bool parallel = false) const;
+
+    /// <summary>
+    /// Returns the formatting each cell of this range is displayed with, row by row
+    /// from the top-left cell, including cells that don't exist yet. Cells with the
+    /// same format share one record, which stays valid after the workbook's styles
+    /// change but isn't updated with them. Like cell::computed_font, this fills a
+    /// cache in the workbook and isn't safe to call concurrently.
+    /// </summary>
+    std::vector<std::shared_ptr<const computed_style>> computed_styles() const;
+
+    /// <summary>
+    /// Reorders the rows of this range by the values of the key columns, comparing
+    /// by the next key where the previous ones are equal. Rows that are equal by
+    /// every key keep their order. Values are ordered as in Excel: numbers, then
+    /// text ignoring case, then FALSE and TRUE, then errors, and empty cells last.
+    /// Cells move with their formats, formulas, hyperlinks and comments, and
+    /// relative references in their formulas move with them. Cells outside the
+    /// columns of the range don't move. Throws invalid_parameter if there are no
+    /// keys, a key column is outside the range, or a merged range overlaps it.
+    /// </summary>
+    void sort(const std::vector<sort_key> &keys);
+
+    /// <summary>
+    /// Reorders the rows of this range by the values of column.
+    /// </summary>
+    void sort(column_t column, bool ascending = true);
+
     /// <summary>
     /// Returns the n-th row or column in this range.
     /// </summary>
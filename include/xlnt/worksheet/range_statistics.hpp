@@ -0,0 +1,104 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Summary statistics of the numeric values of a range of cells, computed in
+/// double precision. Cells of any other type are not included.
+/// </summary>
+class XLNT_API range_statistics
+{
+public:
+    /// <summary>
+    /// Constructs the statistics of no values.
+    /// </summary>
+    range_statistics();
+
+    /// <summary>
+    /// Constructs the statistics of values.
+    /// </summary>
+    range_statistics(const std::vector<double> &values);
+
+    /// <summary>
+    /// Returns the number of values.
+    /// </summary>
+    std::size_t count() const;
+
+    /// <summary>
+    /// Returns the sum of the values.
+    /// </summary>
+    double sum() const;
+
+    /// <summary>
+    /// Returns the smallest value, or 0 if there are none.
+    /// </summary>
+    double min() const;
+
+    /// <summary>
+    /// Returns the largest value, or 0 if there are none.
+    /// </summary>
+    double max() const;
+
+    /// <summary>
+    /// Returns the arithmetic mean of the values, or 0 if there are none.
+    /// </summary>
+    double mean() const;
+
+    /// <summary>
+    /// Returns the sample variance of the values, as Excel's VAR does, or 0 if
+    /// there are fewer than two.
+    /// </summary>
+    double variance() const;
+
+    /// <summary>
+    /// Returns the sample standard deviation of the values, as Excel's STDEV does,
+    /// or 0 if there are fewer than two.
+    /// </summary>
+    double standard_deviation() const;
+
+    /// <summary>
+    /// Combines the statistics of other's values into these, as if they had
+    /// been computed over both sets of values at once.
+    /// </summary>
+    range_statistics &operator+=(const range_statistics &other);
+
+private:
+    std::size_t count_ = 0;
+    double sum_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+
+    // the sum of squared differences from the mean
+    double squared_deviations_ = 0;
+};
+
+} // namespace xlnt
@@ -0,0 +1,143 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+class worksheet;
+
+namespace detail {
+struct row_writer_impl;
+} // namespace detail
+
+/// <summary>
+/// Writes cells of a worksheet in row-major order. Each cell is created in the
+/// row being written without a cell reference being constructed or looked up in
+/// the sheet, so writing n cells takes amortized O(n) time. A row_writer is
+/// obtained from worksheet::append_rows and is invalidated by any operation that
+/// removes rows from its worksheet, such as worksheet::garbage_collect.
+/// </summary>
+class XLNT_API row_writer
+{
+public:
+    /// <summary>
+    /// Constructs a row_writer that starts writing at the first column of row.
+    /// </summary>
+    row_writer(worksheet ws, row_t row);
+
+    /// <summary>
+    /// Move constructor.
+    /// </summary>
+    row_writer(row_writer &&other);
+
+    /// <summary>
+    /// Destructor.
+    /// </summary>
+    ~row_writer();
+
+    /// <summary>
+    /// Returns the next cell of the current row, creating it if needed, and
+    /// moves past it. Throws invalid_cell_reference if the row is full.
+    /// </summary>
+    class cell next_cell();
+
+    /// <summary>
+    /// Sets the value of the next cell of the current row to value.
+    /// </summary>
+    template <typename T>
+    row_writer &append(const T &value)
+    {
+        next_cell().value(value);
+        return *this;
+    }
+
+    /// <summary>
+    /// Moves past count cells of the current row without creating them.
+    /// </summary>
+    row_writer &skip_cells(column_t::index_t count);
+
+    /// <summary>
+    /// Moves to the first column of the following row.
+    /// </summary>
+    row_writer &next_row();
+
+    /// <summary>
+    /// Appends the given values to the current row and moves to the following row.
+    /// </summary>
+    template <typename T>
+    row_writer &append_row(std::initializer_list<T> values)
+    {
+        return append_row(values.begin(), values.end());
+    }
+
+    /// <summary>
+    /// Appends count values starting at values to the current row and moves to
+    /// the following row.
+    /// </summary>
+    template <typename T>
+    row_writer &append_row(const T *values, std::size_t count)
+    {
+        return append_row(values, values + count);
+    }
+
+    /// <summary>
+    /// Appends the values in [first, last) to the current row and moves to the
+    /// following row.
+    /// </summary>
+    template <typename Iterator>
+    row_writer &append_row(Iterator first, Iterator last)
+    {
+        for (; first != last; ++first)
+        {
+            next_cell().value(*first);
+        }
+
+        return next_row();
+    }
+
+    /// <summary>
+    /// Returns the row currently being written.
+    /// </summary>
+    row_t row() const;
+
+    /// <summary>
+    /// Returns the column of the cell that will be returned by the next call to next_cell.
+    /// Throws invalid_cell_reference if the last column of the row has been written.
+    /// </summary>
+    column_t column() const;
+
+private:
+    std::unique_ptr<detail::row_writer_impl> d_;
+};
+
+} // namespace xlnt
@@ -24,15 +24,18 @@
 
 #pragma once
 
+#include <iosfwd>
 #include <iterator>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/packaging/relationship.hpp>
+#include <xlnt/worksheet/csv_options.hpp>
 #include <xlnt/worksheet/page_margins.hpp>
 #include <xlnt/worksheet/page_setup.hpp>
 #include <xlnt/worksheet/sheet_view.hpp>
@@ -44,6 +47,7 @@ class cell_reference;
 class cell_vector;
 class column_properties;
 class comment;
+class computed_style;
 class condition;
 class conditional_format;
 class const_range_iterator;
@@ -52,8 +56,11 @@ class header;
 class range;
 class range_iterator;
 class range_reference;
+class range_statistics;
 class relationship;
 class row_properties;
+class row_writer;
+class sort_key;
 class workbook;
 
 struct date;
@@ -63,6 +70,8 @@ namespace detail {
 class xlsx_consumer;
 class xlsx_producer;
 
+struct cell_impl;
+struct format_impl;
 struct worksheet_impl;
 
 } // namespace detail
@@ -178,6 +187,19 @@ public:
     /// </summary>
     bool has_cell(const cell_reference &reference) const;
 
+    /// <summary>
+    /// Returns the references of the cells of this sheet with a formula in
+    /// row-major order. Cells without a formula aren't visited.
+    /// </summary>
+    std::vector<cell_reference> formula_cells() const;
+
+    /// <summary>
+    /// Sets the formula of every cell of reference to formula, as written in the
+    /// top-left cell, with its relative references moved to each cell. The text
+    /// is stored once for the whole range and is saved as a shared formula.
+    /// </summary>
+    void shared_formula(const range_reference &reference, const std::string &formula);
+
     /// <summary>
     /// Returns the cell at the given reference. If the cell doesn't exist, it
     /// will be initialized to null before being returned.
@@ -202,6 +224,26 @@ public:
     /// </summary>
     const class cell cell(column_t column, row_t row) const;
 
+    /// <summary>
+    /// Returns a row_writer that writes cells from the first column of the row
+    /// after the last row containing any cells.
+    /// </summary>
+    row_writer append_rows();
+
+    /// <summary>
+    /// Reads delimited text, such as comma or tab separated values, from the file
+    /// at filename and appends one row per record from the first column of the
+    /// row after the last row containing any cells. Empty values leave their cell
+    /// blank. See csv_options for how values are split and typed.
+    /// </summary>
+    void import_csv(const path &filename, const csv_options &options = csv_options());
+
+    /// <summary>
+    /// Reads delimited text from stream and appends it to this worksheet as
+    /// import_csv(const path &, const csv_options &) does.
+    /// </summary>
+    void import_csv(std::istream &stream, const csv_options &options = csv_options());
+
     /// <summary>
     /// Returns the range defined by reference string. If reference string is the name of
     /// a previously-defined named range in the sheet, it will be returned.
@@ -385,6 +427,12 @@ public:
     /// </summary>
     range_reference calculate_dimension() const;
 
+    /// <summary>
+    /// Returns the statistics of the numeric cells of the given column. If parallel
+    /// is true, the rows of a large sheet are divided between several threads.
+    /// </summary>
+    range_statistics column_stats(column_t column, bool parallel = false) const;
+
     // cell merge
 
     /// <summary>
@@ -393,7 +441,8 @@ public:
     void merge_cells(const std::string &reference_string);
 
     /// <summary>
-    /// Merges the cells within the given range.
+    /// Merges the cells within the given range. No cells are created for the
+    /// range. The values of existing cells other than the top-left one are cleared.
     /// </summary>
     void merge_cells(const range_reference &reference);
 
@@ -403,7 +452,8 @@ public:
     void unmerge_cells(const std::string &reference_string);
 
     /// <summary>
-    /// Removes the merging of the cells in the given range.
+    /// Removes the merging of the cells in the given range. Throws invalid_parameter
+    /// if the range hasn't been merged.
     /// </summary>
     void unmerge_cells(const range_reference &reference);
 
@@ -412,6 +462,35 @@ public:
     /// </summary>
     std::vector<range_reference> merged_ranges() const;
 
+    // insertion and deletion
+
+    /// <summary>
+    /// Inserts amount empty rows before row, moving the rows from row down. Formulas
+    /// of every sheet, merged ranges, the auto filter, the print area and titles,
+    /// named ranges, page breaks and row properties follow the rows they refer to.
+    /// Throws invalid_parameter if a cell would be moved past the last row.
+    /// </summary>
+    void insert_rows(row_t row, std::uint32_t amount);
+
+    /// <summary>
+    /// Inserts amount empty columns before column, moving the columns from column
+    /// right, as insert_rows does for rows.
+    /// </summary>
+    void insert_columns(column_t column, std::uint32_t amount);
+
+    /// <summary>
+    /// Deletes amount rows starting at row along with their cells, moving the rows
+    /// below them up. References to the deleted cells become #REF! and ranges
+    /// covering them shrink.
+    /// </summary>
+    void delete_rows(row_t row, std::uint32_t amount);
+
+    /// <summary>
+    /// Deletes amount columns starting at column along with their cells, moving
+    /// the columns right of them left, as delete_rows does for rows.
+    /// </summary>
+    void delete_columns(column_t column, std::uint32_t amount);
+
     // operators
 
     /// <summary>
@@ -525,6 +604,16 @@ public:
     /// </summary>
     void reserve(std::size_t n);
 
+    /// <summary>
+    /// Keeps roughly at most count cells of this sheet in memory. When more are used,
+    /// the rows least recently accessed through this sheet are written to a temporary
+    /// file and read back when next accessed. Cell handles to a row become invalid
+    /// once it has been written out, so handles should only be used until count other
+    /// cells have been accessed. Rows containing comments or rich text with fonts
+    /// are always kept in memory.
+    /// </summary>
+    void max_resident_cells(std::size_t count);
+
     /// <summary>
     /// Returns true if this sheet has a header/footer.
     /// </summary>
@@ -663,10 +752,22 @@ public:
 	/// </summary>
 	xlnt::conditional_format conditional_format(const range_reference &ref, const condition &when);
 
+    /// <summary>
+    /// Evaluates the conditional formats of this worksheet against the current values
+    /// of its cells. Returns each cell that satisfies a rule with the format of that
+    /// rule, ordered by row and then by column. Where the ranges of several rules a
+    /// cell satisfies overlap, the rule created first applies. Rules read from a file
+    /// are included when conditional_format can hold them. Formula expressions, color
+    /// scales, data bars, icon sets and the other kinds of rule are dropped on load.
+    /// </summary>
+    std::vector<std::pair<cell_reference, xlnt::conditional_format>> evaluate_conditional_formats() const;
+
 private:
     friend class cell;
+    friend class range;
     friend class const_range_iterator;
     friend class range_iterator;
+    friend class row_writer;
     friend class workbook;
     friend class detail::xlsx_consumer;
     friend class detail::xlsx_producer;
@@ -682,14 +783,51 @@ private:
     void register_comments_in_manifest();
 
     /// <summary>
-    /// Creates a calcChain part in the manifest if it doesn't already exist.
+    /// Records that the cell at reference has a formula. Creates a calcChain part
+    /// in the manifest if this is the first formula of the sheet.
+    /// </summary>
+    void add_formula_cell(const cell_reference &reference);
+
+    /// <summary>
+    /// Records that the cell at reference no longer has a formula. Removes the
+    /// calcChain part from the manifest if no formulae remain in the workbook.
+    /// </summary>
+    void remove_formula_cell(const cell_reference &reference);
+
+    /// <summary>
+    /// Removes the cell from the shared formula it belongs to, if any. If the cell
+    /// holds the text of the shared formula, each other cell of the group gets a
+    /// copy of its own formula first.
+    /// </summary>
+    void unshare_formula(detail::cell_impl &cell);
+
+    /// <summary>
+    /// Returns the statistics of the numeric cells within reference.
+    /// </summary>
+    range_statistics statistics(const range_reference &reference, bool parallel) const;
+
+    /// <summary>
+    /// Returns the effective formatting of cells with the given format, or with
+    /// the workbook's default format if format is null.
+    /// </summary>
+    std::shared_ptr<const computed_style> resolve_style(const detail::format_impl *format) const;
+
+    /// <summary>
+    /// Returns the effective formatting of each cell within reference, row by row.
+    /// </summary>
+    std::vector<std::shared_ptr<const computed_style>> computed_styles(const range_reference &reference) const;
+
+    /// <summary>
+    /// Reorders the rows of the cells within reference by keys.
     /// </summary>
-    void register_calc_chain_in_manifest();
+    void sort_rows(const range_reference &reference, const std::vector<sort_key> &keys);
 
     /// <summary>
-    /// Removes calcChain part from manifest if no formulae remain in workbook.
+    /// Renumbers the rows, or columns if rows is false, from first on by adding
+    /// offset, deleting the -offset lines from first if offset is negative, and
+    /// updates everything referring to them.
     /// </summary>
-    void garbage_collect_formulae();
+    void move_lines(bool rows, std::uint32_t first, long long offset);
     
     /// <summary>
     /// Sets the parent of this worksheet to wb.
@@ -34,6 +34,9 @@
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/cell/rich_text_run.hpp>
 
+// formula
+#include <xlnt/formula/formula_translator.hpp>
+
 // packaging
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/packaging/relationship.hpp>
@@ -43,6 +46,7 @@
 #include <xlnt/styles/alignment.hpp>
 #include <xlnt/styles/border.hpp>
 #include <xlnt/styles/color.hpp>
+#include <xlnt/styles/computed_style.hpp>
 #include <xlnt/styles/fill.hpp>
 #include <xlnt/styles/font.hpp>
 #include <xlnt/styles/format.hpp>
@@ -63,6 +67,8 @@
 // workbook
 #include <xlnt/workbook/document_security.hpp>
 #include <xlnt/workbook/external_book.hpp>
+#include <xlnt/workbook/frozen_workbook.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
@@ -75,6 +81,8 @@
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/cell_vector.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/csv_options.hpp>
+#include <xlnt/worksheet/frozen_worksheet.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/major_order.hpp>
@@ -84,8 +92,11 @@
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/range_statistics.hpp>
 #include <xlnt/worksheet/row_properties.hpp>
+#include <xlnt/worksheet/row_writer.hpp>
 #include <xlnt/worksheet/selection.hpp>
 #include <xlnt/worksheet/sheet_protection.hpp>
 #include <xlnt/worksheet/sheet_view.hpp>
+#include <xlnt/worksheet/sort_key.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
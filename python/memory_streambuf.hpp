@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+namespace xlnt {
+
+/// Read-only streambuf over a contiguous block of memory owned by someone
+/// else (e.g. a Python buffer protocol object or an mmap). No data is copied;
+/// the get area points directly at the block.
+class memory_streambuf : public std::basic_streambuf<char>
+{
+private:
+    typedef std::basic_streambuf<char> base_t;
+
+public:
+    typedef base_t::char_type char_type;
+    typedef base_t::int_type int_type;
+    typedef base_t::pos_type pos_type;
+    typedef base_t::off_type off_type;
+    typedef base_t::traits_type traits_type;
+
+    memory_streambuf(const char *data, std::size_t size)
+    {
+        auto begin = const_cast<char *>(data);
+        setg(begin, begin, begin + size);
+    }
+
+    memory_streambuf(const memory_streambuf &) = delete;
+    memory_streambuf &operator=(const memory_streambuf &) = delete;
+
+protected:
+    virtual std::streamsize showmanyc()
+    {
+        auto remaining = egptr() - gptr();
+        return remaining == 0 ? -1 : remaining;
+    }
+
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir way,
+        std::ios_base::openmode which = std::ios_base::in)
+    {
+        off_type base = gptr() - eback();
+
+        if (way == std::ios_base::beg)
+        {
+            base = 0;
+        }
+        else if (way == std::ios_base::end)
+        {
+            base = egptr() - eback();
+        }
+
+        return seekpos(pos_type(base + off), which);
+    }
+
+    virtual pos_type seekpos(pos_type sp, std::ios_base::openmode which = std::ios_base::in)
+    {
+        if ((which & std::ios_base::in) == 0
+            || off_type(sp) < 0
+            || off_type(sp) > egptr() - eback())
+        {
+            return pos_type(off_type(-1));
+        }
+
+        setg(eback(), eback() + off_type(sp), egptr());
+
+        return sp;
+    }
+};
+
+} // namespace xlnt
@@ -0,0 +1,81 @@
+import io
+import os
+import tempfile
+import unittest
+
+import pyarrow as pa
+import xlntpyarrow
+
+
+def make_table(rows):
+    numbers = pa.array([float(i) for i in range(rows)], pa.float64())
+    text = pa.array([str(i % 7) for i in range(rows)], pa.string())
+
+    return pa.Table.from_arrays([numbers, text], ['number', 'text'])
+
+
+def to_xlsx(table):
+    destination = io.BytesIO()
+    xlntpyarrow.arrow2xlsx(table, destination)
+
+    return destination.getvalue()
+
+
+def read_all(source, **kwargs):
+    return pa.Table.from_batches(list(xlntpyarrow.xlsx2arrow_batches(source, **kwargs)))
+
+
+class TestBatchReader(unittest.TestCase):
+    def test_round_trip(self):
+        table = make_table(1000)
+        result = read_all(to_xlsx(table), batch_size=64, threads=1)
+
+        self.assertEqual(result.num_rows, 1000)
+        self.assertTrue(result.equals(table))
+
+    def test_threads(self):
+        # a single sheet is split between one parser and several builders
+        data = to_xlsx(make_table(5000))
+        single = read_all(data, batch_size=100, threads=1)
+
+        for threads in [2, 4, 8]:
+            self.assertTrue(read_all(data, batch_size=100, threads=threads).equals(single))
+
+    def test_path(self):
+        table = make_table(10)
+        handle, path = tempfile.mkstemp(suffix='.xlsx')
+        os.close(handle)
+
+        try:
+            xlntpyarrow.arrow2xlsx(table, path)
+            self.assertTrue(read_all(path).equals(table))
+        finally:
+            os.remove(path)
+
+    def test_memoryview(self):
+        data = to_xlsx(make_table(10))
+        self.assertTrue(read_all(memoryview(data)).equals(read_all(data)))
+
+    def test_non_contiguous_buffer(self):
+        data = to_xlsx(make_table(10))
+        strided = memoryview(bytearray(data * 2))[::2]
+
+        with self.assertRaises(ValueError):
+            xlntpyarrow.xlsx2arrow_batches(strided)
+
+    def test_unsupported_type(self):
+        data = to_xlsx(make_table(10))
+        schema = pa.schema([pa.field('number', pa.list_(pa.int32()))])
+
+        with self.assertRaises(RuntimeError):
+            read_all(data, schema=schema)
+
+    def test_early_close(self):
+        # dropping a reader before it's exhausted stops its threads
+        reader = xlntpyarrow.xlsx2arrow_batches(to_xlsx(make_table(5000)), batch_size=10, threads=4)
+        next(reader)
+        del reader
+
+
+if __name__ == '__main__':
+    unittest.main()
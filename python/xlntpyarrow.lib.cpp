@@ -21,14 +21,25 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 #include <arrow/api.h>
 #include <arrow/python/pyarrow.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <xlnt/xlnt.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
+#include <memory_streambuf.hpp>
 #include <python_streambuf.hpp>
+#include <xlntarrow.hpp>
 
 void import_pyarrow()
 {
@@ -45,6 +56,14 @@ void import_pyarrow()
     }
 }
 
+void check(const arrow::Status &status)
+{
+    if (!status.ok())
+    {
+        throw std::runtime_error(status.ToString());
+    }
+}
+
 arrow::ArrayBuilder *make_array_builder(arrow::Type::type type)
 {
     auto pool = arrow::default_memory_pool();
@@ -167,10 +186,29 @@ void open_file(xlnt::streaming_workbook_reader &reader, pybind11::object file)
     reader.open(std::unique_ptr<std::streambuf>(new xlnt::python_streambuf(file)));
 }
 
+/// A cell copied out of a streaming_workbook_reader. The reader reuses one
+/// cell for everything it reads, so cells are copied before they are handed
+/// to another thread.
+struct raw_cell
+{
+    explicit raw_cell(xlnt::cell cell)
+        : column(static_cast<std::size_t>(cell.column().index - 1)),
+          has_value(cell.has_value()),
+          number(cell.value<long double>()),
+          text(cell.value<std::string>())
+    {
+    }
+
+    std::size_t column;
+    bool has_value;
+    long double number;
+    std::string text;
+};
+
 template<typename T>
-T cell_value(xlnt::cell cell)
+T cell_value(const raw_cell &cell)
 {
-    return static_cast<T>(cell.value<long double>());
+    return static_cast<T>(cell.number);
 }
 
 // from https://stackoverflow.com/questions/1659440/32-bit-to-16-bit-floating-point-conversion
@@ -184,142 +222,122 @@ std::uint16_t float_to_half(float f)
     return half;
 }
 
-void append_cell_value(arrow::ArrayBuilder *builder, arrow::Type::type type, xlnt::cell cell)
+// Builders of null columns are nullptr, see make_array_builder.
+arrow::Status append_null(arrow::ArrayBuilder *builder)
+{
+    return builder == nullptr ? arrow::Status::OK() : builder->AppendNull();
+}
+
+arrow::Status append_cell_value(arrow::ArrayBuilder *builder, arrow::Type::type type, const raw_cell &cell)
 {
     switch (type)
     {
     case arrow::Type::NA:
-        break;
+        return arrow::Status::OK();
 
     case arrow::Type::BOOL:
-        static_cast<arrow::BooleanBuilder *>(builder)
-            ->Append(cell.value<bool>());
-        break;
+        return static_cast<arrow::BooleanBuilder *>(builder)
+            ->Append(cell.number != 0);
 
     case arrow::Type::UINT8:
-        static_cast<arrow::UInt8Builder *>(builder)
+        return static_cast<arrow::UInt8Builder *>(builder)
             ->Append(cell_value<std::uint8_t>(cell));
-        break;
 
     case arrow::Type::INT8:
-      static_cast<arrow::Int8Builder *>(builder)
-          ->Append(cell_value<std::uint8_t>(cell));
-        break;
+        return static_cast<arrow::Int8Builder *>(builder)
+            ->Append(cell_value<std::int8_t>(cell));
 
     case arrow::Type::UINT16:
-        static_cast<arrow::UInt16Builder *>(builder)
+        return static_cast<arrow::UInt16Builder *>(builder)
             ->Append(cell_value<std::uint16_t>(cell));
-        break;
 
     case arrow::Type::INT16:
-        static_cast<arrow::Int16Builder *>(builder)
+        return static_cast<arrow::Int16Builder *>(builder)
             ->Append(cell_value<std::int16_t>(cell));
-        break;
 
     case arrow::Type::UINT32:
-        static_cast<arrow::UInt32Builder *>(builder)
+        return static_cast<arrow::UInt32Builder *>(builder)
             ->Append(cell_value<std::uint32_t>(cell));
-        break;
 
     case arrow::Type::INT32:
-        static_cast<arrow::Int32Builder *>(builder)
+        return static_cast<arrow::Int32Builder *>(builder)
             ->Append(cell_value<std::int32_t>(cell));
-        break;
 
     case arrow::Type::UINT64:
-        static_cast<arrow::UInt64Builder *>(builder)
+        return static_cast<arrow::UInt64Builder *>(builder)
             ->Append(cell_value<std::uint64_t>(cell));
-        break;
 
     case arrow::Type::INT64:
-        static_cast<arrow::Int64Builder *>(builder)
+        return static_cast<arrow::Int64Builder *>(builder)
             ->Append(cell_value<std::int64_t>(cell));
-        break;
 
     case arrow::Type::HALF_FLOAT:
-        static_cast<arrow::HalfFloatBuilder *>(builder)
+        return static_cast<arrow::HalfFloatBuilder *>(builder)
             ->Append(float_to_half(cell_value<float>(cell)));
-        break;
 
     case arrow::Type::FLOAT:
-        static_cast<arrow::FloatBuilder *>(builder)
+        return static_cast<arrow::FloatBuilder *>(builder)
             ->Append(cell_value<float>(cell));
-        break;
 
     case arrow::Type::DOUBLE:
-        static_cast<arrow::DoubleBuilder *>(builder)
+        return static_cast<arrow::DoubleBuilder *>(builder)
             ->Append(cell_value<long double>(cell));
-        break;
 
     case arrow::Type::STRING:
-        static_cast<arrow::StringBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::StringBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::BINARY:
-        static_cast<arrow::BinaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::BinaryBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::FIXED_SIZE_BINARY:
-        static_cast<arrow::FixedSizeBinaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::FixedSizeBinaryBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::DATE32:
-        static_cast<arrow::Date32Builder *>(builder)
+        return static_cast<arrow::Date32Builder *>(builder)
             ->Append(cell_value<arrow::Date32Type::c_type>(cell));
-        break;
 
     case arrow::Type::DATE64:
-        static_cast<arrow::Date64Builder *>(builder)
+        return static_cast<arrow::Date64Builder *>(builder)
             ->Append(cell_value<arrow::Date64Type::c_type>(cell));
-        break;
 
     case arrow::Type::TIMESTAMP:
-        static_cast<arrow::TimestampBuilder *>(builder)
+        return static_cast<arrow::TimestampBuilder *>(builder)
             ->Append(cell_value<arrow::TimestampType::c_type>(cell));
-        break;
 
     case arrow::Type::TIME32:
-        static_cast<arrow::Time32Builder *>(builder)
+        return static_cast<arrow::Time32Builder *>(builder)
             ->Append(cell_value<arrow::Time32Type::c_type>(cell));
-        break;
 
     case arrow::Type::TIME64:
-        static_cast<arrow::Time64Builder *>(builder)
+        return static_cast<arrow::Time64Builder *>(builder)
             ->Append(cell_value<arrow::Time64Type::c_type>(cell));
-        break;
 /*
     case arrow::Type::INTERVAL:
-        static_cast<arrow::IntervalBuilder *>(builder)
+        return static_cast<arrow::IntervalBuilder *>(builder)
             ->Append(cell_value<std::int64_t>(cell));
-        break;
 
     case arrow::Type::DECIMAL:
-        static_cast<arrow::DecimalBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::DecimalBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::LIST:
-        static_cast<arrow::ListBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::ListBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::STRUCT:
-        static_cast<arrow::StructBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::StructBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::UNION:
-        static_cast<arrow::UnionBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::UnionBuilder *>(builder)
+            ->Append(cell.text);
 
     case arrow::Type::DICTIONARY:
-        static_cast<arrow::DictionaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        return static_cast<arrow::DictionaryBuilder *>(builder)
+            ->Append(cell.text);
 */
     default:
         throw std::runtime_error("not implemented");
@@ -332,7 +350,7 @@ pybind11::handle read_batch(xlnt::streaming_workbook_reader &reader,
     import_pyarrow();
 
     std::shared_ptr<arrow::Schema> schema;
-    arrow::py::unwrap_schema(pyschema.ptr(), &schema);
+    check(arrow::py::unwrap_schema(pyschema.ptr(), &schema));
 
     std::vector<arrow::Type::type> column_types;
 
@@ -358,12 +376,11 @@ pybind11::handle read_batch(xlnt::streaming_workbook_reader &reader,
         {
             if (!reader.has_cell()) break;
 
-            auto cell = reader.read_cell();
-            auto zero_indexed_column = cell.column().index - 1;
-            auto column_type = column_types.at(zero_indexed_column);
-            auto builder = builders.at(zero_indexed_column).get();
+            auto cell = raw_cell(reader.read_cell());
+            auto column_type = column_types.at(cell.column);
+            auto builder = builders.at(cell.column).get();
 
-            append_cell_value(builder, column_type, cell);
+            check(append_cell_value(builder, column_type, cell));
         }
 
         ++row;
@@ -373,18 +390,649 @@ pybind11::handle read_batch(xlnt::streaming_workbook_reader &reader,
 
     for (auto &builder : builders)
     {
-        std::shared_ptr<arrow::Array> column;
-        builder->Finish(&column);
+        std::shared_ptr<arrow::Array> column = std::make_shared<arrow::NullArray>(row);
+        if (builder) check(builder->Finish(&column));
         columns.emplace_back(column);
     }
 
     auto batch_pointer = std::make_shared<arrow::RecordBatch>(schema, row, columns);
     auto batch_object = arrow::py::wrap_record_batch(batch_pointer);
+    if (batch_object == nullptr) throw pybind11::error_already_set();
     auto batch_handle = pybind11::handle(batch_object); // don't need to incr. reference count, right?
 
     return batch_handle;
 }
 
+std::shared_ptr<arrow::DataType> cell_type_to_arrow_type(xlnt::cell::type type)
+{
+    switch (type)
+    {
+    case xlnt::cell::type::number:
+        return arrow::float64();
+
+    case xlnt::cell::type::boolean:
+        return arrow::boolean();
+
+    case xlnt::cell::type::date:
+        return arrow::date32();
+
+    default:
+        return arrow::utf8();
+    }
+}
+
+/// Where a batch_reader gets its bytes from: either a file on disk, which
+/// each worker opens itself, or a contiguous block of memory exported by a
+/// Python buffer protocol object, which all workers read from without copying.
+struct batch_source
+{
+    std::string path;
+    const char *data = nullptr;
+    std::size_t size = 0;
+
+    void open(xlnt::streaming_workbook_reader &reader) const
+    {
+        if (data == nullptr)
+        {
+            reader.open(xlnt::path(path));
+        }
+        else
+        {
+            reader.open(std::unique_ptr<std::streambuf>(new xlnt::memory_streambuf(data, size)));
+        }
+    }
+};
+
+/// Returns true if the elements of the buffer described by info are laid out
+/// contiguously in row-major order, so that it can be read as one block.
+bool is_c_contiguous(const pybind11::buffer_info &info)
+{
+    auto expected_stride = info.itemsize;
+
+    for (auto dimension = info.shape.size(); dimension > 0; --dimension)
+    {
+        const auto extent = info.shape[dimension - 1];
+
+        if (extent > 1 && info.strides[dimension - 1] != expected_stride)
+        {
+            return false;
+        }
+
+        expected_stride *= extent;
+    }
+
+    return true;
+}
+
+using batch_future = std::future<std::shared_ptr<arrow::RecordBatch>>;
+
+/// Bounded single-consumer queue of the record batches of one sheet, in sheet
+/// order. Each batch may still be under construction on another thread.
+/// Workers block in push when the consumer falls behind so that memory use
+/// stays proportional to the queue capacity rather than the sheet size.
+class batch_queue
+{
+public:
+    explicit batch_queue(std::size_t capacity)
+        : capacity_(capacity)
+    {
+    }
+
+    bool push(batch_future batch)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return cancelled_ || batches_.size() < capacity_; });
+
+        if (cancelled_) return false;
+
+        batches_.push_back(std::move(batch));
+        not_empty_.notify_one();
+
+        return true;
+    }
+
+    void finish(std::exception_ptr error = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        error_ = error;
+        not_empty_.notify_all();
+    }
+
+    void cancel()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+        not_full_.notify_all();
+    }
+
+    // Returns nullptr once the sheet has been completely consumed.
+    std::shared_ptr<arrow::RecordBatch> pop()
+    {
+        batch_future batch;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() { return finished_ || !batches_.empty(); });
+
+            if (batches_.empty())
+            {
+                if (error_) std::rethrow_exception(error_);
+                return nullptr;
+            }
+
+            batch = std::move(batches_.front());
+            batches_.pop_front();
+            not_full_.notify_one();
+        }
+
+        // waits for the batch to be built and rethrows anything that went wrong
+        return batch.get();
+    }
+
+private:
+    const std::size_t capacity_;
+    std::deque<batch_future> batches_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    bool finished_ = false;
+    bool cancelled_ = false;
+    std::exception_ptr error_;
+};
+
+/// Runs tasks on a fixed set of threads in the order they were submitted.
+/// Tasks still queued when the pool is stopped are dropped.
+class task_pool
+{
+public:
+    explicit task_pool(std::size_t threads)
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            threads_.emplace_back([this]() { run(); });
+        }
+    }
+
+    task_pool(const task_pool &) = delete;
+    task_pool &operator=(const task_pool &) = delete;
+
+    ~task_pool()
+    {
+        stop();
+    }
+
+    bool empty() const
+    {
+        return threads_.empty();
+    }
+
+    void submit(std::function<void()> task)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        not_empty_.notify_one();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+            not_empty_.notify_all();
+        }
+
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+
+        threads_.clear();
+    }
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_empty_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+
+                if (stopped_) return;
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    bool stopped_ = false;
+};
+
+/// The cells of up to batch_size consecutive rows of a sheet as read by a
+/// streaming_workbook_reader, waiting to be converted into a record batch.
+struct raw_rows
+{
+    std::vector<raw_cell> cells;
+    // row i holds cells [row_ends[i - 1], row_ends[i])
+    std::vector<std::size_t> row_ends;
+};
+
+/// Decodes worksheets into Arrow record batches on background threads.
+/// Each sheet is parsed by one thread, since a worksheet's XML can only be
+/// read from the start. Threads that aren't needed for parsing convert the
+/// parsed rows into record batches, so a single sheet is still decoded by
+/// several threads. Batches are yielded in sheet order, so the output is
+/// deterministic regardless of the thread count. Nothing on the decoding
+/// path touches Python, so the GIL is only held while a finished batch is
+/// wrapped for the caller.
+class batch_reader
+{
+public:
+    batch_reader(pybind11::object source, std::vector<std::string> sheet_titles,
+        pybind11::object pyschema, std::int64_t batch_size, std::size_t threads)
+        : batch_size_(std::max(batch_size, std::int64_t(1)))
+    {
+        import_pyarrow();
+
+        if (pybind11::isinstance<pybind11::str>(source))
+        {
+            source_.path = source.cast<std::string>();
+        }
+        else
+        {
+            // holding the buffer keeps the exported memory valid for as long as workers may read it
+            buffer_ = source.cast<pybind11::buffer>().request();
+
+            if (!is_c_contiguous(buffer_))
+            {
+                throw pybind11::value_error("source must be a C-contiguous buffer");
+            }
+
+            source_.data = static_cast<const char *>(buffer_.ptr);
+            source_.size = static_cast<std::size_t>(buffer_.size * buffer_.itemsize);
+        }
+
+        if (!pyschema.is_none())
+        {
+            check(arrow::py::unwrap_schema(pyschema.ptr(), &schema_));
+        }
+
+        {
+            pybind11::gil_scoped_release release;
+
+            xlnt::streaming_workbook_reader reader;
+            source_.open(reader);
+
+            sheet_titles_ = sheet_titles.empty()
+                ? std::vector<std::string>{ reader.sheet_titles().front() }
+                : sheet_titles;
+
+            if (!schema_)
+            {
+                schema_ = infer_schema(reader, sheet_titles_.front());
+            }
+        }
+
+        for (auto i = 0; i < schema_->num_fields(); ++i)
+        {
+            column_types_.push_back(schema_->field(i)->type()->id());
+        }
+
+        for (std::size_t i = 0; i < sheet_titles_.size(); ++i)
+        {
+            queues_.emplace_back(new batch_queue(4));
+        }
+
+        if (threads == 0)
+        {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        const auto parsers = std::min(threads, sheet_titles_.size());
+        builders_.reset(new task_pool(threads - parsers));
+
+        for (std::size_t i = 0; i < parsers; ++i)
+        {
+            workers_.emplace_back([this]() { work(); });
+        }
+    }
+
+    batch_reader(const batch_reader &) = delete;
+    batch_reader &operator=(const batch_reader &) = delete;
+
+    ~batch_reader()
+    {
+        next_sheet_ = sheet_titles_.size();
+
+        for (auto &queue : queues_)
+        {
+            queue->cancel();
+        }
+
+        pybind11::gil_scoped_release release;
+
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+
+        builders_->stop();
+    }
+
+    pybind11::object schema() const
+    {
+        return pybind11::reinterpret_steal<pybind11::object>(arrow::py::wrap_schema(schema_));
+    }
+
+    pybind11::object next()
+    {
+        std::shared_ptr<arrow::RecordBatch> batch;
+
+        {
+            pybind11::gil_scoped_release release;
+
+            while (!batch && current_queue_ < queues_.size())
+            {
+                batch = queues_[current_queue_]->pop();
+
+                if (!batch)
+                {
+                    ++current_queue_;
+                }
+            }
+        }
+
+        if (!batch)
+        {
+            throw pybind11::stop_iteration();
+        }
+
+        auto batch_object = arrow::py::wrap_record_batch(batch);
+        if (batch_object == nullptr) throw pybind11::error_already_set();
+
+        return pybind11::reinterpret_steal<pybind11::object>(batch_object);
+    }
+
+private:
+    // Column names come from the first row and types from the second.
+    static std::shared_ptr<arrow::Schema> infer_schema(
+        xlnt::streaming_workbook_reader &reader, const std::string &title)
+    {
+        reader.begin_worksheet(title);
+
+        auto names = std::vector<std::string>();
+        auto fields = std::vector<std::shared_ptr<arrow::Field>>();
+
+        while (reader.has_cell())
+        {
+            auto cell = reader.read_cell();
+            auto column = static_cast<std::size_t>(cell.column().index - 1);
+
+            if (cell.row() == 1)
+            {
+                names.resize(std::max(names.size(), column + 1));
+                names[column] = cell.value<std::string>();
+            }
+            else if (cell.row() == 2)
+            {
+                if (column >= names.size()) continue;
+
+                while (fields.size() < column)
+                {
+                    fields.push_back(arrow::field(names[fields.size()], arrow::utf8()));
+                }
+
+                fields.push_back(arrow::field(names[column], cell_type_to_arrow_type(cell.data_type())));
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        while (fields.size() < names.size())
+        {
+            fields.push_back(arrow::field(names[fields.size()], arrow::utf8()));
+        }
+
+        return arrow::schema(fields);
+    }
+
+    void work()
+    {
+        while (true)
+        {
+            const auto sheet_index = next_sheet_++;
+
+            if (sheet_index >= sheet_titles_.size()) break;
+
+            auto &queue = *queues_[sheet_index];
+
+            try
+            {
+                parse_sheet(sheet_titles_[sheet_index], queue);
+                queue.finish();
+            }
+            catch (...)
+            {
+                queue.finish(std::current_exception());
+            }
+        }
+    }
+
+    // Converts rows into a batch on the pool, or right away if it has no threads.
+    batch_future build_batch(raw_rows rows) const
+    {
+        using task_type = std::packaged_task<std::shared_ptr<arrow::RecordBatch>()>;
+
+        auto shared_rows = std::make_shared<raw_rows>(std::move(rows));
+        auto task = std::make_shared<task_type>([this, shared_rows]() { return finish_batch(*shared_rows); });
+        auto batch = task->get_future();
+
+        if (builders_->empty())
+        {
+            (*task)();
+        }
+        else
+        {
+            builders_->submit([task]() { (*task)(); });
+        }
+
+        return batch;
+    }
+
+    std::shared_ptr<arrow::RecordBatch> finish_batch(const raw_rows &rows) const
+    {
+        const auto num_columns = column_types_.size();
+        const auto num_rows = static_cast<std::int64_t>(rows.row_ends.size());
+        auto builders = std::vector<std::unique_ptr<arrow::ArrayBuilder>>();
+
+        for (auto type : column_types_)
+        {
+            builders.emplace_back(make_array_builder(type));
+            if (builders.back()) check(builders.back()->Reserve(num_rows));
+        }
+
+        auto row_begin = std::size_t(0);
+
+        for (auto row_end : rows.row_ends)
+        {
+            auto next_column = std::size_t(0);
+
+            for (auto i = row_begin; i < row_end; ++i)
+            {
+                const auto &cell = rows.cells[i];
+
+                // cells are in column order, anything else is ignored
+                if (cell.column < next_column) continue;
+
+                while (next_column < cell.column)
+                {
+                    check(append_null(builders[next_column++].get()));
+                }
+
+                auto builder = builders[cell.column].get();
+                check(cell.has_value
+                    ? append_cell_value(builder, column_types_[cell.column], cell)
+                    : append_null(builder));
+
+                next_column = cell.column + 1;
+            }
+
+            // pads the rest of the row so that all columns stay aligned
+            while (next_column < num_columns)
+            {
+                check(append_null(builders[next_column++].get()));
+            }
+
+            row_begin = row_end;
+        }
+
+        auto columns = std::vector<std::shared_ptr<arrow::Array>>();
+
+        for (auto &builder : builders)
+        {
+            std::shared_ptr<arrow::Array> column = std::make_shared<arrow::NullArray>(num_rows);
+            if (builder) check(builder->Finish(&column));
+            columns.emplace_back(column);
+        }
+
+        return std::make_shared<arrow::RecordBatch>(schema_, num_rows, columns);
+    }
+
+    void parse_sheet(const std::string &title, batch_queue &queue)
+    {
+        xlnt::streaming_workbook_reader reader;
+        source_.open(reader);
+        reader.begin_worksheet(title);
+
+        const auto num_columns = column_types_.size();
+        auto rows = raw_rows();
+        auto current_row = xlnt::row_t(0);
+
+        while (reader.has_cell())
+        {
+            auto cell = reader.read_cell();
+
+            // the first row holds the column names
+            if (cell.row() == 1) continue;
+
+            if (cell.row() != current_row)
+            {
+                if (current_row != 0)
+                {
+                    rows.row_ends.push_back(rows.cells.size());
+                }
+
+                if (static_cast<std::int64_t>(rows.row_ends.size()) == batch_size_)
+                {
+                    if (!queue.push(build_batch(std::move(rows)))) return;
+                    rows = raw_rows();
+                }
+
+                current_row = cell.row();
+            }
+
+            if (static_cast<std::size_t>(cell.column().index - 1) < num_columns)
+            {
+                rows.cells.emplace_back(cell);
+            }
+        }
+
+        if (current_row != 0)
+        {
+            rows.row_ends.push_back(rows.cells.size());
+        }
+
+        if (!rows.row_ends.empty())
+        {
+            queue.push(build_batch(std::move(rows)));
+        }
+    }
+
+    const std::int64_t batch_size_;
+    batch_source source_;
+    pybind11::buffer_info buffer_;
+    std::vector<std::string> sheet_titles_;
+    std::shared_ptr<arrow::Schema> schema_;
+    std::vector<arrow::Type::type> column_types_;
+    std::vector<std::unique_ptr<batch_queue>> queues_;
+    std::atomic<std::size_t> next_sheet_{0};
+    std::size_t current_queue_ = 0;
+    std::unique_ptr<task_pool> builders_;
+    std::vector<std::thread> workers_;
+};
+
+/// Writes record batches from a Python iterable into a new xlsx file with a
+/// single sheet. The header row comes from the schema of the first batch.
+/// This doesn't stream: streaming_workbook_writer can't serialize cells yet,
+/// so the sheet is built and then saved with workbook::save. To keep memory
+/// from growing with the number of rows, the sheet keeps about two batches
+/// of cells in memory and moves older rows to a temporary file (see
+/// worksheet::max_resident_cells). Shared strings always stay in memory.
+/// The GIL is only held while fetching the next batch from the iterable and
+/// while writing to a Python file object.
+void write_batches(pybind11::object destination, const std::string &title, pybind11::iterable batches)
+{
+    import_pyarrow();
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+    ws.title(title);
+
+    auto next_row = xlnt::row_t(1);
+
+    for (auto pybatch : batches)
+    {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        check(arrow::py::unwrap_record_batch(pybatch.ptr(), &batch));
+
+        pybind11::gil_scoped_release release;
+
+        if (next_row == 1)
+        {
+            // columns are written one at a time, so a whole batch has to fit
+            const auto batch_cells = static_cast<std::size_t>(batch->num_rows())
+                * static_cast<std::size_t>(batch->num_columns());
+            ws.max_resident_cells(std::max(std::size_t(1) << 20, 2 * batch_cells));
+
+            for (auto i = 0; i < batch->num_columns(); ++i)
+            {
+                ws.cell(static_cast<xlnt::column_t::index_t>(i + 1), 1).value(batch->schema()->field(i)->name());
+            }
+
+            ++next_row;
+        }
+
+        xlnt::arrow2xlsx(*batch, ws, next_row);
+        next_row += static_cast<xlnt::row_t>(batch->num_rows());
+    }
+
+    if (pybind11::isinstance<pybind11::str>(destination))
+    {
+        const auto path = destination.cast<std::string>();
+        pybind11::gil_scoped_release release;
+        wb.save(path);
+    }
+    else
+    {
+        xlnt::python_streambuf buffer(destination);
+        std::ostream stream(&buffer);
+        wb.save(stream);
+        stream.flush();
+    }
+}
+
 PYBIND11_MODULE(lib, m)
 {
     m.doc() = "streaming read/write interface for C++ XLSX library xlnt";
@@ -400,6 +1048,17 @@ PYBIND11_MODULE(lib, m)
         .def("open", &open_file)
         .def("read_batch", &read_batch);
 
+    pybind11::class_<batch_reader>(m, "BatchReader")
+        .def(pybind11::init<pybind11::object, std::vector<std::string>, pybind11::object, std::int64_t, std::size_t>(),
+            pybind11::arg("source"), pybind11::arg("sheet_titles"), pybind11::arg("schema"),
+            pybind11::arg("batch_size"), pybind11::arg("threads"))
+        .def_property_readonly("schema", &batch_reader::schema)
+        .def("__iter__", [](pybind11::object self) { return self; })
+        .def("__next__", &batch_reader::next);
+
+    m.def("write_batches", &write_batches,
+        pybind11::arg("destination"), pybind11::arg("title"), pybind11::arg("batches"));
+
     pybind11::class_<xlnt::worksheet>(m, "Worksheet");
 
     pybind11::class_<xlnt::cell> cell(m, "Cell");
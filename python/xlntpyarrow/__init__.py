@@ -1,3 +1,4 @@
+import mmap
 import pyarrow as pa
 import xlntpyarrow.lib as xpa
 
@@ -77,6 +78,44 @@ def xlsx2arrow(io, sheetname):
 
     return pa.Table.from_batches(batches)
 
+def xlsx2arrow_batches(source, sheetnames=None, schema=None, batch_size=65536, threads=0):
+    """Returns an iterator of RecordBatches decoded on background threads.
+
+    source may be a path or any object supporting the buffer protocol
+    (bytes, memoryview, mmap). Paths are memory-mapped so that no data is
+    copied and the GIL is only taken to hand over finished batches. When
+    schema is None, column names are taken from the first row of the first
+    sheet and types from the second.
+    """
+    if isinstance(source, str):
+        with open(source, 'rb') as file:
+            source = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+
+    if sheetnames is None:
+        sheetnames = []
+    elif isinstance(sheetnames, str):
+        sheetnames = [sheetnames]
+
+    return xpa.BatchReader(source, sheetnames, schema, batch_size, threads)
+
+def arrow2xlsx(data, io, sheetname='Sheet1'):
+    """Writes a Table or an iterable of RecordBatches to io.
+
+    io may be a path or a writable binary file object. Column names are
+    written to the first row. Values are copied straight from the Arrow
+    buffers in C++; dictionary-encoded string columns are interned into the
+    shared string table once per dictionary entry.
+
+    The file is only written once every batch has been read. Rows of earlier
+    batches are moved to a temporary file meanwhile, so memory use depends
+    on the batch size and the number of distinct strings, not the number of
+    rows.
+    """
+    if isinstance(data, pa.Table):
+        data = data.to_batches()
+
+    xpa.write_batches(io, sheetname, data)
+
 if __name__ == '__main__':
     file = open('tmp.xlsx', 'rb')
     table = xlsx2arrow(file, 'Sheet1')
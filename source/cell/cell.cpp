@@ -24,15 +24,19 @@
 
 #include <algorithm>
 #include <cmath>
+#include <mutex>
 #include <sstream>
 
 #include <detail/implementations/cell_impl.hpp>
 #include <detail/implementations/format_impl.hpp>
 #include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/cell/comment.hpp>
 #include <xlnt/cell/rich_text.hpp>
+#include <xlnt/formula/formula_translator.hpp>
 #include <xlnt/packaging/relationship.hpp>
 #include <xlnt/styles/alignment.hpp>
 #include <xlnt/styles/border.hpp>
@@ -144,6 +148,29 @@ std::pair<bool, xlnt::time> cast_time(const std::string &s)
     return {true, result};
 }
 
+/// <summary>
+/// Locks the workbook of the cell d while worksheets are filled concurrently,
+/// or returns an empty lock otherwise.
+/// </summary>
+std::unique_lock<std::recursive_mutex> lock_workbook(const xlnt::detail::cell_impl *d)
+{
+    auto mutex = d->parent_->population_mutex_;
+    return mutex == nullptr ? std::unique_lock<std::recursive_mutex>() : std::unique_lock<std::recursive_mutex>(*mutex);
+}
+
+/// <summary>
+/// Returns the cell to write to in place of d. A handle obtained before its
+/// worksheet was copied may point into a row that is still shared with the
+/// copy, which is copied first so the copy doesn't see the change.
+/// </summary>
+xlnt::detail::cell_impl *unshared(xlnt::detail::cell_impl *d)
+{
+    auto sheet = d->parent_;
+    if (!sheet->rows_shared_) return d;
+
+    return &sheet->mutable_row(d->row_).at(d->column_);
+}
+
 } // namespace
 
 namespace xlnt {
@@ -204,48 +231,56 @@ void cell::value(std::nullptr_t)
 
 void cell::value(bool boolean_value)
 {
+    d_ = unshared(d_);
     d_->type_ = type::boolean;
     d_->value_numeric_ = boolean_value ? 1.0L : 0.0L;
 }
 
 void cell::value(int int_value)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = static_cast<long double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned int int_value)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = static_cast<long double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(long long int int_value)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = static_cast<long double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned long long int int_value)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = static_cast<long double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(float float_value)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = static_cast<long double>(float_value);
     d_->type_ = type::number;
 }
 
 void cell::value(double float_value)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = static_cast<long double>(float_value);
     d_->type_ = type::number;
 }
 
 void cell::value(long double d)
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = d;
     d_->type_ = type::number;
 }
@@ -257,10 +292,15 @@ void cell::value(const std::string &s)
 
 void cell::value(const rich_text &text)
 {
+    d_ = unshared(d_);
     check_string(text.plain_text());
 
+    const auto &local_strings = d_->parent_->local_strings_;
+
     d_->type_ = type::shared_string;
-    d_->value_numeric_ = static_cast<long double>(workbook().add_shared_string(text));
+    d_->value_numeric_ = static_cast<long double>(local_strings
+        ? local_strings->add(text)
+        : workbook().add_shared_string(text));
 }
 
 void cell::value(const char *c)
@@ -270,16 +310,40 @@ void cell::value(const char *c)
 
 void cell::value(const cell c)
 {
+    d_ = unshared(d_);
+    const auto lock = lock_workbook(d_);
+
+    const auto had_formula = has_formula();
+    auto formula = c.has_formula() ? optional<std::string>(c.formula()) : optional<std::string>();
+    worksheet().unshare_formula(*d_);
+
+    if (formula.is_set())
+    {
+        worksheet().add_formula_cell(reference());
+    }
+    else if (had_formula)
+    {
+        worksheet().remove_formula_cell(reference());
+    }
+
     d_->type_ = c.d_->type_;
     d_->value_numeric_ = c.d_->value_numeric_;
     d_->value_text_ = c.d_->value_text_;
     d_->hyperlink_ = c.d_->hyperlink_;
-    d_->formula_ = c.d_->formula_;
+    d_->formula_ = formula;
     d_->format_ = c.d_->format_;
+
+    // strings of sheets being filled concurrently are numbered per sheet
+    if (c.d_->type_ == type::shared_string && c.d_->parent_ != d_->parent_
+        && (c.d_->parent_->local_strings_ || d_->parent_->local_strings_))
+    {
+        value(c.value<rich_text>());
+    }
 }
 
 void cell::value(const date &d)
 {
+    d_ = unshared(d_);
     d_->type_ = type::number;
     d_->value_numeric_ = d.to_number(base_date());
     number_format(number_format::date_yyyymmdd2());
@@ -287,6 +351,7 @@ void cell::value(const date &d)
 
 void cell::value(const datetime &d)
 {
+    d_ = unshared(d_);
     d_->type_ = type::number;
     d_->value_numeric_ = d.to_number(base_date());
     number_format(number_format::date_datetime());
@@ -294,6 +359,7 @@ void cell::value(const datetime &d)
 
 void cell::value(const time &t)
 {
+    d_ = unshared(d_);
     d_->type_ = type::number;
     d_->value_numeric_ = t.to_number();
     number_format(number_format::date_time6());
@@ -301,6 +367,7 @@ void cell::value(const time &t)
 
 void cell::value(const timedelta &t)
 {
+    d_ = unshared(d_);
     d_->type_ = type::number;
     d_->value_numeric_ = t.to_number();
     number_format(xlnt::number_format("[hh]:mm:ss"));
@@ -318,12 +385,13 @@ column_t cell::column() const
 
 void cell::merged(bool merged)
 {
+    d_ = unshared(d_);
     d_->is_merged_ = merged;
 }
 
 bool cell::is_merged() const
 {
-    return d_->is_merged_;
+    return d_->is_merged_ || d_->parent_->merged_cells_.contains(reference());
 }
 
 bool cell::is_date() const
@@ -348,9 +416,11 @@ bool cell::operator==(const cell &comparand) const
 
 cell &cell::operator=(const cell &rhs)
 {
+    d_ = unshared(d_);
     d_->column_ = rhs.d_->column_;
     d_->format_ = rhs.d_->format_;
     d_->formula_ = rhs.d_->formula_;
+    d_->shared_formula_ = rhs.d_->shared_formula_;
     d_->hyperlink_ = rhs.d_->hyperlink_;
     d_->is_merged_ = rhs.d_->is_merged_;
     d_->parent_ = rhs.d_->parent_;
@@ -369,6 +439,7 @@ std::string cell::hyperlink() const
 
 void cell::hyperlink(const std::string &hyperlink)
 {
+    d_ = unshared(d_);
     if (hyperlink.length() == 0 || std::find(hyperlink.begin(), hyperlink.end(), ':') == hyperlink.end())
     {
         throw invalid_parameter();
@@ -390,11 +461,15 @@ void cell::hyperlink(xlnt::cell /*target*/)
 
 void cell::formula(const std::string &formula)
 {
+    d_ = unshared(d_);
+    const auto lock = lock_workbook(d_);
     if (formula.empty())
     {
         return clear_formula();
     }
 
+    worksheet().unshare_formula(*d_);
+
     if (formula[0] == '=')
     {
         d_->formula_ = formula.substr(1);
@@ -405,31 +480,43 @@ void cell::formula(const std::string &formula)
     }
 
     data_type(type::number);
-    
-    worksheet().register_calc_chain_in_manifest();
+    worksheet().add_formula_cell(reference());
 }
 
 bool cell::has_formula() const
 {
-    return d_->formula_.is_set();
+    return d_->formula_.is_set() || d_->shared_formula_.is_set();
 }
 
 std::string cell::formula() const
 {
+    if (d_->shared_formula_.is_set())
+    {
+        const auto &shared = d_->parent_->shared_formulae_.at(d_->shared_formula_.get());
+        const auto here = reference();
+
+        return here == shared.anchor_ ? shared.formula_ : formula_translator(shared.formula_, shared.anchor_).translate(here);
+    }
+
     return d_->formula_.get();
 }
 
 void cell::clear_formula()
 {
+    d_ = unshared(d_);
+    const auto lock = lock_workbook(d_);
+
     if (has_formula())
     {
+        worksheet().unshare_formula(*d_);
         d_->formula_.clear();
-        worksheet().garbage_collect_formulae();
+        worksheet().remove_formula_cell(reference());
     }
 }
 
 void cell::error(const std::string &error)
 {
+    d_ = unshared(d_);
     if (error.length() == 0 || error[0] != '#')
     {
         throw invalid_data_type();
@@ -490,41 +577,43 @@ cell::type cell::data_type() const
 
 void cell::data_type(type t)
 {
+    d_ = unshared(d_);
     d_->type_ = t;
 }
 
 number_format cell::computed_number_format() const
 {
-    return xlnt::number_format();
+    return worksheet().resolve_style(d_->format_.is_set() ? d_->format_.get() : nullptr)->number_format;
 }
 
 font cell::computed_font() const
 {
-    return xlnt::font();
+    return worksheet().resolve_style(d_->format_.is_set() ? d_->format_.get() : nullptr)->font;
 }
 
 fill cell::computed_fill() const
 {
-    return xlnt::fill();
+    return worksheet().resolve_style(d_->format_.is_set() ? d_->format_.get() : nullptr)->fill;
 }
 
 border cell::computed_border() const
 {
-    return xlnt::border();
+    return worksheet().resolve_style(d_->format_.is_set() ? d_->format_.get() : nullptr)->border;
 }
 
 alignment cell::computed_alignment() const
 {
-    return xlnt::alignment();
+    return worksheet().resolve_style(d_->format_.is_set() ? d_->format_.get() : nullptr)->alignment;
 }
 
 protection cell::computed_protection() const
 {
-    return xlnt::protection();
+    return worksheet().resolve_style(d_->format_.is_set() ? d_->format_.get() : nullptr)->protection;
 }
 
 void cell::clear_value()
 {
+    d_ = unshared(d_);
     d_->value_numeric_ = 0;
     d_->value_text_.clear();
     d_->type_ = cell::type::empty;
@@ -605,36 +694,48 @@ XLNT_API timedelta cell::value() const
 
 void cell::alignment(const class alignment &alignment_)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
     format(new_format.alignment(alignment_, true));
 }
 
 void cell::border(const class border &border_)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
     format(new_format.border(border_, true));
 }
 
 void cell::fill(const class fill &fill_)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
     format(new_format.fill(fill_, true));
 }
 
 void cell::font(const class font &font_)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
     format(new_format.font(font_, true));
 }
 
 void cell::number_format(const class number_format &number_format_)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
     format(new_format.number_format(number_format_, true));
 }
 
 void cell::protection(const class protection &protection_)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? modifiable_format() : workbook().create_format();
     format(new_format.protection(protection_, true));
 }
@@ -650,7 +751,11 @@ XLNT_API rich_text cell::value() const
 {
     if (data_type() == cell::type::shared_string)
     {
-        return workbook().shared_strings().at(static_cast<std::size_t>(d_->value_numeric_));
+        const auto index = static_cast<std::size_t>(d_->value_numeric_);
+        const auto &local_strings = d_->parent_->local_strings_;
+
+        return local_strings && local_strings->contains(index) ? local_strings->at(index)
+                                                              : workbook().shared_strings().at(index);
     }
 
     return d_->value_text_;
@@ -691,6 +796,8 @@ bool cell::has_format() const
 
 void cell::format(const class format new_format)
 {
+    d_ = unshared(d_);
+    const auto lock = lock_workbook(d_);
     if (has_format())
     {
         format().d_->references -= format().d_->references > 0 ? 1 : 0;
@@ -764,12 +871,16 @@ void cell::value(const std::string &value_string, bool infer_type)
 
 void cell::clear_format()
 {
+    d_ = unshared(d_);
+    const auto lock = lock_workbook(d_);
     format().d_->references -= format().d_->references > 0 ? 1 : 0;
     d_->format_.clear();
 }
 
 void cell::clear_style()
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     if (has_format())
     {
         modifiable_format().clear_style();
@@ -778,17 +889,22 @@ void cell::clear_style()
 
 void cell::style(const class style &new_style)
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     auto new_format = has_format() ? format() : workbook().create_format();
     format(new_format.style(new_style));
 }
 
 void cell::style(const std::string &style_name)
 {
+    const auto lock = lock_workbook(d_);
     style(workbook().style(style_name));
 }
 
 style cell::style()
 {
+    detach_stylesheet();
+    const auto lock = lock_workbook(d_);
     if (!has_format() || !format().has_style())
     {
         throw invalid_attribute();
@@ -801,6 +917,7 @@ style cell::style()
 
 const style cell::style() const
 {
+    const auto lock = lock_workbook(d_);
 	if (!has_format() || !format().has_style())
 	{
 		throw invalid_attribute();
@@ -811,9 +928,24 @@ const style cell::style() const
 
 bool cell::has_style() const
 {
+    const auto lock = lock_workbook(d_);
     return has_format() && format().has_style();
 }
 
+void cell::detach_stylesheet()
+{
+    auto sheet = d_->parent_;
+    auto &wb = *sheet->parent_;
+    if (wb.d_->stylesheet_.use_count() <= 1) return;
+
+    const auto column = d_->column_;
+    const auto row = d_->row_;
+    wb.modifiable_stylesheet();
+
+    // the row of this cell may have been copied or moved to the row store
+    d_ = &sheet->mutable_row(row).at(column);
+}
+
 format cell::modifiable_format()
 {
     if (!d_->format_.is_set())
@@ -836,31 +968,37 @@ const format cell::format() const
 
 alignment cell::alignment() const
 {
+    const auto lock = lock_workbook(d_);
     return format().alignment();
 }
 
 border cell::border() const
 {
+    const auto lock = lock_workbook(d_);
     return format().border();
 }
 
 fill cell::fill() const
 {
+    const auto lock = lock_workbook(d_);
     return format().fill();
 }
 
 font cell::font() const
 {
+    const auto lock = lock_workbook(d_);
     return format().font();
 }
 
 number_format cell::number_format() const
 {
+    const auto lock = lock_workbook(d_);
     return format().number_format();
 }
 
 protection cell::protection() const
 {
+    const auto lock = lock_workbook(d_);
     return format().protection();
 }
 
@@ -878,6 +1016,7 @@ bool cell::has_comment()
 
 void cell::clear_comment()
 {
+    d_ = unshared(d_);
     d_->comment_.clear();
 }
 
@@ -904,6 +1043,8 @@ void cell::comment(const std::string &text, const class font &comment_font, cons
 
 void cell::comment(const class comment &new_comment)
 {
+    d_ = unshared(d_);
+    const auto lock = lock_workbook(d_);
     d_->comment_.set(new_comment);
 
     // offset comment 5 pixels down and 5 pixels right of the top right corner of the cell
@@ -105,6 +105,9 @@ public:
     compound_document_istreambuf(const compound_document_entry &entry, compound_document &document)
         : entry_(entry),
           document_(document),
+          chain_(entry.size < document.header_.threshold
+              ? document.follow_chain(entry.start, document.ssat_)
+              : document.follow_chain(entry.start, document.sat_)),
           sector_writer_(current_sector_),
           position_(0)
     {
@@ -122,7 +125,7 @@ private:
 
         if (entry_.size < document_.header_.threshold)
         {
-            const auto chain = document_.follow_chain(entry_.start, document_.ssat_);
+            const auto &chain = chain_;
             auto current_sector = chain[position_ / document_.short_sector_size()];
             auto remaining = std::min(std::size_t(entry_.size) - position_, std::size_t(count));
 
@@ -161,7 +164,7 @@ private:
         }
         else
         {
-            const auto chain = document_.follow_chain(entry_.start, document_.sat_);
+            const auto &chain = chain_;
             auto current_sector = chain[position_ / document_.sector_size()];
             auto remaining = std::min(std::size_t(entry_.size) - position_, std::size_t(count));
 
@@ -295,6 +298,7 @@ private:
 private:
     const compound_document_entry &entry_;
     compound_document &document_;
+    const sector_chain chain_;
     binary_writer<byte> sector_writer_;
     std::vector<byte> current_sector_;
     std::size_t position_;
@@ -304,6 +308,163 @@ compound_document_istreambuf::~compound_document_istreambuf()
 {
 }
 
+/// <summary>
+/// Reads a stream directly from the memory backing a compound_document
+/// without copying. The sector chain of the stream is resolved once on
+/// construction so that seeking to any position is a constant time lookup.
+/// </summary>
+class compound_document_view_istreambuf : public std::streambuf
+{
+    using int_type = std::streambuf::int_type;
+
+public:
+    compound_document_view_istreambuf(const compound_document_entry &entry, compound_document &document)
+        : size_(entry.size),
+          segment_size_(entry.size < document.header_.threshold
+              ? document.short_sector_size()
+              : document.sector_size()),
+          position_(0)
+    {
+        const auto is_short = entry.size < document.header_.threshold;
+        const auto chain = document.follow_chain(entry.start, is_short ? document.ssat_ : document.sat_);
+
+        if (chain.size() * segment_size_ < size_)
+        {
+            throw xlnt::exception("bad sector chain");
+        }
+
+        segments_.reserve(chain.size());
+
+        // only the part of each sector that holds stream data has to be in the buffer
+        for (std::size_t i = 0; i < chain.size() && i * segment_size_ < size_; ++i)
+        {
+            const auto length = std::min(segment_size_, size_ - i * segment_size_);
+            segments_.push_back(is_short
+                ? document.short_sector_data(chain[i], length)
+                : document.sector_data(chain[i], length));
+        }
+    }
+
+    compound_document_view_istreambuf(const compound_document_view_istreambuf &) = delete;
+    compound_document_view_istreambuf &operator=(const compound_document_view_istreambuf &) = delete;
+
+    virtual ~compound_document_view_istreambuf();
+
+private:
+    std::size_t current_position() const
+    {
+        return position_ + static_cast<std::size_t>(gptr() - eback());
+    }
+
+    // Points the get area at the sector containing the given stream position.
+    bool load_segment(std::size_t position)
+    {
+        if (position >= size_)
+        {
+            position_ = size_;
+            setg(nullptr, nullptr, nullptr);
+
+            return false;
+        }
+
+        const auto index = position / segment_size_;
+        const auto start = index * segment_size_;
+        const auto length = std::min(segment_size_, size_ - start);
+        auto begin = const_cast<char *>(reinterpret_cast<const char *>(segments_[index]));
+
+        position_ = start;
+        setg(begin, begin + (position - start), begin + length);
+
+        return true;
+    }
+
+    int_type underflow() override
+    {
+        if (gptr() != nullptr && gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        if (!load_segment(current_position()))
+        {
+            return traits_type::eof();
+        }
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize xsgetn(char *c, std::streamsize count) override
+    {
+        auto bytes_read = std::streamsize(0);
+
+        while (bytes_read < count)
+        {
+            if (gptr() == egptr() && !load_segment(current_position()))
+            {
+                break;
+            }
+
+            const auto to_read = std::min(count - bytes_read, static_cast<std::streamsize>(egptr() - gptr()));
+            std::memcpy(c + bytes_read, gptr(), static_cast<std::size_t>(to_read));
+            gbump(static_cast<int>(to_read));
+            bytes_read += to_read;
+        }
+
+        return bytes_read;
+    }
+
+    std::streamsize showmanyc() override
+    {
+        const auto position = current_position();
+
+        if (position >= size_)
+        {
+            return static_cast<std::streamsize>(-1);
+        }
+
+        return static_cast<std::streamsize>(size_ - position);
+    }
+
+    std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode mode) override
+    {
+        auto base = static_cast<std::streamoff>(current_position());
+
+        if (way == std::ios_base::beg)
+        {
+            base = 0;
+        }
+        else if (way == std::ios_base::end)
+        {
+            base = static_cast<std::streamoff>(size_);
+        }
+
+        return seekpos(base + off, mode);
+    }
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode) override
+    {
+        if (sp < 0 || static_cast<std::size_t>(sp) > size_)
+        {
+            return static_cast<std::ptrdiff_t>(-1);
+        }
+
+        load_segment(static_cast<std::size_t>(sp));
+
+        return sp;
+    }
+
+private:
+    const std::size_t size_;
+    const std::size_t segment_size_;
+    std::vector<const std::uint8_t *> segments_;
+    // stream position of eback()
+    std::size_t position_;
+};
+
+compound_document_view_istreambuf::~compound_document_view_istreambuf()
+{
+}
+
 /// <summary>
 /// Allows a std::vector to be written through a std::ostream.
 /// </summary>
@@ -538,6 +699,24 @@ compound_document::compound_document(std::istream &in)
     read_directory();
 }
 
+compound_document::compound_document(const std::uint8_t *data, std::size_t size)
+    : data_(data),
+      data_size_(size),
+      stream_in_(nullptr),
+      stream_out_(nullptr)
+{
+    if (size < sizeof(compound_document_header))
+    {
+        throw xlnt::exception("bad header");
+    }
+
+    read_header();
+    read_msat();
+    read_sat();
+    read_ssat();
+    read_directory();
+}
+
 compound_document::~compound_document()
 {
     close();
@@ -568,7 +747,15 @@ std::istream &compound_document::open_read_stream(const std::string &name)
     const auto entry_id = find_entry(name, compound_document_entry::entry_type::UserStream);
     const auto &entry = entries_.at(static_cast<std::size_t>(entry_id));
 
-    stream_in_buffer_.reset(new compound_document_istreambuf(entry, *this));
+    if (data_ != nullptr)
+    {
+        stream_in_buffer_.reset(new compound_document_view_istreambuf(entry, *this));
+    }
+    else
+    {
+        stream_in_buffer_.reset(new compound_document_istreambuf(entry, *this));
+    }
+
     stream_in_.rdbuf(stream_in_buffer_.get());
 
     return stream_in_;
@@ -606,12 +793,57 @@ void compound_document::write_short_sector(binary_reader<T> &reader, sector_id i
         static_cast<std::ptrdiff_t>(std::min(short_sector_size(), reader.bytes() - reader.offset())));
 }
 
+void compound_document::read_bytes(std::size_t offset, void *destination, std::size_t count)
+{
+    if (data_ != nullptr)
+    {
+        if (offset > data_size_ || count > data_size_ - offset)
+        {
+            throw xlnt::exception("read past end of compound document");
+        }
+
+        std::memcpy(destination, data_ + offset, count);
+
+        return;
+    }
+
+    in_->seekg(static_cast<std::ptrdiff_t>(offset));
+    in_->read(reinterpret_cast<char *>(destination), static_cast<std::ptrdiff_t>(count));
+}
+
+const std::uint8_t *compound_document::sector_data(sector_id id, std::size_t length)
+{
+    const auto offset = sector_data_start() + sector_size() * static_cast<std::size_t>(id);
+
+    // the last sector of a file may be truncated as long as the bytes in use are present
+    if (id < 0 || offset > data_size_ || length > data_size_ - offset)
+    {
+        throw xlnt::invalid_file("truncated compound document sector");
+    }
+
+    return data_ + offset;
+}
+
+const std::uint8_t *compound_document::short_sector_data(sector_id id, std::size_t length)
+{
+    const auto short_sectors_per_sector = sector_size() / short_sector_size();
+    const auto container_index = static_cast<std::size_t>(id) / short_sectors_per_sector;
+
+    if (id < 0 || container_index >= short_container_chain_.size())
+    {
+        throw xlnt::exception("bad short sector");
+    }
+
+    const auto offset = (static_cast<std::size_t>(id) % short_sectors_per_sector) * short_sector_size();
+
+    return sector_data(short_container_chain_[container_index], offset + length) + offset;
+}
+
 template<typename T>
 void compound_document::read_sector(sector_id id, binary_writer<T> &writer)
 {
-    in_->seekg(static_cast<std::ptrdiff_t>(sector_data_start() + sector_size() * static_cast<std::size_t>(id)));
     std::vector<byte> sector(sector_size(), 0);
-    in_->read(reinterpret_cast<char *>(sector.data()), static_cast<std::ptrdiff_t>(sector_size()));
+    read_bytes(sector_data_start() + sector_size() * static_cast<std::size_t>(id), sector.data(), sector_size());
     writer.append(sector);
 }
 
@@ -638,19 +870,14 @@ void compound_document::read_sector_chain(sector_id start, binary_writer<T> &wri
 template<typename T>
 void compound_document::read_short_sector(sector_id id, binary_writer<T> &writer)
 {
-    const auto container_chain = follow_chain(entries_[0].start, sat_);
-    auto container = std::vector<byte>();
-    auto container_writer = binary_writer<byte>(container);
-    
-    for (auto sector : container_chain)
-    {
-        read_sector(sector, container_writer);
-    }
-
-    auto container_reader = binary_reader<byte>(container);
-    container_reader.offset(static_cast<std::size_t>(id) * short_sector_size());
+    const auto short_sectors_per_sector = sector_size() / short_sector_size();
+    const auto container_sector = short_container_chain_.at(static_cast<std::size_t>(id) / short_sectors_per_sector);
+    const auto container_offset = (static_cast<std::size_t>(id) % short_sectors_per_sector) * short_sector_size();
 
-    writer.append(container_reader, short_sector_size());
+    std::vector<byte> sector(short_sector_size(), 0);
+    read_bytes(sector_data_start() + sector_size() * static_cast<std::size_t>(container_sector) + container_offset,
+        sector.data(), short_sector_size());
+    writer.append(sector);
 }
 
 template<typename T>
@@ -1016,6 +1243,8 @@ void compound_document::read_directory()
             }
         }
     }
+
+    short_container_chain_ = follow_chain(entries_[0].start, sat_);
 }
 
 void compound_document::tree_insert(directory_id new_id, directory_id storage_id)
@@ -1257,8 +1486,7 @@ compound_document_entry::entry_color &compound_document::tree_color(directory_id
 
 void compound_document::read_header()
 {
-    in_->seekg(0, std::ios::beg);
-    in_->read(reinterpret_cast<char *>(&header_), sizeof(compound_document_header));
+    read_bytes(0, &header_, sizeof(compound_document_header));
 }
 
 void compound_document::read_msat()
@@ -1314,8 +1542,7 @@ void compound_document::read_entry(directory_id id)
     const auto offset = sector_size() * static_cast<std::size_t>(directory_sector)
         + ((static_cast<std::size_t>(id) % entries_per_sector) * sizeof(compound_document_entry));
 
-    in_->seekg(static_cast<std::ptrdiff_t>(sector_data_start() + offset), std::ios::beg);
-    in_->read(reinterpret_cast<char *>(&entries_[static_cast<std::size_t>(id)]), sizeof(compound_document_entry));
+    read_bytes(sector_data_start() + offset, &entries_[static_cast<std::size_t>(id)], sizeof(compound_document_entry));
 }
 
 void compound_document::write_header()
@@ -115,12 +115,17 @@ struct compound_document_entry
 
 class compound_document_istreambuf;
 class compound_document_ostreambuf;
+class compound_document_view_istreambuf;
 
 class compound_document
 {
 public:
     compound_document(std::istream &in);
     compound_document(std::ostream &out);
+
+    // Reads directly from a contiguous buffer which must outlive this document.
+    // Streams opened for reading are then served from the buffer without copying.
+    compound_document(const std::uint8_t *data, std::size_t size);
     ~compound_document();
 
     void close();
@@ -131,6 +136,7 @@ public:
 private:
     friend class compound_document_istreambuf;
     friend class compound_document_ostreambuf;
+    friend class compound_document_view_istreambuf;
 
     template<typename T>
     void read_sector(sector_id id, binary_writer<T> &writer);
@@ -147,6 +153,10 @@ private:
 
     sector_chain follow_chain(sector_id start, const sector_chain &table);
 
+    void read_bytes(std::size_t offset, void *destination, std::size_t count);
+    const std::uint8_t *sector_data(sector_id id, std::size_t length);
+    const std::uint8_t *short_sector_data(sector_id id, std::size_t length);
+
     template<typename T>
     void write_sector(binary_reader<T> &reader, sector_id id);
     template<typename T>
@@ -212,10 +222,14 @@ private:
     std::unordered_map<directory_id, directory_id> parent_storage_;
     std::unordered_map<directory_id, directory_id> parent_;
 
-    std::istream *in_;
-    std::ostream *out_;
+    std::istream *in_ = nullptr;
+    std::ostream *out_ = nullptr;
+
+    const std::uint8_t *data_ = nullptr;
+    std::size_t data_size_ = 0;
+    sector_chain short_container_chain_;
 
-    std::unique_ptr<compound_document_istreambuf> stream_in_buffer_;
+    std::unique_ptr<std::streambuf> stream_in_buffer_;
     std::istream stream_in_;
     std::unique_ptr<compound_document_ostreambuf> stream_out_buffer_;
     std::ostream stream_out_;
@@ -314,9 +314,7 @@ std::vector<std::uint8_t> decrypt_xlsx(
         throw xlnt::exception("empty file");
     }
 
-    xlnt::detail::vector_istreambuf buffer(bytes);
-    std::istream stream(&buffer);
-    xlnt::detail::compound_document document(stream);
+    xlnt::detail::compound_document document(bytes.data(), bytes.size());
 
     auto &encryption_info_stream = document.open_read_stream("/EncryptionInfo");
     auto encryption_info = read_encryption_info(encryption_info_stream, password);
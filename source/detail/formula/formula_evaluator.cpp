@@ -0,0 +1,1185 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <sstream>
+#include <thread>
+
+#include <detail/formula/formula_evaluator.hpp>
+#include <detail/formula/formula_parser.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <xlnt/formula/formula_translator.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace {
+
+using xlnt::detail::formula_node;
+using xlnt::detail::formula_value;
+using value_type = xlnt::detail::formula_value::value_type;
+
+// below this many formulas to evaluate, starting threads costs more than it saves
+const std::size_t parallel_threshold = 1024;
+
+struct function_arity
+{
+    std::size_t minimum;
+    std::size_t maximum;
+};
+
+const std::unordered_map<std::string, function_arity> &supported_functions()
+{
+    static const auto *functions = new std::unordered_map<std::string, function_arity>({
+        {"SUM", {1, 255}},
+        {"AVERAGE", {1, 255}},
+        {"MIN", {1, 255}},
+        {"MAX", {1, 255}},
+        {"COUNT", {1, 255}},
+        {"IF", {2, 3}},
+        {"VLOOKUP", {3, 4}}});
+
+    return *functions;
+}
+
+/// <summary>
+/// Returns true if expression only uses functions that can be evaluated.
+/// </summary>
+bool is_supported(const formula_node &expression)
+{
+    if (expression.type == formula_node::node_type::name)
+    {
+        return false;
+    }
+
+    if (expression.type == formula_node::node_type::function)
+    {
+        const auto match = supported_functions().find(expression.string);
+
+        if (match == supported_functions().end()
+            || expression.children.size() < match->second.minimum
+            || expression.children.size() > match->second.maximum)
+        {
+            return false;
+        }
+    }
+
+    return std::all_of(expression.children.begin(), expression.children.end(),
+        [](const std::unique_ptr<formula_node> &child) { return is_supported(*child); });
+}
+
+void find_references(const formula_node &expression, std::vector<const formula_node *> &references)
+{
+    if (expression.type == formula_node::node_type::reference)
+    {
+        references.push_back(&expression);
+    }
+
+    for (const auto &child : expression.children)
+    {
+        find_references(*child, references);
+    }
+}
+
+formula_value number(long double value)
+{
+    formula_value result;
+
+    if (std::isnan(value) || std::isinf(value))
+    {
+        result.type = value_type::error;
+        result.text = "#NUM!";
+    }
+    else
+    {
+        result.type = value_type::number;
+        result.number = value;
+    }
+
+    return result;
+}
+
+formula_value boolean(bool value)
+{
+    formula_value result;
+    result.type = value_type::boolean;
+    result.number = value ? 1 : 0;
+
+    return result;
+}
+
+formula_value text(const std::string &value)
+{
+    formula_value result;
+    result.type = value_type::text;
+    result.text = value;
+
+    return result;
+}
+
+formula_value error(const std::string &code)
+{
+    formula_value result;
+    result.type = value_type::error;
+    result.text = code;
+
+    return result;
+}
+
+std::string to_upper(std::string value)
+{
+    for (auto &c : value)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    return value;
+}
+
+/// <summary>
+/// Converts value to a number as Excel does for arithmetic, or to an error.
+/// </summary>
+formula_value to_number(const formula_value &value)
+{
+    switch (value.type)
+    {
+    case value_type::empty:
+        return number(0);
+
+    case value_type::number:
+    case value_type::boolean:
+        return number(value.number);
+
+    case value_type::text:
+    {
+        auto begin = value.text.find_first_not_of(' ');
+        auto end = value.text.find_last_not_of(' ');
+
+        if (begin != std::string::npos)
+        {
+            const auto trimmed = value.text.substr(begin, end - begin + 1);
+            char *parsed = nullptr;
+            const auto result = std::strtold(trimmed.c_str(), &parsed);
+
+            if (parsed == trimmed.c_str() + trimmed.size())
+            {
+                return number(result);
+            }
+        }
+
+        return error("#VALUE!");
+    }
+
+    case value_type::error:
+        break;
+    }
+
+    return value;
+}
+
+/// <summary>
+/// Converts value to a boolean as Excel does for conditions, or to an error.
+/// </summary>
+formula_value to_boolean(const formula_value &value)
+{
+    switch (value.type)
+    {
+    case value_type::empty:
+        return boolean(false);
+
+    case value_type::number:
+    case value_type::boolean:
+        return boolean(value.number != 0);
+
+    case value_type::text:
+        if (to_upper(value.text) == "TRUE") return boolean(true);
+        if (to_upper(value.text) == "FALSE") return boolean(false);
+        return error("#VALUE!");
+
+    case value_type::error:
+        break;
+    }
+
+    return value;
+}
+
+/// <summary>
+/// Returns value as text the way Excel shows it in the General number format.
+/// </summary>
+std::string to_text(const formula_value &value)
+{
+    switch (value.type)
+    {
+    case value_type::number:
+    {
+        if (value.number == std::floor(value.number) && std::fabs(value.number) < 1e15L)
+        {
+            return std::to_string(static_cast<long long>(value.number));
+        }
+
+        std::ostringstream stream;
+        stream.precision(15);
+        stream << static_cast<double>(value.number);
+
+        auto result = stream.str();
+        std::replace(result.begin(), result.end(), 'e', 'E');
+
+        return result;
+    }
+
+    case value_type::boolean:
+        return value.number != 0 ? "TRUE" : "FALSE";
+
+    case value_type::text:
+    case value_type::error:
+        return value.text;
+
+    case value_type::empty:
+        break;
+    }
+
+    return std::string();
+}
+
+/// <summary>
+/// Compares two values that aren't errors in Excel's order, where numbers come
+/// before text, which comes before booleans, and text is compared ignoring case.
+/// An empty value is taken as the zero value of the type of the other one.
+/// </summary>
+int compare(formula_value left, formula_value right)
+{
+    const auto zero_of = [](value_type type) {
+        formula_value zero;
+        zero.type = type == value_type::empty ? value_type::number : type;
+        return zero;
+    };
+
+    if (left.type == value_type::empty) left = zero_of(right.type);
+    if (right.type == value_type::empty) right = zero_of(left.type);
+
+    const auto rank = [](value_type type) { return type == value_type::number ? 0 : type == value_type::text ? 1 : 2; };
+
+    if (left.type != right.type)
+    {
+        return rank(left.type) < rank(right.type) ? -1 : 1;
+    }
+
+    if (left.type == value_type::text)
+    {
+        const auto order = to_upper(left.text).compare(to_upper(right.text));
+        return order < 0 ? -1 : order > 0 ? 1 : 0;
+    }
+
+    return left.number < right.number ? -1 : left.number > right.number ? 1 : 0;
+}
+
+formula_value apply(const std::string &operation, const formula_value &left, const formula_value &right)
+{
+    if (left.type == value_type::error) return left;
+    if (right.type == value_type::error) return right;
+
+    if (operation == "&")
+    {
+        return text(to_text(left) + to_text(right));
+    }
+
+    if (operation == "=" || operation == "<>" || operation == "<" || operation == ">"
+        || operation == "<=" || operation == ">=")
+    {
+        const auto order = compare(left, right);
+
+        return boolean(operation == "=" ? order == 0
+            : operation == "<>" ? order != 0
+            : operation == "<" ? order < 0
+            : operation == ">" ? order > 0
+            : operation == "<=" ? order <= 0
+            : order >= 0);
+    }
+
+    const auto a = to_number(left);
+    if (a.type == value_type::error) return a;
+
+    const auto b = to_number(right);
+    if (b.type == value_type::error) return b;
+
+    if (operation == "+") return number(a.number + b.number);
+    if (operation == "-") return number(a.number - b.number);
+    if (operation == "*") return number(a.number * b.number);
+
+    if (operation == "/")
+    {
+        return b.number == 0 ? error("#DIV/0!") : number(a.number / b.number);
+    }
+
+    if (a.number == 0 && b.number <= 0)
+    {
+        return error(b.number == 0 ? "#NUM!" : "#DIV/0!");
+    }
+
+    return number(std::pow(a.number, b.number));
+}
+
+const xlnt::detail::cell_impl *find_cell(xlnt::detail::worksheet_impl &sheet, std::uint64_t key)
+{
+    auto entry = sheet.find_row(static_cast<xlnt::row_t>(key >> 32));
+    if (entry == nullptr) return nullptr;
+
+    const auto match = (*entry)->find(xlnt::column_t(static_cast<xlnt::column_t::index_t>(key & 0xffffffff)));
+
+    return match == (*entry)->end() ? nullptr : &match->second;
+}
+
+std::string formula_text(const xlnt::detail::worksheet_impl &sheet, const xlnt::detail::cell_impl &cell)
+{
+    if (!cell.shared_formula_.is_set())
+    {
+        return cell.formula_.get();
+    }
+
+    const auto &shared = sheet.shared_formulae_.at(cell.shared_formula_.get());
+    const auto reference = xlnt::cell_reference(cell.column_, cell.row_);
+
+    return reference == shared.anchor_
+        ? shared.formula_
+        : xlnt::formula_translator(shared.formula_, shared.anchor_).translate(reference);
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+bool formula_value::operator==(const formula_value &other) const
+{
+    return type == other.type && number == other.number && text == other.text;
+}
+
+bool formula_value::operator!=(const formula_value &other) const
+{
+    return !(*this == other);
+}
+
+bool formula_evaluator::node_key::operator==(const node_key &other) const
+{
+    return sheet == other.sheet && cell == other.cell;
+}
+
+std::size_t formula_evaluator::node_key_hash::operator()(const node_key &key) const
+{
+    return std::hash<std::uint64_t>()(key.cell) ^ (std::hash<worksheet_impl *>()(key.sheet) << 1);
+}
+
+bool formula_evaluator::extent::operator!=(const extent &other) const
+{
+    return columns != other.columns || rows != other.rows;
+}
+
+formula_evaluator::formula_evaluator()
+{
+}
+
+formula_evaluator::~formula_evaluator()
+{
+}
+
+void formula_evaluator::reset()
+{
+    nodes_.clear();
+    index_.clear();
+    extents_.clear();
+}
+
+std::size_t formula_evaluator::calculate(workbook_impl &workbook)
+{
+    ++generation_;
+
+    // the graph refers to sheets by address and title, so it's built again
+    // after any sheet was added, removed or renamed
+    auto sheets = std::vector<std::pair<worksheet_impl *, std::string>>();
+
+    for (auto &sheet : workbook.worksheets_)
+    {
+        sheets.emplace_back(&sheet, sheet.title_);
+    }
+
+    if (workbook_ != &workbook || sheets != sheets_)
+    {
+        reset();
+        workbook_ = &workbook;
+        sheets_ = sheets;
+    }
+
+    auto changed = std::vector<std::size_t>();
+    auto reconnect = std::vector<std::size_t>();
+
+    for (auto &sheet : workbook.worksheets_)
+    {
+        for (auto key : sheet.formula_cells_)
+        {
+            const auto id = find_or_add(node_key{&sheet, key});
+            const auto cell = find_cell(sheet, key);
+            const auto formula = cell != nullptr ? formula_text(sheet, *cell) : std::string();
+            auto &target = nodes_[id];
+
+            target.seen = generation_;
+
+            if (!target.is_formula || target.formula != formula)
+            {
+                target.is_formula = true;
+                target.formula = formula;
+                reconnect.push_back(id);
+            }
+        }
+    }
+
+    auto structure_changed = !reconnect.empty();
+
+    for (std::size_t id = 0; id < nodes_.size(); ++id)
+    {
+        auto &target = nodes_[id];
+        if (!target.is_formula || target.seen == generation_) continue;
+
+        target.is_formula = false;
+        target.formula.clear();
+        target.syntax.reset();
+        target.clipped.clear();
+        target.precedents.clear();
+        structure_changed = true;
+    }
+
+    // ranges that were cut to the used area of a sheet that has grown since
+    // must include the new cells
+    auto grown = std::vector<worksheet_impl *>();
+
+    for (auto &entry : extents_)
+    {
+        const auto current = measure(entry.first);
+
+        if (current != entry.second)
+        {
+            entry.second = current;
+            grown.push_back(entry.first);
+        }
+    }
+
+    if (!grown.empty())
+    {
+        for (std::size_t id = 0; id < nodes_.size(); ++id)
+        {
+            const auto &clipped = nodes_[id].clipped;
+            const auto affected = std::any_of(clipped.begin(), clipped.end(),
+                [&grown](worksheet_impl *sheet) { return std::find(grown.begin(), grown.end(), sheet) != grown.end(); });
+
+            if (affected && std::find(reconnect.begin(), reconnect.end(), id) == reconnect.end())
+            {
+                reconnect.push_back(id);
+            }
+        }
+    }
+
+    for (auto id : reconnect)
+    {
+        connect(id);
+        changed.push_back(id);
+    }
+
+    if (structure_changed || !reconnect.empty())
+    {
+        for (auto &target : nodes_)
+        {
+            target.dependents.clear();
+        }
+
+        for (std::size_t id = 0; id < nodes_.size(); ++id)
+        {
+            for (auto precedent : nodes_[id].precedents)
+            {
+                nodes_[precedent].dependents.push_back(id);
+            }
+        }
+    }
+
+    // cells that aren't evaluated here, including formulas that can't be,
+    // are compared with the values seen last time
+    for (std::size_t id = 0; id < nodes_.size(); ++id)
+    {
+        if (nodes_[id].syntax) continue;
+
+        auto current = read_cell(nodes_[id].key);
+
+        if (current != nodes_[id].value)
+        {
+            nodes_[id].value = std::move(current);
+            changed.push_back(id);
+        }
+    }
+
+    auto cone = std::vector<std::size_t>();
+
+    while (!changed.empty())
+    {
+        const auto id = changed.back();
+        changed.pop_back();
+
+        auto &target = nodes_[id];
+        if (target.reached == generation_) continue;
+
+        target.reached = generation_;
+
+        if (target.syntax)
+        {
+            cone.push_back(id);
+        }
+
+        changed.insert(changed.end(), target.dependents.begin(), target.dependents.end());
+    }
+
+    // formulas are evaluated after all of the formulas they depend on, which
+    // leaves formulas with circular references at their cached values
+    auto order = std::vector<std::size_t>();
+
+    for (auto id : cone)
+    {
+        auto &target = nodes_[id];
+        target.pending = static_cast<std::size_t>(
+            std::count_if(target.precedents.begin(), target.precedents.end(), [this](std::size_t p) { return in_cone(p); }));
+
+        if (target.pending == 0)
+        {
+            order.push_back(id);
+        }
+    }
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        for (auto dependent : nodes_[order[i]].dependents)
+        {
+            if (in_cone(dependent) && --nodes_[dependent].pending == 0)
+            {
+                order.push_back(dependent);
+            }
+        }
+    }
+
+    evaluate_all(order);
+
+    for (auto id : order)
+    {
+        if (nodes_[id].modified)
+        {
+            write_cell(nodes_[id]);
+        }
+    }
+
+    return order.size();
+}
+
+std::size_t formula_evaluator::find_or_add(const node_key &key)
+{
+    const auto match = index_.find(key);
+
+    if (match != index_.end())
+    {
+        return match->second;
+    }
+
+    nodes_.emplace_back();
+    nodes_.back().key = key;
+    nodes_.back().value = read_cell(key);
+    index_.emplace(key, nodes_.size() - 1);
+
+    return nodes_.size() - 1;
+}
+
+formula_value formula_evaluator::read_cell(const node_key &key)
+{
+    auto result = formula_value();
+    const auto cell = find_cell(*key.sheet, key.cell);
+
+    if (cell == nullptr)
+    {
+        return result;
+    }
+
+    switch (cell->type_)
+    {
+    case cell_type::empty:
+        break;
+
+    case cell_type::boolean:
+        result = boolean(cell->value_numeric_ != 0);
+        break;
+
+    case cell_type::date:
+    case cell_type::number:
+        result = number(cell->value_numeric_);
+        break;
+
+    case cell_type::error:
+        result = error(cell->value_text_.plain_text());
+        break;
+
+    case cell_type::inline_string:
+    case cell_type::formula_string:
+        result = text(cell->value_text_.plain_text());
+        break;
+
+    case cell_type::shared_string:
+    {
+        const auto index = static_cast<std::size_t>(cell->value_numeric_);
+        const auto &local_strings = key.sheet->local_strings_;
+
+        result = text(local_strings && local_strings->contains(index) ? local_strings->at(index).plain_text()
+                                    : workbook_->shared_strings_->at(index).plain_text());
+        break;
+    }
+    }
+
+    return result;
+}
+
+void formula_evaluator::write_cell(const node &target)
+{
+    auto &sheet = *target.key.sheet;
+    const auto column = column_t(static_cast<column_t::index_t>(target.key.cell & 0xffffffff));
+    auto &cell = sheet.mutable_row(static_cast<row_t>(target.key.cell >> 32)).at(column);
+
+    cell.value_numeric_ = target.value.number;
+    cell.value_text_.clear();
+
+    switch (target.value.type)
+    {
+    case value_type::boolean:
+        cell.type_ = cell_type::boolean;
+        break;
+
+    case value_type::text:
+        cell.type_ = cell_type::formula_string;
+        cell.value_text_.plain_text(target.value.text);
+        break;
+
+    case value_type::error:
+        cell.type_ = cell_type::error;
+        cell.value_text_.plain_text(target.value.text);
+        break;
+
+    case value_type::empty:
+    case value_type::number:
+        cell.type_ = cell_type::number;
+        break;
+    }
+
+    sheet.source_part_.clear();
+}
+
+formula_evaluator::extent formula_evaluator::measure(worksheet_impl *sheet) const
+{
+    auto result = extent();
+
+    for (auto row : sheet->row_indices())
+    {
+        auto entry = sheet->find_row(row);
+        if (entry == nullptr || (*entry)->empty()) continue;
+
+        result.rows = std::max(result.rows, static_cast<std::uint32_t>(row));
+
+        for (const auto &cell : **entry)
+        {
+            result.columns = std::max(result.columns, static_cast<std::uint32_t>(cell.first.index));
+        }
+    }
+
+    return result;
+}
+
+const formula_evaluator::extent &formula_evaluator::sheet_extent(worksheet_impl *sheet)
+{
+    auto match = extents_.find(sheet);
+
+    if (match == extents_.end())
+    {
+        match = extents_.emplace(sheet, measure(sheet)).first;
+    }
+
+    return match->second;
+}
+
+void formula_evaluator::connect(std::size_t id)
+{
+    auto syntax = std::unique_ptr<formula_node>();
+
+    try
+    {
+        syntax = formula_parser(nodes_[id].formula).parse();
+    }
+    catch (const xlnt::exception &)
+    {
+    }
+
+    if (syntax && !is_supported(*syntax))
+    {
+        syntax.reset();
+    }
+
+    auto references = std::vector<const formula_node *>();
+    auto precedents = std::vector<std::size_t>();
+    auto clipped = std::vector<worksheet_impl *>();
+
+    if (syntax)
+    {
+        find_references(*syntax, references);
+    }
+
+    for (auto reference : references)
+    {
+        const auto &range = reference->reference;
+        const auto sheet = resolve_sheet(range, nodes_[id].key.sheet);
+        if (sheet == nullptr) continue;
+
+        const auto used = sheet_extent(sheet);
+        const auto last_column = std::min(range.last_column, used.columns);
+        const auto last_row = std::min(range.last_row, used.rows);
+
+        if (last_column < range.last_column || last_row < range.last_row)
+        {
+            clipped.push_back(sheet);
+        }
+
+        for (auto row = range.first_row; row <= last_row; ++row)
+        {
+            for (auto column = range.first_column; column <= last_column; ++column)
+            {
+                precedents.push_back(find_or_add(node_key{sheet, worksheet_impl::cell_key(column, row)}));
+            }
+        }
+    }
+
+    std::sort(precedents.begin(), precedents.end());
+    precedents.erase(std::unique(precedents.begin(), precedents.end()), precedents.end());
+    std::sort(clipped.begin(), clipped.end());
+    clipped.erase(std::unique(clipped.begin(), clipped.end()), clipped.end());
+
+    auto &target = nodes_[id];
+    target.syntax = std::move(syntax);
+    target.precedents = std::move(precedents);
+    target.clipped = std::move(clipped);
+
+    // a formula that can't be evaluated keeps its cached value
+    if (!target.syntax)
+    {
+        target.value = read_cell(target.key);
+    }
+}
+
+worksheet_impl *formula_evaluator::resolve_sheet(const formula_reference &reference, worksheet_impl *sheet) const
+{
+    if (reference.sheet.empty())
+    {
+        return sheet;
+    }
+
+    const auto title = to_upper(reference.sheet);
+
+    for (const auto &candidate : sheets_)
+    {
+        if (to_upper(candidate.second) == title)
+        {
+            return candidate.first;
+        }
+    }
+
+    return nullptr;
+}
+
+bool formula_evaluator::in_cone(std::size_t id) const
+{
+    return nodes_[id].reached == generation_ && nodes_[id].syntax;
+}
+
+void formula_evaluator::evaluate_all(const std::vector<std::size_t> &order)
+{
+    const auto root = [this](std::size_t id) {
+        while (nodes_[id].component != id)
+        {
+            id = nodes_[id].component = nodes_[nodes_[id].component].component;
+        }
+
+        return id;
+    };
+
+    for (auto id : order)
+    {
+        nodes_[id].component = id;
+    }
+
+    for (auto id : order)
+    {
+        for (auto precedent : nodes_[id].precedents)
+        {
+            if (in_cone(precedent))
+            {
+                nodes_[root(precedent)].component = root(id);
+            }
+        }
+    }
+
+    // formulas that share no formula to evaluate form independent groups, which
+    // are spread over threads while keeping the order within each group
+    auto groups = std::vector<std::vector<std::size_t>>();
+    auto group_of = std::unordered_map<std::size_t, std::size_t>();
+
+    for (auto id : order)
+    {
+        const auto group = group_of.emplace(root(id), groups.size());
+        if (group.second) groups.emplace_back();
+
+        groups[group.first->second].push_back(id);
+    }
+
+    const auto thread_count = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), groups.size());
+
+    if (order.size() < parallel_threshold || thread_count < 2)
+    {
+        for (auto id : order)
+        {
+            evaluate_node(id);
+        }
+
+        return;
+    }
+
+    std::sort(groups.begin(), groups.end(),
+        [](const std::vector<std::size_t> &a, const std::vector<std::size_t> &b) { return a.size() > b.size(); });
+
+    auto work = std::vector<std::vector<const std::vector<std::size_t> *>>(thread_count);
+    auto load = std::vector<std::size_t>(thread_count, 0);
+
+    for (const auto &group : groups)
+    {
+        const auto lightest = static_cast<std::size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        work[lightest].push_back(&group);
+        load[lightest] += group.size();
+    }
+
+    auto errors = std::vector<std::exception_ptr>(thread_count);
+    auto threads = std::vector<std::thread>();
+
+    for (std::size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([this, &work, &errors, t]() {
+            try
+            {
+                for (auto group : work[t])
+                {
+                    for (auto id : *group)
+                    {
+                        evaluate_node(id);
+                    }
+                }
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto &error : errors)
+    {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+void formula_evaluator::evaluate_node(std::size_t id)
+{
+    auto &target = nodes_[id];
+    auto result = evaluate(*target.syntax, target.key.sheet);
+
+    // a formula referring to an empty cell shows 0
+    if (result.type == value_type::empty)
+    {
+        result = number(0);
+    }
+
+    target.modified = result != target.value;
+    target.value = std::move(result);
+}
+
+const formula_value &formula_evaluator::value_at(worksheet_impl *sheet, std::uint32_t column, std::uint32_t row) const
+{
+    static const auto *empty = new formula_value();
+    const auto match = index_.find(node_key{sheet, worksheet_impl::cell_key(column, row)});
+
+    return match == index_.end() ? *empty : nodes_[match->second].value;
+}
+
+formula_value formula_evaluator::evaluate(const formula_node &expression, worksheet_impl *sheet) const
+{
+    using node_type = formula_node::node_type;
+
+    switch (expression.type)
+    {
+    case node_type::number:
+        return number(expression.number);
+
+    case node_type::text:
+        return text(expression.string);
+
+    case node_type::boolean:
+        return boolean(expression.number != 0);
+
+    case node_type::error:
+        return error(expression.string);
+
+    case node_type::missing:
+        return formula_value();
+
+    case node_type::name:
+        return error("#NAME?");
+
+    case node_type::reference:
+    {
+        const auto &range = expression.reference;
+        const auto target = resolve_sheet(range, sheet);
+
+        if (target == nullptr) return error("#REF!");
+
+        // a range only has a single value where it intersects the formula's
+        // row or column, which isn't supported
+        if (range.first_column != range.last_column || range.first_row != range.last_row)
+        {
+            return error("#VALUE!");
+        }
+
+        return value_at(target, range.first_column, range.first_row);
+    }
+
+    case node_type::unary:
+    {
+        const auto operand = evaluate(*expression.children.front(), sheet);
+
+        if (expression.string == "+") return operand;
+
+        const auto value = to_number(operand);
+        if (value.type == value_type::error) return value;
+
+        return number(expression.string == "-" ? -value.number : value.number / 100);
+    }
+
+    case node_type::binary:
+        return apply(expression.string,
+            evaluate(*expression.children[0], sheet),
+            evaluate(*expression.children[1], sheet));
+
+    case node_type::function:
+        return evaluate_function(expression, sheet);
+    }
+
+    return error("#VALUE!");
+}
+
+formula_value formula_evaluator::evaluate_function(const formula_node &expression, worksheet_impl *sheet) const
+{
+    const auto &name = expression.string;
+    const auto &arguments = expression.children;
+
+    if (name == "IF")
+    {
+        const auto condition = to_boolean(evaluate(*arguments[0], sheet));
+        if (condition.type == value_type::error) return condition;
+
+        if (condition.number != 0)
+        {
+            return evaluate(*arguments[1], sheet);
+        }
+
+        return arguments.size() > 2 ? evaluate(*arguments[2], sheet) : boolean(false);
+    }
+
+    if (name == "VLOOKUP")
+    {
+        return lookup(expression, sheet);
+    }
+
+    const auto counting = name == "COUNT";
+    auto numbers = std::vector<long double>();
+
+    for (const auto &argument : arguments)
+    {
+        const auto failure = collect_numbers(*argument, sheet, counting, numbers);
+        if (failure.type == value_type::error) return failure;
+    }
+
+    if (counting)
+    {
+        return number(static_cast<long double>(numbers.size()));
+    }
+
+    if (name == "MIN" || name == "MAX")
+    {
+        if (numbers.empty()) return number(0);
+
+        return number(name == "MIN" ? *std::min_element(numbers.begin(), numbers.end())
+                                    : *std::max_element(numbers.begin(), numbers.end()));
+    }
+
+    auto sum = 0.0L;
+
+    for (auto value : numbers)
+    {
+        sum += value;
+    }
+
+    if (name == "AVERAGE")
+    {
+        return numbers.empty() ? error("#DIV/0!") : number(sum / numbers.size());
+    }
+
+    return number(sum);
+}
+
+formula_value formula_evaluator::collect_numbers(const formula_node &expression, worksheet_impl *sheet,
+    bool counting, std::vector<long double> &numbers) const
+{
+    // only numbers in ranges count, while values given directly are converted
+    if (expression.type == formula_node::node_type::reference)
+    {
+        const auto &range = expression.reference;
+        const auto target = resolve_sheet(range, sheet);
+
+        if (target == nullptr) return error("#REF!");
+
+        const auto &used = extents_.at(target);
+        const auto last_column = std::min(range.last_column, used.columns);
+        const auto last_row = std::min(range.last_row, used.rows);
+
+        for (auto row = range.first_row; row <= last_row; ++row)
+        {
+            for (auto column = range.first_column; column <= last_column; ++column)
+            {
+                const auto &value = value_at(target, column, row);
+
+                if (value.type == value_type::number)
+                {
+                    numbers.push_back(value.number);
+                }
+                else if (value.type == value_type::error && !counting)
+                {
+                    return value;
+                }
+            }
+        }
+
+        return formula_value();
+    }
+
+    const auto value = evaluate(expression, sheet);
+    const auto converted = to_number(value);
+
+    if (converted.type != value_type::error)
+    {
+        numbers.push_back(converted.number);
+    }
+    else if (!counting)
+    {
+        return converted;
+    }
+
+    return formula_value();
+}
+
+formula_value formula_evaluator::lookup(const formula_node &expression, worksheet_impl *sheet) const
+{
+    const auto &arguments = expression.children;
+
+    const auto needle = evaluate(*arguments[0], sheet);
+    if (needle.type == value_type::error) return needle;
+    if (needle.type == value_type::empty) return error("#N/A");
+
+    if (arguments[1]->type != formula_node::node_type::reference) return error("#VALUE!");
+
+    const auto index = to_number(evaluate(*arguments[2], sheet));
+    if (index.type == value_type::error) return index;
+
+    auto approximate = boolean(true);
+
+    if (arguments.size() > 3)
+    {
+        approximate = to_boolean(evaluate(*arguments[3], sheet));
+        if (approximate.type == value_type::error) return approximate;
+    }
+
+    const auto &table = arguments[1]->reference;
+    const auto target = resolve_sheet(table, sheet);
+
+    if (target == nullptr) return error("#REF!");
+    if (index.number < 1) return error("#VALUE!");
+    if (std::floor(index.number) > table.last_column - table.first_column + 1) return error("#REF!");
+
+    const auto column = table.first_column + static_cast<std::uint32_t>(index.number) - 1;
+    const auto last_row = std::min(table.last_row, extents_.at(target).rows);
+    auto match = std::uint32_t(0);
+
+    for (auto row = table.first_row; row <= last_row; ++row)
+    {
+        const auto &key = value_at(target, table.first_column, row);
+
+        // values of another type never match, and are skipped by an
+        // approximate match, which expects the first column to be sorted
+        if (key.type != needle.type) continue;
+
+        const auto order = compare(key, needle);
+
+        if (approximate.number == 0)
+        {
+            if (order == 0)
+            {
+                match = row;
+                break;
+            }
+        }
+        else if (order <= 0)
+        {
+            match = row;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return match == 0 ? error("#N/A") : value_at(target, column, match);
+}
+
+} // namespace detail
+} // namespace xlnt
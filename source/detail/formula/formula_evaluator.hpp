@@ -0,0 +1,164 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+struct formula_node;
+struct formula_reference;
+struct workbook_impl;
+struct worksheet_impl;
+
+struct formula_value
+{
+    enum class value_type
+    {
+        empty,
+        number,
+        boolean,
+        text,
+        error
+    } type = value_type::empty;
+
+    long double number = 0;
+
+    // the text of a string or the code of an error
+    std::string text;
+
+    bool operator==(const formula_value &other) const;
+    bool operator!=(const formula_value &other) const;
+};
+
+/// <summary>
+/// Evaluates the formulas of a workbook into the cached values of their cells.
+/// The cells each formula depends on are remembered so that later calls only
+/// evaluate the formulas that depend, directly or not, on a cell whose value
+/// or formula changed since.
+/// </summary>
+class formula_evaluator
+{
+public:
+    formula_evaluator();
+    ~formula_evaluator();
+
+    /// <summary>
+    /// Brings the cached values of the formula cells of workbook, whose deferred
+    /// sheets must have been read, up to date. Returns the number of formulas
+    /// that were evaluated.
+    /// </summary>
+    std::size_t calculate(workbook_impl &workbook);
+
+private:
+    struct node_key
+    {
+        worksheet_impl *sheet;
+        std::uint64_t cell;
+
+        bool operator==(const node_key &other) const;
+    };
+
+    struct node_key_hash
+    {
+        std::size_t operator()(const node_key &key) const;
+    };
+
+    /// <summary>
+    /// A cell that is either a formula or referenced by one.
+    /// </summary>
+    struct node
+    {
+        node_key key;
+
+        // the value of the cell, or the result of its formula
+        formula_value value;
+
+        bool is_formula = false;
+        std::string formula;
+
+        // null if the formula can't be evaluated, in which case its cached
+        // value is used like the value of any other cell
+        std::unique_ptr<formula_node> syntax;
+
+        // the sheets on which a range of the formula was cut to the used area
+        std::vector<worksheet_impl *> clipped;
+
+        std::vector<std::size_t> precedents;
+        std::vector<std::size_t> dependents;
+
+        // bookkeeping of the current call to calculate()
+        std::size_t seen = 0;
+        std::size_t reached = 0;
+        std::size_t pending = 0;
+        std::size_t component = 0;
+        bool modified = false;
+    };
+
+    struct extent
+    {
+        std::uint32_t columns = 0;
+        std::uint32_t rows = 0;
+
+        bool operator!=(const extent &other) const;
+    };
+
+    void reset();
+    std::size_t find_or_add(const node_key &key);
+    formula_value read_cell(const node_key &key);
+    void write_cell(const node &target);
+    extent measure(worksheet_impl *sheet) const;
+    const extent &sheet_extent(worksheet_impl *sheet);
+    void connect(std::size_t id);
+    worksheet_impl *resolve_sheet(const formula_reference &reference, worksheet_impl *sheet) const;
+    bool in_cone(std::size_t id) const;
+    void evaluate_all(const std::vector<std::size_t> &order);
+    void evaluate_node(std::size_t id);
+
+    formula_value evaluate(const formula_node &expression, worksheet_impl *sheet) const;
+    formula_value evaluate_function(const formula_node &expression, worksheet_impl *sheet) const;
+    formula_value collect_numbers(const formula_node &expression, worksheet_impl *sheet,
+        bool counting, std::vector<long double> &numbers) const;
+    formula_value lookup(const formula_node &expression, worksheet_impl *sheet) const;
+    const formula_value &value_at(worksheet_impl *sheet, std::uint32_t column, std::uint32_t row) const;
+
+    workbook_impl *workbook_ = nullptr;
+    std::vector<std::pair<worksheet_impl *, std::string>> sheets_;
+    std::vector<node> nodes_;
+    std::unordered_map<node_key, std::size_t, node_key_hash> index_;
+
+    // the used area of every sheet referenced by a formula, to which ranges
+    // such as whole columns are cut
+    std::unordered_map<worksheet_impl *, extent> extents_;
+    std::size_t generation_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,631 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <cctype>
+#include <cstdlib>
+
+#include <detail/formula/formula_parser.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace {
+
+// the largest column (XFD) and row of a sheet
+const std::uint32_t max_column = 16384;
+const std::uint32_t max_row = 1048576;
+
+const char *const error_codes[] = {"#NULL!", "#DIV/0!", "#VALUE!", "#REF!", "#NAME?", "#NUM!", "#N/A", "#GETTING_DATA"};
+
+bool is_name_character(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return std::isalnum(u) || c == '_' || c == '.' || c == '$' || c == '\\' || c == '?' || u >= 0x80;
+}
+
+std::string to_upper(std::string text)
+{
+    for (auto &c : text)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    return text;
+}
+
+[[noreturn]] void invalid_formula(const std::string &formula)
+{
+    throw xlnt::exception("invalid or unsupported formula: " + formula);
+}
+
+/// <summary>
+/// Reads one side of a reference, which is a column such as "$B", a row such
+/// as "3" or a cell such as "B$3". Indices that aren't present are left 0.
+/// </summary>
+bool read_reference_part(const std::string &part, std::uint32_t &column, std::uint32_t &row)
+{
+    auto position = std::size_t(0);
+    column = 0;
+    row = 0;
+
+    if (position < part.size() && part[position] == '$') ++position;
+
+    const auto column_start = position;
+
+    while (position < part.size() && std::isalpha(static_cast<unsigned char>(part[position])))
+    {
+        if (position - column_start == 3) return false;
+        column = column * 26 + static_cast<std::uint32_t>(std::toupper(static_cast<unsigned char>(part[position])) - 'A' + 1);
+        ++position;
+    }
+
+    if (column > max_column) return false;
+    if (position < part.size() && part[position] == '$' && position > column_start) ++position;
+
+    const auto row_start = position;
+
+    while (position < part.size() && std::isdigit(static_cast<unsigned char>(part[position])))
+    {
+        if (position - row_start == 7) return false;
+        row = row * 10 + static_cast<std::uint32_t>(part[position] - '0');
+        ++position;
+    }
+
+    if (position != part.size() || (row_start == position && column == 0)) return false;
+
+    return row_start == position || (row >= 1 && row <= max_row);
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+bool parse_formula_reference(const std::string &text, formula_reference &reference)
+{
+    const auto colon = text.find(':');
+
+    if (colon != std::string::npos && text.find(':', colon + 1) != std::string::npos)
+    {
+        return false;
+    }
+
+    std::uint32_t first_column = 0, first_row = 0, last_column = 0, last_row = 0;
+
+    if (!read_reference_part(text.substr(0, colon), first_column, first_row))
+    {
+        return false;
+    }
+
+    if (colon == std::string::npos)
+    {
+        if (first_column == 0 || first_row == 0) return false;
+
+        last_column = first_column;
+        last_row = first_row;
+    }
+    else
+    {
+        if (!read_reference_part(text.substr(colon + 1), last_column, last_row)
+            || (first_column == 0) != (last_column == 0)
+            || (first_row == 0) != (last_row == 0))
+        {
+            return false;
+        }
+
+        if (first_column == 0)
+        {
+            first_column = 1;
+            last_column = max_column;
+        }
+
+        if (first_row == 0)
+        {
+            first_row = 1;
+            last_row = max_row;
+        }
+    }
+
+    reference.first_column = std::min(first_column, last_column);
+    reference.last_column = std::max(first_column, last_column);
+    reference.first_row = std::min(first_row, last_row);
+    reference.last_row = std::max(first_row, last_row);
+
+    return true;
+}
+
+formula_parser::formula_parser(const std::string &formula)
+    : formula_(formula)
+{
+}
+
+std::unique_ptr<formula_node> formula_parser::parse()
+{
+    position_ = 0;
+    advance();
+
+    auto root = parse_comparison();
+
+    if (current_.type != formula_token::token_type::end)
+    {
+        invalid_formula(formula_);
+    }
+
+    return root;
+}
+
+std::string formula_parser::read_word()
+{
+    const auto start = position_;
+
+    while (position_ < formula_.size())
+    {
+        if (is_name_character(formula_[position_]))
+        {
+            ++position_;
+        }
+        else if (formula_[position_] == ':' && position_ + 1 < formula_.size()
+            && is_name_character(formula_[position_ + 1]))
+        {
+            position_ += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return formula_.substr(start, position_ - start);
+}
+
+formula_token formula_parser::parse_next_token()
+{
+    using token_type = formula_token::token_type;
+
+    while (position_ < formula_.size() && std::isspace(static_cast<unsigned char>(formula_[position_])))
+    {
+        ++position_;
+    }
+
+    formula_token token;
+
+    if (position_ == formula_.size())
+    {
+        return token;
+    }
+
+    const auto c = formula_[position_];
+
+    if (c == '"')
+    {
+        token.type = token_type::text;
+
+        while (true)
+        {
+            if (++position_ == formula_.size()) invalid_formula(formula_);
+
+            if (formula_[position_] == '"')
+            {
+                if (position_ + 1 == formula_.size() || formula_[position_ + 1] != '"') break;
+                ++position_;
+            }
+
+            token.string.push_back(formula_[position_]);
+        }
+
+        ++position_;
+        return token;
+    }
+
+    if (c == '#')
+    {
+        for (auto code : error_codes)
+        {
+            const auto length = std::string(code).size();
+
+            if (to_upper(formula_.substr(position_, length)) == code)
+            {
+                token.type = token_type::error;
+                token.string = code;
+                position_ += length;
+
+                return token;
+            }
+        }
+
+        invalid_formula(formula_);
+    }
+
+    const auto single = std::string("()+-*/^&=%,");
+
+    if (single.find(c) != std::string::npos)
+    {
+        token.type = c == '(' ? token_type::open
+            : c == ')' ? token_type::close
+            : c == ',' ? token_type::separator
+            : token_type::operation;
+        token.string = std::string(1, c);
+        ++position_;
+
+        return token;
+    }
+
+    if (c == '<' || c == '>')
+    {
+        token.type = token_type::operation;
+        token.string = std::string(1, c);
+        ++position_;
+
+        if (position_ < formula_.size() && (formula_[position_] == '=' || (c == '<' && formula_[position_] == '>')))
+        {
+            token.string.push_back(formula_[position_++]);
+        }
+
+        return token;
+    }
+
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+    {
+        auto end = position_;
+        const auto digits = [this, &end]() {
+            while (end < formula_.size() && std::isdigit(static_cast<unsigned char>(formula_[end]))) ++end;
+        };
+
+        digits();
+        const auto integral = end;
+
+        if (end < formula_.size() && formula_[end] == '.')
+        {
+            ++end;
+            digits();
+        }
+
+        if (end < formula_.size() && (formula_[end] == 'e' || formula_[end] == 'E'))
+        {
+            auto exponent = end + 1;
+            if (exponent < formula_.size() && (formula_[exponent] == '+' || formula_[exponent] == '-')) ++exponent;
+
+            if (exponent < formula_.size() && std::isdigit(static_cast<unsigned char>(formula_[exponent])))
+            {
+                end = exponent;
+                digits();
+            }
+        }
+
+        // rows such as 2:5 start like numbers
+        if (!(end == integral && end < formula_.size() && formula_[end] == ':'))
+        {
+            const auto text = formula_.substr(position_, end - position_);
+            char *parsed = nullptr;
+
+            token.type = token_type::number;
+            token.string = text;
+            std::strtold(text.c_str(), &parsed);
+
+            if (parsed != text.c_str() + text.size()) invalid_formula(formula_);
+
+            position_ = end;
+            return token;
+        }
+    }
+
+    if (c == '\'')
+    {
+        while (true)
+        {
+            if (++position_ == formula_.size()) invalid_formula(formula_);
+
+            if (formula_[position_] == '\'')
+            {
+                if (position_ + 1 == formula_.size() || formula_[position_ + 1] != '\'') break;
+                ++position_;
+            }
+
+            token.sheet.push_back(formula_[position_]);
+        }
+
+        if (++position_ == formula_.size() || formula_[position_] != '!') invalid_formula(formula_);
+        ++position_;
+
+        token.type = token_type::reference;
+        token.string = read_word();
+
+        return token;
+    }
+
+    if (!is_name_character(c))
+    {
+        invalid_formula(formula_);
+    }
+
+    auto word = read_word();
+
+    if (position_ < formula_.size() && formula_[position_] == '!')
+    {
+        ++position_;
+        token.type = token_type::reference;
+        token.sheet = word;
+        token.string = read_word();
+    }
+    else if (position_ < formula_.size() && formula_[position_] == '(')
+    {
+        // functions added after Excel 2007 are stored with a prefix
+        word = to_upper(word);
+        const auto prefix = std::string("_XLFN.");
+
+        token.type = token_type::function;
+        token.string = word.compare(0, prefix.size(), prefix) == 0 ? word.substr(prefix.size()) : word;
+    }
+    else if (to_upper(word) == "TRUE" || to_upper(word) == "FALSE")
+    {
+        token.type = token_type::boolean;
+        token.string = to_upper(word);
+    }
+    else
+    {
+        formula_reference reference;
+        token.type = parse_formula_reference(word, reference) ? token_type::reference : token_type::name;
+        token.string = word;
+
+        if (token.type == token_type::name && word.find(':') != std::string::npos)
+        {
+            invalid_formula(formula_);
+        }
+    }
+
+    return token;
+}
+
+void formula_parser::advance()
+{
+    current_ = parse_next_token();
+}
+
+bool formula_parser::at_operation(const std::string &operation) const
+{
+    return current_.type == formula_token::token_type::operation && current_.string == operation;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_comparison()
+{
+    auto left = parse_concatenation();
+
+    while (at_operation("=") || at_operation("<>") || at_operation("<") || at_operation(">")
+        || at_operation("<=") || at_operation(">="))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::binary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(std::move(left));
+        node->children.push_back(parse_concatenation());
+        left = std::move(node);
+    }
+
+    return left;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_concatenation()
+{
+    auto left = parse_additive();
+
+    while (at_operation("&"))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::binary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(std::move(left));
+        node->children.push_back(parse_additive());
+        left = std::move(node);
+    }
+
+    return left;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_additive()
+{
+    auto left = parse_multiplicative();
+
+    while (at_operation("+") || at_operation("-"))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::binary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(std::move(left));
+        node->children.push_back(parse_multiplicative());
+        left = std::move(node);
+    }
+
+    return left;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_multiplicative()
+{
+    auto left = parse_power();
+
+    while (at_operation("*") || at_operation("/"))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::binary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(std::move(left));
+        node->children.push_back(parse_power());
+        left = std::move(node);
+    }
+
+    return left;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_power()
+{
+    auto left = parse_unary();
+
+    while (at_operation("^"))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::binary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(std::move(left));
+        node->children.push_back(parse_unary());
+        left = std::move(node);
+    }
+
+    return left;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_unary()
+{
+    // unlike in most languages, negation binds tighter than ^ so -2^2 is 4
+    if (at_operation("-") || at_operation("+"))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::unary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(parse_unary());
+
+        return node;
+    }
+
+    return parse_percent();
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_percent()
+{
+    auto operand = parse_primary();
+
+    while (at_operation("%"))
+    {
+        auto node = std::unique_ptr<formula_node>(new formula_node());
+        node->type = formula_node::node_type::unary;
+        node->string = current_.string;
+        advance();
+
+        node->children.push_back(std::move(operand));
+        operand = std::move(node);
+    }
+
+    return operand;
+}
+
+std::unique_ptr<formula_node> formula_parser::parse_primary()
+{
+    using node_type = formula_node::node_type;
+    using token_type = formula_token::token_type;
+
+    auto node = std::unique_ptr<formula_node>(new formula_node());
+
+    switch (current_.type)
+    {
+    case token_type::number:
+        node->type = node_type::number;
+        node->number = std::strtold(current_.string.c_str(), nullptr);
+        break;
+
+    case token_type::text:
+        node->type = node_type::text;
+        node->string = current_.string;
+        break;
+
+    case token_type::boolean:
+        node->type = node_type::boolean;
+        node->number = current_.string == "TRUE" ? 1 : 0;
+        break;
+
+    case token_type::error:
+        node->type = node_type::error;
+        node->string = current_.string;
+        break;
+
+    case token_type::reference:
+        node->type = node_type::reference;
+
+        if (!parse_formula_reference(current_.string, node->reference))
+        {
+            invalid_formula(formula_);
+        }
+
+        node->reference.sheet = current_.sheet;
+        break;
+
+    case token_type::name:
+        node->type = node_type::name;
+        node->string = current_.string;
+        break;
+
+    case token_type::function:
+        node->type = node_type::function;
+        node->string = current_.string;
+        advance();
+
+        if (current_.type != token_type::open) invalid_formula(formula_);
+        advance();
+
+        if (current_.type == token_type::close) break;
+
+        while (true)
+        {
+            if (current_.type == token_type::separator || current_.type == token_type::close)
+            {
+                node->children.push_back(std::unique_ptr<formula_node>(new formula_node()));
+            }
+            else
+            {
+                node->children.push_back(parse_comparison());
+            }
+
+            if (current_.type == token_type::close) break;
+            if (current_.type != token_type::separator) invalid_formula(formula_);
+
+            advance();
+        }
+
+        break;
+
+    case token_type::open:
+        advance();
+        node = parse_comparison();
+
+        if (current_.type != token_type::close) invalid_formula(formula_);
+        break;
+
+    default:
+        invalid_formula(formula_);
+    }
+
+    advance();
+
+    return node;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,140 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+struct formula_token
+{
+    enum class token_type
+    {
+        number,
+        text,
+        boolean,
+        error,
+        reference,
+        name,
+        function,
+        operation,
+        open,
+        close,
+        separator,
+        end
+    } type = token_type::end;
+
+    std::string string;
+
+    // the sheet a reference is qualified with, if any
+    std::string sheet;
+};
+
+/// <summary>
+/// A cell or a rectangular range of cells as written in a formula. Whole
+/// columns and rows span every row or column of their sheet.
+/// </summary>
+struct formula_reference
+{
+    std::string sheet;
+    std::uint32_t first_column = 1;
+    std::uint32_t first_row = 1;
+    std::uint32_t last_column = 1;
+    std::uint32_t last_row = 1;
+};
+
+struct formula_node
+{
+    enum class node_type
+    {
+        number,
+        text,
+        boolean,
+        error,
+        reference,
+        name,
+        function,
+        unary,
+        binary,
+        missing
+    } type = node_type::missing;
+
+    long double number = 0;
+
+    // the text of a literal, the code of an error, or the name of a defined
+    // name, function or operator
+    std::string string;
+
+    formula_reference reference;
+    std::vector<std::unique_ptr<formula_node>> children;
+};
+
+/// <summary>
+/// Parses the text of a formula, without its leading '=', into a syntax tree
+/// following Excel's operator precedence.
+/// </summary>
+class formula_parser
+{
+public:
+    formula_parser(const std::string &formula);
+
+    /// <summary>
+    /// Returns the syntax tree of the formula. Throws xlnt::exception if the
+    /// formula isn't valid or uses array constants or range operators.
+    /// </summary>
+    std::unique_ptr<formula_node> parse();
+
+private:
+    formula_token parse_next_token();
+    std::string read_word();
+    void advance();
+    bool at_operation(const std::string &operation) const;
+
+    std::unique_ptr<formula_node> parse_comparison();
+    std::unique_ptr<formula_node> parse_concatenation();
+    std::unique_ptr<formula_node> parse_additive();
+    std::unique_ptr<formula_node> parse_multiplicative();
+    std::unique_ptr<formula_node> parse_power();
+    std::unique_ptr<formula_node> parse_unary();
+    std::unique_ptr<formula_node> parse_percent();
+    std::unique_ptr<formula_node> parse_primary();
+
+    std::string formula_;
+    std::size_t position_ = 0;
+    formula_token current_;
+};
+
+/// <summary>
+/// Reads a reference such as "A1", "$B$2:C3", "A:C" or "2:4" into reference.
+/// Returns false if text isn't one.
+/// </summary>
+bool parse_formula_reference(const std::string &text, formula_reference &reference);
+
+} // namespace detail
+} // namespace xlnt
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include <xlnt/cell/cell_type.hpp>
@@ -54,6 +55,9 @@ struct cell_impl
     long double value_numeric_;
 
     optional<std::string> formula_;
+    // index of the worksheet's shared formula this cell's formula is derived
+    // from, set instead of formula_
+    optional<std::uint32_t> shared_formula_;
     optional<std::string> hyperlink_;
     optional<format_impl *> format_;
     optional<comment> comment_;
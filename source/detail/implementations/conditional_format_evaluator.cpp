@@ -0,0 +1,525 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+#include <detail/constants.hpp>
+#include <detail/implementations/conditional_format_evaluator.hpp>
+#include <detail/implementations/conditional_format_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/utils/calendar.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace {
+
+using xlnt::column_t;
+using xlnt::row_t;
+
+const std::uint8_t number_kind = 0;
+const std::uint8_t text_kind = 1;
+const std::uint8_t boolean_kind = 2;
+const std::uint8_t error_kind = 3;
+
+std::uint64_t cell_key(column_t column, row_t row)
+{
+    return static_cast<std::uint64_t>(row) << 32 | column.index;
+}
+
+std::string to_lower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+
+    return text;
+}
+
+/// <summary>
+/// Sets each entry of matches to predicate(value) for numbers and to otherwise
+/// for text and booleans, which compare greater than any number. Errors never
+/// match. This is one branch-free pass over the arrays.
+/// </summary>
+template <typename Predicate>
+void compare_numbers(const std::vector<std::uint8_t> &kinds, const std::vector<double> &numbers,
+    bool otherwise, Predicate predicate, std::vector<std::uint8_t> &matches)
+{
+    const auto count = kinds.size();
+    const auto kind = kinds.data();
+    const auto number = numbers.data();
+    const auto other = static_cast<std::uint8_t>(otherwise);
+    auto result = matches.data();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto compared = static_cast<std::uint8_t>(predicate(number[i]));
+        const auto fallback = kind[i] == error_kind ? std::uint8_t(0) : other;
+        result[i] = kind[i] == number_kind ? compared : fallback;
+    }
+}
+
+/// <summary>
+/// Calls compare_numbers with the comparison the operator of a cell_is
+/// condition stands for. Between and not between accept their bounds in
+/// either order, like Excel.
+/// </summary>
+template <typename Operator>
+void compare_cell_values(Operator op, double first, double second, const std::vector<std::uint8_t> &kinds,
+    const std::vector<double> &numbers, std::vector<std::uint8_t> &matches)
+{
+    const auto low = std::min(first, second);
+    const auto high = std::max(first, second);
+
+    switch (op)
+    {
+    case Operator::less_than:
+        compare_numbers(kinds, numbers, false, [first](double v) { return v < first; }, matches);
+        break;
+    case Operator::less_than_or_equal:
+        compare_numbers(kinds, numbers, false, [first](double v) { return v <= first; }, matches);
+        break;
+    case Operator::equal:
+        compare_numbers(kinds, numbers, false, [first](double v) { return v == first; }, matches);
+        break;
+    case Operator::not_equal:
+        compare_numbers(kinds, numbers, true, [first](double v) { return v != first; }, matches);
+        break;
+    case Operator::greater_than_or_equal:
+        compare_numbers(kinds, numbers, true, [first](double v) { return v >= first; }, matches);
+        break;
+    case Operator::greater_than:
+        compare_numbers(kinds, numbers, true, [first](double v) { return v > first; }, matches);
+        break;
+    case Operator::between:
+        compare_numbers(kinds, numbers, false, [low, high](double v) { return v >= low && v <= high; }, matches);
+        break;
+    case Operator::not_between:
+        compare_numbers(kinds, numbers, true, [low, high](double v) { return v < low || v > high; }, matches);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+conditional_format_evaluator::conditional_format_evaluator(worksheet_impl &ws)
+    : ws_(ws)
+{
+}
+
+std::vector<std::pair<cell_reference, conditional_format_impl *>> conditional_format_evaluator::evaluate(
+    std::list<conditional_format_impl> &rules)
+{
+    std::unordered_map<std::uint64_t, conditional_format_impl *> applied;
+    auto values = range_values();
+    auto gathered = optional<range_reference>();
+    auto matches = std::vector<std::uint8_t>();
+
+    for (auto &rule : rules)
+    {
+        if (rule.target_sheet != &ws_) continue;
+
+        const auto needs_text = rule.when.type_ == condition::type::contains_text
+            || rule.when.type_ == condition::type::duplicate_values
+            || rule.when.type_ == condition::type::unique_values;
+
+        // rules on the same range usually follow each other
+        if (!gathered.is_set() || gathered.get() != rule.target_range
+            || (needs_text && values.texts.size() != values.keys.size()))
+        {
+            gather(rule.target_range, needs_text, values);
+            gathered = rule.target_range;
+        }
+
+        matches.assign(values.keys.size(), 0);
+        match(rule.when, values, matches);
+
+        for (std::size_t i = 0; i < matches.size(); ++i)
+        {
+            if (matches[i] != 0)
+            {
+                applied.emplace(values.keys[i], &rule);
+            }
+        }
+
+        if (!matches_blank(rule.when)) continue;
+
+        // values.keys is sorted, so the cells missing from it are found in one walk
+        const auto &reference = rule.target_range;
+        auto present = values.keys.begin();
+
+        for (auto row = reference.top_left().row(); row <= reference.bottom_right().row(); ++row)
+        {
+            for (auto column = reference.top_left().column(); column <= reference.bottom_right().column(); ++column)
+            {
+                const auto key = cell_key(column, row);
+
+                while (present != values.keys.end() && *present < key)
+                {
+                    ++present;
+                }
+
+                if (present == values.keys.end() || *present != key)
+                {
+                    applied.emplace(key, &rule);
+                }
+
+                if (column == constants::max_column()) break;
+            }
+
+            if (row == constants::max_row()) break;
+        }
+    }
+
+    auto result = std::vector<std::pair<std::uint64_t, conditional_format_impl *>>(applied.begin(), applied.end());
+    std::sort(result.begin(), result.end(),
+        [](const std::pair<std::uint64_t, conditional_format_impl *> &a,
+            const std::pair<std::uint64_t, conditional_format_impl *> &b) { return a.first < b.first; });
+
+    auto cells = std::vector<std::pair<cell_reference, conditional_format_impl *>>();
+    cells.reserve(result.size());
+
+    for (const auto &entry : result)
+    {
+        const auto column = static_cast<column_t::index_t>(entry.first & 0xFFFFFFFF);
+        const auto row = static_cast<row_t>(entry.first >> 32);
+        cells.emplace_back(cell_reference(column, row), entry.second);
+    }
+
+    return cells;
+}
+
+void conditional_format_evaluator::gather(const range_reference &reference, bool with_text, range_values &values)
+{
+    const auto first_column = reference.top_left().column();
+    const auto last_column = reference.bottom_right().column();
+    const auto width = static_cast<std::size_t>((last_column - first_column).index + 1);
+
+    auto rows = ws_.row_indices();
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&reference](row_t row) {
+        return row < reference.top_left().row() || row > reference.bottom_right().row();
+    }), rows.end());
+    std::sort(rows.begin(), rows.end());
+
+    values.keys.clear();
+    values.kinds.clear();
+    values.numbers.clear();
+    values.texts.clear();
+
+    const auto &shared_strings = ws_.parent_->shared_strings();
+    const auto local_strings = ws_.local_strings_.get();
+    auto row_cells = std::vector<const cell_impl *>();
+
+    for (auto row : rows)
+    {
+        auto entry = ws_.find_row(row);
+        if (entry == nullptr) continue;
+
+        const auto &cells = **entry;
+        row_cells.clear();
+
+        if (width < cells.size())
+        {
+            for (auto column = first_column; column <= last_column; ++column)
+            {
+                const auto match = cells.find(column);
+
+                if (match != cells.end() && match->second.type_ != cell_type::empty)
+                {
+                    row_cells.push_back(&match->second);
+                }
+            }
+        }
+        else
+        {
+            for (const auto &cell : cells)
+            {
+                if (cell.second.type_ != cell_type::empty
+                    && cell.first >= first_column && cell.first <= last_column)
+                {
+                    row_cells.push_back(&cell.second);
+                }
+            }
+
+            std::sort(row_cells.begin(), row_cells.end(),
+                [](const cell_impl *a, const cell_impl *b) { return a->column_ < b->column_; });
+        }
+
+        for (auto cell : row_cells)
+        {
+            values.keys.push_back(cell_key(cell->column_, row));
+            values.numbers.push_back(static_cast<double>(cell->value_numeric_));
+
+            switch (cell->type_)
+            {
+            case cell_type::number:
+            case cell_type::date:
+                values.kinds.push_back(number_kind);
+                break;
+            case cell_type::boolean:
+                values.kinds.push_back(boolean_kind);
+                break;
+            case cell_type::error:
+                values.kinds.push_back(error_kind);
+                break;
+            default:
+                values.kinds.push_back(text_kind);
+                break;
+            }
+
+            if (!with_text) continue;
+
+            switch (cell->type_)
+            {
+            case cell_type::number:
+            case cell_type::date:
+                values.texts.push_back(number_format::general().format(cell->value_numeric_, calendar::windows_1900));
+                break;
+            case cell_type::boolean:
+                values.texts.push_back(cell->value_numeric_ == 0.L ? "false" : "true");
+                break;
+            case cell_type::shared_string:
+            {
+                const auto index = static_cast<std::size_t>(cell->value_numeric_);
+                const auto &text = local_strings != nullptr && local_strings->contains(index)
+                    ? local_strings->at(index)
+                    : shared_strings.at(index);
+                values.texts.push_back(to_lower(text.plain_text()));
+                break;
+            }
+            default:
+                values.texts.push_back(to_lower(cell->value_text_.plain_text()));
+                break;
+            }
+        }
+    }
+}
+
+void conditional_format_evaluator::match(
+    const condition &when, const range_values &values, std::vector<std::uint8_t> &matches) const
+{
+    const auto count = values.keys.size();
+
+    switch (when.type_)
+    {
+    case condition::type::contains_text:
+    {
+        const auto comparand = to_lower(when.text_comparand_);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (values.kinds[i] == error_kind) continue;
+
+            const auto &text = values.texts[i];
+            auto matched = false;
+
+            switch (when.operator_)
+            {
+            case condition::condition_operator::starts_with:
+                matched = text.compare(0, comparand.size(), comparand) == 0;
+                break;
+            case condition::condition_operator::ends_with:
+                matched = text.size() >= comparand.size()
+                    && text.compare(text.size() - comparand.size(), comparand.size(), comparand) == 0;
+                break;
+            case condition::condition_operator::does_not_contain:
+                matched = text.find(comparand) == std::string::npos;
+                break;
+            default:
+                matched = text.find(comparand) != std::string::npos;
+                break;
+            }
+
+            matches[i] = static_cast<std::uint8_t>(matched);
+        }
+
+        break;
+    }
+
+    case condition::type::cell_is:
+        compare_cell_values(when.operator_, when.number_comparand_, when.second_number_comparand_,
+            values.kinds, values.numbers, matches);
+        break;
+
+    case condition::type::top_n:
+    {
+        auto numbers = std::vector<double>();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (values.kinds[i] == number_kind)
+            {
+                numbers.push_back(values.numbers[i]);
+            }
+        }
+
+        if (numbers.empty()) break;
+
+        auto rank = when.rank_;
+
+        if (when.percent_)
+        {
+            rank = std::max<std::size_t>(1, numbers.size() * rank / 100);
+        }
+
+        rank = std::min(rank, numbers.size());
+
+        // the rank-th value from the matching end is the threshold, ties included
+        const auto nth = numbers.begin() + static_cast<std::ptrdiff_t>(rank - 1);
+
+        if (when.reversed_)
+        {
+            std::nth_element(numbers.begin(), nth, numbers.end());
+            const auto threshold = *nth;
+            compare_numbers(values.kinds, values.numbers, false, [threshold](double v) { return v <= threshold; }, matches);
+        }
+        else
+        {
+            std::nth_element(numbers.begin(), nth, numbers.end(), std::greater<double>());
+            const auto threshold = *nth;
+            compare_numbers(values.kinds, values.numbers, false, [threshold](double v) { return v >= threshold; }, matches);
+        }
+
+        break;
+    }
+
+    case condition::type::above_average:
+    {
+        auto sum = 0.0;
+        auto numbers = std::size_t(0);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto is_number = values.kinds[i] == number_kind;
+            sum += is_number ? values.numbers[i] : 0.0;
+            numbers += is_number ? 1 : 0;
+        }
+
+        if (numbers == 0) break;
+
+        const auto average = sum / static_cast<double>(numbers);
+
+        if (when.reversed_)
+        {
+            compare_numbers(values.kinds, values.numbers, false, [average](double v) { return v < average; }, matches);
+        }
+        else
+        {
+            compare_numbers(values.kinds, values.numbers, false, [average](double v) { return v > average; }, matches);
+        }
+
+        break;
+    }
+
+    case condition::type::duplicate_values:
+    case condition::type::unique_values:
+    {
+        // numbers are counted by value and everything else by its lower case
+        // text, with booleans kept apart from strings that spell them
+        std::unordered_map<double, std::size_t> number_counts;
+        std::unordered_map<std::string, std::size_t> text_counts;
+        std::size_t boolean_counts[2] = {0, 0};
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            switch (values.kinds[i])
+            {
+            case number_kind:
+                ++number_counts[values.numbers[i]];
+                break;
+            case text_kind:
+                ++text_counts[values.texts[i]];
+                break;
+            case boolean_kind:
+                ++boolean_counts[values.numbers[i] != 0.0];
+                break;
+            default:
+                break;
+            }
+        }
+
+        const auto wanted_duplicate = when.type_ == condition::type::duplicate_values;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto occurrences = std::size_t(0);
+
+            switch (values.kinds[i])
+            {
+            case number_kind:
+                occurrences = number_counts[values.numbers[i]];
+                break;
+            case text_kind:
+                occurrences = text_counts[values.texts[i]];
+                break;
+            case boolean_kind:
+                occurrences = boolean_counts[values.numbers[i] != 0.0];
+                break;
+            default:
+                continue;
+            }
+
+            matches[i] = static_cast<std::uint8_t>((occurrences > 1) == wanted_duplicate);
+        }
+
+        break;
+    }
+    }
+}
+
+bool conditional_format_evaluator::matches_blank(const condition &when) const
+{
+    if (when.type_ == condition::type::contains_text)
+    {
+        // a blank cell is empty text, which every other text only contains if empty
+        const auto does_not_contain = when.operator_ == condition::condition_operator::does_not_contain;
+        return when.text_comparand_.empty() != does_not_contain;
+    }
+
+    if (when.type_ == condition::type::cell_is)
+    {
+        // a blank cell compares as zero
+        const auto kinds = std::vector<std::uint8_t>(1, number_kind);
+        const auto numbers = std::vector<double>(1, 0.0);
+        auto matches = std::vector<std::uint8_t>(1, 0);
+        compare_cell_values(when.operator_, when.number_comparand_, when.second_number_comparand_,
+            kinds, numbers, matches);
+
+        return matches.front() != 0;
+    }
+
+    return false;
+}
+
+} // namespace detail
+} // namespace xlnt
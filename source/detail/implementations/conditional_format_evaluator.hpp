@@ -0,0 +1,93 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+
+namespace xlnt {
+
+class condition;
+class range_reference;
+
+namespace detail {
+
+struct conditional_format_impl;
+struct worksheet_impl;
+
+/// <summary>
+/// Works out which conditional format applies to each cell of a worksheet. The
+/// values of each rule's range are copied into flat arrays once, so comparisons
+/// against numbers run as plain loops and top, average and duplicate rules only
+/// need one pass to find their thresholds.
+/// </summary>
+class conditional_format_evaluator
+{
+public:
+    explicit conditional_format_evaluator(worksheet_impl &ws);
+
+    /// <summary>
+    /// Returns every cell of the worksheet that satisfies one of the rules in the
+    /// list targeting it, together with the first such rule, ordered by row and
+    /// then by column. Blank cells satisfy a rule when Excel would consider them
+    /// to, e.g. when comparing their value against a number as zero.
+    /// </summary>
+    std::vector<std::pair<cell_reference, conditional_format_impl *>> evaluate(
+        std::list<conditional_format_impl> &rules);
+
+private:
+    /// <summary>
+    /// The non-blank cells of a range, in no particular order, stored as one
+    /// array per field.
+    /// </summary>
+    struct range_values
+    {
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint8_t> kinds;
+        std::vector<double> numbers;
+        // lower case text of every cell, only filled in for rules that need it
+        std::vector<std::string> texts;
+    };
+
+    /// <summary>
+    /// Replaces the contents of values with the cells of reference, including
+    /// their text if with_text is true.
+    /// </summary>
+    void gather(const range_reference &reference, bool with_text, range_values &values);
+
+    void match(const condition &when, const range_values &values, std::vector<std::uint8_t> &matches) const;
+
+    bool matches_blank(const condition &when) const;
+
+    worksheet_impl &ws_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,82 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <xlnt/cell/cell_type.hpp>
+#include <xlnt/utils/calendar.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The value of one cell of a frozen_worksheet. As in cell_impl, strings are
+/// stored as an index into frozen_workbook_impl::strings_. is_date_ is set for
+/// numbers with a date or time number format.
+/// </summary>
+struct frozen_cell
+{
+    long double value_numeric_;
+    cell_type type_;
+    bool is_date_;
+};
+
+struct frozen_worksheet_impl
+{
+    /// <summary>
+    /// Returns the sort key of the cell at column and row.
+    /// </summary>
+    static std::uint64_t key(std::uint32_t column, std::uint32_t row)
+    {
+        return (static_cast<std::uint64_t>(row) << 32) | column;
+    }
+
+    std::string title_;
+
+    // keys_[i] is the key of cells_[i]; both are sorted by key
+    std::vector<std::uint64_t> keys_;
+    std::vector<frozen_cell> cells_;
+
+    // only a few cells have formulas so they are kept apart, sorted by key
+    std::vector<std::pair<std::uint64_t, std::string>> formulae_;
+};
+
+struct frozen_workbook_impl
+{
+    calendar base_date_;
+
+    // the shared strings of the workbook followed by inline strings
+    std::vector<std::string> strings_;
+
+    std::vector<frozen_worksheet_impl> sheets_;
+    std::unordered_map<std::string, std::size_t> sheet_indices_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,186 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Allocates small blocks from large chunks which are only returned to the
+/// system when the pool is destroyed. Freed blocks are kept on a list per size
+/// so cells that are erased and recreated reuse their memory. Blocks larger
+/// than max_block_size come from the global heap. Not thread-safe.
+/// </summary>
+class memory_pool
+{
+public:
+    static const std::size_t alignment = alignof(std::max_align_t);
+    static const std::size_t max_block_size = 512;
+    static const std::size_t chunk_size = 64 * 1024;
+
+    memory_pool() = default;
+    memory_pool(const memory_pool &) = delete;
+    memory_pool &operator=(const memory_pool &) = delete;
+
+    void *allocate(std::size_t size)
+    {
+        if (size > max_block_size)
+        {
+            return ::operator new(size);
+        }
+
+        auto &free_list = free_lists_[size_class(size)];
+
+        if (free_list != nullptr)
+        {
+            auto block = free_list;
+            free_list = free_list->next;
+
+            return block;
+        }
+
+        size = (size_class(size) + 1) * alignment;
+
+        if (static_cast<std::size_t>(end_ - cursor_) < size)
+        {
+            chunks_.emplace_back(new char[chunk_size]);
+            cursor_ = chunks_.back().get();
+            end_ = cursor_ + chunk_size;
+        }
+
+        auto block = cursor_;
+        cursor_ += size;
+
+        return block;
+    }
+
+    void deallocate(void *block, std::size_t size)
+    {
+        if (size > max_block_size)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        auto &free_list = free_lists_[size_class(size)];
+        free_list = new (block) free_block{free_list};
+    }
+
+    /// <summary>
+    /// Returns the number of bytes held in chunks, whether in use or not.
+    /// </summary>
+    std::size_t capacity() const
+    {
+        return chunks_.size() * chunk_size;
+    }
+
+private:
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    static std::size_t size_class(std::size_t size)
+    {
+        return (size - 1) / alignment;
+    }
+
+    std::array<free_block *, max_block_size / alignment> free_lists_ = {};
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char *cursor_ = nullptr;
+    char *end_ = nullptr;
+};
+
+/// <summary>
+/// A standard allocator that takes memory from a shared memory_pool, or from the
+/// global heap when constructed without one. Containers using it keep the pool
+/// alive, so it may be shared between workbooks.
+/// </summary>
+template <typename T>
+class pool_allocator
+{
+public:
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    explicit pool_allocator(std::shared_ptr<memory_pool> pool)
+        : pool_(std::move(pool))
+    {
+    }
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U> &other)
+        : pool_(other.pool())
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        const auto size = count * sizeof(T);
+        return static_cast<T *>(pool_ ? pool_->allocate(size) : ::operator new(size));
+    }
+
+    void deallocate(T *block, std::size_t count)
+    {
+        if (pool_)
+        {
+            pool_->deallocate(block, count * sizeof(T));
+        }
+        else
+        {
+            ::operator delete(block);
+        }
+    }
+
+    const std::shared_ptr<memory_pool> &pool() const
+    {
+        return pool_;
+    }
+
+private:
+    std::shared_ptr<memory_pool> pool_;
+};
+
+template <typename T, typename U>
+bool operator==(const pool_allocator<T> &left, const pool_allocator<U> &right)
+{
+    return left.pool() == right.pool();
+}
+
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T> &left, const pool_allocator<U> &right)
+{
+    return !(left == right);
+}
+
+} // namespace detail
+} // namespace xlnt
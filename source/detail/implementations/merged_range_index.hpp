@@ -0,0 +1,304 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The merged ranges of a worksheet, indexed so that the range covering a cell
+/// can be found without visiting every range. Ranges are kept in levels whose
+/// sizes are distinct powers of two, each sorted by top row with the greatest
+/// bottom row of every subtree of its implicit binary tree, so adding a range
+/// merges at most a logarithmic number of levels. Removed ranges are marked and
+/// dropped when the levels are rebuilt.
+/// </summary>
+class merged_range_index
+{
+public:
+    void add(const range_reference &reference)
+    {
+        std::vector<entry> carry(1, make_entry(reference, next_sequence_++));
+
+        for (auto &level : levels_)
+        {
+            if (level.entries.empty())
+            {
+                level.build(std::move(carry));
+                return;
+            }
+
+            for (const auto &e : level.entries)
+            {
+                if (e.removed)
+                {
+                    --removed_;
+                }
+                else
+                {
+                    carry.push_back(e);
+                }
+            }
+
+            level.entries.clear();
+            level.max_bottom.clear();
+        }
+
+        levels_.emplace_back();
+        levels_.back().build(std::move(carry));
+    }
+
+    /// <summary>
+    /// Removes one range equal to reference and returns true, or returns false
+    /// if there is no such range.
+    /// </summary>
+    bool remove(const range_reference &reference)
+    {
+        const auto target = make_entry(reference, 0);
+
+        for (auto &level : levels_)
+        {
+            auto match = std::lower_bound(level.entries.begin(), level.entries.end(), target,
+                [](const entry &a, const entry &b) { return a.top < b.top; });
+
+            for (; match != level.entries.end() && match->top == target.top; ++match)
+            {
+                if (!match->removed && match->bottom == target.bottom
+                    && match->left == target.left && match->right == target.right)
+                {
+                    match->removed = true;
+                    ++removed_;
+
+                    if (removed_ * 2 > size() + removed_)
+                    {
+                        rebuild();
+                    }
+
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /// <summary>
+    /// Returns true if any range covers the given cell.
+    /// </summary>
+    bool contains(const cell_reference &reference) const
+    {
+        const auto row = reference.row();
+        const auto column = reference.column_index();
+
+        for (const auto &level : levels_)
+        {
+            if (level.covers(row, column, 0, level.entries.size()))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// <summary>
+    /// Returns every range in the order they were added.
+    /// </summary>
+    std::vector<range_reference> ranges() const
+    {
+        auto all = live_entries();
+
+        std::sort(all.begin(), all.end(),
+            [](const entry &a, const entry &b) { return a.sequence < b.sequence; });
+
+        std::vector<range_reference> result;
+        result.reserve(all.size());
+
+        for (const auto &e : all)
+        {
+            result.push_back(e.reference);
+        }
+
+        return result;
+    }
+
+    std::size_t size() const
+    {
+        std::size_t count = 0;
+
+        for (const auto &level : levels_)
+        {
+            count += level.entries.size();
+        }
+
+        return count - removed_;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    bool operator==(const merged_range_index &other) const
+    {
+        return ranges() == other.ranges();
+    }
+
+private:
+    struct entry
+    {
+        row_t top;
+        row_t bottom;
+        column_t::index_t left;
+        column_t::index_t right;
+        std::size_t sequence;
+        range_reference reference;
+        bool removed;
+    };
+
+    struct level
+    {
+        // sorted by top
+        std::vector<entry> entries;
+        // the greatest bottom in the subtree rooted at each index
+        std::vector<row_t> max_bottom;
+
+        void build(std::vector<entry> &&source)
+        {
+            entries = std::move(source);
+            std::sort(entries.begin(), entries.end(),
+                [](const entry &a, const entry &b) { return a.top < b.top; });
+            max_bottom.assign(entries.size(), 0);
+            build_subtree(0, entries.size());
+        }
+
+        row_t build_subtree(std::size_t first, std::size_t last)
+        {
+            if (first == last) return 0;
+
+            const auto middle = first + (last - first) / 2;
+            max_bottom[middle] = std::max({ entries[middle].bottom,
+                build_subtree(first, middle), build_subtree(middle + 1, last) });
+
+            return max_bottom[middle];
+        }
+
+        bool covers(row_t row, column_t::index_t column, std::size_t first, std::size_t last) const
+        {
+            if (first == last) return false;
+
+            const auto middle = first + (last - first) / 2;
+
+            if (max_bottom[middle] < row) return false;
+            if (covers(row, column, first, middle)) return true;
+
+            const auto &e = entries[middle];
+
+            // everything to the right starts below row
+            if (e.top > row) return false;
+
+            if (!e.removed && row <= e.bottom && e.left <= column && column <= e.right)
+            {
+                return true;
+            }
+
+            return covers(row, column, middle + 1, last);
+        }
+    };
+
+    static entry make_entry(const range_reference &reference, std::size_t sequence)
+    {
+        const auto top_left = reference.top_left();
+        const auto bottom_right = reference.bottom_right();
+
+        return { std::min(top_left.row(), bottom_right.row()),
+            std::max(top_left.row(), bottom_right.row()),
+            std::min(top_left.column_index(), bottom_right.column_index()),
+            std::max(top_left.column_index(), bottom_right.column_index()),
+            sequence, reference, false };
+    }
+
+    std::vector<entry> live_entries() const
+    {
+        std::vector<entry> result;
+        result.reserve(size());
+
+        for (const auto &level : levels_)
+        {
+            for (const auto &e : level.entries)
+            {
+                if (!e.removed)
+                {
+                    result.push_back(e);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    void rebuild()
+    {
+        auto all = live_entries();
+        levels_.clear();
+        removed_ = 0;
+
+        // split the entries by the binary digits of their count, as a sequence
+        // of adds would have left them
+        auto remaining = all.size();
+
+        while (remaining > 0)
+        {
+            levels_.emplace_back();
+            remaining >>= 1;
+        }
+
+        auto begin = all.begin();
+
+        for (std::size_t i = 0; i < levels_.size(); ++i)
+        {
+            if ((all.size() >> i) & 1)
+            {
+                const auto count = std::size_t(1) << i;
+                levels_[i].build(std::vector<entry>(begin, begin + static_cast<std::ptrdiff_t>(count)));
+                begin += static_cast<std::ptrdiff_t>(count);
+            }
+        }
+    }
+
+    std::vector<level> levels_;
+    std::size_t removed_ = 0;
+    std::size_t next_sequence_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
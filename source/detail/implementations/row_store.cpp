@@ -0,0 +1,449 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include <detail/implementations/row_store.hpp>
+#include <xlnt/cell/rich_text_run.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace {
+
+enum cell_flags : std::uint8_t
+{
+    merged = 1,
+    has_formula = 2,
+    has_hyperlink = 4,
+    has_format = 8,
+    has_shared_formula = 16,
+    has_comment = 32
+};
+
+// the file is only compacted once it has at least this much unused space
+const std::uint64_t min_compacted_size = 1 << 20;
+
+template <typename T>
+void write_value(std::string &buffer, const T &value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void write_string(std::string &buffer, const std::string &value)
+{
+    write_value(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+template <typename T>
+T read_value(const char *&cursor)
+{
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+
+    return value;
+}
+
+std::string read_string(const char *&cursor)
+{
+    const auto size = read_value<std::uint32_t>(cursor);
+    std::string value(cursor, size);
+    cursor += size;
+
+    return value;
+}
+
+std::shared_ptr<std::FILE> make_file()
+{
+    std::shared_ptr<std::FILE> file(std::tmpfile(), [](std::FILE *file) { if (file != nullptr) std::fclose(file); });
+
+    if (!file)
+    {
+        throw xlnt::exception("unable to create temporary file for worksheet rows");
+    }
+
+    return file;
+}
+
+bool seek(std::FILE *file, std::uint64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), origin) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+}
+
+std::string read_extent(std::FILE *file, std::uint64_t offset, std::uint64_t size)
+{
+    std::string buffer(static_cast<std::size_t>(size), '\0');
+
+    if (!seek(file, offset, SEEK_SET)
+        || std::fread(&buffer[0], 1, buffer.size(), file) != buffer.size())
+    {
+        throw xlnt::exception("unable to read worksheet rows from temporary file");
+    }
+
+    return buffer;
+}
+
+void write_extent(std::FILE *file, std::uint64_t offset, const std::string &buffer)
+{
+    if (!seek(file, offset, SEEK_SET)
+        || std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+    {
+        throw xlnt::exception("unable to write worksheet rows to temporary file");
+    }
+}
+
+/// <summary>
+/// Writes the rows in from to the start of to, one after the other, updating
+/// their offsets, and returns the number of bytes written.
+/// </summary>
+std::uint64_t copy_rows(std::FILE *from, std::FILE *to,
+    std::unordered_map<xlnt::row_t, xlnt::detail::row_store::spilled_row> &rows)
+{
+    std::uint64_t size = 0;
+
+    for (auto &entry : rows)
+    {
+        auto &location = entry.second;
+        write_extent(to, size, read_extent(from, location.offset, location.size));
+        location.offset = size;
+        size += location.size;
+    }
+
+    return size;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+row_store::row_store(std::size_t max_resident_cells)
+    : max_resident_cells_(max_resident_cells),
+      file_(make_file())
+{
+}
+
+row_store::row_store(const row_store &other)
+    : max_resident_cells_(other.max_resident_cells_),
+      resident_cells_(other.resident_cells_),
+      resident_(other.resident_),
+      file_(make_file()),
+      spilled_(other.spilled_),
+      formats_(other.formats_),
+      format_indices_(other.format_indices_),
+      fonts_(other.fonts_)
+{
+    for (auto entry = resident_.begin(); entry != resident_.end(); ++entry)
+    {
+        resident_index_[entry->first] = entry;
+    }
+
+    file_size_ = spilled_size_ = copy_rows(other.file_.get(), file_.get(), spilled_);
+}
+
+std::size_t row_store::max_resident_cells() const
+{
+    return max_resident_cells_;
+}
+
+void row_store::max_resident_cells(std::size_t count)
+{
+    max_resident_cells_ = count;
+}
+
+void row_store::touch(row_t row, std::size_t cells)
+{
+    auto match = resident_index_.find(row);
+
+    if (match == resident_index_.end())
+    {
+        resident_.emplace_front(row, cells);
+        resident_index_[row] = resident_.begin();
+    }
+    else
+    {
+        resident_.splice(resident_.begin(), resident_, match->second);
+        resident_cells_ -= match->second->second;
+        match->second->second = cells;
+    }
+
+    resident_cells_ += cells;
+}
+
+bool row_store::over_budget() const
+{
+    return resident_cells_ > max_resident_cells_;
+}
+
+row_t row_store::coldest() const
+{
+    return resident_.back().first;
+}
+
+void row_store::forget(row_t row)
+{
+    auto match = resident_index_.find(row);
+    if (match == resident_index_.end()) return;
+
+    resident_cells_ -= match->second->second;
+    resident_.erase(match->second);
+    resident_index_.erase(match);
+}
+
+std::uint32_t row_store::format_index(format_impl *format)
+{
+    auto match = format_indices_.find(format);
+    if (match != format_indices_.end()) return match->second;
+
+    const auto index = static_cast<std::uint32_t>(formats_.size());
+    formats_.push_back(format);
+    format_indices_.emplace(format, index);
+
+    return index;
+}
+
+std::uint32_t row_store::font_index(const font &run_font)
+{
+    // rich text in a sheet tends to use a handful of fonts
+    const auto match = std::find(fonts_.begin(), fonts_.end(), run_font);
+    if (match != fonts_.end()) return static_cast<std::uint32_t>(match - fonts_.begin());
+
+    fonts_.push_back(run_font);
+
+    return static_cast<std::uint32_t>(fonts_.size() - 1);
+}
+
+void row_store::spill(row_t row, const cell_row &cells)
+{
+    std::string buffer;
+    write_value(buffer, static_cast<std::uint32_t>(cells.size()));
+
+    const auto write_text = [this, &buffer](const rich_text &text) {
+        const auto runs = text.runs();
+        write_value(buffer, static_cast<std::uint32_t>(runs.size()));
+
+        for (const auto &run : runs)
+        {
+            write_string(buffer, run.first);
+            // 0 for runs without a font, otherwise one more than the font's index
+            write_value(buffer, run.second.is_set() ? font_index(run.second.get()) + 1 : std::uint32_t(0));
+        }
+    };
+
+    auto first_column = std::numeric_limits<column_t::index_t>::max();
+    column_t::index_t last_column = 0;
+
+    for (const auto &entry : cells)
+    {
+        const auto &cell = entry.second;
+
+        first_column = std::min(first_column, entry.first.index);
+        last_column = std::max(last_column, entry.first.index);
+
+        std::uint8_t flags = 0;
+        if (cell.is_merged_) flags |= merged;
+        if (cell.formula_.is_set()) flags |= has_formula;
+        if (cell.hyperlink_.is_set()) flags |= has_hyperlink;
+        if (cell.format_.is_set()) flags |= has_format;
+        if (cell.shared_formula_.is_set()) flags |= has_shared_formula;
+        if (cell.comment_.is_set()) flags |= has_comment;
+
+        write_value(buffer, entry.first.index);
+        write_value(buffer, static_cast<std::uint8_t>(cell.type_));
+        write_value(buffer, flags);
+        write_value(buffer, cell.value_numeric_);
+        write_text(cell.value_text_);
+
+        if (cell.formula_.is_set()) write_string(buffer, cell.formula_.get());
+        if (cell.hyperlink_.is_set()) write_string(buffer, cell.hyperlink_.get());
+        if (cell.shared_formula_.is_set()) write_value(buffer, cell.shared_formula_.get());
+        if (cell.format_.is_set()) write_value(buffer, format_index(cell.format_.get()));
+
+        if (cell.comment_.is_set())
+        {
+            const auto &note = cell.comment_.get();
+
+            write_text(note.text());
+            write_string(buffer, note.author());
+            write_value(buffer, static_cast<std::uint8_t>(note.visible()));
+            write_value(buffer, note.left());
+            write_value(buffer, note.top());
+            write_value(buffer, note.width());
+            write_value(buffer, note.height());
+        }
+    }
+
+    const auto unused = file_size_ - spilled_size_;
+
+    if (unused > min_compacted_size && unused > spilled_size_)
+    {
+        compact();
+    }
+
+    write_extent(file_.get(), file_size_, buffer);
+
+    spilled_[row] = { file_size_, buffer.size(), first_column, last_column };
+    file_size_ += buffer.size();
+    spilled_size_ += buffer.size();
+}
+
+bool row_store::is_spilled(row_t row) const
+{
+    return spilled_.find(row) != spilled_.end();
+}
+
+void row_store::restore(row_t row, cell_row &cells, worksheet_impl *parent)
+{
+    const auto location = spilled_.at(row);
+    const auto buffer = read_extent(file_.get(), location.offset, location.size);
+
+    erase(row);
+
+    const auto read_text = [this](const char *&cursor) {
+        rich_text text;
+        const auto runs = read_value<std::uint32_t>(cursor);
+
+        for (std::uint32_t run = 0; run < runs; ++run)
+        {
+            auto run_text = read_string(cursor);
+            const auto font_id = read_value<std::uint32_t>(cursor);
+
+            text.add_run(rich_text_run{ run_text, font_id == 0 ? optional<font>() : optional<font>(fonts_.at(font_id - 1)) });
+        }
+
+        return text;
+    };
+
+    const char *cursor = buffer.data();
+    const auto count = read_value<std::uint32_t>(cursor);
+    cells.reserve(count);
+
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        const auto column = read_value<column_t::index_t>(cursor);
+        auto &cell = cells[column];
+
+        cell.parent_ = parent;
+        cell.row_ = row;
+        cell.column_ = column;
+        cell.type_ = static_cast<cell_type>(read_value<std::uint8_t>(cursor));
+
+        const auto flags = read_value<std::uint8_t>(cursor);
+        cell.is_merged_ = (flags & merged) != 0;
+        cell.value_numeric_ = read_value<long double>(cursor);
+        cell.value_text_ = read_text(cursor);
+
+        if (flags & has_formula) cell.formula_ = read_string(cursor);
+        if (flags & has_hyperlink) cell.hyperlink_ = read_string(cursor);
+        if (flags & has_shared_formula) cell.shared_formula_ = read_value<std::uint32_t>(cursor);
+        if (flags & has_format) cell.format_ = formats_.at(read_value<std::uint32_t>(cursor));
+
+        if (flags & has_comment)
+        {
+            const auto text = read_text(cursor);
+            comment note(text, read_string(cursor));
+
+            if (read_value<std::uint8_t>(cursor) != 0) note.show();
+
+            const auto left = read_value<int>(cursor);
+            const auto top = read_value<int>(cursor);
+            note.position(left, top);
+
+            const auto width = read_value<int>(cursor);
+            const auto height = read_value<int>(cursor);
+            note.size(width, height);
+
+            cell.comment_ = note;
+        }
+    }
+}
+
+void row_store::erase(row_t row)
+{
+    forget(row);
+
+    const auto match = spilled_.find(row);
+    if (match == spilled_.end()) return;
+
+    spilled_size_ -= match->second.size;
+    spilled_.erase(match);
+
+    // nothing is left to read, so the file can start over
+    if (spilled_.empty())
+    {
+        file_size_ = 0;
+    }
+}
+
+void row_store::compact()
+{
+    auto file = make_file();
+    file_size_ = copy_rows(file_.get(), file.get(), spilled_);
+    file_.swap(file);
+}
+
+void row_store::shift(row_t first, long long offset)
+{
+    const auto moved = [first, offset](row_t row) {
+        return row < first ? row : static_cast<row_t>(static_cast<long long>(row) + offset);
+    };
+
+    std::unordered_map<row_t, spilled_row> spilled;
+    spilled.reserve(spilled_.size());
+
+    for (const auto &entry : spilled_)
+    {
+        spilled.emplace(moved(entry.first), entry.second);
+    }
+
+    spilled_.swap(spilled);
+    resident_index_.clear();
+
+    for (auto entry = resident_.begin(); entry != resident_.end(); ++entry)
+    {
+        entry->first = moved(entry->first);
+        resident_index_[entry->first] = entry;
+    }
+}
+
+const std::unordered_map<row_t, row_store::spilled_row> &row_store::spilled() const
+{
+    return spilled_;
+}
+
+std::uint64_t row_store::file_size() const
+{
+    return file_size_;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,160 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/memory_pool.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct worksheet_impl;
+
+using cell_row = std::unordered_map<column_t, cell_impl, std::hash<column_t>, std::equal_to<column_t>,
+    pool_allocator<std::pair<const column_t, cell_impl>>>;
+
+/// <summary>
+/// Keeps track of which rows of a worksheet are in memory, in order of last use,
+/// and holds the rows that were evicted in a temporary file. A row is written to
+/// the end of the file each time it is evicted. Once more than half of the file
+/// is space left by rows that were read back or erased, the rows still in it are
+/// moved to a new file. Copies get their own file holding the same rows.
+/// </summary>
+class row_store
+{
+public:
+    /// <summary>
+    /// Where an evicted row is in the file, and what worksheet needs to know about
+    /// it without reading it back.
+    /// </summary>
+    struct spilled_row
+    {
+        std::uint64_t offset;
+        std::uint64_t size;
+        column_t::index_t first_column;
+        column_t::index_t last_column;
+    };
+
+    explicit row_store(std::size_t max_resident_cells);
+
+    row_store(const row_store &other);
+
+    std::size_t max_resident_cells() const;
+
+    void max_resident_cells(std::size_t count);
+
+    /// <summary>
+    /// Records that row, holding the given number of cells, was just used.
+    /// </summary>
+    void touch(row_t row, std::size_t cells);
+
+    /// <summary>
+    /// Returns true if the rows in memory hold more cells than allowed.
+    /// </summary>
+    bool over_budget() const;
+
+    /// <summary>
+    /// Returns the least recently used row in memory.
+    /// </summary>
+    row_t coldest() const;
+
+    /// <summary>
+    /// Stops tracking row as being in memory.
+    /// </summary>
+    void forget(row_t row);
+
+    /// <summary>
+    /// Writes cells to the file as the content of row.
+    /// </summary>
+    void spill(row_t row, const cell_row &cells);
+
+    /// <summary>
+    /// Returns true if row is in the file.
+    /// </summary>
+    bool is_spilled(row_t row) const;
+
+    /// <summary>
+    /// Reads row back from the file into cells and forgets where it was.
+    /// </summary>
+    void restore(row_t row, cell_row &cells, worksheet_impl *parent);
+
+    /// <summary>
+    /// Forgets row, whether it is in memory or in the file.
+    /// </summary>
+    void erase(row_t row);
+
+    /// <summary>
+    /// Renumbers the rows from first on by adding offset, as when rows are inserted
+    /// or deleted before them. Rows that would collide must have been erased.
+    /// </summary>
+    void shift(row_t first, long long offset);
+
+    const std::unordered_map<row_t, spilled_row> &spilled() const;
+
+    /// <summary>
+    /// Returns the size of the file, including space that is no longer used.
+    /// </summary>
+    std::uint64_t file_size() const;
+
+private:
+    /// <summary>
+    /// Moves the rows in the file to a new one without the unused space between them.
+    /// </summary>
+    void compact();
+
+    std::uint32_t format_index(format_impl *format);
+
+    std::uint32_t font_index(const font &run_font);
+
+    std::size_t max_resident_cells_;
+    std::size_t resident_cells_ = 0;
+
+    // most recently used first, with the number of cells when it was used
+    std::list<std::pair<row_t, std::size_t>> resident_;
+    std::unordered_map<row_t, std::list<std::pair<row_t, std::size_t>>::iterator> resident_index_;
+
+    std::shared_ptr<std::FILE> file_;
+    std::uint64_t file_size_ = 0;
+    std::uint64_t spilled_size_ = 0;
+    std::unordered_map<row_t, spilled_row> spilled_;
+
+    // Formats and rich text fonts are written as indices into these. Format ids
+    // can't be used since the stylesheet renumbers formats when it drops unused
+    // ones, which spilled cells keep referencing and so stay where they are.
+    std::vector<format_impl *> formats_;
+    std::unordered_map<format_impl *, std::uint32_t> format_indices_;
+    std::vector<font> fonts_;
+};
+
+} // namespace detail
+} // namespace xlnt
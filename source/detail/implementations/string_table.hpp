@@ -0,0 +1,97 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/cell/rich_text.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The strings of one worksheet while the worksheets of a workbook are filled
+/// concurrently. Strings added to the table are numbered from first_index_, the
+/// number of shared strings the workbook had when population began, so shared
+/// string cells of the worksheet that existed before keep referring to the
+/// workbook. workbook::end_concurrent_population merges the table into the
+/// shared strings of the workbook and renumbers the cells referring to it.
+/// </summary>
+struct string_table
+{
+    explicit string_table(std::size_t first_index = 0)
+        : first_index_(first_index)
+    {
+    }
+
+    /// <summary>
+    /// Returns true if index refers to a string of this table rather than to a
+    /// shared string of the workbook.
+    /// </summary>
+    bool contains(std::size_t index) const
+    {
+        return index >= first_index_;
+    }
+
+    /// <summary>
+    /// Returns the string of this table with the given index.
+    /// </summary>
+    const rich_text &at(std::size_t index) const
+    {
+        return strings_.at(index - first_index_);
+    }
+
+    /// <summary>
+    /// Returns the index of text, adding it if it isn't in the table yet.
+    /// </summary>
+    std::size_t add(const rich_text &text)
+    {
+        auto plain_text = text.plain_text();
+        auto candidates = ids_.equal_range(plain_text);
+
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if (strings_[candidate->second] == text)
+            {
+                return first_index_ + candidate->second;
+            }
+        }
+
+        const auto index = strings_.size();
+        strings_.push_back(text);
+        ids_.emplace(std::move(plain_text), index);
+
+        return first_index_ + index;
+    }
+
+    std::size_t first_index_;
+    std::vector<rich_text> strings_;
+    std::unordered_multimap<std::string, std::size_t> ids_;
+};
+
+} // namespace detail
+} // namespace xlnt
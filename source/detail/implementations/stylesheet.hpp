@@ -24,6 +24,7 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include <detail/implementations/format_impl.hpp>
 #include <detail/implementations/style_impl.hpp>
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/styles/computed_style.hpp>
 #include <xlnt/styles/conditional_format.hpp>
 #include <xlnt/styles/format.hpp>
 #include <xlnt/styles/style.hpp>
@@ -42,6 +44,16 @@
 namespace xlnt {
 namespace detail {
 
+/// <summary>
+/// The parts of a differential format (dxf) that conditional formats can apply.
+/// </summary>
+struct differential_format
+{
+    optional<xlnt::border> border;
+    optional<xlnt::fill> fill;
+    optional<xlnt::font> font;
+};
+
 struct stylesheet
 {
     class format create_format(bool default_format)
@@ -51,6 +63,7 @@ struct stylesheet
 
 		impl.parent = this;
 		impl.id = format_impls.size() - 1;
+        ++generation;
         
         impl.border_id = 0;
         impl.fill_id = 0;
@@ -83,6 +96,8 @@ struct stylesheet
         impl.number_format_id = 0;
 
         style_names.push_back(name);
+        ++generation;
+
         return xlnt::style(&impl);
     }
 
@@ -233,6 +248,8 @@ struct stylesheet
     void garbage_collect()
     {
         if (!garbage_collection_enabled) return;
+
+        ++generation;
         
         auto format_iter = format_impls.begin();
 
@@ -332,6 +349,24 @@ struct stylesheet
             }
         }
         
+        for (auto &rule : conditional_format_impls)
+        {
+            if (rule.border_id.is_set())
+            {
+                border_reference_counts[rule.border_id.get()]++;
+            }
+
+            if (rule.fill_id.is_set())
+            {
+                fill_reference_counts[rule.fill_id.get()]++;
+            }
+
+            if (rule.font_id.is_set())
+            {
+                font_reference_counts[rule.font_id.get()]++;
+            }
+        }
+
         auto alignment_id_map = garbage_collect(alignment_reference_counts, alignments);
         auto border_id_map = garbage_collect(border_reference_counts, borders);
         auto fill_id_map = garbage_collect(fill_reference_counts, fills);
@@ -395,6 +430,24 @@ struct stylesheet
                 impl.protection_id = protection_id_map[impl.protection_id.get()];
             }
         }
+
+        for (auto &rule : conditional_format_impls)
+        {
+            if (rule.border_id.is_set())
+            {
+                rule.border_id = border_id_map[rule.border_id.get()];
+            }
+
+            if (rule.fill_id.is_set())
+            {
+                rule.fill_id = fill_id_map[rule.fill_id.get()];
+            }
+
+            if (rule.font_id.is_set())
+            {
+                rule.font_id = font_id_map[rule.font_id.get()];
+            }
+        }
     }
 
     format_impl *find_or_create(format_impl &pattern)
@@ -405,6 +458,7 @@ struct stylesheet
         std::advance(iter, static_cast<std::list<format_impl>::difference_type>(id));
         
         auto &result = *iter;
+        ++generation;
 
         if (added)
         {
@@ -499,6 +553,7 @@ struct stylesheet
     void clear()
     {
 		conditional_format_impls.clear();
+        source_differential_formats.clear();
         format_impls.clear();
         
         style_impls.clear();
@@ -512,6 +567,116 @@ struct stylesheet
         protections.clear();
         
         colors.clear();
+
+        ++generation;
+    }
+
+    /// <summary>
+    /// Returns the effective formatting of cells with the given format, or with
+    /// the default format if format is null. Each component is the format's if
+    /// it's applied, otherwise the named style's if the format has a style that
+    /// sets it, otherwise the workbook default: the first font, fill and border,
+    /// the General number format and default alignment and protection.
+    /// Results are kept by format id until the stylesheet next changes.
+    /// </summary>
+    std::shared_ptr<const computed_style> computed(const format_impl *format)
+    {
+        if (computed_generation != generation)
+        {
+            computed_styles.clear();
+            default_computed_style.reset();
+            computed_generation = generation;
+        }
+
+        if (format == nullptr && !format_impls.empty())
+        {
+            format = &format_impls.front();
+        }
+
+        if (format == nullptr)
+        {
+            if (!default_computed_style)
+            {
+                default_computed_style = std::make_shared<const computed_style>(compute(format_impl()));
+            }
+
+            return default_computed_style;
+        }
+
+        if (computed_styles.size() <= format->id)
+        {
+            computed_styles.resize(format_impls.size());
+        }
+
+        auto &result = computed_styles.at(format->id);
+
+        if (!result)
+        {
+            result = std::make_shared<const computed_style>(compute(*format));
+        }
+
+        return result;
+    }
+
+    computed_style compute(const format_impl &format) const
+    {
+        const style_impl *named = nullptr;
+
+        if (format.style.is_set())
+        {
+            const auto match = style_impls.find(format.style.get());
+            if (match != style_impls.end()) named = &match->second;
+        }
+
+        // the id of the component to use, if not the default
+        const auto pick = [named](const optional<std::size_t> &own, bool applied,
+                              optional<std::size_t> style_impl::*from_style) {
+            if (own.is_set() && applied) return own;
+            if (named != nullptr && (named->*from_style).is_set()) return named->*from_style;
+
+            return optional<std::size_t>();
+        };
+
+        computed_style result;
+
+        const auto alignment_id = pick(format.alignment_id, format.alignment_applied, &style_impl::alignment_id);
+        if (alignment_id.is_set()) result.alignment = alignments.at(alignment_id.get());
+
+        const auto border_id = pick(format.border_id, format.border_applied, &style_impl::border_id);
+        if (border_id.is_set()) result.border = borders.at(border_id.get());
+        else if (!borders.empty()) result.border = borders.front();
+
+        const auto fill_id = pick(format.fill_id, format.fill_applied, &style_impl::fill_id);
+        if (fill_id.is_set()) result.fill = fills.at(fill_id.get());
+        else if (!fills.empty()) result.fill = fills.front();
+
+        const auto font_id = pick(format.font_id, format.font_applied, &style_impl::font_id);
+        if (font_id.is_set()) result.font = fonts.at(font_id.get());
+        else if (!fonts.empty()) result.font = fonts.front();
+
+        const auto number_format_id = pick(format.number_format_id, format.number_format_applied,
+            &style_impl::number_format_id);
+
+        if (number_format_id.is_set())
+        {
+            const auto id = number_format_id.get();
+            const auto match = std::find_if(number_formats.begin(), number_formats.end(),
+                [id](const number_format &candidate) { return candidate.id() == id; });
+
+            if (number_format::is_builtin_format(id))
+            {
+                result.number_format = number_format::from_builtin_id(id);
+            }
+            else if (match != number_formats.end())
+            {
+                result.number_format = *match;
+            }
+        }
+
+        const auto protection_id = pick(format.protection_id, format.protection_applied, &style_impl::protection_id);
+        if (protection_id.is_set()) result.protection = protections.at(protection_id.get());
+
+        return result;
     }
 
 	conditional_format add_conditional_format_rule(worksheet_impl *ws, const range_reference &ref, const condition &when)
@@ -533,6 +698,10 @@ struct stylesheet
     bool garbage_collection_enabled = true;
 
 	std::list<conditional_format_impl> conditional_format_impls;
+
+    // The differential formats of the source file by dxfId, which the conditional
+    // formats of its sheets refer to. Kept for sheets that are read later.
+    std::vector<differential_format> source_differential_formats;
     std::list<format_impl> format_impls;
     std::unordered_map<std::string, style_impl> style_impls;
     std::vector<std::string> style_names;
@@ -545,6 +714,14 @@ struct stylesheet
 	std::vector<protection> protections;
     
     std::vector<color> colors;
+
+    // Incremented whenever a format or style changes, which makes computed_styles stale.
+    std::size_t generation = 0;
+
+    // Resolved formatting by format id, filled in as it's asked for.
+    std::vector<std::shared_ptr<const computed_style>> computed_styles;
+    std::shared_ptr<const computed_style> default_computed_style;
+    std::size_t computed_generation = 0;
 };
 
 } // namespace detail
@@ -22,7 +22,11 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <algorithm>
+#include <iosfwd>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +37,7 @@
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/variant.hpp>
 #include <xlnt/workbook/calculation_properties.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/workbook/workbook_view.hpp>
 #include <xlnt/worksheet/range.hpp>
@@ -42,6 +47,8 @@
 namespace xlnt {
 namespace detail {
 
+class formula_evaluator;
+class izstream;
 struct worksheet_impl;
 
 struct workbook_impl
@@ -55,15 +62,33 @@ struct workbook_impl
           worksheets_(other.worksheets_),
           shared_strings_(other.shared_strings_),
           stylesheet_(other.stylesheet_),
+          base_date_(other.base_date_),
+          title_(other.title_),
           manifest_(other.manifest_),
           theme_(other.theme_),
+          images_(other.images_),
           core_properties_(other.core_properties_),
           extended_properties_(other.extended_properties_),
           custom_properties_(other.custom_properties_),
+          sheet_title_rel_id_map_(other.sheet_title_rel_id_map_),
           view_(other.view_),
           code_name_(other.code_name_),
-          file_version_(other.file_version_)
+          file_version_(other.file_version_),
+          calculation_properties_(other.calculation_properties_),
+          deferred_source_(other.deferred_source_),
+          deferred_archive_(other.deferred_archive_),
+          deferred_options_(other.deferred_options_),
+          source_shared_strings_(other.source_shared_strings_),
+          passthrough_(other.passthrough_),
+          memory_pool_(other.memory_pool_)
     {
+        // the copy is never filled from several threads
+        for (auto &sheet : worksheets_)
+        {
+            sheet.population_mutex_ = nullptr;
+        }
+
+        share_stylesheet(other);
     }
 
     workbook_impl &operator=(const workbook_impl &other)
@@ -71,36 +96,152 @@ struct workbook_impl
         active_sheet_index_ = other.active_sheet_index_;
         worksheets_.clear();
         std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
-        shared_strings_.clear();
-        std::copy(other.shared_strings_.begin(), other.shared_strings_.end(), std::back_inserter(shared_strings_));
+        shared_strings_ = other.shared_strings_;
+        shared_strings_ids_.clear();
+        shared_strings_indexed_ = 0;
 		theme_ = other.theme_;
         manifest_ = other.manifest_;
+        images_ = other.images_;
+        base_date_ = other.base_date_;
+        title_ = other.title_;
 
 		sheet_title_rel_id_map_ = other.sheet_title_rel_id_map_;
 		view_ = other.view_;
 		code_name_ = other.code_name_;
 		file_version_ = other.file_version_;
+        calculation_properties_ = other.calculation_properties_;
 
         core_properties_ = other.core_properties_;
         extended_properties_ = other.extended_properties_;
         custom_properties_ = other.custom_properties_;
 
+        deferred_source_ = other.deferred_source_;
+        deferred_archive_ = other.deferred_archive_;
+        deferred_options_ = other.deferred_options_;
+        source_shared_strings_ = other.source_shared_strings_;
+        passthrough_ = other.passthrough_;
+        memory_pool_ = other.memory_pool_;
+        formula_evaluator_.reset();
+
+        for (auto &sheet : worksheets_)
+        {
+            sheet.population_mutex_ = nullptr;
+        }
+
+        share_stylesheet(other);
+
         return *this;
     }
 
+    /// <summary>
+    /// Shares the stylesheet of other, whose sheets were just copied to this one.
+    /// Conditional formats refer to the sheets of other, so if there are any this
+    /// gets a copy of the stylesheet with them moved to its own sheets instead.
+    /// </summary>
+    void share_stylesheet(const workbook_impl &other)
+    {
+        stylesheet_ = other.stylesheet_;
+
+        if (stylesheet_ == nullptr || stylesheet_->conditional_format_impls.empty()) return;
+
+        std::unordered_map<const worksheet_impl *, worksheet_impl *> sheets;
+        auto sheet = worksheets_.begin();
+
+        for (const auto &source : other.worksheets_)
+        {
+            sheets[&source] = &*sheet++;
+        }
+
+        detach_stylesheet(sheets);
+    }
+
+    /// <summary>
+    /// Replaces stylesheet_, which is shared with copies of this workbook, with a
+    /// copy of its own. The formatted cells of this workbook are pointed at the
+    /// formats of the copy, which copies the rows holding them that are shared.
+    /// Conditional formats of the sheets in sheets are moved to the sheets they
+    /// map to. Cell handles into copied rows must be looked up again.
+    /// </summary>
+    void detach_stylesheet(const std::unordered_map<const worksheet_impl *, worksheet_impl *> &sheets = {})
+    {
+        const auto shared = stylesheet_;
+        stylesheet_ = std::make_shared<stylesheet>(*shared);
+        auto &own = *stylesheet_;
+
+        // The references of the copied formats include cells of the other
+        // workbooks, so formats they use are only ever kept longer than needed.
+        std::unordered_map<const format_impl *, format_impl *> formats;
+        auto source = shared->format_impls.begin();
+
+        for (auto &format : own.format_impls)
+        {
+            formats[&*source++] = &format;
+            format.parent = &own;
+        }
+
+        for (auto &style : own.style_impls)
+        {
+            style.second.parent = &own;
+        }
+
+        for (auto &rule : own.conditional_format_impls)
+        {
+            rule.parent = &own;
+
+            const auto match = sheets.find(rule.target_sheet);
+            if (match != sheets.end()) rule.target_sheet = match->second;
+        }
+
+        const auto is_formatted = [](const cell_row::value_type &cell) { return cell.second.format_.is_set(); };
+
+        for (auto &sheet : worksheets_)
+        {
+            for (auto row : sheet.row_indices())
+            {
+                const auto &cells = **sheet.find_row(row);
+                if (std::none_of(cells.begin(), cells.end(), is_formatted)) continue;
+
+                for (auto &cell : sheet.mutable_row(row))
+                {
+                    if (!cell.second.format_.is_set()) continue;
+
+                    auto &format = cell.second.format_.get();
+                    const auto match = formats.find(format);
+                    if (match == formats.end()) continue;
+
+                    // own already counts the cell from the copy of the references
+                    format->references -= format->references > 0 ? 1 : 0;
+                    format = match->second;
+                }
+            }
+        }
+    }
+
     optional<std::size_t> active_sheet_index_;
 
     std::list<worksheet_impl> worksheets_;
-    std::vector<rich_text> shared_strings_;
+    // shared between copies of a workbook until one of them adds a string
+    std::shared_ptr<std::vector<rich_text>> shared_strings_ = std::make_shared<std::vector<rich_text>>();
 
-    optional<stylesheet> stylesheet_;
+    // Maps the plain text of shared_strings_[0, shared_strings_indexed_) to
+    // indices so workbook::add_shared_string doesn't need a linear search.
+    // Strings appended directly through workbook::shared_strings() are picked
+    // up lazily on the next call.
+    std::unordered_multimap<std::string, std::size_t> shared_strings_ids_;
+    std::size_t shared_strings_indexed_ = 0;
+
+    // Shared between copies of a workbook until one of them changes a format
+    // or style, which detaches it with detach_stylesheet. Cells in shared rows
+    // refer to the formats of the stylesheet they were formatted with.
+    std::shared_ptr<stylesheet> stylesheet_;
 
     calendar base_date_;
     optional<std::string> title_;
     
     manifest manifest_;
     optional<theme> theme_;
-    std::unordered_map<std::string, std::vector<std::uint8_t>> images_;
+    // image data is never modified in place so copies of a workbook share it
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<std::uint8_t>>> images_;
 
     std::vector<std::pair<xlnt::core_property, variant>> core_properties_;
     std::vector<std::pair<xlnt::extended_property, variant>> extended_properties_;
@@ -121,6 +262,36 @@ struct workbook_impl
     
     optional<file_version_t> file_version_;
     optional<calculation_properties> calculation_properties_;
+
+    // The package of a workbook loaded with load_options::lazy_sheets. Shared
+    // between copies so each can read its own deferred sheets later.
+    std::shared_ptr<std::istream> deferred_source_;
+    std::shared_ptr<izstream> deferred_archive_;
+
+    // The options the package was loaded with, which deferred sheets are read with too.
+    load_options deferred_options_;
+
+    // The shared strings as read from deferred_archive_. Any modification
+    // detaches shared_strings_ so the table is unmodified while both are equal.
+    std::shared_ptr<std::vector<rich_text>> source_shared_strings_;
+
+    // Serializes changes to the stylesheet and manifest through cells while
+    // worksheets are filled concurrently. Null otherwise and never copied.
+    std::unique_ptr<std::recursive_mutex> population_mutex_;
+
+    // When set, deferred_archive_ is kept for the lifetime of the workbook and
+    // parts that weren't modified are copied from it verbatim on save.
+    bool passthrough_ = false;
+
+    // Cells of sheets in this workbook are allocated from this when set. It is
+    // released once the workbook is cleared or destroyed and no copy of it
+    // shares any of its rows.
+    std::shared_ptr<memory_pool> memory_pool_;
+
+    // The dependencies between formulas found by the last workbook::calculate,
+    // which are brought up to date by the next call or save. Null until the
+    // first call and never copied.
+    std::shared_ptr<formula_evaluator> formula_evaluator_;
 };
 
 } // namespace detail
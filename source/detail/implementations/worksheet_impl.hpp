@@ -23,11 +23,20 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/format_impl.hpp>
+#include <detail/implementations/memory_pool.hpp>
+#include <detail/implementations/merged_range_index.hpp>
+#include <detail/implementations/row_store.hpp>
+#include <detail/implementations/string_table.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
@@ -42,6 +51,18 @@ class workbook;
 
 namespace detail {
 
+/// <summary>
+/// A formula written once for a range of cells, as in a shared formula of a
+/// SpreadsheetML worksheet. The formula of each cell of the group is this one
+/// with its relative references moved from anchor_ to the cell.
+/// </summary>
+struct shared_formula
+{
+    cell_reference anchor_;
+    range_reference range_;
+    std::string formula_;
+};
+
 struct worksheet_impl
 {
     worksheet_impl(workbook *parent_workbook, std::size_t id, const std::string &title)
@@ -62,17 +83,21 @@ struct worksheet_impl
 
         id_ = other.id_;
         title_ = other.title_;
+        deferred_rel_id_ = other.deferred_rel_id_;
+        source_part_ = other.source_part_;
+        memory_pool_ = other.memory_pool_;
+        row_store_.reset(other.row_store_ ? new row_store(*other.row_store_) : nullptr);
+        local_strings_.reset(other.local_strings_ ? new string_table(*other.local_strings_) : nullptr);
+        population_mutex_ = other.population_mutex_;
         column_properties_ = other.column_properties_;
         row_properties_ = other.row_properties_;
-        cell_map_ = other.cell_map_;
 
-        for (auto &row : cell_map_)
-        {
-            for (auto &cell : row.second)
-            {
-                cell.second.parent_ = this;
-            }
-        }
+        // rows are shared with other until one of the two accesses them
+        cell_map_ = other.cell_map_;
+        rows_shared_ = !cell_map_.empty();
+        other.rows_shared_ = other.rows_shared_ || rows_shared_;
+        formula_cells_ = other.formula_cells_;
+        shared_formulae_ = other.shared_formulae_;
 
         page_setup_ = other.page_setup_;
         auto_filter_ = other.auto_filter_;
@@ -93,15 +118,226 @@ struct worksheet_impl
     std::size_t id_;
     std::string title_;
 
+    // Relationship ID of the part this sheet's content will be read from
+    // when it is first accessed. Empty once the content has been read.
+    std::string deferred_rel_id_;
+
+    // The part of the workbook's source package this sheet was read from, if
+    // the sheet hasn't been handed out for modification since. Only set when
+    // workbook_impl::passthrough_ is.
+    std::string source_part_;
+
     std::unordered_map<column_t, column_properties> column_properties_;
     std::unordered_map<row_t, row_properties> row_properties_;
 
-    std::unordered_map<row_t, std::unordered_map<column_t, cell_impl>> cell_map_;
+    // Where new rows allocate their cells from. Null unless the workbook was
+    // loaded with load_options::pooled_memory.
+    std::shared_ptr<memory_pool> memory_pool_;
+
+    using cell_row = detail::cell_row;
+
+    /// <summary>
+    /// Returns a new row allocated from this sheet's memory pool, optionally
+    /// holding a copy of the cells of other.
+    /// </summary>
+    std::shared_ptr<cell_row> make_row() const
+    {
+        cell_row::allocator_type allocator(memory_pool_);
+        return std::allocate_shared<cell_row>(allocator, allocator);
+    }
+
+    std::shared_ptr<cell_row> make_row(const cell_row &other) const
+    {
+        cell_row::allocator_type allocator(memory_pool_);
+        return std::allocate_shared<cell_row>(allocator, other, allocator);
+    }
+
+    /// <summary>
+    /// Returns the cells of the given row, which must exist, for access through
+    /// cell handles. A row shared with a copy of this sheet is copied first, and
+    /// cells still pointing at the sheet they were copied from are adopted.
+    /// </summary>
+    cell_row &mutable_row(row_t row)
+    {
+        auto entry = find_row(row);
+        auto &cells = entry != nullptr ? *entry : cell_map_.at(row);
+
+        if (cells.use_count() > 1)
+        {
+            cells = make_row(*cells);
+
+            // both copies of each cell now refer to its format
+            for (auto &cell : *cells)
+            {
+                if (cell.second.format_.is_set())
+                {
+                    ++cell.second.format_.get()->references;
+                }
+            }
+        }
+
+        if (!cells->empty() && cells->begin()->second.parent_ != this)
+        {
+            for (auto &cell : *cells)
+            {
+                cell.second.parent_ = this;
+            }
+        }
+
+        return *cells;
+    }
+
+    /// <summary>
+    /// Returns the cells of the given row, which must exist, for reading through
+    /// cell handles. Unlike mutable_row, a row shared with a copy of this sheet is
+    /// only copied while its cells still belong to the other sheet, so reading
+    /// a sheet that was never copied doesn't modify it. Writes through the
+    /// handles copy the row as needed, see rows_shared_.
+    /// </summary>
+    cell_row &readable_row(row_t row)
+    {
+        auto entry = find_row(row);
+        auto &cells = entry != nullptr ? *entry : cell_map_.at(row);
+
+        if (!cells->empty() && cells->begin()->second.parent_ != this)
+        {
+            return mutable_row(row);
+        }
+
+        return *cells;
+    }
+
+    /// <summary>
+    /// Returns the entry of the given row in cell_map_, reading the row back if it
+    /// was moved to row_store_, or null if the row doesn't exist.
+    /// </summary>
+    std::shared_ptr<cell_row> *find_row(row_t row)
+    {
+        auto match = cell_map_.find(row);
+
+        if (match == cell_map_.end())
+        {
+            if (!row_store_ || !row_store_->is_spilled(row)) return nullptr;
+
+            auto cells = make_row();
+            row_store_->restore(row, *cells, this);
+            match = cell_map_.emplace(row, cells).first;
+        }
+
+        use_row(row);
+
+        return &match->second;
+    }
+
+    /// <summary>
+    /// Returns the entry of the given row in cell_map_, creating the row if it
+    /// doesn't exist.
+    /// </summary>
+    std::shared_ptr<cell_row> &create_row(row_t row)
+    {
+        auto entry = find_row(row);
+        if (entry != nullptr) return *entry;
+
+        auto &cells = cell_map_[row] = make_row();
+        use_row(row);
+
+        return cells;
+    }
+
+    /// <summary>
+    /// Records a use of the given row in memory. If that leaves more cells in
+    /// memory than row_store_ allows, the least recently used rows are moved to it.
+    /// Cell handles to those rows become invalid.
+    /// </summary>
+    void use_row(row_t row)
+    {
+        if (!row_store_) return;
+
+        row_store_->touch(row, cell_map_.at(row)->size());
+
+        while (row_store_->over_budget() && row_store_->coldest() != row)
+        {
+            const auto coldest = row_store_->coldest();
+            row_store_->forget(coldest);
+
+            const auto match = cell_map_.find(coldest);
+            if (match == cell_map_.end()) continue;
+
+            if (!match->second->empty())
+            {
+                row_store_->spill(coldest, *match->second);
+            }
+
+            cell_map_.erase(match);
+        }
+    }
+
+    /// <summary>
+    /// Returns the indices of all rows, whether they are in memory or not.
+    /// </summary>
+    std::vector<row_t> row_indices() const
+    {
+        std::vector<row_t> rows;
+        rows.reserve(cell_map_.size() + (row_store_ ? row_store_->spilled().size() : 0));
+
+        for (const auto &row : cell_map_)
+        {
+            rows.push_back(row.first);
+        }
+
+        if (row_store_)
+        {
+            for (const auto &row : row_store_->spilled())
+            {
+                rows.push_back(row.first);
+            }
+        }
+
+        return rows;
+    }
+
+    /// <summary>
+    /// Returns true if any row exists, whether in memory or not.
+    /// </summary>
+    bool has_rows() const
+    {
+        return !cell_map_.empty() || (row_store_ && !row_store_->spilled().empty());
+    }
+
+    std::unordered_map<row_t, std::shared_ptr<cell_row>> cell_map_;
+
+    // Set once rows of this sheet have been shared with a copy of it. Cell
+    // handles may then point into a row that is still shared, so writes through
+    // them look their cell up again through mutable_row first.
+    mutable bool rows_shared_ = false;
+
+    /// <summary>
+    /// Returns the key of the cell at column and row in formula_cells_.
+    /// </summary>
+    static std::uint64_t cell_key(column_t column, row_t row)
+    {
+        return (static_cast<std::uint64_t>(row) << 32) | column.index;
+    }
+
+    // Cells with a formula, kept up to date by cell so formulas can be found
+    // without visiting every cell.
+    std::unordered_set<std::uint64_t> formula_cells_;
+
+    // Shared formulae by index, referred to by cell_impl::shared_formula_.
+    std::unordered_map<std::uint32_t, shared_formula> shared_formulae_;
+
+    // Rows moved out of memory. Null unless worksheet::max_resident_cells was set.
+    std::unique_ptr<row_store> row_store_;
+
+    // Strings of this sheet's cells and the lock for changes to the rest of the
+    // workbook while sheets are filled concurrently. Both are null otherwise.
+    std::unique_ptr<string_table> local_strings_;
+    std::recursive_mutex *population_mutex_ = nullptr;
 
     optional<page_setup> page_setup_;
     optional<range_reference> auto_filter_;
     optional<page_margins> page_margins_;
-    std::vector<range_reference> merged_cells_;
+    merged_range_index merged_cells_;
     std::unordered_map<std::string, named_range> named_ranges_;
 
     optional<header_footer> header_footer_;
@@ -0,0 +1,873 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <detail/external/include_windows.hpp>
+#include <detail/serialization/csv_parser.hpp>
+#include <detail/serialization/open_stream.hpp>
+#include <xlnt/utils/calendar.hpp>
+#include <xlnt/utils/date.hpp>
+#include <xlnt/utils/datetime.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/path.hpp>
+#include <xlnt/utils/time.hpp>
+
+namespace {
+
+/// <summary>
+/// A file mapped into memory for reading. Nothing is mapped if the file can't
+/// be opened, is empty or the platform isn't supported.
+/// </summary>
+class mapped_file
+{
+public:
+    explicit mapped_file(const xlnt::path &filename)
+    {
+#ifdef _MSC_VER
+        file_ = CreateFileW(filename.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ,
+            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return;
+
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ == nullptr) return;
+
+        data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        size_ = data_ == nullptr ? 0 : static_cast<std::size_t>(size.QuadPart);
+#elif defined(__unix__) || defined(__APPLE__)
+        const auto descriptor = ::open(filename.string().c_str(), O_RDONLY);
+        if (descriptor < 0) return;
+
+        struct stat info;
+
+        if (::fstat(descriptor, &info) == 0 && info.st_size > 0)
+        {
+            const auto size = static_cast<std::size_t>(info.st_size);
+            const auto address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+            if (address != MAP_FAILED)
+            {
+                ::madvise(address, size, MADV_SEQUENTIAL);
+                data_ = static_cast<const char *>(address);
+                size_ = size;
+            }
+        }
+
+        ::close(descriptor);
+#else
+        static_cast<void>(filename);
+#endif
+    }
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    ~mapped_file()
+    {
+#ifdef _MSC_VER
+        if (data_ != nullptr) UnmapViewOfFile(data_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#elif defined(__unix__) || defined(__APPLE__)
+        if (data_ != nullptr) ::munmap(const_cast<char *>(data_), size_);
+#endif
+    }
+
+    const char *data() const
+    {
+        return data_;
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _MSC_VER
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/// <summary>
+/// Parses a decimal number such as -12.5e3 that makes up all of [first, last).
+/// Numbers with up to 15 significant digits and a power of ten of at most 22 are
+/// converted exactly with one multiplication or division. Others are copied to
+/// a buffer on the stack and converted by strtod.
+/// </summary>
+bool parse_number(const char *first, const char *last, double &result)
+{
+    auto p = first;
+    const auto negative = p != last && *p == '-';
+
+    if (p != last && (*p == '-' || *p == '+'))
+    {
+        ++p;
+    }
+
+    std::uint64_t mantissa = 0;
+    auto digits = 0;
+    auto exponent = 0;
+    auto any_digits = false;
+    auto exact = true;
+
+    for (; p != last && is_digit(*p); ++p)
+    {
+        any_digits = true;
+        if (mantissa == 0 && *p == '0') continue;
+
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+            ++digits;
+        }
+        else
+        {
+            ++exponent;
+            exact = false;
+        }
+    }
+
+    if (p != last && *p == '.')
+    {
+        for (++p; p != last && is_digit(*p); ++p)
+        {
+            any_digits = true;
+
+            if (mantissa == 0 && *p == '0')
+            {
+                --exponent;
+            }
+            else if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+                ++digits;
+                --exponent;
+            }
+            else
+            {
+                exact = false;
+            }
+        }
+    }
+
+    if (!any_digits) return false;
+
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        const auto negative_exponent = p != last && *p == '-';
+
+        if (p != last && (*p == '-' || *p == '+'))
+        {
+            ++p;
+        }
+
+        if (p == last || !is_digit(*p)) return false;
+
+        auto written = 0;
+
+        for (; p != last && is_digit(*p); ++p)
+        {
+            written = std::min(written * 10 + (*p - '0'), 100000);
+        }
+
+        exponent += negative_exponent ? -written : written;
+    }
+
+    if (p != last) return false;
+
+    if (exact && digits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        auto value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+        result = negative ? -value : value;
+
+        return true;
+    }
+
+    char buffer[128];
+    const auto length = static_cast<std::size_t>(last - first);
+    if (length >= sizeof(buffer)) return false;
+
+    std::memcpy(buffer, first, length);
+    buffer[length] = '\0';
+    result = std::strtod(buffer, nullptr);
+
+    return std::isfinite(result);
+}
+
+/// <summary>
+/// Reads between min_digits and max_digits digits at p into value.
+/// </summary>
+bool read_digits(const char *&p, const char *last, int min_digits, int max_digits, int &value)
+{
+    auto count = 0;
+    value = 0;
+
+    for (; p != last && is_digit(*p) && count < max_digits; ++p, ++count)
+    {
+        value = value * 10 + (*p - '0');
+    }
+
+    return count >= min_digits;
+}
+
+/// <summary>
+/// Reads an optional fraction of a second starting with '.' at p, as microseconds.
+/// </summary>
+bool read_fraction(const char *&p, const char *last, int &microseconds)
+{
+    microseconds = 0;
+    if (p == last || *p != '.') return true;
+
+    auto scale = 100000;
+    auto any_digits = false;
+
+    for (++p; p != last && is_digit(*p); ++p)
+    {
+        microseconds += (*p - '0') * scale;
+        scale /= 10;
+        any_digits = true;
+    }
+
+    return any_digits;
+}
+
+/// <summary>
+/// Parses a time the way cell::value(const std::string &, bool) does: two or
+/// three components separated by colons, each with at most two digits before
+/// an optional decimal point. If the second component has a fraction, the
+/// components are read as minutes and seconds rather than hours and minutes.
+/// </summary>
+bool parse_time(const char *first, const char *last, double &result)
+{
+    double components[3];
+    std::size_t count = 0;
+    auto p = first;
+
+    while (true)
+    {
+        if (count == 3) return false;
+
+        std::uint64_t whole = 0;
+        std::uint64_t fraction = 0;
+        auto whole_digits = 0;
+        auto fraction_digits = 0;
+        auto point = false;
+
+        for (; p != last && *p != ':'; ++p)
+        {
+            if (*p == '.')
+            {
+                if (point) return false;
+                point = true;
+            }
+            else if (!is_digit(*p))
+            {
+                return false;
+            }
+            else if (!point)
+            {
+                if (++whole_digits > 2) return false;
+                whole = whole * 10 + static_cast<std::uint64_t>(*p - '0');
+            }
+            else if (fraction_digits < 15)
+            {
+                fraction = fraction * 10 + static_cast<std::uint64_t>(*p - '0');
+                ++fraction_digits;
+            }
+        }
+
+        if (whole_digits + fraction_digits == 0) return false;
+
+        components[count++] = static_cast<double>(whole)
+            + static_cast<double>(fraction) / powers_of_ten[fraction_digits];
+
+        if (p == last) break;
+        ++p;
+    }
+
+    if (count < 2) return false;
+
+    auto hour = static_cast<int>(components[0]);
+    auto minute = static_cast<int>(components[1]);
+    auto second = 0;
+    auto microsecond = 0;
+
+    if (std::fabs(static_cast<double>(minute) - components[1]) > std::numeric_limits<double>::epsilon())
+    {
+        minute = hour;
+        hour = 0;
+        second = static_cast<int>(components[1]);
+        microsecond = static_cast<int>((components[1] - second) * 1E6);
+    }
+    else if (count > 2)
+    {
+        second = static_cast<int>(components[2]);
+        microsecond = static_cast<int>((components[2] - second) * 1E6);
+    }
+
+    if (minute >= 60 || second >= 60) return false;
+
+    result = static_cast<double>(xlnt::time(hour, minute, second, microsecond).to_number());
+
+    return true;
+}
+
+/// <summary>
+/// Parses an ISO 8601 date such as 2017-03-31, optionally followed by 'T' or
+/// a space and a time such as 13:45 or 13:45:30.25, into a serial date.
+/// </summary>
+bool parse_date(const char *first, const char *last, xlnt::calendar base_date, double &result, bool &has_time)
+{
+    auto p = first;
+    int year, month, day;
+
+    if (!read_digits(p, last, 4, 4, year) || p == last || *p++ != '-'
+        || !read_digits(p, last, 1, 2, month) || p == last || *p++ != '-'
+        || !read_digits(p, last, 1, 2, day))
+    {
+        return false;
+    }
+
+    const auto first_year = base_date == xlnt::calendar::mac_1904 ? 1904 : 1900;
+    if (year < first_year || month < 1 || month > 12 || day < 1) return false;
+
+    static const int month_lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const auto leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > month_lengths[month - 1] + (month == 2 && leap ? 1 : 0)) return false;
+
+    has_time = p != last;
+
+    if (!has_time)
+    {
+        result = static_cast<double>(xlnt::date(year, month, day).to_number(base_date));
+        return true;
+    }
+
+    int hour, minute, second = 0, microsecond = 0;
+
+    if ((*p != 'T' && *p != ' ') || !read_digits(++p, last, 1, 2, hour)
+        || p == last || *p++ != ':' || !read_digits(p, last, 2, 2, minute))
+    {
+        return false;
+    }
+
+    if (p != last && (*p++ != ':' || !read_digits(p, last, 2, 2, second) || !read_fraction(p, last, microsecond)))
+    {
+        return false;
+    }
+
+    if (p != last || hour > 23 || minute > 59 || second > 59) return false;
+
+    result = static_cast<double>(
+        xlnt::datetime(year, month, day, hour, minute, second, microsecond).to_number(base_date));
+
+    return true;
+}
+
+bool parse_boolean(const char *first, const char *last, double &result)
+{
+    const auto size = last - first;
+    if (size != 4 && size != 5) return false;
+
+    const char *expected = size == 4 ? "true" : "false";
+
+    for (auto i = 0; i < size; ++i)
+    {
+        if ((first[i] | 0x20) != expected[i]) return false;
+    }
+
+    result = size == 4 ? 1.0 : 0.0;
+
+    return true;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+std::string csv_block::text(const csv_field &field) const
+{
+    return field.unescaped
+        ? unescaped.substr(field.text_offset, field.text_size)
+        : std::string(source + field.text_offset, field.text_size);
+}
+
+csv_parser::csv_parser(const csv_options &options, calendar base_date)
+    : options_(options),
+      base_date_(base_date),
+      threads_(options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    options_.chunk_size = std::max<std::size_t>(options_.chunk_size, 1);
+
+    for (const auto &pinned : options_.column_types)
+    {
+        const auto index = static_cast<std::size_t>(pinned.first.index);
+
+        if (column_types_.size() < index + 1)
+        {
+            column_types_.resize(index + 1, csv_options::column_type::inferred);
+        }
+
+        column_types_[index] = pinned.second;
+    }
+}
+
+void csv_parser::parse(const path &filename, const block_handler &handler)
+{
+    if (options_.memory_map)
+    {
+        const mapped_file file(filename);
+
+        if (file.data() != nullptr)
+        {
+            parse(file.data(), file.data() + file.size(), handler);
+            return;
+        }
+    }
+
+    std::ifstream file_stream;
+    open_stream(file_stream, filename.string());
+
+    if (!file_stream.good())
+    {
+        throw xlnt::exception("file not found " + filename.string());
+    }
+
+    parse(file_stream, handler);
+}
+
+void csv_parser::parse(std::istream &stream, const block_handler &handler)
+{
+    const auto window = options_.chunk_size * threads_;
+    auto buffer = std::vector<char>();
+    auto filled = std::size_t(0);
+    auto start = true;
+
+    while (true)
+    {
+        buffer.resize(filled + window);
+        stream.read(buffer.data() + filled, static_cast<std::streamsize>(window));
+        filled += static_cast<std::size_t>(stream.gcount());
+
+        const auto final = !stream;
+        auto begin = buffer.data();
+        const auto end = buffer.data() + filled;
+
+        if (start && filled >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0)
+        {
+            begin += 3;
+        }
+
+        if (start && (filled >= 3 || final))
+        {
+            start = false;
+        }
+        else if (start)
+        {
+            continue;
+        }
+
+        const auto parsed = parse_window(begin, end, final, handler);
+        if (final) break;
+
+        // the incomplete record at the end is kept for the next window
+        filled = static_cast<std::size_t>(end - parsed);
+        std::memmove(buffer.data(), parsed, filled);
+    }
+}
+
+void csv_parser::parse(const char *begin, const char *end, const block_handler &handler)
+{
+    if (end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0)
+    {
+        begin += 3;
+    }
+
+    const auto default_window = options_.chunk_size * threads_;
+    auto window = default_window;
+
+    while (begin != end)
+    {
+        const auto window_end = static_cast<std::size_t>(end - begin) <= window ? end : begin + window;
+        const auto parsed = parse_window(begin, window_end, window_end == end, handler);
+
+        // a record longer than the window is parsed with a larger one
+        window = parsed == begin ? window * 2 : default_window;
+        begin = parsed;
+    }
+}
+
+const char *csv_parser::parse_window(const char *begin, const char *end, bool final, const block_handler &handler)
+{
+    const auto length = static_cast<std::size_t>(end - begin);
+    const auto pieces = std::max<std::size_t>(1, std::min(threads_, length / options_.chunk_size));
+    const auto bounds = pieces == 1 && final ? std::vector<const char *>{begin, end} : split(begin, end, pieces, final);
+    const auto count = bounds.size() - 1;
+
+    if (count == 0) return begin;
+
+    if (blocks_.size() < count)
+    {
+        blocks_.resize(count);
+    }
+
+    if (count == 1)
+    {
+        parse_records(bounds[0], bounds[1], blocks_[0]);
+    }
+    else
+    {
+        auto workers = std::vector<std::thread>();
+
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            workers.emplace_back([this, &bounds, i]() { parse_records(bounds[i], bounds[i + 1], blocks_[i]); });
+        }
+
+        parse_records(bounds[0], bounds[1], blocks_[0]);
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        handler(blocks_[i]);
+    }
+
+    return bounds.back();
+}
+
+std::vector<const char *> csv_parser::split(const char *begin, const char *end, std::size_t pieces, bool final) const
+{
+    const auto delimiter = options_.delimiter;
+    const auto quote = options_.quote;
+    const auto length = static_cast<std::size_t>(end - begin);
+
+    auto bounds = std::vector<const char *>{begin};
+    auto next_piece = std::size_t(1);
+    auto target = begin + length / pieces;
+    auto last_record_end = begin;
+    auto field_start = true;
+    auto quoted = false;
+
+    // this follows the quoting rules of parse_records without reading values
+    for (auto p = begin; p != end; ++p)
+    {
+        const auto c = *p;
+
+        if (quoted)
+        {
+            if (c != quote) continue;
+
+            if (p + 1 == end)
+            {
+                // whether this ends the value or escapes a quote depends on the next window
+                if (!final) break;
+                quoted = false;
+            }
+            else if (p[1] == quote)
+            {
+                ++p;
+            }
+            else
+            {
+                quoted = false;
+            }
+
+            continue;
+        }
+
+        if (c == '\n')
+        {
+            last_record_end = p + 1;
+            field_start = true;
+
+            if (last_record_end >= target && next_piece < pieces)
+            {
+                bounds.push_back(last_record_end);
+                ++next_piece;
+                target = begin + length / pieces * next_piece;
+            }
+
+            continue;
+        }
+
+        quoted = c == quote && field_start;
+        field_start = c == delimiter;
+    }
+
+    const auto stop = final ? end : last_record_end;
+
+    if (bounds.back() != stop)
+    {
+        bounds.push_back(stop);
+    }
+
+    return bounds;
+}
+
+void csv_parser::parse_records(const char *begin, const char *end, csv_block &block) const
+{
+    const auto delimiter = options_.delimiter;
+    const auto quote = options_.quote;
+
+    block.source = begin;
+    block.fields.clear();
+    block.record_ends.clear();
+    block.unescaped.clear();
+
+    if (begin == end) return;
+
+    const auto find_quote = [end, quote](const char *from) {
+        const auto match = static_cast<const char *>(std::memchr(from, quote, static_cast<std::size_t>(end - from)));
+        return match == nullptr ? end : match;
+    };
+
+    // the end of the value before stop, without the '\r' of a "\r\n" line break
+    const auto value_end = [end](const char *value, const char *stop) {
+        return stop != value && (stop == end || *stop == '\n') && stop[-1] == '\r' ? stop - 1 : stop;
+    };
+
+    auto p = begin;
+    auto column = column_t::index_t(1);
+
+    while (true)
+    {
+        csv_field field;
+        field.column = column;
+        field.unescaped = false;
+
+        const char *first = nullptr;
+        const char *last = nullptr;
+
+        if (p != end && *p == quote)
+        {
+            const auto offset = block.unescaped.size();
+            auto segment = p + 1;
+            auto closing = find_quote(segment);
+            auto escaped = false;
+
+            while (closing != end && closing + 1 != end && closing[1] == quote)
+            {
+                escaped = true;
+                block.unescaped.append(segment, closing + 1);
+                segment = closing + 2;
+                closing = find_quote(segment);
+            }
+
+            // anything between the closing quote and the delimiter is kept as is
+            const auto after = closing == end ? end : closing + 1;
+            p = after;
+
+            while (p != end && *p != delimiter && *p != '\n')
+            {
+                ++p;
+            }
+
+            const auto tail_end = value_end(after, p);
+
+            if (!escaped && tail_end == after)
+            {
+                first = segment;
+                last = closing;
+            }
+            else
+            {
+                block.unescaped.append(segment, closing);
+                block.unescaped.append(after, tail_end);
+                field.unescaped = true;
+                first = block.unescaped.data() + offset;
+                last = block.unescaped.data() + block.unescaped.size();
+            }
+        }
+        else
+        {
+            first = p;
+
+            while (p != end && *p != delimiter && *p != '\n')
+            {
+                ++p;
+            }
+
+            last = value_end(first, p);
+        }
+
+        if (first != last)
+        {
+            field.text_offset = static_cast<std::size_t>(
+                first - (field.unescaped ? block.unescaped.data() : block.source));
+            field.text_size = static_cast<std::size_t>(last - first);
+            infer(first, last, field);
+            block.fields.push_back(field);
+        }
+
+        if (p != end && *p == delimiter)
+        {
+            ++p;
+            ++column;
+            continue;
+        }
+
+        block.record_ends.push_back(block.fields.size());
+        column = 1;
+
+        if (p == end || ++p == end) break;
+    }
+}
+
+void csv_parser::infer(const char *first, const char *last, csv_field &field) const
+{
+    const auto index = static_cast<std::size_t>(field.column);
+    auto type = index < column_types_.size() ? column_types_[index] : csv_options::column_type::inferred;
+
+    if (type == csv_options::column_type::inferred && !options_.infer_types)
+    {
+        type = csv_options::column_type::text;
+    }
+
+    field.type = csv_field::kind::text;
+    field.number = 0.0;
+
+    auto has_time = false;
+
+    switch (type)
+    {
+    case csv_options::column_type::text:
+        break;
+
+    case csv_options::column_type::number:
+        if (parse_number(first, last, field.number))
+        {
+            field.type = csv_field::kind::number;
+        }
+        break;
+
+    case csv_options::column_type::percentage:
+        if (last[-1] == '%' && parse_number(first, last - 1, field.number))
+        {
+            field.number /= 100;
+            field.type = csv_field::kind::percentage;
+        }
+        else if (parse_number(first, last, field.number))
+        {
+            field.type = csv_field::kind::percentage;
+        }
+        break;
+
+    case csv_options::column_type::date:
+        if (parse_date(first, last, base_date_, field.number, has_time))
+        {
+            field.type = has_time ? csv_field::kind::date_time : csv_field::kind::date;
+        }
+        break;
+
+    case csv_options::column_type::time:
+        if (parse_time(first, last, field.number))
+        {
+            field.type = csv_field::kind::time;
+        }
+        break;
+
+    case csv_options::column_type::boolean:
+        if (parse_boolean(first, last, field.number))
+        {
+            field.type = csv_field::kind::boolean;
+        }
+        break;
+
+    case csv_options::column_type::inferred:
+    {
+        const auto c = *first;
+
+        if (last - first > 1 && (c == '=' || c == '#'))
+        {
+            field.type = c == '=' ? csv_field::kind::formula : csv_field::kind::error;
+        }
+        // anything else that isn't text starts with one of these
+        else if (!is_digit(c) && c != '-' && c != '+' && c != '.' && (c | 0x20) != 't' && (c | 0x20) != 'f')
+        {
+        }
+        else if (last[-1] == '%' && parse_number(first, last - 1, field.number))
+        {
+            field.number /= 100;
+            field.type = csv_field::kind::percentage;
+        }
+        else if (parse_time(first, last, field.number))
+        {
+            field.type = csv_field::kind::time;
+        }
+        else if (parse_number(first, last, field.number))
+        {
+            field.type = csv_field::kind::number;
+        }
+        else if (parse_boolean(first, last, field.number))
+        {
+            field.type = csv_field::kind::boolean;
+        }
+        else if (parse_date(first, last, base_date_, field.number, has_time))
+        {
+            field.type = has_time ? csv_field::kind::date_time : csv_field::kind::date;
+        }
+
+        break;
+    }
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
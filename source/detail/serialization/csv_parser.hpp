@@ -0,0 +1,150 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/worksheet/csv_options.hpp>
+
+namespace xlnt {
+
+enum class calendar;
+class path;
+
+namespace detail {
+
+/// <summary>
+/// A value read from delimited text, with its type already inferred.
+/// </summary>
+struct csv_field
+{
+    enum class kind : std::uint8_t
+    {
+        text,
+        number,
+        percentage,
+        date,
+        date_time,
+        time,
+        boolean,
+        formula,
+        error
+    };
+
+    column_t::index_t column;
+    kind type;
+    // true if the text is in csv_block::unescaped rather than the input
+    bool unescaped;
+    std::size_t text_offset;
+    std::size_t text_size;
+    // the number, serial date or time, or 0 or 1 for a boolean
+    double number;
+};
+
+/// <summary>
+/// The non-empty fields of a run of whole records. A record without any such
+/// fields still ends a row.
+/// </summary>
+struct csv_block
+{
+    // the input the text of fields refers to
+    const char *source = nullptr;
+    std::vector<csv_field> fields;
+    // the number of fields up to the end of each record
+    std::vector<std::size_t> record_ends;
+    // text of quoted fields with escaped quotes, with the escapes removed
+    std::string unescaped;
+
+    std::string text(const csv_field &field) const;
+};
+
+/// <summary>
+/// Splits delimited text into records and fields and infers the type of each field
+/// without allocating. Input is read in windows of whole records which are divided
+/// between threads, each of which parses its part into a csv_block. The blocks are
+/// then passed to a callback on the calling thread in the order of the input.
+/// </summary>
+class csv_parser
+{
+public:
+    using block_handler = std::function<void(const csv_block &)>;
+
+    csv_parser(const csv_options &options, calendar base_date);
+
+    /// <summary>
+    /// Parses the file at filename, mapping it into memory if the options allow it.
+    /// </summary>
+    void parse(const path &filename, const block_handler &handler);
+
+    /// <summary>
+    /// Parses everything remaining in stream.
+    /// </summary>
+    void parse(std::istream &stream, const block_handler &handler);
+
+    /// <summary>
+    /// Parses the text in [begin, end).
+    /// </summary>
+    void parse(const char *begin, const char *end, const block_handler &handler);
+
+private:
+    /// <summary>
+    /// Parses the whole records at the start of [begin, end), or all of it if
+    /// final is true, and returns the end of the text parsed.
+    /// </summary>
+    const char *parse_window(const char *begin, const char *end, bool final, const block_handler &handler);
+
+    /// <summary>
+    /// Returns positions dividing [begin, end) into at most pieces runs of whole
+    /// records of about equal length. The first position is begin and the last is
+    /// the end of the last whole record, or end if final is true.
+    /// </summary>
+    std::vector<const char *> split(const char *begin, const char *end, std::size_t pieces, bool final) const;
+
+    /// <summary>
+    /// Parses the records in [begin, end) into block.
+    /// </summary>
+    void parse_records(const char *begin, const char *end, csv_block &block) const;
+
+    /// <summary>
+    /// Sets the type and value of field from its text in [first, last).
+    /// </summary>
+    void infer(const char *first, const char *last, csv_field &field) const;
+
+    csv_options options_;
+    // the type of each column up to the last one in options_.column_types
+    std::vector<csv_options::column_type> column_types_;
+    calendar base_date_;
+    std::size_t threads_;
+    std::vector<csv_block> blocks_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -22,7 +22,9 @@
 // @author: see AUTHORS file
 
 #include <cctype>
+#include <cstdlib>
 #include <numeric> // for std::accumulate
+#include <sstream>
 
 #include <detail/constants.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
@@ -34,6 +36,7 @@
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/comment.hpp>
 #include <xlnt/packaging/manifest.hpp>
+#include <xlnt/styles/conditional_format.hpp>
 #include <xlnt/utils/optional.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -96,6 +99,29 @@ bool is_true(const std::string &bool_string)
 #endif
 }
 
+/// <summary>
+/// Returns true if text is a number, which is written to result.
+/// </summary>
+bool parse_number(const std::string &text, double &result)
+{
+    char *end = nullptr;
+    result = std::strtod(text.c_str(), &end);
+
+    return !text.empty() && end == text.c_str() + text.size();
+}
+
+/// <summary>
+/// A conditional formatting rule of a worksheet as it is read, before the
+/// rules are put in order of priority.
+/// </summary>
+struct conditional_format_rule
+{
+    std::size_t priority;
+    xlnt::range_reference range;
+    xlnt::condition when;
+    xlnt::optional<std::size_t> differential_format_id;
+};
+
 /// <summary>
 /// Helper template function that returns true if element is in container.
 /// </summary>
@@ -133,6 +159,13 @@ xlsx_consumer::xlsx_consumer(workbook &target)
 {
 }
 
+xlsx_consumer::xlsx_consumer(workbook &target, const load_options &options)
+    : target_(target),
+      parser_(nullptr),
+      options_(options)
+{
+}
+
 xlsx_consumer::~xlsx_consumer()
 {
 }
@@ -149,55 +182,152 @@ void xlsx_consumer::open(std::istream &source)
     populate_workbook(true);
 }
 
-cell xlsx_consumer::read_cell()
+void xlsx_consumer::read_lazily(std::shared_ptr<std::istream> source)
 {
-    if (!has_cell())
+    archive_.reset(new izstream(*source));
+    defer_worksheets_ = true;
+    populate_workbook(false);
+
+    target_.d_->deferred_source_ = source;
+    target_.d_->deferred_archive_ = archive_;
+    target_.d_->deferred_options_ = options_;
+
+    // Deferred sheets refer to formats by index so these must stay put until
+    // they have been read, and for as long as their parts may be passed through.
+    if (target_.d_->stylesheet_ != nullptr)
+    {
+        target_.d_->stylesheet_->garbage_collection_enabled = false;
+    }
+
+    if (passthrough())
     {
-        return cell(nullptr);
+        target_.d_->passthrough_ = true;
+        target_.d_->source_shared_strings_ = target_.d_->shared_strings_;
     }
+}
+
+void xlsx_consumer::read_deferred_worksheet(worksheet_impl &ws)
+{
+    if (ws.deferred_rel_id_.empty()) return;
+
+    archive_ = target_.d_->deferred_archive_;
+    current_worksheet_ = &ws;
+
+    const auto rel_id = ws.deferred_rel_id_;
+    ws.deferred_rel_id_.clear();
+
+    const auto workbook_rel = manifest().relationship(path("/"), relationship_type::office_document);
+    read_part({ workbook_rel, manifest().relationship(workbook_rel.target().path(), rel_id) });
+}
 
+cell xlsx_consumer::read_cell()
+{
     auto ws = worksheet(current_worksheet_);
 
-    if (in_element(qn("spreadsheetml", "sheetData")))
+    while (has_cell())
     {
-        expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
-        auto row_index = parser().attribute<row_t>("r");
-
-        if (parser().attribute_present("ht"))
+        if (in_element(qn("spreadsheetml", "sheetData")))
         {
-            ws.row_properties(row_index).height = parser().attribute<double>("ht");
+            expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
+            auto row_index = parser().attribute<row_t>("r");
+
+            if (options_.last_row.is_set() && row_index > options_.last_row.get())
+            {
+                // rows are in ascending order so nothing else in the sheet is wanted
+                skip_remaining_content(qn("spreadsheetml", "row"));
+                expect_end_element(qn("spreadsheetml", "row"));
+                skip_remaining_content(qn("spreadsheetml", "sheetData"));
+                expect_end_element(qn("spreadsheetml", "sheetData"));
+
+                return cell(nullptr);
+            }
+
+            if (!row_selected(row_index))
+            {
+                skip_remaining_content(qn("spreadsheetml", "row"));
+                expect_end_element(qn("spreadsheetml", "row"));
+
+                if (!in_element(qn("spreadsheetml", "sheetData")))
+                {
+                    expect_end_element(qn("spreadsheetml", "sheetData"));
+                }
+
+                continue;
+            }
+
+            if (parser().attribute_present("ht"))
+            {
+                ws.row_properties(row_index).height = parser().attribute<double>("ht");
+            }
+
+            if (parser().attribute_present("customHeight"))
+            {
+                ws.row_properties(row_index).custom_height = is_true(parser().attribute("customHeight"));
+            }
+
+            if (parser().attribute_present("hidden") && is_true(parser().attribute("hidden")))
+            {
+                ws.row_properties(row_index).hidden = true;
+            }
+
+            skip_attributes({ qn("x14ac", "dyDescent") });
+            skip_attributes({ "customFormat", "s", "customFont",
+                "outlineLevel", "collapsed", "thickTop", "thickBot",
+                "ph", "spans" });
         }
 
-        if (parser().attribute_present("customHeight"))
+        if (!in_element(qn("spreadsheetml", "row")))
         {
-            ws.row_properties(row_index).custom_height = is_true(parser().attribute("customHeight"));
+            return cell(nullptr);
         }
 
-        if (parser().attribute_present("hidden") && is_true(parser().attribute("hidden")))
+        expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
+
+        auto reference = cell_reference(parser().attribute("r"));
+
+        if (!column_selected(reference.column()))
         {
-            ws.row_properties(row_index).hidden = true;
+            skip_remaining_content(qn("spreadsheetml", "c"));
+            expect_end_element(qn("spreadsheetml", "c"));
         }
+        else
+        {
+            auto cell = streaming_ ? xlnt::cell(streaming_cell_.get()) : ws.cell(reference);
+            cell.d_->parent_ = current_worksheet_;
+            cell.d_->column_ = reference.column_index();
+            cell.d_->row_ = reference.row();
 
-        skip_attributes({ qn("x14ac", "dyDescent") });
-        skip_attributes({ "customFormat", "s", "customFont",
-            "outlineLevel", "collapsed", "thickTop", "thickBot",
-            "ph", "spans" });
-    }
+            read_cell_content(cell);
 
-    if (!in_element(qn("spreadsheetml", "row")))
-    {
-        return cell(nullptr);
-    }
+            if (!in_element(qn("spreadsheetml", "row")))
+            {
+                expect_end_element(qn("spreadsheetml", "row"));
+
+                if (!in_element(qn("spreadsheetml", "sheetData")))
+                {
+                    expect_end_element(qn("spreadsheetml", "sheetData"));
+                }
+            }
+
+            return cell;
+        }
 
-    expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
+        if (!in_element(qn("spreadsheetml", "row")))
+        {
+            expect_end_element(qn("spreadsheetml", "row"));
+
+            if (!in_element(qn("spreadsheetml", "sheetData")))
+            {
+                expect_end_element(qn("spreadsheetml", "sheetData"));
+            }
+        }
+    }
 
-    auto cell = streaming_ ? xlnt::cell(streaming_cell_.get())
-        : ws.cell(cell_reference(parser().attribute("r")));
-    auto reference = cell_reference(parser().attribute("r"));
-    cell.d_->parent_ = current_worksheet_;
-    cell.d_->column_ = reference.column_index();
-    cell.d_->row_ = reference.row();
+    return cell(nullptr);
+}
 
+void xlsx_consumer::read_cell_content(cell target)
+{
     auto has_type = parser().attribute_present("t");
     auto type = has_type ? parser().attribute("t") : "n";
 
@@ -210,6 +340,8 @@ cell xlsx_consumer::read_cell()
     auto has_formula = false;
     auto has_shared_formula = false;
     auto formula_value_string = std::string();
+    auto formula_range = std::string();
+    auto shared_formula_index = std::uint32_t(0);
 
     while (in_element(qn("spreadsheetml", "c")))
     {
@@ -220,6 +352,10 @@ cell xlsx_consumer::read_cell()
             has_value = true;
             value_string = read_text();
         }
+        else if (current_element == qn("spreadsheetml", "f") && options_.values_only)
+        {
+            skip_remaining_content(current_element);
+        }
         else if (current_element == qn("spreadsheetml", "f")) // CT_CellFormula
         {
             has_formula = true;
@@ -229,8 +365,21 @@ cell xlsx_consumer::read_cell()
                 has_shared_formula = parser().attribute("t") == "shared";
             }
 
-            skip_attributes(
-            { "aca", "ref", "dt2D", "dtr", "del1", "del2", "r1", "r2", "ca", "si", "bx" });
+            if (parser().attribute_present("ref"))
+            {
+                formula_range = parser().attribute("ref");
+            }
+
+            if (parser().attribute_present("si"))
+            {
+                shared_formula_index = parser().attribute<std::uint32_t>("si");
+            }
+            else
+            {
+                has_shared_formula = false;
+            }
+
+            skip_attributes({ "aca", "dt2D", "dtr", "del1", "del2", "r1", "r2", "ca", "bx" });
 
             formula_value_string = read_text();
         }
@@ -250,58 +399,69 @@ cell xlsx_consumer::read_cell()
 
     expect_end_element(qn("spreadsheetml", "c"));
 
-    if (has_formula && !has_shared_formula)
+    if (has_formula && has_shared_formula)
+    {
+        // the first cell of a shared formula holds its text and range, the
+        // others only its index
+        auto &shared_formulae = target.d_->parent_->shared_formulae_;
+
+        if (!formula_range.empty())
+        {
+            shared_formulae[shared_formula_index] = detail::shared_formula{
+                target.reference(), range_reference(formula_range), formula_value_string};
+        }
+
+        if (shared_formulae.find(shared_formula_index) != shared_formulae.end())
+        {
+            target.d_->shared_formula_ = shared_formula_index;
+            target.data_type(cell::type::number);
+            target.worksheet().add_formula_cell(target.reference());
+        }
+    }
+    else if (has_formula)
     {
-        cell.formula(formula_value_string);
+        target.formula(formula_value_string);
     }
 
     if (has_value)
     {
         if (type == "str")
         {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::formula_string);
+            target.d_->value_text_ = value_string;
+            target.data_type(cell::type::formula_string);
         }
         else if (type == "inlineStr")
         {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::inline_string);
+            target.d_->value_text_ = value_string;
+            target.data_type(cell::type::inline_string);
+        }
+        else if (type == "s" && !options_.resolve_shared_strings)
+        {
+            target.value(std::stold(value_string));
         }
         else if (type == "s")
         {
-            cell.d_->value_numeric_ = std::stold(value_string);
-            cell.data_type(cell::type::shared_string);
+            target.d_->value_numeric_ = std::stold(value_string);
+            target.data_type(cell::type::shared_string);
         }
         else if (type == "b") // boolean
         {
-            cell.value(is_true(value_string));
+            target.value(is_true(value_string));
         }
         else if (type == "n") // numeric
         {
-            cell.value(std::stold(value_string));
+            target.value(std::stold(value_string));
         }
         else if (!value_string.empty() && value_string[0] == '#')
         {
-            cell.error(value_string);
+            target.error(value_string);
         }
     }
 
-    if (has_format)
+    if (has_format && !options_.values_only)
     {
-        cell.format(target_.format(format_id));
-    }
-
-    if (!in_element(qn("spreadsheetml", "row")))
-    {
-        expect_end_element(qn("spreadsheetml", "row"));
-
-        if (!in_element(qn("spreadsheetml", "sheetData")))
-        {
-            expect_end_element(qn("spreadsheetml", "sheetData"));
-        }
+        target.format(target_.format(format_id));
     }
-
-    return cell;
 }
 
 void xlsx_consumer::read_worksheet(const std::string &rel_id)
@@ -552,6 +712,24 @@ void xlsx_consumer::read_worksheet_sheetdata()
         expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
         auto row_index = parser().attribute<row_t>("r");
 
+        if (options_.last_row.is_set() && row_index > options_.last_row.get())
+        {
+            // rows are in ascending order so nothing else in the sheet is wanted
+            skip_remaining_content(qn("spreadsheetml", "row"));
+            expect_end_element(qn("spreadsheetml", "row"));
+            skip_remaining_content(qn("spreadsheetml", "sheetData"));
+
+            break;
+        }
+
+        if (!row_selected(row_index))
+        {
+            skip_remaining_content(qn("spreadsheetml", "row"));
+            expect_end_element(qn("spreadsheetml", "row"));
+
+            continue;
+        }
+
         if (parser().attribute_present("ht"))
         {
             ws.row_properties(row_index).height = parser().attribute<double>("ht");
@@ -575,100 +753,17 @@ void xlsx_consumer::read_worksheet_sheetdata()
         while (in_element(qn("spreadsheetml", "row")))
         {
             expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
-            auto cell = ws.cell(cell_reference(parser().attribute("r")));
-
-            auto has_type = parser().attribute_present("t");
-            auto type = has_type ? parser().attribute("t") : "n";
-
-            auto has_format = parser().attribute_present("s");
-            auto format_id = static_cast<std::size_t>(has_format ? std::stoull(parser().attribute("s")) : 0LL);
-
-            auto has_value = false;
-            auto value_string = std::string();
+            auto reference = cell_reference(parser().attribute("r"));
 
-            auto has_formula = false;
-            auto has_shared_formula = false;
-            auto formula_value_string = std::string();
-
-            while (in_element(qn("spreadsheetml", "c")))
-            {
-                auto current_element = expect_start_element(xml::content::mixed);
-
-                if (current_element == qn("spreadsheetml", "v")) // s:ST_Xstring
-                {
-                    has_value = true;
-                    value_string = read_text();
-                }
-                else if (current_element == qn("spreadsheetml", "f")) // CT_CellFormula
-                {
-                    has_formula = true;
-
-                    if (parser().attribute_present("t"))
-                    {
-                        has_shared_formula = parser().attribute("t") == "shared";
-                    }
-
-                    skip_attributes(
-                    { "aca", "ref", "dt2D", "dtr", "del1", "del2", "r1", "r2", "ca", "si", "bx" });
-
-                    formula_value_string = read_text();
-                }
-                else if (current_element == qn("spreadsheetml", "is")) // CT_Rst
-                {
-                    expect_start_element(qn("spreadsheetml", "t"), xml::content::simple);
-                    value_string = read_text();
-                    expect_end_element(qn("spreadsheetml", "t"));
-                }
-                else
-                {
-                    unexpected_element(current_element);
-                }
-
-                expect_end_element(current_element);
-            }
-
-            expect_end_element(qn("spreadsheetml", "c"));
-
-            if (has_formula && !has_shared_formula)
+            if (!column_selected(reference.column()))
             {
-                cell.formula(formula_value_string);
-            }
+                skip_remaining_content(qn("spreadsheetml", "c"));
+                expect_end_element(qn("spreadsheetml", "c"));
 
-            if (has_value)
-            {
-                if (type == "str")
-                {
-                    cell.d_->value_text_ = value_string;
-                    cell.data_type(cell::type::formula_string);
-                }
-                else if (type == "inlineStr")
-                {
-                    cell.d_->value_text_ = value_string;
-                    cell.data_type(cell::type::inline_string);
-                }
-                else if (type == "s")
-                {
-                    cell.d_->value_numeric_ = std::stold(value_string);
-                    cell.data_type(cell::type::shared_string);
-                }
-                else if (type == "b") // boolean
-                {
-                    cell.value(is_true(value_string));
-                }
-                else if (type == "n") // numeric
-                {
-                    cell.value(std::stold(value_string));
-                }
-                else if (!value_string.empty() && value_string[0] == '#')
-                {
-                    cell.error(value_string);
-                }
+                continue;
             }
 
-            if (has_format)
-            {
-                cell.format(target_.format(format_id));
-            }
+            read_cell_content(ws.cell(reference));
         }
 
         expect_end_element(qn("spreadsheetml", "row"));
@@ -687,6 +782,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
     auto hyperlinks = manifest.relationships(sheet_path, xlnt::relationship_type::hyperlink);
 
     auto ws = worksheet(current_worksheet_);
+    std::vector<conditional_format_rule> conditional_format_rules;
 
     while (in_element(qn("spreadsheetml", "worksheet")))
     {
@@ -750,19 +846,77 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
         }
         else if (current_worksheet_element == qn("spreadsheetml", "conditionalFormatting")) // CT_ConditionalFormatting 0+
         {
-            skip_remaining_content(current_worksheet_element);
+            // the formats of the rules are in the stylesheet, which isn't read with values_only
+            if (options_.values_only)
+            {
+                skip_remaining_content(current_worksheet_element);
+            }
+            else
+            {
+                const auto sqref = parser().attribute("sqref");
+                skip_attribute("pivot");
+
+                while (in_element(current_worksheet_element))
+                {
+                    auto rule_element = expect_start_element(xml::content::complex);
+
+                    if (rule_element != qn("spreadsheetml", "cfRule"))
+                    {
+                        skip_remaining_content(rule_element);
+                        expect_end_element(rule_element);
+
+                        continue;
+                    }
+
+                    const auto priority = parser().attribute<std::size_t>("priority");
+                    auto differential_format_id = optional<std::size_t>();
+
+                    if (parser().attribute_present("dxfId"))
+                    {
+                        differential_format_id = parser().attribute<std::size_t>("dxfId");
+                    }
+
+                    const auto when = read_conditional_format_rule();
+                    expect_end_element(rule_element);
+
+                    if (!when.is_set()) continue;
+
+                    // the rules of a list of ranges become one rule per range
+                    std::istringstream ranges(sqref);
+                    std::string range;
+
+                    while (ranges >> range)
+                    {
+                        conditional_format_rules.push_back({ priority, range_reference(range), when.get(), differential_format_id });
+                    }
+                }
+            }
         }
         else if (current_worksheet_element == qn("spreadsheetml", "dataValidations")) // CT_DataValidations 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
+        else if (current_worksheet_element == qn("spreadsheetml", "hyperlinks") && options_.values_only)
+        {
+            skip_remaining_content(current_worksheet_element);
+        }
         else if (current_worksheet_element == qn("spreadsheetml", "hyperlinks")) // CT_Hyperlinks 0-1
         {
             while (in_element(qn("spreadsheetml", "hyperlinks")))
             {
                 expect_start_element(qn("spreadsheetml", "hyperlink"), xml::content::simple);
 
-                auto cell = ws.cell(parser().attribute("ref"));
+                auto reference = cell_reference(parser().attribute("ref"));
+
+                if (!row_selected(reference.row()) || !column_selected(reference.column()))
+                {
+                    skip_remaining_content(qn("spreadsheetml", "hyperlink"));
+                    expect_end_element(qn("spreadsheetml", "hyperlink"));
+
+                    continue;
+                }
+
+                auto cell = ws.cell(reference);
 
                 if (parser().attribute_present(qn("r", "id")))
                 {
@@ -987,7 +1141,38 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 
     expect_end_element(qn("spreadsheetml", "worksheet"));
 
-    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::comments))
+    if (!conditional_format_rules.empty() && target_.d_->stylesheet_ != nullptr)
+    {
+        // a copy of a lazily loaded workbook may still share the stylesheet
+        auto &stylesheet = target_.modifiable_stylesheet();
+
+        // rules are kept in order of precedence, which is the order of creation
+        std::stable_sort(conditional_format_rules.begin(), conditional_format_rules.end(),
+            [](const conditional_format_rule &a, const conditional_format_rule &b) { return a.priority < b.priority; });
+
+        for (const auto &rule : conditional_format_rules)
+        {
+            auto format = stylesheet.add_conditional_format_rule(current_worksheet_, rule.range, rule.when);
+
+            if (!rule.differential_format_id.is_set()
+                || rule.differential_format_id.get() >= stylesheet.source_differential_formats.size())
+            {
+                continue;
+            }
+
+            const auto &source_format = stylesheet.source_differential_formats.at(rule.differential_format_id.get());
+
+            if (source_format.border.is_set()) format.border(source_format.border.get());
+            if (source_format.fill.is_set()) format.fill(source_format.fill.get());
+            if (source_format.font.is_set()) format.font(source_format.font.get());
+        }
+    }
+
+    if (options_.values_only)
+    {
+        drop_comments(workbook_rel, sheet_rel);
+    }
+    else if (manifest.has_relationship(sheet_path, xlnt::relationship_type::comments))
     {
         auto comments_part = manifest.canonicalize({ workbook_rel, sheet_rel,
             manifest.relationship(sheet_path, xlnt::relationship_type::comments) });
@@ -1199,7 +1384,10 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
         break;
 
     case relationship_type::image:
-        read_image(part_path);
+        if (options_.images)
+        {
+            read_image(part_path);
+        }
         break;
     }
 
@@ -1212,6 +1400,11 @@ void xlsx_consumer::populate_workbook(bool streaming)
 
     target_.clear();
 
+    if (options_.pooled_memory)
+    {
+        target_.d_->memory_pool_ = std::make_shared<memory_pool>();
+    }
+
     read_content_types();
     const auto root_path = path("/");
 
@@ -1228,6 +1421,12 @@ void xlsx_consumer::populate_workbook(bool streaming)
             continue;
         }
 
+        if (package_rel.type() == relationship_type::thumbnail && !options_.images)
+        {
+            manifest().unregister_relationship(uri(root_path.string()), package_rel.id());
+            continue;
+        }
+
         read_part({package_rel});
     }
 
@@ -1541,14 +1740,21 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
     auto workbook_rel = manifest().relationship(path("/"), relationship_type::office_document);
     auto workbook_path = workbook_rel.target().path();
 
-    if (manifest().has_relationship(workbook_path, relationship_type::shared_string_table))
+    if (options_.resolve_shared_strings
+        && manifest().has_relationship(workbook_path, relationship_type::shared_string_table))
     {
         read_part({workbook_rel,
             manifest().relationship(workbook_path,
                 relationship_type::shared_string_table)});
     }
 
-    if (manifest().has_relationship(workbook_path, relationship_type::stylesheet))
+    if (options_.values_only)
+    {
+        // cells won't refer to any formats but the workbook still needs somewhere to keep new ones
+        target_.d_->stylesheet_ = std::make_shared<detail::stylesheet>();
+        target_.d_->stylesheet_->parent = &target_;
+    }
+    else if (manifest().has_relationship(workbook_path, relationship_type::stylesheet))
     {
         read_part({workbook_rel,
             manifest().relationship(workbook_path,
@@ -1580,8 +1786,29 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         }
 
         current_worksheet_ = &*target_.d_->worksheets_.emplace(insertion_iter, &target_, id, title);
+        current_worksheet_->memory_pool_ = target_.d_->memory_pool_;
+
+        if (passthrough())
+        {
+            current_worksheet_->source_part_ = worksheet_rel.source().path().parent()
+                .append(worksheet_rel.target().path()).string();
+        }
+
+        if (!options_.sheets.empty() && !contains(options_.sheets, title))
+        {
+            if (!passthrough())
+            {
+                drop_comments(workbook_rel, worksheet_rel);
+            }
+
+            continue;
+        }
 
-        if (!streaming_)
+        if (defer_worksheets_)
+        {
+            current_worksheet_->deferred_rel_id_ = worksheet_rel.id();
+        }
+        else if (!streaming_)
         {
             read_part({ workbook_rel, worksheet_rel });
         }
@@ -1667,8 +1894,8 @@ void xlsx_consumer::read_shared_workbook_user_data()
 
 void xlsx_consumer::read_stylesheet()
 {
-    target_.impl().stylesheet_ = detail::stylesheet();
-    auto &stylesheet = target_.impl().stylesheet_.get();
+    target_.impl().stylesheet_ = std::make_shared<detail::stylesheet>();
+    auto &stylesheet = *target_.impl().stylesheet_;
 
     expect_start_element(qn("spreadsheetml", "styleSheet"), xml::content::complex);
     skip_attributes({qn("mc", "Ignorable")});
@@ -1689,139 +1916,27 @@ void xlsx_consumer::read_stylesheet()
 
             while (in_element(qn("spreadsheetml", "borders")))
             {
-                borders.push_back(xlnt::border());
-                auto &border = borders.back();
-
                 expect_start_element(qn("spreadsheetml", "border"), xml::content::complex);
+                borders.push_back(read_border());
+                expect_end_element(qn("spreadsheetml", "border"));
+            }
 
-                auto diagonal = diagonal_direction::neither;
+            if (count != borders.size())
+            {
+                throw xlnt::exception("border counts don't match");
+            }
+        }
+        else if (current_style_element == qn("spreadsheetml", "fills"))
+        {
+            auto &fills = stylesheet.fills;
+            auto count = parser().attribute<std::size_t>("count");
 
-                if (parser().attribute_present("diagonalDown") && parser().attribute("diagonalDown") == "1")
-                {
-                    diagonal = diagonal_direction::down;
-                }
-
-                if (parser().attribute_present("diagonalUp") && parser().attribute("diagonalUp") == "1")
-                {
-                    diagonal = diagonal == diagonal_direction::down ? diagonal_direction::both : diagonal_direction::up;
-                }
-
-                if (diagonal != diagonal_direction::neither)
-                {
-                    border.diagonal(diagonal);
-                }
-
-                while (in_element(qn("spreadsheetml", "border")))
-                {
-                    auto current_side_element = expect_start_element(xml::content::complex);
-
-                    xlnt::border::border_property side;
-
-                    if (parser().attribute_present("style"))
-                    {
-                        side.style(parser().attribute<xlnt::border_style>("style"));
-                    }
-
-                    if (in_element(current_side_element))
-                    {
-                        expect_start_element(qn("spreadsheetml", "color"), xml::content::complex);
-                        side.color(read_color());
-                        expect_end_element(qn("spreadsheetml", "color"));
-                    }
-
-                    expect_end_element(current_side_element);
-
-                    auto side_type = xml::value_traits<xlnt::border_side>::parse(current_side_element.name(), parser());
-                    border.side(side_type, side);
-                }
-
-                expect_end_element(qn("spreadsheetml", "border"));
-            }
-
-            if (count != borders.size())
-            {
-                throw xlnt::exception("border counts don't match");
-            }
-        }
-        else if (current_style_element == qn("spreadsheetml", "fills"))
-        {
-            auto &fills = stylesheet.fills;
-            auto count = parser().attribute<std::size_t>("count");
-
-            while (in_element(qn("spreadsheetml", "fills")))
-            {
-                fills.push_back(xlnt::fill());
-                auto &new_fill = fills.back();
-
-                expect_start_element(qn("spreadsheetml", "fill"), xml::content::complex);
-                auto fill_element = expect_start_element(xml::content::complex);
-
-                if (fill_element == qn("spreadsheetml", "patternFill"))
-                {
-                    xlnt::pattern_fill pattern;
-
-                    if (parser().attribute_present("patternType"))
-                    {
-                        pattern.type(parser().attribute<xlnt::pattern_fill_type>("patternType"));
-
-                        while (in_element(qn("spreadsheetml", "patternFill")))
-                        {
-                            auto pattern_type_element = expect_start_element(xml::content::complex);
-
-                            if (pattern_type_element == qn("spreadsheetml", "fgColor"))
-                            {
-                                pattern.foreground(read_color());
-                            }
-                            else if (pattern_type_element == qn("spreadsheetml", "bgColor"))
-                            {
-                                pattern.background(read_color());
-                            }
-                            else
-                            {
-                                unexpected_element(pattern_type_element);
-                            }
-
-                            expect_end_element(pattern_type_element);
-                        }
-                    }
-
-                    new_fill = pattern;
-                }
-                else if (fill_element == qn("spreadsheetml", "gradientFill"))
-                {
-                    xlnt::gradient_fill gradient;
-
-                    if (parser().attribute_present("type"))
-                    {
-                        gradient.type(parser().attribute<xlnt::gradient_fill_type>("type"));
-                    }
-                    else
-                    {
-                        gradient.type(xlnt::gradient_fill_type::linear);
-                    }
-
-                    while (in_element(qn("spreadsheetml", "gradientFill")))
-                    {
-                        expect_start_element(qn("spreadsheetml", "stop"), xml::content::complex);
-                        auto position = parser().attribute<double>("position");
-                        expect_start_element(qn("spreadsheetml", "color"), xml::content::complex);
-                        auto color = read_color();
-                        expect_end_element(qn("spreadsheetml", "color"));
-                        expect_end_element(qn("spreadsheetml", "stop"));
-
-                        gradient.add_stop(position, color);
-                    }
-
-                    new_fill = gradient;
-                }
-                else
-                {
-                    unexpected_element(fill_element);
-                }
-
-                expect_end_element(fill_element);
-                expect_end_element(qn("spreadsheetml", "fill"));
-            }
+            while (in_element(qn("spreadsheetml", "fills")))
+            {
+                expect_start_element(qn("spreadsheetml", "fill"), xml::content::complex);
+                fills.push_back(read_fill());
+                expect_end_element(qn("spreadsheetml", "fill"));
+            }
 
             if (count != fills.size())
             {
@@ -1836,120 +1951,8 @@ void xlsx_consumer::read_stylesheet()
 
             while (in_element(qn("spreadsheetml", "fonts")))
             {
-                fonts.push_back(xlnt::font());
-                auto &new_font = stylesheet.fonts.back();
-
                 expect_start_element(qn("spreadsheetml", "font"), xml::content::complex);
-
-                while (in_element(qn("spreadsheetml", "font")))
-                {
-                    auto font_property_element = expect_start_element(xml::content::simple);
-
-                    if (font_property_element == qn("spreadsheetml", "sz"))
-                    {
-                        new_font.size(parser().attribute<double>("val"));
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "name"))
-                    {
-                        new_font.name(parser().attribute("val"));
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "color"))
-                    {
-                        new_font.color(read_color());
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "family"))
-                    {
-                        new_font.family(parser().attribute<std::size_t>("val"));
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "scheme"))
-                    {
-                        new_font.scheme(parser().attribute("val"));
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "b"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            new_font.bold(is_true(parser().attribute("val")));
-                        }
-                        else
-                        {
-                            new_font.bold(true);
-                        }
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "vertAlign"))
-                    {
-                        new_font.superscript(parser().attribute("val") == "superscript");
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "strike"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            new_font.strikethrough(is_true(parser().attribute("val")));
-                        }
-                        else
-                        {
-                            new_font.strikethrough(true);
-                        }
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "outline"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            new_font.outline(is_true(parser().attribute("val")));
-                        }
-                        else
-                        {
-                            new_font.outline(true);
-                        }
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "shadow"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            new_font.shadow(is_true(parser().attribute("val")));
-                        }
-                        else
-                        {
-                            new_font.shadow(true);
-                        }
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "i"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            new_font.italic(is_true(parser().attribute("val")));
-                        }
-                        else
-                        {
-                            new_font.italic(true);
-                        }
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "u"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            new_font.underline(parser().attribute<xlnt::font::underline_style>("val"));
-                        }
-                        else
-                        {
-                            new_font.underline(xlnt::font::underline_style::single);
-                        }
-                    }
-                    else if (font_property_element == qn("spreadsheetml", "charset"))
-                    {
-                        if (parser().attribute_present("val"))
-                        {
-                            parser().attribute("val");
-                        }
-                    }
-                    else
-                    {
-                        unexpected_element(font_property_element);
-                    }
-
-                    expect_end_element(font_property_element);
-                }
-
+                fonts.push_back(read_font());
                 expect_end_element(qn("spreadsheetml", "font"));
             }
 
@@ -2155,9 +2158,36 @@ void xlsx_consumer::read_stylesheet()
 
             while (in_element(current_style_element))
             {
-                auto current_element = expect_start_element(xml::content::mixed);
-                skip_remaining_content(current_element);
-                expect_end_element(current_element);
+                expect_start_element(qn("spreadsheetml", "dxf"), xml::content::complex);
+                stylesheet.source_differential_formats.push_back(differential_format());
+                auto &format = stylesheet.source_differential_formats.back();
+
+                while (in_element(qn("spreadsheetml", "dxf")))
+                {
+                    auto component = expect_start_element(xml::content::complex);
+
+                    if (component == qn("spreadsheetml", "border"))
+                    {
+                        format.border = read_border();
+                    }
+                    else if (component == qn("spreadsheetml", "fill"))
+                    {
+                        format.fill = read_fill();
+                    }
+                    else if (component == qn("spreadsheetml", "font"))
+                    {
+                        format.font = read_font();
+                    }
+                    else
+                    {
+                        // conditional formats don't hold number formats, alignment or protection
+                        skip_remaining_content(component);
+                    }
+
+                    expect_end_element(component);
+                }
+
+                expect_end_element(qn("spreadsheetml", "dxf"));
                 ++processed;
             }
 
@@ -2353,7 +2383,13 @@ void xlsx_consumer::read_comments(worksheet ws)
 
         expect_start_element(qn("spreadsheetml", "text"), xml::content::complex);
 
-        ws.cell(cell_ref).comment(comment(read_rich_text(qn("spreadsheetml", "text")), authors.at(author_id)));
+        auto text = read_rich_text(qn("spreadsheetml", "text"));
+        auto reference = cell_reference(cell_ref);
+
+        if (row_selected(reference.row()) && column_selected(reference.column()))
+        {
+            ws.cell(reference).comment(comment(text, authors.at(author_id)));
+        }
 
         expect_end_element(qn("spreadsheetml", "text"));
 
@@ -2388,9 +2424,130 @@ void xlsx_consumer::read_unknown_relationships()
 void xlsx_consumer::read_image(const xlnt::path &image_path)
 {
     auto image_streambuf = archive_->open(image_path);
-    vector_ostreambuf buffer(target_.d_->images_[image_path.string()]);
+    auto image = std::make_shared<std::vector<std::uint8_t>>();
+    vector_ostreambuf buffer(*image);
     std::ostream out_stream(&buffer);
     out_stream << image_streambuf.get();
+    target_.d_->images_[image_path.string()] = image;
+}
+
+void xlsx_consumer::drop_comments(const relationship &workbook_rel, const relationship &sheet_rel)
+{
+    auto &manifest = target_.manifest();
+    const auto sheet_path = sheet_rel.source().path().parent().append(sheet_rel.target().path());
+
+    for (auto type : { relationship_type::comments, relationship_type::vml_drawing })
+    {
+        for (const auto &rel : manifest.relationships(sheet_path, type))
+        {
+            manifest.unregister_override_type(manifest.canonicalize({ workbook_rel, sheet_rel, rel }));
+            manifest.unregister_relationship(uri(sheet_path.string()), rel.id());
+        }
+    }
+}
+
+bool xlsx_consumer::row_selected(row_t row) const
+{
+    return row >= options_.first_row
+        && (!options_.last_row.is_set() || row <= options_.last_row.get());
+}
+
+bool xlsx_consumer::column_selected(column_t column) const
+{
+    return options_.columns.empty() || contains(options_.columns, column);
+}
+
+bool xlsx_consumer::passthrough() const
+{
+    const auto &stylesheet = target_.d_->stylesheet_;
+
+    return defer_worksheets_ && !options_.values_only && options_.resolve_shared_strings
+        && (stylesheet == nullptr || stylesheet->source_differential_formats.empty());
+}
+
+optional<condition> xlsx_consumer::read_conditional_format_rule()
+{
+    const auto type = parser().attribute("type");
+    const auto attribute = [this](const std::string &name, const std::string &default_value) {
+        return parser().attribute_present(name) ? parser().attribute(name) : default_value;
+    };
+
+    const auto operator_name = attribute("operator", "");
+    const auto has_text = parser().attribute_present("text");
+    const auto text = attribute("text", "");
+    const auto rank = std::strtoul(attribute("rank", "0").c_str(), nullptr, 10);
+    const auto percent = is_true(attribute("percent", "0"));
+    const auto bottom = is_true(attribute("bottom", "0"));
+    const auto above = is_true(attribute("aboveAverage", "1"));
+    const auto equal_or_deviation = is_true(attribute("equalAverage", "0")) || parser().attribute_present("stdDev");
+    skip_attributes();
+
+    std::vector<double> numbers;
+    auto supported = true;
+
+    while (in_element(qn("spreadsheetml", "cfRule")))
+    {
+        auto child_element = expect_start_element(xml::content::mixed);
+
+        if (child_element == qn("spreadsheetml", "formula"))
+        {
+            auto number = 0.0;
+            supported = parse_number(read_text(), number) && supported;
+            numbers.push_back(number);
+        }
+        else
+        {
+            // color scales, data bars and icon sets
+            skip_remaining_content(child_element);
+            supported = false;
+        }
+
+        expect_end_element(child_element);
+    }
+
+    // text rules have a formula that repeats their text
+    if (has_text && (type == "containsText" || type == "notContainsText" || type == "beginsWith" || type == "endsWith"))
+    {
+        if (type == "containsText") return optional<condition>(condition::text_contains(text));
+        if (type == "notContainsText") return optional<condition>(condition::text_does_not_contain(text));
+        if (type == "beginsWith") return optional<condition>(condition::text_starts_with(text));
+        return optional<condition>(condition::text_ends_with(text));
+    }
+
+    if (!supported) return optional<condition>();
+
+    if (type == "cellIs" && !numbers.empty())
+    {
+        const auto low = numbers.front();
+        const auto high = numbers.back();
+
+        if (operator_name == "lessThan") return optional<condition>(condition::less_than(low));
+        if (operator_name == "lessThanOrEqual") return optional<condition>(condition::less_than_or_equal(low));
+        if (operator_name == "equal") return optional<condition>(condition::equal(low));
+        if (operator_name == "notEqual") return optional<condition>(condition::not_equal(low));
+        if (operator_name == "greaterThanOrEqual") return optional<condition>(condition::greater_than_or_equal(low));
+        if (operator_name == "greaterThan") return optional<condition>(condition::greater_than(low));
+        if (operator_name == "between" && numbers.size() == 2) return optional<condition>(condition::between(low, high));
+        if (operator_name == "notBetween" && numbers.size() == 2) return optional<condition>(condition::not_between(low, high));
+    }
+    else if (type == "top10" && rank != 0 && (!percent || rank <= 100))
+    {
+        return optional<condition>(bottom ? condition::bottom(rank, percent) : condition::top(rank, percent));
+    }
+    else if (type == "aboveAverage" && !equal_or_deviation)
+    {
+        return optional<condition>(above ? condition::above_average() : condition::below_average());
+    }
+    else if (type == "duplicateValues")
+    {
+        return optional<condition>(condition::duplicate_values());
+    }
+    else if (type == "uniqueValues")
+    {
+        return optional<condition>(condition::unique_values());
+    }
+
+    return optional<condition>();
 }
 
 std::string xlsx_consumer::read_text()
@@ -2701,6 +2858,247 @@ rich_text xlsx_consumer::read_rich_text(const xml::qname &parent)
     return t;
 }
 
+xlnt::border xlsx_consumer::read_border()
+{
+    xlnt::border result;
+
+
+    auto diagonal = diagonal_direction::neither;
+
+    if (parser().attribute_present("diagonalDown") && parser().attribute("diagonalDown") == "1")
+    {
+        diagonal = diagonal_direction::down;
+    }
+
+    if (parser().attribute_present("diagonalUp") && parser().attribute("diagonalUp") == "1")
+    {
+        diagonal = diagonal == diagonal_direction::down ? diagonal_direction::both : diagonal_direction::up;
+    }
+
+    if (diagonal != diagonal_direction::neither)
+    {
+        result.diagonal(diagonal);
+    }
+
+    while (in_element(qn("spreadsheetml", "border")))
+    {
+        auto current_side_element = expect_start_element(xml::content::complex);
+
+        xlnt::border::border_property side;
+
+        if (parser().attribute_present("style"))
+        {
+            side.style(parser().attribute<xlnt::border_style>("style"));
+        }
+
+        if (in_element(current_side_element))
+        {
+            expect_start_element(qn("spreadsheetml", "color"), xml::content::complex);
+            side.color(read_color());
+            expect_end_element(qn("spreadsheetml", "color"));
+        }
+
+        expect_end_element(current_side_element);
+
+        auto side_type = xml::value_traits<xlnt::border_side>::parse(current_side_element.name(), parser());
+        result.side(side_type, side);
+    }
+
+    return result;
+}
+
+xlnt::fill xlsx_consumer::read_fill()
+{
+    xlnt::fill result;
+
+    auto fill_element = expect_start_element(xml::content::complex);
+
+    if (fill_element == qn("spreadsheetml", "patternFill"))
+    {
+        xlnt::pattern_fill pattern;
+
+        if (parser().attribute_present("patternType"))
+        {
+            pattern.type(parser().attribute<xlnt::pattern_fill_type>("patternType"));
+        }
+
+        // fills of differential formats give colors without a pattern type
+        while (in_element(qn("spreadsheetml", "patternFill")))
+        {
+            auto pattern_type_element = expect_start_element(xml::content::complex);
+
+            if (pattern_type_element == qn("spreadsheetml", "fgColor"))
+            {
+                pattern.foreground(read_color());
+            }
+            else if (pattern_type_element == qn("spreadsheetml", "bgColor"))
+            {
+                pattern.background(read_color());
+            }
+            else
+            {
+                unexpected_element(pattern_type_element);
+            }
+
+            expect_end_element(pattern_type_element);
+        }
+
+        result = pattern;
+    }
+    else if (fill_element == qn("spreadsheetml", "gradientFill"))
+    {
+        xlnt::gradient_fill gradient;
+
+        if (parser().attribute_present("type"))
+        {
+            gradient.type(parser().attribute<xlnt::gradient_fill_type>("type"));
+        }
+        else
+        {
+            gradient.type(xlnt::gradient_fill_type::linear);
+        }
+
+        while (in_element(qn("spreadsheetml", "gradientFill")))
+        {
+            expect_start_element(qn("spreadsheetml", "stop"), xml::content::complex);
+            auto position = parser().attribute<double>("position");
+            expect_start_element(qn("spreadsheetml", "color"), xml::content::complex);
+            auto color = read_color();
+            expect_end_element(qn("spreadsheetml", "color"));
+            expect_end_element(qn("spreadsheetml", "stop"));
+
+            gradient.add_stop(position, color);
+        }
+
+        result = gradient;
+    }
+    else
+    {
+        unexpected_element(fill_element);
+    }
+
+    expect_end_element(fill_element);
+
+    return result;
+}
+
+xlnt::font xlsx_consumer::read_font()
+{
+    xlnt::font result;
+
+
+    while (in_element(qn("spreadsheetml", "font")))
+    {
+        auto font_property_element = expect_start_element(xml::content::simple);
+
+        if (font_property_element == qn("spreadsheetml", "sz"))
+        {
+            result.size(parser().attribute<double>("val"));
+        }
+        else if (font_property_element == qn("spreadsheetml", "name"))
+        {
+            result.name(parser().attribute("val"));
+        }
+        else if (font_property_element == qn("spreadsheetml", "color"))
+        {
+            result.color(read_color());
+        }
+        else if (font_property_element == qn("spreadsheetml", "family"))
+        {
+            result.family(parser().attribute<std::size_t>("val"));
+        }
+        else if (font_property_element == qn("spreadsheetml", "scheme"))
+        {
+            result.scheme(parser().attribute("val"));
+        }
+        else if (font_property_element == qn("spreadsheetml", "b"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                result.bold(is_true(parser().attribute("val")));
+            }
+            else
+            {
+                result.bold(true);
+            }
+        }
+        else if (font_property_element == qn("spreadsheetml", "vertAlign"))
+        {
+            result.superscript(parser().attribute("val") == "superscript");
+        }
+        else if (font_property_element == qn("spreadsheetml", "strike"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                result.strikethrough(is_true(parser().attribute("val")));
+            }
+            else
+            {
+                result.strikethrough(true);
+            }
+        }
+        else if (font_property_element == qn("spreadsheetml", "outline"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                result.outline(is_true(parser().attribute("val")));
+            }
+            else
+            {
+                result.outline(true);
+            }
+        }
+        else if (font_property_element == qn("spreadsheetml", "shadow"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                result.shadow(is_true(parser().attribute("val")));
+            }
+            else
+            {
+                result.shadow(true);
+            }
+        }
+        else if (font_property_element == qn("spreadsheetml", "i"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                result.italic(is_true(parser().attribute("val")));
+            }
+            else
+            {
+                result.italic(true);
+            }
+        }
+        else if (font_property_element == qn("spreadsheetml", "u"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                result.underline(parser().attribute<xlnt::font::underline_style>("val"));
+            }
+            else
+            {
+                result.underline(xlnt::font::underline_style::single);
+            }
+        }
+        else if (font_property_element == qn("spreadsheetml", "charset"))
+        {
+            if (parser().attribute_present("val"))
+            {
+                parser().attribute("val");
+            }
+        }
+        else
+        {
+            unexpected_element(font_property_element);
+        }
+
+        expect_end_element(font_property_element);
+    }
+
+    return result;
+}
+
 xlnt::color xlsx_consumer::read_color()
 {
     xlnt::color result;
@@ -34,11 +34,17 @@
 
 #include <detail/external/include_libstudxml.hpp>
 #include <detail/serialization/zstream.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/workbook/load_options.hpp>
 
 namespace xlnt {
 
+class border;
 class cell;
 class color;
+class condition;
+class fill;
+class font;
 class rich_text;
 class manifest;
 template<typename T>
@@ -64,12 +70,26 @@ class xlsx_consumer
 public:
 	xlsx_consumer(workbook &destination);
 
+    xlsx_consumer(workbook &destination, const load_options &options);
+
 	~xlsx_consumer();
 
 	void read(std::istream &source);
 
 	void read(std::istream &source, const std::string &password);
 
+    /// <summary>
+    /// Reads everything in source except the content of worksheets, which is
+    /// left for read_deferred_worksheet. source is kept alive by the target
+    /// workbook for as long as it may be needed.
+    /// </summary>
+    void read_lazily(std::shared_ptr<std::istream> source);
+
+    /// <summary>
+    /// Reads the content of a worksheet skipped by read_lazily.
+    /// </summary>
+    void read_deferred_worksheet(worksheet_impl &ws);
+
 private:
     friend class xlnt::streaming_workbook_reader;
 
@@ -84,6 +104,12 @@ private:
     /// </summary>
     cell read_cell();
 
+    /// <summary>
+    /// Reads the attributes and children of the c element that was just started
+    /// into target and handles the end of the element.
+    /// </summary>
+    void read_cell_content(cell target);
+
 	/// <summary>
 	/// Read all the files needed from the XLSX archive and initialize all of
 	/// the data in the workbook to match.
@@ -259,6 +285,21 @@ private:
     /// </summary>
     std::vector<relationship> read_relationships(const path &part);
 
+    /// <summary>
+    /// Read the content of a CT_Border element whose start has just been read.
+    /// </summary>
+    border read_border();
+
+    /// <summary>
+    /// Read the content of a CT_Fill element whose start has just been read.
+    /// </summary>
+    fill read_fill();
+
+    /// <summary>
+    /// Read the content of a CT_Font element whose start has just been read.
+    /// </summary>
+    font read_font();
+
     /// <summary>
     /// Read a CT_Color from the document currently being parsed.
     /// </summary>
@@ -269,6 +310,40 @@ private:
     /// </summary>
     rich_text read_rich_text(const xml::qname &parent);
 
+    /// <summary>
+    /// Returns true if row is inside the row window selected by options_.
+    /// </summary>
+    bool row_selected(row_t row) const;
+
+    /// <summary>
+    /// Returns true if column is one of the columns selected by options_.
+    /// </summary>
+    bool column_selected(column_t column) const;
+
+    /// <summary>
+    /// Removes the relationships from the given sheet to its comments and their
+    /// drawings, for sheets whose comments aren't read, so that empty comment
+    /// parts aren't written when the workbook is saved.
+    /// </summary>
+    void drop_comments(const relationship &workbook_rel, const relationship &sheet_rel);
+
+    /// <summary>
+    /// Returns true if the package being read lazily should be kept so that
+    /// unmodified parts can be copied from it when the workbook is saved.
+    /// Projections that drop styles or shared strings would leave those parts
+    /// inconsistent with the original sheets so they disable this, as do
+    /// differential formats, which the rewritten stylesheet doesn't keep in
+    /// the order the original sheets refer to them.
+    /// </summary>
+    bool passthrough() const;
+
+    /// <summary>
+    /// Reads the CT_CfRule whose start and priority have just been read. Returns
+    /// its condition, or nothing if it's a kind of rule conditional_format can't
+    /// hold, such as formula expressions, color scales, data bars and icon sets.
+    /// </summary>
+    optional<condition> read_conditional_format_rule();
+
     /// <summary>
     /// Returns true if the givent document type represents an XLSX file.
     /// </summary>
@@ -379,7 +454,7 @@ private:
 	/// <summary>
 	/// The ZIP file containing the files that make up the OOXML package.
 	/// </summary>
-	std::unique_ptr<izstream> archive_;
+	std::shared_ptr<izstream> archive_;
 
 	/// <summary>
 	/// Map of sheet titles to relationship IDs.
@@ -410,6 +485,10 @@ private:
 
     bool streaming_ = false;
 
+    bool defer_worksheets_ = false;
+
+    load_options options_;
+
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
     detail::cell_impl *current_cell_;
@@ -30,6 +30,7 @@
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
+#include <detail/serialization/miniz.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
 #include <detail/serialization/zstream.hpp>
@@ -79,11 +80,44 @@ std::vector<std::pair<std::string, std::string>> core_property_namespace(xlnt::c
     return {{constants::ns("core-properties"), "cp"}};
 }
 
+/// <summary>
+/// Returns the path within the package of target relative to the part source,
+/// with any ".." components resolved.
+/// </summary>
+xlnt::path resolve_part(const xlnt::path &source, const xlnt::path &target)
+{
+    if (source == xlnt::path("/")) return target;
+
+    auto split_part_path = source.parent().append(target).split();
+    auto part_path_iter = split_part_path.begin();
+
+    while (part_path_iter != split_part_path.end())
+    {
+        if (*part_path_iter == ".." && part_path_iter != split_part_path.begin())
+        {
+            part_path_iter = split_part_path.erase(part_path_iter - 1, part_path_iter + 1);
+            continue;
+        }
+
+        ++part_path_iter;
+    }
+
+    return std::accumulate(split_part_path.begin(), split_part_path.end(), xlnt::path(""),
+        [](const xlnt::path &a, const std::string &b) { return a.append(b); });
+}
+
 } // namespace
 
 namespace xlnt {
 namespace detail {
 
+struct xlsx_producer::default_part
+{
+    zheader header;
+    std::vector<std::uint8_t> compressed;
+    std::vector<std::uint8_t> content;
+};
+
 xlsx_producer::xlsx_producer(const workbook &target)
     : source_(target),
       current_part_stream_(nullptr)
@@ -164,8 +198,8 @@ void xlsx_producer::populate_archive(bool streaming)
 
     // Unknown Parts
 
-    void write_unknown_parts();
-    void write_unknown_relationships();
+    write_unknown_parts();
+    write_unknown_relationships();
 
     end_part();
 }
@@ -178,16 +212,120 @@ void xlsx_producer::end_part()
     }
 
     current_part_streambuf_.reset();
+
+    if (!buffering_part_) return;
+
+    buffering_part_ = false;
+    const auto &default_content = default_parts().at(current_part_.string()).content;
+
+    if (current_part_buffer_ == default_content)
+    {
+        write_default_part(current_part_);
+        return;
+    }
+
+    auto part_streambuf = archive_->open(current_part_);
+    std::ostream(part_streambuf.get()).write(reinterpret_cast<const char *>(current_part_buffer_.data()),
+        static_cast<std::streamsize>(current_part_buffer_.size()));
 }
 
 void xlsx_producer::begin_part(const path &part)
 {
     end_part();
-    current_part_streambuf_ = archive_->open(part);
+    written_parts_.insert(part.string());
+    current_part_ = part;
+
+    if (use_default_parts_ && default_parts().count(part.string()) != 0)
+    {
+        // These parts are small and usually identical to the default, in which
+        // case the stored compressed copy is written instead.
+        buffering_part_ = true;
+        current_part_buffer_.clear();
+        current_part_streambuf_.reset(new vector_ostreambuf(current_part_buffer_));
+    }
+    else
+    {
+        current_part_streambuf_ = archive_->open(part);
+    }
+
     current_part_stream_.rdbuf(current_part_streambuf_.get());
     current_part_serializer_.reset(new xml::serializer(current_part_stream_, part.string()));
 }
 
+const izstream *xlsx_producer::source_package() const
+{
+    return source_.d_->passthrough_ ? source_.d_->deferred_archive_.get() : nullptr;
+}
+
+bool xlsx_producer::write_raw_part(const path &part)
+{
+    const auto package = source_package();
+
+    if (package == nullptr || !package->has_file(part) || written_parts_.count(part.string()) != 0)
+    {
+        return false;
+    }
+
+    end_part();
+    package->copy_raw(part, *archive_);
+    written_parts_.insert(part.string());
+
+    const auto rels_part = part.parent().append("_rels").append(part.filename() + ".rels");
+
+    if (package->has_file(rels_part) && written_parts_.insert(rels_part.string()).second)
+    {
+        package->copy_raw(rels_part, *archive_);
+    }
+
+    return true;
+}
+
+const std::unordered_map<std::string, xlsx_producer::default_part> &xlsx_producer::default_parts()
+{
+    static const auto parts = []() {
+        std::vector<std::uint8_t> bytes;
+
+        {
+            const auto wb = workbook::empty();
+            vector_ostreambuf buffer(bytes);
+            std::ostream stream(&buffer);
+            xlsx_producer producer(wb);
+            producer.use_default_parts_ = false;
+            producer.write(stream);
+        }
+
+        vector_istreambuf buffer(bytes);
+        std::istream stream(&buffer);
+        izstream archive(stream);
+        std::unordered_map<std::string, default_part> result;
+
+        for (const auto &file : archive.files())
+        {
+            // sheets hold the user's data and can be arbitrarily large
+            if (file.string().find("xl/worksheets/") == 0) continue;
+
+            const auto content = archive.read(file);
+            result[file.string()] = default_part{archive.header(file), archive.read_raw(file),
+                std::vector<std::uint8_t>(content.begin(), content.end())};
+        }
+
+        return result;
+    }();
+
+    return parts;
+}
+
+void xlsx_producer::write_default_part(const path &part)
+{
+    end_part();
+
+    const auto &stored = default_parts().at(part.string());
+    vector_istreambuf buffer(stored.compressed);
+    std::istream stream(&buffer);
+    archive_->write_raw(stored.header, stream);
+    written_parts_.insert(part.string());
+}
+
 // Package Parts
 
 void xlsx_producer::write_content_types()
@@ -440,8 +578,12 @@ void xlsx_producer::write_workbook(const relationship &rel)
     std::size_t num_visible = 0;
     bool any_defined_names = false;
 
-    for (auto ws : source_)
+    // Sheets are inspected directly so that deferred ones aren't read just to
+    // write this part. Their sheet properties haven't been read yet either way.
+    for (auto &impl : source_.d_->worksheets_)
     {
+        const auto ws = worksheet(&impl);
+
         if (!ws.has_page_setup() || ws.page_setup().sheet_state() == sheet_state::visible)
         {
             num_visible++;
@@ -460,7 +602,6 @@ void xlsx_producer::write_workbook(const relationship &rel)
 
     static const auto &xmlns = constants::ns("workbook");
     static const auto &xmlns_r = constants::ns("r");
-    static const auto &xmlns_s = constants::ns("spreadsheetml");
 
     write_start_element(xmlns, "workbook");
     write_namespace(xmlns, "");
@@ -570,10 +711,9 @@ void xlsx_producer::write_workbook(const relationship &rel)
 
     write_start_element(xmlns, "sheets");
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wrange-loop-analysis"
-    for (const auto ws : source_)
+    for (auto &impl : source_.d_->worksheets_)
     {
+        const auto ws = worksheet(&impl);
         auto sheet_rel_id = source_.d_->sheet_title_rel_id_map_[ws.title()];
         auto sheet_rel = source_.d_->manifest_.relationship(rel.target().path(), sheet_rel_id);
 
@@ -589,7 +729,6 @@ void xlsx_producer::write_workbook(const relationship &rel)
         write_attribute(xml::qname(xmlns_r, "id"), sheet_rel_id);
         write_end_element(xmlns, "sheet");
     }
-#pragma clang diagnostic pop
 
     write_end_element(xmlns, "sheets");
 
@@ -622,12 +761,11 @@ void xlsx_producer::write_workbook(const relationship &rel)
 
         for (auto &named_range : source_.named_ranges())
         {
-            write_start_element(xmlns_s, "definedName");
-            write_namespace(xmlns_s, "s");
+            write_start_element(xmlns, "definedName");
             write_attribute("name", named_range.name());
             const auto &target = named_range.targets().front();
             write_characters("'" + target.first.title() + "\'!" + target.second.to_string());
-            write_end_element(xmlns_s, "definedName");
+            write_end_element(xmlns, "definedName");
         }
 
         write_end_element(xmlns, "definedNames");
@@ -643,6 +781,40 @@ void xlsx_producer::write_workbook(const relationship &rel)
         if (child_rel.type() == relationship_type::calculation_chain) continue;
 
         path archive_path(child_rel.source().path().parent().append(child_rel.target().path()));
+
+        if (child_rel.type() == relationship_type::shared_string_table
+            && source_.d_->shared_strings_ == source_.d_->source_shared_strings_
+            && write_raw_part(archive_path))
+        {
+            continue;
+        }
+
+        if (child_rel.type() == relationship_type::worksheet)
+        {
+            const auto &title_rel_ids = source_.d_->sheet_title_rel_id_map_;
+            const auto title = std::find_if(title_rel_ids.begin(), title_rel_ids.end(),
+                [&](const std::pair<std::string, std::string> &p) { return p.second == child_rel.id(); })->first;
+            const auto &worksheets = source_.d_->worksheets_;
+            const auto impl = std::find_if(worksheets.begin(), worksheets.end(),
+                [&](const worksheet_impl &ws) { return ws.title_ == title; });
+
+            // the parts this sheet refers to are copied with the unknown parts
+            if (impl != worksheets.end() && impl->source_part_ == archive_path.string()
+                && write_raw_part(archive_path))
+            {
+                continue;
+            }
+        }
+
+        // the theme model holds no data so its part never differs from the default
+        if (child_rel.type() == relationship_type::theme && use_default_parts_
+            && default_parts().count(archive_path.string()) != 0
+            && source_.manifest().relationships(archive_path).empty())
+        {
+            write_default_part(archive_path);
+            continue;
+        }
+
         begin_part(archive_path);
 
         switch (child_rel.type())
@@ -790,11 +962,18 @@ void xlsx_producer::write_shared_string_table(const relationship & /*rel*/)
 
     // todo: is there a more elegant way to get this number?
     std::size_t string_count = 0;
+    bool all_sheets_read = true;
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wrange-loop-analysis"
-    for (const auto ws : source_)
+    for (auto &impl : source_.d_->worksheets_)
     {
+        // count is optional so it is left out rather than reading deferred sheets
+        if (!impl.deferred_rel_id_.empty())
+        {
+            all_sheets_read = false;
+            continue;
+        }
+
+        const auto ws = worksheet(&impl);
         auto dimension = ws.calculate_dimension();
         auto current_cell = dimension.top_left();
 
@@ -815,9 +994,12 @@ void xlsx_producer::write_shared_string_table(const relationship & /*rel*/)
             current_cell.column_index(dimension.top_left().column_index());
         }
     }
-#pragma clang diagnostic pop
 
-    write_attribute("count", string_count);
+    if (all_sheets_read)
+    {
+        write_attribute("count", string_count);
+    }
+
     write_attribute("uniqueCount", source_.shared_strings().size());
 
     auto has_trailing_whitespace = [](const std::string &s)
@@ -1121,7 +1303,7 @@ void xlsx_producer::write_styles(const relationship & /*rel*/)
     write_start_element(xmlns, "styleSheet");
     write_namespace(xmlns, "");
 
-    const auto &stylesheet = source_.impl().stylesheet_.get();
+    const auto &stylesheet = *source_.impl().stylesheet_;
 
     // Number Formats
 
@@ -2298,7 +2480,28 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
             // begin child elements
 
-            if (cell.has_formula())
+            if (cell.d_->shared_formula_.is_set())
+            {
+                const auto index = cell.d_->shared_formula_.get();
+                const auto &shared = ws.d_->shared_formulae_.at(index);
+
+                write_start_element(xmlns, "f");
+                write_attribute("t", "shared");
+
+                if (shared.anchor_ == cell.reference())
+                {
+                    write_attribute("ref", shared.range_.to_string());
+                    write_attribute("si", index);
+                    write_characters(shared.formula_);
+                }
+                else
+                {
+                    write_attribute("si", index);
+                }
+
+                write_end_element(xmlns, "f");
+            }
+            else if (cell.has_formula())
             {
                 write_element(xmlns, "f", cell.formula());
             }
@@ -2384,42 +2587,189 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "mergeCells");
     }
 
-	if (source_.impl().stylesheet_.is_set())
+	if (source_.impl().stylesheet_ != nullptr)
 	{
-		const auto &stylesheet = source_.impl().stylesheet_.get();
+		const auto &stylesheet = *source_.impl().stylesheet_;
 		const auto &cf_impls = stylesheet.conditional_format_impls;
 
-		std::unordered_map<std::string, std::vector<const conditional_format_impl *>> range_map;
+		// rules are grouped by range in order of creation and the earliest
+		// created rule takes precedence where ranges overlap
+		std::vector<std::pair<std::string, std::vector<const conditional_format_impl *>>> range_rules;
+		std::unordered_map<const conditional_format_impl *, std::size_t> priorities;
 
 		for (auto &cf : cf_impls)
 		{
 			if (cf.target_sheet != ws.d_) continue;
 
-			if (range_map.find(cf.target_range.to_string()) == range_map.end())
+			const auto priority = priorities.size() + 1;
+			priorities[&cf] = priority;
+
+			const auto sqref = cf.target_range.to_string();
+			auto match = std::find_if(range_rules.begin(), range_rules.end(),
+				[&sqref](const std::pair<std::string, std::vector<const conditional_format_impl *>> &entry) {
+					return entry.first == sqref;
+				});
+
+			if (match == range_rules.end())
 			{
-				range_map[cf.target_range.to_string()] = {};
+				range_rules.push_back({sqref, {}});
+				match = range_rules.end() - 1;
 			}
 
-			range_map[cf.target_range.to_string()].push_back(&cf);
+			match->second.push_back(&cf);
 		}
 
-		for (const auto &range_rules_pair : range_map)
+		const auto format_number = [](double number) {
+			std::stringstream ss;
+			ss.precision(17);
+			ss << number;
+			return ss.str();
+		};
+
+		for (const auto &range_rules_pair : range_rules)
 		{
 			write_start_element(xmlns, "conditionalFormatting");
 			write_attribute("sqref", range_rules_pair.first);
 
-			std::size_t i = 1;
-
 			for (auto rule : range_rules_pair.second)
 			{
+				const auto &when = rule->when;
+				const auto first_cell = rule->target_range.top_left().to_string();
+				auto quoted_text = std::string("\"");
+
+				for (auto c : when.text_comparand_)
+				{
+					quoted_text.append(c == '"' ? 2 : 1, c);
+				}
+
+				quoted_text.push_back('"');
+
 				write_start_element(xmlns, "cfRule");
-				write_attribute("type", "containsText");
-				write_attribute("operator", "containsText");
+
+				switch (when.type_)
+				{
+				case condition::type::contains_text:
+					switch (when.operator_)
+					{
+					case condition::condition_operator::starts_with:
+						write_attribute("type", "beginsWith");
+						write_attribute("operator", "beginsWith");
+						break;
+					case condition::condition_operator::ends_with:
+						write_attribute("type", "endsWith");
+						write_attribute("operator", "endsWith");
+						break;
+					case condition::condition_operator::does_not_contain:
+						write_attribute("type", "notContainsText");
+						write_attribute("operator", "notContains");
+						break;
+					default:
+						write_attribute("type", "containsText");
+						write_attribute("operator", "containsText");
+						break;
+					}
+					break;
+				case condition::type::cell_is:
+					write_attribute("type", "cellIs");
+					switch (when.operator_)
+					{
+					case condition::condition_operator::less_than:
+						write_attribute("operator", "lessThan");
+						break;
+					case condition::condition_operator::less_than_or_equal:
+						write_attribute("operator", "lessThanOrEqual");
+						break;
+					case condition::condition_operator::equal:
+						write_attribute("operator", "equal");
+						break;
+					case condition::condition_operator::not_equal:
+						write_attribute("operator", "notEqual");
+						break;
+					case condition::condition_operator::greater_than_or_equal:
+						write_attribute("operator", "greaterThanOrEqual");
+						break;
+					case condition::condition_operator::greater_than:
+						write_attribute("operator", "greaterThan");
+						break;
+					case condition::condition_operator::between:
+						write_attribute("operator", "between");
+						break;
+					default:
+						write_attribute("operator", "notBetween");
+						break;
+					}
+					break;
+				case condition::type::top_n:
+					write_attribute("type", "top10");
+					break;
+				case condition::type::above_average:
+					write_attribute("type", "aboveAverage");
+					break;
+				case condition::type::duplicate_values:
+					write_attribute("type", "duplicateValues");
+					break;
+				case condition::type::unique_values:
+					write_attribute("type", "uniqueValues");
+					break;
+				}
+
 				write_attribute("dxfId", rule->differential_format_id);
-				write_attribute("priority", i++);
-				write_attribute("text", rule->when.text_comparand_);
-				//TODO: what does this formula mean and why is it necessary?
-				write_element(xmlns, "formula", "NOT(ISERROR(SEARCH(\"" + rule->when.text_comparand_ + "\",A1)))");
+				write_attribute("priority", priorities.at(rule));
+
+				if (when.type_ == condition::type::contains_text)
+				{
+					write_attribute("text", when.text_comparand_);
+				}
+				else if (when.type_ == condition::type::top_n)
+				{
+					if (when.percent_)
+					{
+						write_attribute("percent", write_bool(true));
+					}
+
+					if (when.reversed_)
+					{
+						write_attribute("bottom", write_bool(true));
+					}
+
+					write_attribute("rank", when.rank_);
+				}
+				else if (when.type_ == condition::type::above_average && when.reversed_)
+				{
+					write_attribute("aboveAverage", write_bool(false));
+				}
+
+				if (when.type_ == condition::type::contains_text)
+				{
+					switch (when.operator_)
+					{
+					case condition::condition_operator::starts_with:
+						write_element(xmlns, "formula",
+							"LEFT(" + first_cell + ",LEN(" + quoted_text + "))=" + quoted_text);
+						break;
+					case condition::condition_operator::ends_with:
+						write_element(xmlns, "formula",
+							"RIGHT(" + first_cell + ",LEN(" + quoted_text + "))=" + quoted_text);
+						break;
+					case condition::condition_operator::does_not_contain:
+						write_element(xmlns, "formula", "ISERROR(SEARCH(" + quoted_text + "," + first_cell + "))");
+						break;
+					default:
+						write_element(xmlns, "formula", "NOT(ISERROR(SEARCH(" + quoted_text + "," + first_cell + ")))");
+						break;
+					}
+				}
+				else if (when.type_ == condition::type::cell_is)
+				{
+					write_element(xmlns, "formula", format_number(when.number_comparand_));
+
+					if (when.operator_ == condition::condition_operator::between
+						|| when.operator_ == condition::condition_operator::not_between)
+					{
+						write_element(xmlns, "formula", format_number(when.second_number_comparand_));
+					}
+				}
+
 				write_end_element(xmlns, "cfRule");
 			}
 
@@ -2658,25 +3008,7 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         {
             if (child_rel.target_mode() == target_mode::external) continue;
 
-            // todo: this is ugly
-            path archive_path(worksheet_part.parent().append(child_rel.target().path()));
-            auto split_part_path = archive_path.split();
-            auto part_path_iter = split_part_path.begin();
-
-            while (part_path_iter != split_part_path.end())
-            {
-                if (*part_path_iter == "..")
-                {
-                    part_path_iter = split_part_path.erase(part_path_iter - 1, part_path_iter + 1);
-                    continue;
-                }
-
-                ++part_path_iter;
-            }
-
-            archive_path = std::accumulate(split_part_path.begin(), split_part_path.end(), path(""),
-                [](const path &a, const std::string &b) { return a.append(b); });
-
+            const auto archive_path = resolve_part(worksheet_part, child_rel.target().path());
             begin_part(archive_path);
 
             if (child_rel.type() == relationship_type::comments)
@@ -2950,6 +3282,31 @@ void xlsx_producer::write_custom_property()
 
 void xlsx_producer::write_unknown_parts()
 {
+    if (source_package() == nullptr) return;
+
+    // Copy every part still reachable from the package root that wasn't
+    // written above, which covers parts xlnt doesn't model as well as those
+    // belonging to sheets that were passed through.
+    std::vector<path> pending{path("/")};
+    std::unordered_set<std::string> visited{"/"};
+
+    while (!pending.empty())
+    {
+        const auto part = pending.back();
+        pending.pop_back();
+
+        for (const auto &rel : source_.manifest().relationships(part))
+        {
+            if (rel.target_mode() == target_mode::external) continue;
+            if (rel.type() == relationship_type::calculation_chain) continue;
+
+            const auto target = resolve_part(part, rel.target().path());
+            if (!visited.insert(target.string()).second) continue;
+
+            write_raw_part(target);
+            pending.push_back(target);
+        }
+    }
 }
 
 void xlsx_producer::write_unknown_relationships()
@@ -2960,7 +3317,28 @@ void xlsx_producer::write_image(const path &image_path)
 {
     end_part();
 
-    vector_istreambuf buffer(source_.d_->images_.at(image_path.string()));
+    const auto &image = *source_.d_->images_.at(image_path.string());
+    const auto package = source_package();
+
+    if (package != nullptr && package->has_file(image_path))
+    {
+        const auto &header = package->header(image_path);
+        const auto crc = crc32(0, image.data(), static_cast<mz_ulong>(image.size()));
+
+        if (header.uncompressed_size == image.size() && header.crc == crc && write_raw_part(image_path))
+        {
+            return;
+        }
+    }
+
+    if (use_default_parts_ && default_parts().count(image_path.string()) != 0
+        && default_parts().at(image_path.string()).content == image)
+    {
+        write_default_part(image_path);
+        return;
+    }
+
+    vector_istreambuf buffer(image);
     auto image_streambuf = archive_->open(image_path);
     std::ostream(image_streambuf.get()) << &buffer;
 }
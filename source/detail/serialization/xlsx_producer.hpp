@@ -26,10 +26,14 @@
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <detail/constants.hpp>
 #include <detail/external/include_libstudxml.hpp>
+#include <xlnt/utils/path.hpp>
 
 namespace xml {
 class serializer;
@@ -52,6 +56,7 @@ class worksheet;
 
 namespace detail {
 
+class izstream;
 class ozstream;
 struct cell_impl;
 struct worksheet_impl;
@@ -88,6 +93,37 @@ private:
     void begin_part(const path &part);
     void end_part();
 
+    /// <summary>
+    /// Returns the package the workbook was loaded from if unmodified parts
+    /// may be copied from it, otherwise nullptr.
+    /// </summary>
+    const izstream *source_package() const;
+
+    /// <summary>
+    /// Copies part and its relationships part, if any, from the source package
+    /// without recompressing them. Returns false if part isn't in the source
+    /// package or has already been written.
+    /// </summary>
+    bool write_raw_part(const path &part);
+
+    /// <summary>
+    /// A part of the default workbook, compressed once and reused by every
+    /// save whose part has the same content.
+    /// </summary>
+    struct default_part;
+
+    /// <summary>
+    /// Returns the parts of workbook::empty() other than its sheets keyed by
+    /// path. They are produced and compressed the first time this is called.
+    /// </summary>
+    static const std::unordered_map<std::string, default_part> &default_parts();
+
+    /// <summary>
+    /// Writes the stored compressed default for part. part must be one of
+    /// default_parts().
+    /// </summary>
+    void write_default_part(const path &part);
+
 	// Package Parts
 
 	void write_content_types();
@@ -205,6 +241,24 @@ private:
     detail::cell_impl *current_cell_;
 
     detail::worksheet_impl *current_worksheet_;
+
+    /// <summary>
+    /// Paths of the parts already written to archive_.
+    /// </summary>
+    std::unordered_set<std::string> written_parts_;
+
+    /// <summary>
+    /// When false, parts are always serialized and compressed from scratch.
+    /// </summary>
+    bool use_default_parts_ = true;
+
+    /// <summary>
+    /// The part being written and, if it has a default, its uncompressed
+    /// content so far.
+    /// </summary>
+    path current_part_;
+    bool buffering_part_ = false;
+    std::vector<std::uint8_t> current_part_buffer_;
 };
 
 } // namespace detail
@@ -487,6 +487,33 @@ std::unique_ptr<std::streambuf> ozstream::open(const path &filename)
     return std::unique_ptr<zip_streambuf_compress>(buffer);
 }
 
+void ozstream::write_raw(zheader header, std::istream &compressed)
+{
+    // sizes and CRC are known up front so no data descriptor follows the data
+    header.flags = static_cast<std::uint16_t>(header.flags & ~0x08);
+    header.header_offset = static_cast<std::uint32_t>(destination_stream_.tellp());
+    write_header(header, destination_stream_, false);
+
+    std::vector<char> buffer(1 << 16);
+    auto remaining = static_cast<std::size_t>(header.compressed_size);
+
+    while (remaining > 0)
+    {
+        const auto count = std::min(remaining, buffer.size());
+        compressed.read(buffer.data(), static_cast<std::streamsize>(count));
+
+        if (static_cast<std::size_t>(compressed.gcount()) != count)
+        {
+            throw xlnt::exception("truncated ZIP entry " + header.filename);
+        }
+
+        destination_stream_.write(buffer.data(), static_cast<std::streamsize>(count));
+        remaining -= count;
+    }
+
+    file_headers_.push_back(header);
+}
+
 izstream::izstream(std::istream &stream)
     : source_stream_(stream)
 {
@@ -625,5 +652,44 @@ bool izstream::has_file(const path &filename) const
     return file_headers_.count(filename.string()) != 0;
 }
 
+const zheader &izstream::header(const path &filename) const
+{
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    return file_headers_.at(filename.string());
+}
+
+void izstream::copy_raw(const path &filename, ozstream &destination) const
+{
+    const auto &central_header = header(filename);
+
+    // the local header may carry a different extra field than the central one
+    source_stream_.seekg(central_header.header_offset);
+    read_header(source_stream_, false);
+
+    destination.write_raw(central_header, source_stream_);
+}
+
+std::vector<std::uint8_t> izstream::read_raw(const path &filename) const
+{
+    const auto &central_header = header(filename);
+
+    source_stream_.seekg(central_header.header_offset);
+    read_header(source_stream_, false);
+
+    std::vector<std::uint8_t> data(central_header.compressed_size);
+    source_stream_.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    if (static_cast<std::size_t>(source_stream_.gcount()) != data.size())
+    {
+        throw xlnt::exception("truncated ZIP entry " + filename.string());
+    }
+
+    return data;
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -90,6 +90,12 @@ public:
     /// </summary>
     std::unique_ptr<std::streambuf> open(const path &file);
 
+    /// <summary>
+    /// Writes a file whose data is already compressed as described by header,
+    /// copying header.compressed_size bytes from compressed without recompressing them.
+    /// </summary>
+    void write_raw(zheader header, std::istream &compressed);
+
 private:
     std::vector<zheader> file_headers_;
     std::ostream &destination_stream_;
@@ -132,6 +138,23 @@ public:
     /// </summary>
     bool has_file(const path &filename) const;
 
+    /// <summary>
+    /// Returns the central directory header of the given file, including its CRC and sizes.
+    /// </summary>
+    const zheader &header(const path &filename) const;
+
+    /// <summary>
+    /// Copies the given file into destination as it is stored in this archive,
+    /// without decompressing and recompressing it.
+    /// </summary>
+    void copy_raw(const path &filename, ozstream &destination) const;
+
+    /// <summary>
+    /// Returns the data of the given file as it is stored in this archive, without
+    /// decompressing it.
+    /// </summary>
+    std::vector<std::uint8_t> read_raw(const path &filename) const;
+
 private:
     /// <summary>
     ///
@@ -0,0 +1,541 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cctype>
+
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/formula/formula_translator.hpp>
+
+namespace {
+
+// the largest column (XFD) and row of a sheet in a file, beyond which tokens
+// that look like references are names
+const long long max_column = 16384;
+const long long max_row = 1048576;
+
+bool is_name_character(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return std::isalnum(u) || c == '_' || c == '.' || c == '$' || c == '\\' || u >= 0x80;
+}
+
+/// <summary>
+/// Reads an optionally absolute column such as "$AB" from token starting at
+/// position. Returns false if there is no valid column there.
+/// </summary>
+bool read_column(const std::string &token, std::size_t &position, bool &absolute, long long &column)
+{
+    absolute = position < token.size() && token[position] == '$';
+    auto end = position + (absolute ? 1 : 0);
+    const auto start = end;
+    column = 0;
+
+    while (end < token.size() && std::isalpha(static_cast<unsigned char>(token[end])) && end - start < 3)
+    {
+        column = column * 26 + (std::toupper(static_cast<unsigned char>(token[end])) - 'A' + 1);
+        ++end;
+    }
+
+    if (end == start || column > max_column) return false;
+
+    position = end;
+    return true;
+}
+
+/// <summary>
+/// Reads an optionally absolute row such as "$12" from token starting at
+/// position. Returns false if there is no valid row there.
+/// </summary>
+bool read_row(const std::string &token, std::size_t &position, bool &absolute, long long &row)
+{
+    absolute = position < token.size() && token[position] == '$';
+    auto end = position + (absolute ? 1 : 0);
+    const auto start = end;
+    row = 0;
+
+    while (end < token.size() && std::isdigit(static_cast<unsigned char>(token[end])) && end - start < 8)
+    {
+        row = row * 10 + (token[end] - '0');
+        ++end;
+    }
+
+    if (end == start || row < 1 || row > max_row) return false;
+
+    position = end;
+    return true;
+}
+
+/// <summary>
+/// Appends the column moved by offset unless it's absolute. Returns false if
+/// the column would be outside the sheet.
+/// </summary>
+bool append_column(std::string &result, bool absolute, long long column, long long offset)
+{
+    if (!absolute) column += offset;
+    if (column < 1 || column > max_column) return false;
+
+    if (absolute) result.push_back('$');
+    result.append(xlnt::column_t::column_string_from_index(static_cast<xlnt::column_t::index_t>(column)));
+
+    return true;
+}
+
+/// <summary>
+/// Appends the row moved by offset unless it's absolute. Returns false if
+/// the row would be outside the sheet.
+/// </summary>
+bool append_row(std::string &result, bool absolute, long long row, long long offset)
+{
+    if (!absolute) row += offset;
+    if (row < 1 || row > max_row) return false;
+
+    if (absolute) result.push_back('$');
+    result.append(std::to_string(row));
+
+    return true;
+}
+
+/// <summary>
+/// Appends token moved by the given offsets if it's a cell reference such as
+/// "B$2" and returns true, or returns false if it isn't one.
+/// </summary>
+bool append_cell(std::string &result, const std::string &token, long long column_offset, long long row_offset)
+{
+    auto position = std::size_t(0);
+    auto column_absolute = false;
+    auto row_absolute = false;
+    auto column = 0LL;
+    auto row = 0LL;
+
+    if (!read_column(token, position, column_absolute, column)
+        || !read_row(token, position, row_absolute, row)
+        || position != token.size())
+    {
+        return false;
+    }
+
+    const auto size = result.size();
+
+    if (!append_column(result, column_absolute, column, column_offset)
+        || !append_row(result, row_absolute, row, row_offset))
+    {
+        result.resize(size);
+        result.append("#REF!");
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Appends first:second moved by the given offsets if it's a range of whole
+/// columns such as "A:$C" or whole rows such as "2:5" and returns true, or
+/// returns false if it isn't one.
+/// </summary>
+bool append_lines(std::string &result, const std::string &first, const std::string &second,
+    long long column_offset, long long row_offset)
+{
+    using reader = bool (*)(const std::string &, std::size_t &, bool &, long long &);
+    using writer = bool (*)(std::string &, bool, long long, long long);
+
+    const auto read_whole = [](reader read, const std::string &token, bool &absolute, long long &index) {
+        auto position = std::size_t(0);
+        return read(token, position, absolute, index) && position == token.size();
+    };
+
+    bool absolute[2];
+    long long index[2];
+    auto append = writer(nullptr);
+    auto offset = 0LL;
+
+    if (read_whole(read_column, first, absolute[0], index[0]) && read_whole(read_column, second, absolute[1], index[1]))
+    {
+        append = append_column;
+        offset = column_offset;
+    }
+    else if (read_whole(read_row, first, absolute[0], index[0]) && read_whole(read_row, second, absolute[1], index[1]))
+    {
+        append = append_row;
+        offset = row_offset;
+    }
+    else
+    {
+        return false;
+    }
+
+    const auto size = result.size();
+    auto valid = append(result, absolute[0], index[0], offset);
+    result.push_back(':');
+    valid = append(result, absolute[1], index[1], offset) && valid;
+
+    if (!valid)
+    {
+        result.resize(size);
+        result.append("#REF!");
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Rows or columns inserted or deleted at a position of a sheet.
+/// </summary>
+struct line_shift
+{
+    bool rows;
+    long long first;
+
+    // the number of lines inserted, or minus the number deleted
+    long long count;
+
+    /// <summary>
+    /// Moves index to where it ends up. Returns false if it was deleted or
+    /// moved outside the sheet.
+    /// </summary>
+    bool apply(long long &index) const
+    {
+        if (index < first) return true;
+
+        if (count < 0 && index < first - count) return false;
+
+        index += count;
+        return index <= (rows ? max_row : max_column);
+    }
+
+    /// <summary>
+    /// Moves the span from low to high, which is cut where lines are deleted
+    /// from it and grows where lines are inserted into it. Returns false if
+    /// nothing is left of it.
+    /// </summary>
+    bool apply(long long &low, long long &high) const
+    {
+        if (count < 0)
+        {
+            const auto last = first - count - 1;
+
+            low = low < first ? low : low > last ? low + count : first;
+            high = high < first ? high : high > last ? high + count : first - 1;
+
+            return low <= high;
+        }
+
+        if (low >= first) low += count;
+        if (high >= first) high += count;
+
+        return high <= (rows ? max_row : max_column);
+    }
+};
+
+/// <summary>
+/// Appends first:second, or first alone if second is null, with shift applied
+/// and returns true if it's a reference, or returns false if it isn't one.
+/// </summary>
+bool append_shifted(std::string &result, const std::string &first, const std::string *second, const line_shift &shift)
+{
+    bool absolute[4];
+    long long index[4];
+    auto position = std::size_t(0);
+
+    if (!read_column(first, position, absolute[0], index[0])
+        || !read_row(first, position, absolute[1], index[1])
+        || position != first.size())
+    {
+        if (second == nullptr) return false;
+
+        // whole rows or columns
+        auto reader = shift.rows ? read_row : read_column;
+        auto other = shift.rows ? read_column : read_row;
+        auto second_position = std::size_t(0);
+        position = 0;
+
+        if (reader(first, position, absolute[0], index[0]) && position == first.size()
+            && reader(*second, second_position, absolute[1], index[1]) && second_position == second->size())
+        {
+            auto low = std::min(index[0], index[1]);
+            auto high = std::max(index[0], index[1]);
+            const auto size = result.size();
+            const auto append = shift.rows ? append_row : append_column;
+
+            if (!shift.apply(low, high)
+                || !append(result, absolute[0], index[0] <= index[1] ? low : high, 0))
+            {
+                result.resize(size);
+                result.append("#REF!");
+                return true;
+            }
+
+            result.push_back(':');
+            append(result, absolute[1], index[0] <= index[1] ? high : low, 0);
+
+            return true;
+        }
+
+        position = 0;
+        second_position = 0;
+
+        if (other(first, position, absolute[0], index[0]) && position == first.size()
+            && other(*second, second_position, absolute[1], index[1]) && second_position == second->size())
+        {
+            result.append(first + ":" + *second);
+            return true;
+        }
+
+        return false;
+    }
+
+    if (second != nullptr)
+    {
+        position = 0;
+
+        if (!read_column(*second, position, absolute[2], index[2])
+            || !read_row(*second, position, absolute[3], index[3])
+            || position != second->size())
+        {
+            return false;
+        }
+    }
+
+    const auto size = result.size();
+    const auto moved = shift.rows ? 1 : 0;
+    auto valid = true;
+
+    if (second == nullptr)
+    {
+        valid = shift.apply(index[moved]);
+    }
+    else
+    {
+        auto low = std::min(index[moved], index[moved + 2]);
+        auto high = std::max(index[moved], index[moved + 2]);
+        const auto forward = index[moved] <= index[moved + 2];
+
+        valid = shift.apply(low, high);
+        index[moved] = forward ? low : high;
+        index[moved + 2] = forward ? high : low;
+    }
+
+    valid = valid && append_column(result, absolute[0], index[0], 0) && append_row(result, absolute[1], index[1], 0);
+
+    if (valid && second != nullptr)
+    {
+        result.push_back(':');
+        valid = append_column(result, absolute[2], index[2], 0) && append_row(result, absolute[3], index[3], 0);
+    }
+
+    if (!valid)
+    {
+        result.resize(size);
+        result.append("#REF!");
+    }
+
+    return true;
+}
+
+bool same_title(const std::string &a, const std::string &b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+    });
+}
+
+/// <summary>
+/// Copies formula, passing each name that could be a reference to reference
+/// along with the sheet it's qualified with, if any, and then copying it as is
+/// if reference returns false. Names joined by a colon are passed together
+/// first. References to other workbooks and to several sheets are qualified
+/// with a sheet name starting with '[', which no worksheet title can.
+/// </summary>
+template <typename Reference>
+std::string rewrite(const std::string &formula, Reference reference)
+{
+    const auto size = formula.size();
+
+    const auto token_end = [&formula, size](std::size_t start) {
+        while (start < size && is_name_character(formula[start]))
+        {
+            ++start;
+        }
+
+        return start;
+    };
+
+    std::string result;
+    result.reserve(size);
+
+    // the sheet qualifying the next name, if any
+    std::string sheet;
+    auto qualified = false;
+    auto external = false;
+
+    const auto qualify = [&](std::size_t end, std::string name) {
+        if (end >= size || formula[end] != '!') return false;
+
+        const auto three_d = !result.empty() && result.back() == ':';
+        sheet = external || three_d ? "[" + name : name;
+        qualified = true;
+        external = false;
+
+        return true;
+    };
+
+    auto i = std::size_t(0);
+
+    while (i < size)
+    {
+        const auto c = formula[i];
+
+        if (c == '"' || c == '\'')
+        {
+            // a string literal or a quoted sheet name, with doubled quotes inside
+            auto end = i + 1;
+            std::string text;
+
+            while (end < size && (formula[end] != c || (end + 1 < size && formula[end + 1] == c)))
+            {
+                text.push_back(formula[end]);
+                end += formula[end] == c ? 2 : 1;
+            }
+
+            end = std::min(end + 1, size);
+
+            if (!(c == '\'' && qualify(end, text)))
+            {
+                qualified = false;
+            }
+
+            result.append(formula, i, end - i);
+            i = end;
+        }
+        else if (c == '[')
+        {
+            // an external workbook index or a structured reference, which may nest
+            auto end = i;
+            auto depth = 0;
+
+            do
+            {
+                depth += formula[end] == '[' ? 1 : formula[end] == ']' ? -1 : 0;
+                ++end;
+            } while (end < size && depth > 0);
+
+            result.append(formula, i, end - i);
+            external = true;
+            i = end;
+        }
+        else if (is_name_character(c))
+        {
+            const auto end = token_end(i);
+            const auto token = formula.substr(i, end - i);
+            const auto next = end < size ? formula[end] : '\0';
+            const auto *qualifier = qualified ? &sheet : nullptr;
+
+            qualified = false;
+
+            if (next == ':' && end + 1 < size && is_name_character(formula[end + 1]))
+            {
+                const auto second_end = token_end(end + 1);
+                const auto second = formula.substr(end + 1, second_end - end - 1);
+
+                if (reference(result, qualifier, token, &second))
+                {
+                    i = second_end;
+                    continue;
+                }
+            }
+
+            // names followed by ( are functions and by ! are sheets
+            if (next == '(' || qualify(end, token) || !reference(result, qualifier, token, nullptr))
+            {
+                result.append(token);
+            }
+
+            external = false;
+            i = end;
+        }
+        else
+        {
+            if (c != '!') qualified = false;
+
+            result.push_back(c);
+            ++i;
+        }
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Returns formula with shift applied to its references to sheet, which
+/// unqualified references are to if local is true.
+/// </summary>
+std::string shift_references(const std::string &formula, const std::string &sheet, bool local, const line_shift &shift)
+{
+    return rewrite(formula, [&sheet, local, &shift](std::string &result, const std::string *qualifier,
+                                const std::string &first, const std::string *second) {
+        if (qualifier == nullptr ? local : same_title(*qualifier, sheet))
+        {
+            return append_shifted(result, first, second, shift);
+        }
+
+        // references to other sheets are kept as they are written
+        std::string ignored;
+        if (!append_shifted(ignored, first, second, shift)) return false;
+
+        result.append(second == nullptr ? first : first + ":" + *second);
+        return true;
+    });
+}
+
+} // namespace
+
+namespace xlnt {
+
+formula_translator::formula_translator(const std::string &formula, const cell_reference &origin)
+    : formula_(formula), origin_(origin)
+{
+}
+
+std::string formula_translator::translate(const cell_reference &destination) const
+{
+    const auto column_offset = static_cast<long long>(destination.column_index())
+        - static_cast<long long>(origin_.column_index());
+    const auto row_offset = static_cast<long long>(destination.row()) - static_cast<long long>(origin_.row());
+
+    return rewrite(formula_, [column_offset, row_offset](std::string &result, const std::string *,
+                                 const std::string &first, const std::string *second) {
+        return second != nullptr ? append_lines(result, first, *second, column_offset, row_offset)
+                                 : append_cell(result, first, column_offset, row_offset);
+    });
+}
+
+std::string formula_translator::shift_rows(const std::string &sheet, bool local, row_t first, long long count) const
+{
+    return shift_references(formula_, sheet, local, line_shift{ true, static_cast<long long>(first), count });
+}
+
+std::string formula_translator::shift_columns(const std::string &sheet, bool local, column_t first, long long count) const
+{
+    return shift_references(formula_, sheet, local, line_shift{ false, static_cast<long long>(first.index), count });
+}
+
+} // namespace xlnt
@@ -28,6 +28,7 @@
 #include <xlnt/styles/fill.hpp>
 #include <xlnt/styles/font.hpp>
 #include <xlnt/styles/conditional_format.hpp>
+#include <xlnt/utils/exceptions.hpp>
 
 namespace xlnt {
 
@@ -67,6 +68,129 @@ condition condition::text_does_not_contain(const std::string &text)
 	return c;
 }
 
+condition condition::less_than(double value)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::less_than;
+	c.number_comparand_ = value;
+	return c;
+}
+
+condition condition::less_than_or_equal(double value)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::less_than_or_equal;
+	c.number_comparand_ = value;
+	return c;
+}
+
+condition condition::equal(double value)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::equal;
+	c.number_comparand_ = value;
+	return c;
+}
+
+condition condition::not_equal(double value)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::not_equal;
+	c.number_comparand_ = value;
+	return c;
+}
+
+condition condition::greater_than_or_equal(double value)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::greater_than_or_equal;
+	c.number_comparand_ = value;
+	return c;
+}
+
+condition condition::greater_than(double value)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::greater_than;
+	c.number_comparand_ = value;
+	return c;
+}
+
+condition condition::between(double low, double high)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::between;
+	c.number_comparand_ = low;
+	c.second_number_comparand_ = high;
+	return c;
+}
+
+condition condition::not_between(double low, double high)
+{
+	condition c;
+	c.type_ = type::cell_is;
+	c.operator_ = condition_operator::not_between;
+	c.number_comparand_ = low;
+	c.second_number_comparand_ = high;
+	return c;
+}
+
+condition condition::top(std::size_t rank, bool percent)
+{
+	if (rank == 0 || (percent && rank > 100))
+	{
+		throw invalid_parameter();
+	}
+
+	condition c;
+	c.type_ = type::top_n;
+	c.rank_ = rank;
+	c.percent_ = percent;
+	return c;
+}
+
+condition condition::bottom(std::size_t rank, bool percent)
+{
+	auto c = top(rank, percent);
+	c.reversed_ = true;
+	return c;
+}
+
+condition condition::above_average()
+{
+	condition c;
+	c.type_ = type::above_average;
+	return c;
+}
+
+condition condition::below_average()
+{
+	auto c = above_average();
+	c.reversed_ = true;
+	return c;
+}
+
+condition condition::duplicate_values()
+{
+	condition c;
+	c.type_ = type::duplicate_values;
+	return c;
+}
+
+condition condition::unique_values()
+{
+	condition c;
+	c.type_ = type::unique_values;
+	return c;
+}
+
 conditional_format::conditional_format(detail::conditional_format_impl *d) : d_(d)
 {
 }
@@ -81,6 +205,11 @@ bool conditional_format::operator!=(const conditional_format &other) const
 	return !(*this == other);
 }
 
+bool conditional_format::has_border() const
+{
+    return d_->border_id.is_set();
+}
+
 xlnt::border conditional_format::border() const
 {
     return d_->parent->borders.at(d_->border_id.get());
@@ -92,6 +221,11 @@ conditional_format conditional_format::border(const xlnt::border &new_border)
 	return *this;
 }
 
+bool conditional_format::has_fill() const
+{
+    return d_->fill_id.is_set();
+}
+
 xlnt::fill conditional_format::fill() const
 {
     return d_->parent->fills.at(d_->fill_id.get());
@@ -103,6 +237,11 @@ conditional_format conditional_format::fill(const xlnt::fill &new_fill)
 	return *this;
 }
 
+bool conditional_format::has_font() const
+{
+    return d_->font_id.is_set();
+}
+
 xlnt::font conditional_format::font() const
 {
     return d_->parent->fonts.at(d_->font_id.get());
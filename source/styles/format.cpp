@@ -37,6 +37,7 @@ format::format(detail::format_impl *d)
 void format::clear_style()
 {
     d_->style.clear();
+    ++d_->parent->generation;
 }
 
 format format::style(const xlnt::style &new_style)
@@ -48,6 +49,8 @@ format format::style(const xlnt::style &new_style)
 format format::style(const std::string &new_style)
 {
     d_->style = new_style;
+    ++d_->parent->generation;
+
     return format(d_);
 }
 
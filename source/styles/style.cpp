@@ -101,6 +101,7 @@ style style::alignment(const xlnt::alignment &new_alignment, bool applied)
 {
     d_->alignment_id = d_->parent->find_or_add(d_->parent->alignments, new_alignment);
     d_->alignment_applied = applied;
+    ++d_->parent->generation;
 
 	return *this;
 }
@@ -119,6 +120,7 @@ style style::border(const xlnt::border &new_border, bool applied)
 {
     d_->border_id = d_->parent->find_or_add(d_->parent->borders, new_border);
     d_->border_applied = applied;
+    ++d_->parent->generation;
 
 	return *this;
 }
@@ -137,6 +139,7 @@ style style::fill(const xlnt::fill &new_fill, bool applied)
 {
     d_->fill_id = d_->parent->find_or_add(d_->parent->fills, new_fill);
     d_->fill_applied = applied;
+    ++d_->parent->generation;
 
 	return *this;
 }
@@ -155,6 +158,7 @@ style style::font(const xlnt::font &new_font, bool applied)
 {
     d_->font_id = d_->parent->find_or_add(d_->parent->fonts, new_font);
     d_->font_applied = applied;
+    ++d_->parent->generation;
 
 	return *this;
 }
@@ -194,6 +198,7 @@ style style::number_format(const xlnt::number_format &new_number_format, bool ap
 
     d_->number_format_id = copy.id();
     d_->number_format_applied = applied;
+    ++d_->parent->generation;
 
 	return *this;
 }
@@ -212,6 +217,7 @@ style style::protection(const xlnt::protection &new_protection, bool applied)
 {
     d_->protection_id = d_->parent->find_or_add(d_->parent->protections, new_protection);
     d_->protection_applied = applied;
+    ++d_->parent->generation;
 
     return *this;
 }
@@ -0,0 +1,233 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/format_impl.hpp>
+#include <detail/implementations/frozen_workbook_impl.hpp>
+#include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <xlnt/formula/formula_translator.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/frozen_workbook.hpp>
+#include <xlnt/workbook/workbook.hpp>
+
+namespace {
+
+/// <summary>
+/// Returns true if format has a date or time number format. Results are kept
+/// in dates since parsing the number format for every cell would be slow.
+/// </summary>
+bool is_date_format(const xlnt::detail::format_impl *format,
+    std::unordered_map<const xlnt::detail::format_impl *, bool> &dates)
+{
+    auto match = dates.find(format);
+    if (match != dates.end()) return match->second;
+
+    auto result = false;
+
+    if (format->number_format_id.is_set())
+    {
+        const auto id = format->number_format_id.get();
+
+        if (xlnt::number_format::is_builtin_format(id))
+        {
+            result = xlnt::number_format::from_builtin_id(id).is_date_format();
+        }
+        else
+        {
+            const auto &formats = format->parent->number_formats;
+            const auto number_format = std::find_if(formats.begin(), formats.end(),
+                [id](const xlnt::number_format &candidate) { return candidate.id() == id; });
+
+            result = number_format != formats.end() && number_format->is_date_format();
+        }
+    }
+
+    dates.emplace(format, result);
+
+    return result;
+}
+
+void freeze_sheet(xlnt::detail::worksheet_impl &source, xlnt::detail::frozen_worksheet_impl &sheet,
+    std::vector<std::string> &strings)
+{
+    using xlnt::detail::frozen_worksheet_impl;
+
+    sheet.title_ = source.title_;
+
+    std::vector<std::pair<std::uint64_t, const xlnt::detail::cell_impl *>> cells;
+    std::unordered_map<const xlnt::detail::format_impl *, bool> dates;
+
+    auto rows = source.row_indices();
+    std::sort(rows.begin(), rows.end());
+
+    // rows moved to disk are read back one at a time, so this may evict others
+    for (auto row : rows)
+    {
+        auto entry = source.find_row(row);
+        if (entry == nullptr) continue;
+
+        cells.clear();
+
+        for (const auto &cell : **entry)
+        {
+            cells.emplace_back(frozen_worksheet_impl::key(cell.first.index, row), &cell.second);
+        }
+
+        std::sort(cells.begin(), cells.end());
+
+        for (const auto &cell : cells)
+        {
+            const auto &impl = *cell.second;
+            const auto is_date = impl.type_ == xlnt::cell_type::number && impl.format_.is_set()
+                && is_date_format(impl.format_.get(), dates);
+            auto value = xlnt::detail::frozen_cell{impl.value_numeric_, impl.type_, is_date};
+
+            switch (impl.type_)
+            {
+            case xlnt::cell_type::inline_string:
+            case xlnt::cell_type::formula_string:
+            case xlnt::cell_type::error:
+                value.value_numeric_ = static_cast<long double>(strings.size());
+                strings.push_back(impl.value_text_.plain_text());
+                break;
+            default:
+                break;
+            }
+
+            sheet.keys_.push_back(cell.first);
+            sheet.cells_.push_back(value);
+
+            if (impl.formula_.is_set())
+            {
+                sheet.formulae_.emplace_back(cell.first, impl.formula_.get());
+            }
+            else if (impl.shared_formula_.is_set())
+            {
+                const auto &shared = source.shared_formulae_.at(impl.shared_formula_.get());
+                const auto reference = xlnt::cell_reference(impl.column_, impl.row_);
+
+                sheet.formulae_.emplace_back(cell.first, reference == shared.anchor_
+                    ? shared.formula_
+                    : xlnt::formula_translator(shared.formula_, shared.anchor_).translate(reference));
+            }
+        }
+    }
+
+    sheet.keys_.shrink_to_fit();
+    sheet.cells_.shrink_to_fit();
+    sheet.formulae_.shrink_to_fit();
+}
+
+} // namespace
+
+namespace xlnt {
+
+frozen_workbook::frozen_workbook(const workbook &source)
+{
+    auto d = std::make_shared<detail::frozen_workbook_impl>();
+
+    // reading a deferred sheet may add to the shared strings, so load them all first.
+    // The sheet accessors aren't used since they stop unmodified sheets being passed through on save.
+    for (auto &impl : source.d_->worksheets_)
+    {
+        source.load_deferred_sheet(impl);
+    }
+
+    d->base_date_ = source.base_date();
+
+    const auto &shared_strings = source.shared_strings();
+    d->strings_.reserve(shared_strings.size());
+
+    for (const auto &text : shared_strings)
+    {
+        d->strings_.push_back(text.plain_text());
+    }
+
+    d->sheets_.reserve(source.sheet_count());
+
+    for (auto &impl : source.d_->worksheets_)
+    {
+        d->sheet_indices_[impl.title_] = d->sheets_.size();
+        d->sheets_.emplace_back();
+        freeze_sheet(impl, d->sheets_.back(), d->strings_);
+    }
+
+    d->strings_.shrink_to_fit();
+    d_ = d;
+}
+
+std::size_t frozen_workbook::sheet_count() const
+{
+    return d_->sheets_.size();
+}
+
+std::vector<std::string> frozen_workbook::sheet_titles() const
+{
+    auto titles = std::vector<std::string>();
+
+    for (const auto &sheet : d_->sheets_)
+    {
+        titles.push_back(sheet.title_);
+    }
+
+    return titles;
+}
+
+bool frozen_workbook::contains(const std::string &title) const
+{
+    return d_->sheet_indices_.find(title) != d_->sheet_indices_.end();
+}
+
+frozen_worksheet frozen_workbook::sheet_by_index(std::size_t index) const
+{
+    if (index >= d_->sheets_.size())
+    {
+        throw invalid_parameter();
+    }
+
+    return frozen_worksheet(d_.get(), &d_->sheets_[index]);
+}
+
+frozen_worksheet frozen_workbook::sheet_by_title(const std::string &title) const
+{
+    auto match = d_->sheet_indices_.find(title);
+
+    if (match == d_->sheet_indices_.end())
+    {
+        throw key_not_found();
+    }
+
+    return frozen_worksheet(d_.get(), &d_->sheets_[match->second]);
+}
+
+calendar frozen_workbook::base_date() const
+{
+    return d_->base_date_;
+}
+
+} // namespace xlnt
@@ -21,6 +21,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
 #include <fstream>
 
 #include <detail/implementations/workbook_impl.hpp>
@@ -30,6 +31,7 @@
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
@@ -148,9 +150,28 @@ void streaming_workbook_reader::open(const xlnt::path &filename)
 }
 
 void streaming_workbook_reader::open(std::istream &stream)
+{
+    open(stream, load_options());
+}
+
+void streaming_workbook_reader::open(const std::vector<std::uint8_t> &data, const load_options &options)
+{
+    stream_buffer_.reset(new detail::vector_istreambuf(data));
+    stream_.reset(new std::istream(stream_buffer_.get()));
+    open(*stream_, options);
+}
+
+void streaming_workbook_reader::open(const xlnt::path &filename, const load_options &options)
+{
+    stream_.reset(new std::ifstream());
+    xlnt::detail::open_stream(static_cast<std::ifstream &>(*stream_), filename.string());
+    open(*stream_, options);
+}
+
+void streaming_workbook_reader::open(std::istream &stream, const load_options &options)
 {
     workbook_.reset(new workbook());
-    consumer_.reset(new detail::xlsx_consumer(*workbook_));
+    consumer_.reset(new detail::xlsx_consumer(*workbook_, options));
     consumer_->open(stream);
 
     const auto workbook_rel = workbook_->manifest()
@@ -167,7 +188,17 @@ void streaming_workbook_reader::open(std::unique_ptr<std::streambuf> &&buffer)
 
 std::vector<std::string> streaming_workbook_reader::sheet_titles()
 {
-    return workbook_->sheet_titles();
+    const auto &selected = consumer_->options_.sheets;
+    auto titles = workbook_->sheet_titles();
+
+    if (!selected.empty())
+    {
+        titles.erase(std::remove_if(titles.begin(), titles.end(), [&selected](const std::string &title) {
+            return std::find(selected.begin(), selected.end(), title) == selected.end();
+        }), titles.end());
+    }
+
+    return titles;
 }
 
 } // namespace xlnt
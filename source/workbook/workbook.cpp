@@ -26,10 +26,12 @@
 #include <array>
 #include <fstream>
 #include <functional>
+#include <memory>
 #include <set>
 
 #include <detail/constants.hpp>
 #include <detail/default_case.hpp>
+#include <detail/formula/formula_evaluator.hpp>
 #include <detail/implementations/cell_impl.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
@@ -52,6 +54,8 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/variant.hpp>
+#include <xlnt/workbook/frozen_workbook.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/theme.hpp>
@@ -66,6 +70,36 @@ namespace {
 
 using xlnt::detail::open_stream;
 
+/// <summary>
+/// An input stream over bytes it owns. Used to keep the package of a workbook
+/// loaded with lazy_sheets readable after the caller's source is gone.
+/// </summary>
+class owning_istream : public std::istream
+{
+public:
+    explicit owning_istream(std::vector<std::uint8_t> &&data)
+        : std::istream(nullptr),
+          data_(std::move(data)),
+          buffer_(data_)
+    {
+        rdbuf(&buffer_);
+    }
+
+private:
+    std::vector<std::uint8_t> data_;
+    xlnt::detail::vector_istreambuf buffer_;
+};
+
+/// <summary>
+/// Returns true if any sheet of the workbook still holds strings collected
+/// since workbook::begin_concurrent_population.
+/// </summary>
+bool is_populating(const xlnt::detail::workbook_impl &impl)
+{
+    return std::any_of(impl.worksheets_.begin(), impl.worksheets_.end(),
+        [](const xlnt::detail::worksheet_impl &sheet) { return sheet.local_strings_ != nullptr; });
+}
+
 template<typename T>
 std::vector<T> keys(const std::vector<std::pair<T, xlnt::variant>> &container)
 {
@@ -253,6 +287,48 @@ std::string content_type(xlnt::relationship_type type)
     default_case("application/xml");
 }
 
+/// <summary>
+/// Returns the workbook that default-constructed workbooks are copied from.
+/// It is built on first use because workbook::empty() does a lot of work.
+/// </summary>
+const xlnt::workbook &prototype()
+{
+    static const xlnt::workbook instance = xlnt::workbook::empty();
+    return instance;
+}
+
+/// <summary>
+/// Points the sheets and style records of impl, which was just copied from
+/// another workbook, at wb and at impl's own stylesheet.
+/// </summary>
+void adopt(xlnt::detail::workbook_impl &impl, xlnt::workbook &wb)
+{
+    for (auto &ws : impl.worksheets_)
+    {
+        ws.parent_ = &wb;
+    }
+
+    if (impl.stylesheet_ == nullptr) return;
+
+    auto &stylesheet = *impl.stylesheet_;
+    stylesheet.parent = &wb;
+
+    for (auto &format : stylesheet.format_impls)
+    {
+        format.parent = &stylesheet;
+    }
+
+    for (auto &style : stylesheet.style_impls)
+    {
+        style.second.parent = &stylesheet;
+    }
+
+    for (auto &rule : stylesheet.conditional_format_impls)
+    {
+        rule.parent = &stylesheet;
+    }
+}
+
 } // namespace
 
 namespace xlnt {
@@ -431,8 +507,8 @@ workbook workbook::empty()
 
     wb.theme(xlnt::theme());
 
-    wb.d_->stylesheet_ = detail::stylesheet();
-    auto &stylesheet = wb.d_->stylesheet_.get();
+    wb.d_->stylesheet_ = std::make_shared<detail::stylesheet>();
+    auto &stylesheet = *wb.d_->stylesheet_;
     stylesheet.parent = &wb;
 
     auto default_border = border()
@@ -441,7 +517,7 @@ workbook workbook::empty()
         .side(border_side::start, border::border_property())
         .side(border_side::end, border::border_property())
         .side(border_side::diagonal, border::border_property());
-    wb.d_->stylesheet_.get().borders.push_back(default_border);
+    wb.d_->stylesheet_->borders.push_back(default_border);
 
     auto default_fill = fill(pattern_fill()
         .type(pattern_fill_type::none));
@@ -476,9 +552,107 @@ workbook workbook::empty()
 }
 
 workbook::workbook()
+    : d_(new detail::workbook_impl(*prototype().d_))
+{
+    d_->stylesheet_ = std::make_shared<detail::stylesheet>(*d_->stylesheet_);
+    adopt(*d_, *this);
+}
+
+void workbook::reset()
 {
-    auto wb_template = empty();
-    swap(wb_template);
+    const auto &source = *prototype().d_;
+    auto strings = d_->shared_strings_;
+
+    *d_ = source;
+    d_->stylesheet_ = std::make_shared<detail::stylesheet>(*source.stylesheet_);
+
+    // keep the string table's storage if nothing else refers to it
+    if (strings.use_count() == 1)
+    {
+        strings->clear();
+        d_->shared_strings_ = strings;
+    }
+
+    adopt(*d_, *this);
+}
+
+frozen_workbook workbook::freeze() const
+{
+    if (is_populating(*d_))
+    {
+        const_cast<workbook &>(*this).end_concurrent_population();
+    }
+
+    return frozen_workbook(*this);
+}
+
+void workbook::begin_concurrent_population()
+{
+    if (d_->population_mutex_) return;
+
+    // deferred sheets are read from the package shared by all sheets
+    for (std::size_t index = 0; index < sheet_count(); ++index)
+    {
+        sheet_by_index(index);
+    }
+
+    // a stylesheet shared with copies can't be detached while cells are changed concurrently
+    if (d_->stylesheet_ != nullptr)
+    {
+        modifiable_stylesheet();
+    }
+
+    d_->population_mutex_.reset(new std::recursive_mutex());
+
+    for (auto &sheet : d_->worksheets_)
+    {
+        if (!sheet.local_strings_)
+        {
+            sheet.local_strings_.reset(new detail::string_table(d_->shared_strings_->size()));
+        }
+
+        sheet.population_mutex_ = d_->population_mutex_.get();
+
+        // memory pools aren't thread-safe
+        if (sheet.memory_pool_)
+        {
+            sheet.memory_pool_ = std::make_shared<detail::memory_pool>();
+        }
+    }
+}
+
+void workbook::end_concurrent_population()
+{
+    for (auto &sheet : d_->worksheets_)
+    {
+        sheet.population_mutex_ = nullptr;
+
+        if (!sheet.local_strings_) continue;
+
+        const auto local_strings = std::move(sheet.local_strings_);
+        auto indices = std::vector<std::size_t>();
+        indices.reserve(local_strings->strings_.size());
+
+        for (const auto &text : local_strings->strings_)
+        {
+            indices.push_back(add_shared_string(text));
+        }
+
+        for (auto row : sheet.row_indices())
+        {
+            for (auto &cell : sheet.mutable_row(row))
+            {
+                if (cell.second.type_ != cell_type::shared_string) continue;
+
+                const auto index = static_cast<std::size_t>(cell.second.value_numeric_);
+                if (!local_strings->contains(index)) continue;
+
+                cell.second.value_numeric_ = static_cast<long double>(indices.at(index - local_strings->first_index_));
+            }
+        }
+    }
+
+    d_->population_mutex_.reset();
 }
 
 workbook::workbook(detail::workbook_impl *impl)
@@ -486,9 +660,9 @@ workbook::workbook(detail::workbook_impl *impl)
 {
     if (impl != nullptr)
     {
-        if (d_->stylesheet_.is_set())
+        if (d_->stylesheet_ != nullptr)
         {
-            d_->stylesheet_.get().parent = this;
+            d_->stylesheet_->parent = this;
         }
     }
 }
@@ -599,6 +773,10 @@ const worksheet workbook::sheet_by_title(const std::string &title) const
     {
         if (impl.title_ == title)
         {
+            load_deferred_sheet(impl);
+            // worksheet handles can change the sheet even when obtained through const
+            impl.source_part_.clear();
+
             return worksheet(&impl);
         }
     }
@@ -612,6 +790,9 @@ worksheet workbook::sheet_by_title(const std::string &title)
     {
         if (impl.title_ == title)
         {
+            load_deferred_sheet(impl);
+            impl.source_part_.clear();
+
             return worksheet(&impl);
         }
     }
@@ -633,6 +814,9 @@ worksheet workbook::sheet_by_index(std::size_t index)
         ++iter;
     }
 
+    load_deferred_sheet(*iter);
+    iter->source_part_.clear();
+
     return worksheet(&*iter);
 }
 
@@ -644,6 +828,9 @@ const worksheet workbook::sheet_by_index(std::size_t index) const
     {
     }
 
+    load_deferred_sheet(*iter);
+    iter->source_part_.clear();
+
     return worksheet(&*iter);
 }
 
@@ -653,6 +840,9 @@ worksheet workbook::sheet_by_id(std::size_t id)
     {
         if (impl.id_ == id)
         {
+            load_deferred_sheet(impl);
+            impl.source_part_.clear();
+
             return worksheet(&impl);
         }
     }
@@ -666,6 +856,9 @@ const worksheet workbook::sheet_by_id(std::size_t id) const
     {
         if (impl.id_ == id)
         {
+            load_deferred_sheet(impl);
+            impl.source_part_.clear();
+
             return worksheet(&impl);
         }
     }
@@ -680,9 +873,9 @@ worksheet workbook::active_sheet()
 
 bool workbook::has_named_range(const std::string &name) const
 {
-    for (auto worksheet : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        if (worksheet.has_named_range(name))
+        if (impl.named_ranges_.find(name) != impl.named_ranges_.end())
         {
             return true;
         }
@@ -704,6 +897,7 @@ worksheet workbook::create_sheet()
     std::string sheet_filename = "sheet" + std::to_string(sheet_id) + ".xml";
 
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    d_->worksheets_.back().memory_pool_ = d_->memory_pool_;
 
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     uri relative_sheet_uri(path("worksheets").append(sheet_filename).string());
@@ -723,10 +917,15 @@ worksheet workbook::copy_sheet(worksheet to_copy)
 {
     if (to_copy.d_->parent_ != this) throw invalid_parameter();
 
-    detail::worksheet_impl impl(*to_copy.d_);
     auto new_sheet = create_sheet();
-    impl.title_ = new_sheet.title();
-    *new_sheet.d_ = impl;
+    const auto title = new_sheet.title();
+    const auto id = new_sheet.id();
+
+    // cells are shared with to_copy until either sheet accesses them
+    *new_sheet.d_ = *to_copy.d_;
+    new_sheet.d_->title_ = title;
+    new_sheet.d_->id_ = id;
+    new_sheet.d_->source_part_.clear();
 
     return new_sheet;
 }
@@ -873,6 +1072,91 @@ void workbook::load(std::istream &stream, const std::string &password)
     consumer.read(stream, password);
 }
 
+void workbook::load(const std::vector<std::uint8_t> &data, const load_options &options)
+{
+    if (data.size() < 22) // the shortest ZIP file is 22 bytes
+    {
+        throw xlnt::exception("file is empty or malformed");
+    }
+
+    if (options.lazy_sheets)
+    {
+        // data may not outlive this workbook so the package is copied
+        clear();
+        detail::xlsx_consumer consumer(*this, options);
+        consumer.read_lazily(std::make_shared<owning_istream>(std::vector<std::uint8_t>(data)));
+
+        return;
+    }
+
+    xlnt::detail::vector_istreambuf data_buffer(data);
+    std::istream data_stream(&data_buffer);
+    load(data_stream, options);
+}
+
+void workbook::load(const std::string &filename, const load_options &options)
+{
+    return load(path(filename), options);
+}
+
+void workbook::load(const path &filename, const load_options &options)
+{
+    auto file_stream = std::make_shared<std::ifstream>();
+    open_stream(*file_stream, filename.string());
+
+    if (!file_stream->good())
+    {
+        throw xlnt::exception("file not found " + filename.string());
+    }
+
+    if (options.lazy_sheets)
+    {
+        // the file stays open until every deferred sheet has been read
+        clear();
+        detail::xlsx_consumer consumer(*this, options);
+        consumer.read_lazily(file_stream);
+
+        return;
+    }
+
+    load(*file_stream, options);
+}
+
+void workbook::load(std::istream &stream, const load_options &options)
+{
+    clear();
+    detail::xlsx_consumer consumer(*this, options);
+
+    if (options.lazy_sheets)
+    {
+        // stream may not outlive this workbook so the package is copied
+        consumer.read_lazily(std::make_shared<owning_istream>(xlnt::detail::to_vector(stream)));
+    }
+    else
+    {
+        consumer.read(stream);
+    }
+}
+
+void workbook::load_deferred_sheet(detail::worksheet_impl &impl) const
+{
+    if (impl.deferred_rel_id_.empty()) return;
+
+    // Reading the sheet doesn't change anything observable about the workbook
+    // so this is allowed through const accessors.
+    detail::xlsx_consumer consumer(const_cast<workbook &>(*this), d_->deferred_options_);
+    consumer.read_deferred_worksheet(impl);
+
+    auto pending = std::any_of(d_->worksheets_.begin(), d_->worksheets_.end(),
+        [](const detail::worksheet_impl &ws) { return !ws.deferred_rel_id_.empty(); });
+
+    if (!pending && !d_->passthrough_)
+    {
+        d_->deferred_archive_.reset();
+        d_->deferred_source_.reset();
+    }
+}
+
 void workbook::save(std::vector<std::uint8_t> &data) const
 {
     xlnt::detail::vector_ostreambuf data_buffer(data);
@@ -899,6 +1183,19 @@ void workbook::save(const std::string &filename, const std::string &password) co
 
 void workbook::save(const path &filename) const
 {
+    if (d_->deferred_source_)
+    {
+        // filename may be the file this workbook is still reading from
+        std::vector<std::uint8_t> data;
+        save(data);
+
+        std::ofstream file_stream;
+        open_stream(file_stream, filename.string());
+        file_stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        return;
+    }
+
     std::ofstream file_stream;
     open_stream(file_stream, filename.string());
     save(file_stream);
@@ -913,12 +1210,32 @@ void workbook::save(const path &filename, const std::string &password) const
 
 void workbook::save(std::ostream &stream) const
 {
+    if (is_populating(*d_))
+    {
+        const_cast<workbook &>(*this).end_concurrent_population();
+    }
+
+    if (d_->formula_evaluator_)
+    {
+        const_cast<workbook &>(*this).calculate();
+    }
+
     detail::xlsx_producer producer(*this);
     producer.write(stream);
 }
 
 void workbook::save(std::ostream &stream, const std::string &password) const
 {
+    if (is_populating(*d_))
+    {
+        const_cast<workbook &>(*this).end_concurrent_population();
+    }
+
+    if (d_->formula_evaluator_)
+    {
+        const_cast<workbook &>(*this).calculate();
+    }
+
     detail::xlsx_producer producer(*this);
     producer.write(stream, password);
 }
@@ -1005,6 +1322,7 @@ worksheet workbook::create_sheet_with_rel(const std::string &title, const relati
 {
     auto sheet_id = d_->worksheets_.size() + 1;
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    d_->worksheets_.back().memory_pool_ = d_->memory_pool_;
 
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     auto sheet_absoulute_path = workbook_rel.target().path().parent().append(rel.target().path());
@@ -1053,14 +1371,27 @@ std::vector<std::string> workbook::sheet_titles() const
 {
     std::vector<std::string> names;
 
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        names.push_back(ws.title());
+        names.push_back(impl.title_);
     }
 
     return names;
 }
 
+std::size_t workbook::formula_count() const
+{
+    auto count = std::size_t(0);
+
+    for (auto &impl : d_->worksheets_)
+    {
+        load_deferred_sheet(impl);
+        count += impl.formula_cells_.size();
+    }
+
+    return count;
+}
+
 std::size_t workbook::sheet_count() const
 {
     return d_->worksheets_.size();
@@ -1079,7 +1410,7 @@ worksheet workbook::operator[](std::size_t index)
 void workbook::clear()
 {
     *d_ = detail::workbook_impl();
-    d_->stylesheet_.clear();
+    d_->stylesheet_.reset();
 }
 
 bool workbook::operator==(const workbook &rhs) const
@@ -1092,6 +1423,17 @@ bool workbook::operator!=(const workbook &rhs) const
     return d_.get() != rhs.d_.get();
 }
 
+detail::stylesheet &workbook::modifiable_stylesheet()
+{
+    if (d_->stylesheet_.use_count() > 1)
+    {
+        d_->detach_stylesheet();
+        d_->stylesheet_->parent = this;
+    }
+
+    return *d_->stylesheet_;
+}
+
 void workbook::swap(workbook &right)
 {
     auto &left = *this;
@@ -1101,27 +1443,27 @@ void workbook::swap(workbook &right)
 
     if (left.d_ != nullptr)
     {
-        for (auto ws : left)
+        for (auto &ws : left.d_->worksheets_)
         {
-            ws.parent(left);
+            ws.parent_ = &left;
         }
 
-        if (left.d_->stylesheet_.is_set())
+        if (left.d_->stylesheet_ != nullptr)
         {
-            left.d_->stylesheet_.get().parent = &left;
+            left.d_->stylesheet_->parent = &left;
         }
     }
 
     if (right.d_ != nullptr)
     {
-        for (auto ws : right)
+        for (auto &ws : right.d_->worksheets_)
         {
-            ws.parent(right);
+            ws.parent_ = &right;
         }
 
-        if (right.d_->stylesheet_.is_set())
+        if (right.d_->stylesheet_ != nullptr)
         {
-            right.d_->stylesheet_.get().parent = &right;
+            right.d_->stylesheet_->parent = &right;
         }
     }
 }
@@ -1129,7 +1471,7 @@ void workbook::swap(workbook &right)
 workbook &workbook::operator=(workbook other)
 {
     swap(other);
-    d_->stylesheet_.get().parent = this;
+    d_->stylesheet_->parent = this;
 
     return *this;
 }
@@ -1145,12 +1487,15 @@ workbook::workbook(const workbook &other)
 {
     *d_.get() = *other.d_.get();
 
-    for (auto ws : *this)
+    for (auto &ws : d_->worksheets_)
     {
-        ws.parent(*this);
+        ws.parent_ = this;
     }
 
-    d_->stylesheet_.get().parent = this;
+    if (d_->stylesheet_.use_count() == 1)
+    {
+        d_->stylesheet_->parent = this;
+    }
 }
 
 workbook::~workbook()
@@ -1177,9 +1522,9 @@ std::vector<named_range> workbook::named_ranges() const
 {
     std::vector<xlnt::named_range> named_ranges;
 
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        for (auto &ws_named_range : ws.d_->named_ranges_)
+        for (auto &ws_named_range : impl.named_ranges_)
         {
             named_ranges.push_back(ws_named_range.second);
         }
@@ -1191,12 +1536,12 @@ std::vector<named_range> workbook::named_ranges() const
 format workbook::create_format(bool default_format)
 {
     register_workbook_part(relationship_type::stylesheet);
-    return d_->stylesheet_.get().create_format(default_format);
+    return modifiable_stylesheet().create_format(default_format);
 }
 
 bool workbook::has_style(const std::string &name) const
 {
-    return d_->stylesheet_.get().has_style(name);
+    return d_->stylesheet_->has_style(name);
 }
 
 void workbook::clear_styles()
@@ -1228,12 +1573,12 @@ void workbook::apply_to_cells(std::function<void(cell)> f)
 
 format workbook::format(std::size_t format_index)
 {
-    return d_->stylesheet_.get().format(format_index);
+    return modifiable_stylesheet().format(format_index);
 }
 
 const format workbook::format(std::size_t format_index) const
 {
-    return d_->stylesheet_.get().format(format_index);
+    return d_->stylesheet_->format(format_index);
 }
 
 manifest &workbook::manifest()
@@ -1248,44 +1593,74 @@ const manifest &workbook::manifest() const
 
 std::vector<rich_text> &workbook::shared_strings()
 {
-    return d_->shared_strings_;
+    if (d_->shared_strings_.use_count() > 1)
+    {
+        d_->shared_strings_ = std::make_shared<std::vector<rich_text>>(*d_->shared_strings_);
+    }
+
+    return *d_->shared_strings_;
 }
 
 const std::vector<rich_text> &workbook::shared_strings() const
 {
-    return d_->shared_strings_;
+    return *d_->shared_strings_;
 }
 
 std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_duplicates)
 {
-    register_workbook_part(relationship_type::shared_string_table);
+    const auto &strings = *d_->shared_strings_;
+    auto &ids = d_->shared_strings_ids_;
 
-    auto index = std::size_t(0);
+    if (strings.empty())
+    {
+        register_workbook_part(relationship_type::shared_string_table);
+    }
+
+    if (d_->shared_strings_indexed_ > strings.size())
+    {
+        ids.clear();
+        d_->shared_strings_indexed_ = 0;
+    }
+
+    for (; d_->shared_strings_indexed_ < strings.size(); ++d_->shared_strings_indexed_)
+    {
+        ids.emplace(strings[d_->shared_strings_indexed_].plain_text(), d_->shared_strings_indexed_);
+    }
+
+    const auto plain_text = shared.plain_text();
 
     if (!allow_duplicates)
     {
-        // TODO: inefficient, use a set or something?
-        for (auto &s : d_->shared_strings_)
+        auto match = strings.size();
+        auto candidates = ids.equal_range(plain_text);
+
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
         {
-            if (s == shared)
+            if (candidate->second < match && strings[candidate->second] == shared)
             {
-                return index;
+                match = candidate->second;
             }
+        }
 
-            ++index;
+        if (match != strings.size())
+        {
+            return match;
         }
     }
 
-    d_->shared_strings_.push_back(shared);
+    const auto index = strings.size();
+    shared_strings().push_back(shared);
+    ids.emplace(plain_text, index);
+    ++d_->shared_strings_indexed_;
 
     return index;
 }
 
 bool workbook::contains(const std::string &sheet_title) const
 {
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        if (ws.title() == sheet_title) return true;
+        if (impl.title_ == sheet_title) return true;
     }
 
     return false;
@@ -1302,33 +1677,33 @@ void workbook::thumbnail(const std::vector<std::uint8_t> &thumbnail,
     }
 
     auto thumbnail_rel = d_->manifest_.relationship(path("/"), relationship_type::thumbnail);
-    d_->images_[thumbnail_rel.target().to_string()] = thumbnail;
+    d_->images_[thumbnail_rel.target().to_string()] = std::make_shared<const std::vector<std::uint8_t>>(thumbnail);
 }
 
 const std::vector<std::uint8_t> &workbook::thumbnail() const
 {
     auto thumbnail_rel = d_->manifest_.relationship(path("/"), relationship_type::thumbnail);
-    return d_->images_.at(thumbnail_rel.target().to_string());
+    return *d_->images_.at(thumbnail_rel.target().to_string());
 }
 
 style workbook::create_style(const std::string &name)
 {
-    return d_->stylesheet_.get().create_style(name);
+    return modifiable_stylesheet().create_style(name);
 }
 
 style workbook::create_builtin_style(const std::size_t builtin_id)
 {
-	return d_->stylesheet_.get().create_builtin_style(builtin_id);
+	return modifiable_stylesheet().create_builtin_style(builtin_id);
 }
 
 style workbook::style(const std::string &name)
 {
-    return d_->stylesheet_.get().style(name);
+    return modifiable_stylesheet().style(name);
 }
 
 const style workbook::style(const std::string &name) const
 {
-    return d_->stylesheet_.get().style(name);
+    return d_->stylesheet_->style(name);
 }
 
 calendar workbook::base_date() const
@@ -1446,24 +1821,32 @@ void workbook::calculation_properties(const class calculation_properties &props)
     d_->calculation_properties_ = props;
 }
 
-void workbook::garbage_collect_formulae()
+std::size_t workbook::calculate()
 {
-    auto any_with_formula = false;
+    if (is_populating(*d_))
+    {
+        end_concurrent_population();
+    }
 
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        for (auto row : ws.rows(true))
-        {
-            for (auto cell : row)
-            {
-                if (cell.has_formula())
-                {
-                    any_with_formula = true;
-                }
-            }
-        }
+        load_deferred_sheet(impl);
+    }
+
+    if (!d_->formula_evaluator_)
+    {
+        d_->formula_evaluator_ = std::make_shared<detail::formula_evaluator>();
     }
 
+    return d_->formula_evaluator_->calculate(*d_);
+}
+
+void workbook::garbage_collect_formulae()
+{
+    // the formulas of deferred sheets aren't known until they are read
+    const auto any_with_formula = std::any_of(d_->worksheets_.begin(), d_->worksheets_.end(),
+        [](const detail::worksheet_impl &ws) { return !ws.formula_cells_.empty() || !ws.deferred_rel_id_.empty(); });
+
     if (any_with_formula) return;
 
     auto wb_rel = manifest().relationship(path("/"), relationship_type::office_document);
@@ -0,0 +1,243 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+
+#include <detail/implementations/frozen_workbook_impl.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/utils/date.hpp>
+#include <xlnt/utils/datetime.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/time.hpp>
+#include <xlnt/utils/timedelta.hpp>
+#include <xlnt/worksheet/frozen_worksheet.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace {
+
+using formula_iterator = std::vector<std::pair<std::uint64_t, std::string>>::const_iterator;
+
+formula_iterator find_formula(const xlnt::detail::frozen_worksheet_impl &sheet, std::uint64_t key)
+{
+    return std::lower_bound(sheet.formulae_.begin(), sheet.formulae_.end(), key,
+        [](const std::pair<std::uint64_t, std::string> &formula, std::uint64_t k) { return formula.first < k; });
+}
+
+} // namespace
+
+namespace xlnt {
+
+frozen_worksheet::frozen_worksheet(const detail::frozen_workbook_impl *parent, const detail::frozen_worksheet_impl *d)
+    : parent_(parent), d_(d)
+{
+}
+
+std::size_t frozen_worksheet::find(const cell_reference &reference) const
+{
+    const auto key = detail::frozen_worksheet_impl::key(reference.column().index, reference.row());
+    const auto match = std::lower_bound(d_->keys_.begin(), d_->keys_.end(), key);
+
+    if (match == d_->keys_.end() || *match != key)
+    {
+        return d_->keys_.size();
+    }
+
+    return static_cast<std::size_t>(match - d_->keys_.begin());
+}
+
+std::size_t frozen_worksheet::at(const cell_reference &reference) const
+{
+    const auto index = find(reference);
+
+    if (index == d_->keys_.size())
+    {
+        throw invalid_parameter();
+    }
+
+    return index;
+}
+
+const std::string &frozen_worksheet::title() const
+{
+    return d_->title_;
+}
+
+std::size_t frozen_worksheet::cell_count() const
+{
+    return d_->keys_.size();
+}
+
+bool frozen_worksheet::has_cell(const cell_reference &reference) const
+{
+    return find(reference) != d_->keys_.size();
+}
+
+cell_type frozen_worksheet::data_type(const cell_reference &reference) const
+{
+    const auto index = find(reference);
+    return index == d_->keys_.size() ? cell_type::empty : d_->cells_[index].type_;
+}
+
+bool frozen_worksheet::has_value(const cell_reference &reference) const
+{
+    return data_type(reference) != cell_type::empty;
+}
+
+bool frozen_worksheet::is_date(const cell_reference &reference) const
+{
+    const auto index = find(reference);
+    return index != d_->keys_.size() && d_->cells_[index].is_date_;
+}
+
+template <>
+XLNT_API bool frozen_worksheet::value(const cell_reference &reference) const
+{
+    return d_->cells_[at(reference)].value_numeric_ != 0.L;
+}
+
+template <>
+XLNT_API int frozen_worksheet::value(const cell_reference &reference) const
+{
+    return static_cast<int>(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API long long int frozen_worksheet::value(const cell_reference &reference) const
+{
+    return static_cast<long long int>(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API unsigned int frozen_worksheet::value(const cell_reference &reference) const
+{
+    return static_cast<unsigned int>(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API unsigned long long frozen_worksheet::value(const cell_reference &reference) const
+{
+    return static_cast<unsigned long long>(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API float frozen_worksheet::value(const cell_reference &reference) const
+{
+    return static_cast<float>(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API double frozen_worksheet::value(const cell_reference &reference) const
+{
+    return static_cast<double>(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API long double frozen_worksheet::value(const cell_reference &reference) const
+{
+    return d_->cells_[at(reference)].value_numeric_;
+}
+
+template <>
+XLNT_API time frozen_worksheet::value(const cell_reference &reference) const
+{
+    return time::from_number(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API datetime frozen_worksheet::value(const cell_reference &reference) const
+{
+    return datetime::from_number(d_->cells_[at(reference)].value_numeric_, parent_->base_date_);
+}
+
+template <>
+XLNT_API date frozen_worksheet::value(const cell_reference &reference) const
+{
+    return date::from_number(static_cast<int>(d_->cells_[at(reference)].value_numeric_), parent_->base_date_);
+}
+
+template <>
+XLNT_API timedelta frozen_worksheet::value(const cell_reference &reference) const
+{
+    return timedelta::from_number(d_->cells_[at(reference)].value_numeric_);
+}
+
+template <>
+XLNT_API std::string frozen_worksheet::value(const cell_reference &reference) const
+{
+    const auto &cell = d_->cells_[at(reference)];
+
+    switch (cell.type_)
+    {
+    case cell_type::inline_string:
+    case cell_type::shared_string:
+    case cell_type::formula_string:
+    case cell_type::error:
+        return parent_->strings_.at(static_cast<std::size_t>(cell.value_numeric_));
+    default:
+        return std::string();
+    }
+}
+
+bool frozen_worksheet::has_formula(const cell_reference &reference) const
+{
+    const auto key = detail::frozen_worksheet_impl::key(reference.column().index, reference.row());
+    const auto match = find_formula(*d_, key);
+
+    return match != d_->formulae_.end() && match->first == key;
+}
+
+const std::string &frozen_worksheet::formula(const cell_reference &reference) const
+{
+    const auto key = detail::frozen_worksheet_impl::key(reference.column().index, reference.row());
+    const auto match = find_formula(*d_, key);
+
+    if (match == d_->formulae_.end() || match->first != key)
+    {
+        throw invalid_attribute();
+    }
+
+    return match->second;
+}
+
+range_reference frozen_worksheet::calculate_dimension() const
+{
+    if (d_->keys_.empty())
+    {
+        return range_reference(1, 1, 1, 1);
+    }
+
+    auto lowest_column = ~std::uint32_t(0);
+    auto highest_column = std::uint32_t(0);
+
+    for (auto key : d_->keys_)
+    {
+        const auto column = static_cast<std::uint32_t>(key);
+        lowest_column = std::min(lowest_column, column);
+        highest_column = std::max(highest_column, column);
+    }
+
+    return range_reference(lowest_column, static_cast<row_t>(d_->keys_.front() >> 32),
+        highest_column, static_cast<row_t>(d_->keys_.back() >> 32));
+}
+
+} // namespace xlnt
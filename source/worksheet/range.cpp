@@ -157,6 +157,26 @@ void range::apply(std::function<void(class cell)> f)
     }
 }
 
+range_statistics range::aggregate(bool parallel) const
+{
+    return ws_.statistics(ref_, parallel);
+}
+
+std::vector<std::shared_ptr<const computed_style>> range::computed_styles() const
+{
+    return ws_.computed_styles(ref_);
+}
+
+void range::sort(const std::vector<sort_key> &keys)
+{
+    ws_.sort_rows(ref_, keys);
+}
+
+void range::sort(column_t column, bool ascending)
+{
+    sort({sort_key(column, ascending)});
+}
+
 cell range::cell(const cell_reference &ref)
 {
     return (*this)[ref.row() - 1][ref.column().index - 1];
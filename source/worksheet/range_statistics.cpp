@@ -0,0 +1,163 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <xlnt/worksheet/range_statistics.hpp>
+
+namespace {
+
+// independent accumulators let the compiler reduce several values at once
+// with vector instructions
+const std::size_t lanes = 4;
+
+} // namespace
+
+namespace xlnt {
+
+range_statistics::range_statistics()
+{
+}
+
+range_statistics::range_statistics(const std::vector<double> &values)
+    : count_(values.size())
+{
+    if (values.empty()) return;
+
+    const auto data = values.data();
+    const auto size = values.size();
+    const auto whole = size - size % lanes;
+
+    double sums[lanes] = {};
+    double lows[lanes];
+    double highs[lanes];
+
+    std::fill(lows, lows + lanes, data[0]);
+    std::fill(highs, highs + lanes, data[0]);
+
+    for (std::size_t i = 0; i < whole; i += lanes)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            const auto value = data[i + lane];
+            sums[lane] += value;
+            lows[lane] = value < lows[lane] ? value : lows[lane];
+            highs[lane] = value > highs[lane] ? value : highs[lane];
+        }
+    }
+
+    for (auto i = whole; i < size; ++i)
+    {
+        sums[i - whole] += data[i];
+        lows[i - whole] = std::min(lows[i - whole], data[i]);
+        highs[i - whole] = std::max(highs[i - whole], data[i]);
+    }
+
+    sum_ = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    min_ = std::min(std::min(lows[0], lows[1]), std::min(lows[2], lows[3]));
+    max_ = std::max(std::max(highs[0], highs[1]), std::max(highs[2], highs[3]));
+
+    // a second pass over the differences from the mean stays accurate where
+    // the difference of the sum of squares and the squared sum would not
+    const auto average = sum_ / static_cast<double>(size);
+    double deviations[lanes] = {};
+
+    for (std::size_t i = 0; i < whole; i += lanes)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            const auto difference = data[i + lane] - average;
+            deviations[lane] += difference * difference;
+        }
+    }
+
+    for (auto i = whole; i < size; ++i)
+    {
+        const auto difference = data[i] - average;
+        deviations[i - whole] += difference * difference;
+    }
+
+    squared_deviations_ = (deviations[0] + deviations[1]) + (deviations[2] + deviations[3]);
+}
+
+std::size_t range_statistics::count() const
+{
+    return count_;
+}
+
+double range_statistics::sum() const
+{
+    return sum_;
+}
+
+double range_statistics::min() const
+{
+    return min_;
+}
+
+double range_statistics::max() const
+{
+    return max_;
+}
+
+double range_statistics::mean() const
+{
+    return count_ == 0 ? 0 : sum_ / static_cast<double>(count_);
+}
+
+double range_statistics::variance() const
+{
+    return count_ < 2 ? 0 : squared_deviations_ / static_cast<double>(count_ - 1);
+}
+
+double range_statistics::standard_deviation() const
+{
+    return std::sqrt(variance());
+}
+
+range_statistics &range_statistics::operator+=(const range_statistics &other)
+{
+    if (other.count_ == 0) return *this;
+
+    if (count_ == 0)
+    {
+        return *this = other;
+    }
+
+    const auto count = count_ + other.count_;
+    const auto difference = other.mean() - mean();
+
+    squared_deviations_ += other.squared_deviations_
+        + difference * difference * static_cast<double>(count_) * static_cast<double>(other.count_)
+            / static_cast<double>(count);
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    count_ = count;
+
+    return *this;
+}
+
+} // namespace xlnt
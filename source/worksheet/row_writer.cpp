@@ -0,0 +1,151 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstdint>
+
+#include <detail/constants.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/worksheet/row_writer.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct row_writer_impl
+{
+    worksheet_impl *ws_;
+    row_t row_;
+
+    // wider than a column index so that it can be one past the last column
+    std::uint64_t column_;
+
+    // The row's entry in ws_->cell_map_, or null until the first cell of the
+    // row is written. Elements of an unordered_map don't move on rehashing, but
+    // the entry is looked up again for every cell if rows may be moved to disk.
+    std::shared_ptr<worksheet_impl::cell_row> *cells_;
+};
+
+} // namespace detail
+
+row_writer::row_writer(worksheet ws, row_t row)
+    : d_(new detail::row_writer_impl{ws.d_, row, 1, nullptr})
+{
+    if (row == 0 || row > constants::max_row())
+    {
+        throw invalid_cell_reference(1, row);
+    }
+}
+
+row_writer::row_writer(row_writer &&other)
+    : d_(std::move(other.d_))
+{
+}
+
+row_writer::~row_writer()
+{
+}
+
+cell row_writer::next_cell()
+{
+    auto &d = *d_;
+
+    if (d.column_ > constants::max_column().index)
+    {
+        throw invalid_cell_reference(constants::max_column(), d.row_);
+    }
+
+    const auto column = static_cast<column_t::index_t>(d.column_);
+
+    // look the row up once, and again only if a copy of the sheet now shares it
+    // or it may have been moved out of memory
+    if (d.cells_ == nullptr || d.cells_->use_count() > 1 || d.ws_->row_store_)
+    {
+        d.cells_ = &d.ws_->create_row(d.row_);
+        d.ws_->mutable_row(d.row_);
+    }
+
+    auto &row = **d.cells_;
+    auto match = row.find(column);
+
+    if (match == row.end())
+    {
+        match = row.emplace(column, detail::cell_impl()).first;
+
+        auto &impl = match->second;
+        impl.parent_ = d.ws_;
+        impl.column_ = column;
+        impl.row_ = d.row_;
+    }
+
+    ++d.column_;
+
+    return cell(&match->second);
+}
+
+row_writer &row_writer::skip_cells(column_t::index_t count)
+{
+    // column_ is at most one past the last column, so this doesn't wrap
+    if (count > constants::max_column().index + std::uint64_t(1) - d_->column_)
+    {
+        throw invalid_cell_reference(constants::max_column().index, d_->row_);
+    }
+
+    d_->column_ += count;
+
+    return *this;
+}
+
+row_writer &row_writer::next_row()
+{
+    if (d_->row_ >= constants::max_row())
+    {
+        throw invalid_cell_reference(1, d_->row_ + 1);
+    }
+
+    ++d_->row_;
+    d_->column_ = 1;
+    d_->cells_ = nullptr;
+
+    return *this;
+}
+
+row_t row_writer::row() const
+{
+    return d_->row_;
+}
+
+column_t row_writer::column() const
+{
+    if (d_->column_ > constants::max_column().index)
+    {
+        throw invalid_cell_reference(constants::max_column(), d_->row_);
+    }
+
+    return static_cast<column_t::index_t>(d_->column_);
+}
+
+} // namespace xlnt
@@ -23,17 +23,29 @@
 // @author: see AUTHORS file
 
 #include <algorithm>
+#include <cctype>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <thread>
 
 #include <detail/constants.hpp>
+#include <detail/formula/formula_evaluator.hpp>
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/conditional_format_evaluator.hpp>
+#include <detail/implementations/stylesheet.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/csv_parser.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/cell/index_types.hpp>
+#include <xlnt/formula/formula_translator.hpp>
 #include <xlnt/packaging/relationship.hpp>
+#include <xlnt/styles/computed_style.hpp>
+#include <xlnt/styles/format.hpp>
+#include <xlnt/styles/number_format.hpp>
 #include <xlnt/utils/date.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
@@ -45,6 +57,9 @@
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/range_statistics.hpp>
+#include <xlnt/worksheet/row_writer.hpp>
+#include <xlnt/worksheet/sort_key.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
 namespace {
@@ -54,6 +69,257 @@ int points_to_pixels(double points, double dpi)
     return static_cast<int>(std::ceil(points * dpi / 72));
 }
 
+// Calls function with each cell of ws within reference that already exists.
+// Rows containing such cells are detached from any copies of the sheet first.
+template <typename Function>
+void for_each_existing_cell(xlnt::detail::worksheet_impl &ws, const xlnt::range_reference &reference, Function function)
+{
+    const auto top = std::min(reference.top_left().row(), reference.bottom_right().row());
+    const auto bottom = std::max(reference.top_left().row(), reference.bottom_right().row());
+    const auto left = std::min(reference.top_left().column_index(), reference.bottom_right().column_index());
+    const auto right = std::max(reference.top_left().column_index(), reference.bottom_right().column_index());
+
+    std::vector<xlnt::row_t> rows;
+
+    // visit whichever is smaller, the rows of the range or the rows of the sheet
+    if (bottom - top < ws.cell_map_.size())
+    {
+        for (auto row = top; row <= bottom; ++row)
+        {
+            if (ws.cell_map_.count(row) > 0 || (ws.row_store_ && ws.row_store_->is_spilled(row)))
+            {
+                rows.push_back(row);
+            }
+        }
+    }
+    else
+    {
+        for (auto row : ws.row_indices())
+        {
+            if (row >= top && row <= bottom)
+            {
+                rows.push_back(row);
+            }
+        }
+    }
+
+    std::vector<xlnt::column_t> columns;
+
+    for (auto row : rows)
+    {
+        const auto &cells = **ws.find_row(row);
+        columns.clear();
+
+        for (const auto &cell : cells)
+        {
+            if (cell.first >= left && cell.first <= right)
+            {
+                columns.push_back(cell.first);
+            }
+        }
+
+        if (columns.empty()) continue;
+
+        auto &mutable_cells = ws.mutable_row(row);
+
+        for (auto column : columns)
+        {
+            function(mutable_cells.at(column));
+        }
+    }
+}
+
+// A value of a sort key column reduced to what ordering it needs.
+struct sort_value
+{
+    // numbers, text, booleans, errors and empty cells, in ascending order
+    std::uint8_t rank = 4;
+    long double number = 0;
+
+    // index of the upper case text of the value
+    std::size_t text = 0;
+};
+
+int compare_sort_values(const sort_value &a, const sort_value &b, const std::vector<std::string> &texts)
+{
+    if (a.rank != b.rank) return a.rank < b.rank ? -1 : 1;
+
+    if (a.rank == 1)
+    {
+        const auto order = texts[a.text].compare(texts[b.text]);
+        return order < 0 ? -1 : order > 0 ? 1 : 0;
+    }
+
+    // all errors are equal
+    if (a.rank > 2) return 0;
+
+    return a.number < b.number ? -1 : a.number > b.number ? 1 : 0;
+}
+
+// Stable sorts items, sorting parts of a large vector on separate threads and
+// merging them after. Each merge keeps the earlier part first, so equal items
+// stay in their original order.
+template <typename Less>
+void parallel_stable_sort(std::vector<std::uint32_t> &items, Less less)
+{
+    const auto minimum_part = std::size_t(1) << 15;
+    const auto parts = std::min<std::size_t>(std::thread::hardware_concurrency(), items.size() / minimum_part);
+
+    if (parts < 2)
+    {
+        std::stable_sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    std::vector<std::size_t> bounds;
+
+    for (std::size_t part = 0; part <= parts; ++part)
+    {
+        bounds.push_back(items.size() * part / parts);
+    }
+
+    const auto begin = items.begin();
+    std::vector<std::thread> threads;
+
+    for (std::size_t part = 0; part < parts; ++part)
+    {
+        threads.emplace_back([begin, &bounds, &less, part]() {
+            std::stable_sort(begin + static_cast<std::ptrdiff_t>(bounds[part]),
+                begin + static_cast<std::ptrdiff_t>(bounds[part + 1]), less);
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    while (bounds.size() > 2)
+    {
+        std::vector<std::size_t> merged;
+        threads.clear();
+
+        for (std::size_t i = 0; i + 1 < bounds.size(); i += 2)
+        {
+            merged.push_back(bounds[i]);
+            if (i + 2 >= bounds.size()) continue;
+
+            const auto first = begin + static_cast<std::ptrdiff_t>(bounds[i]);
+            const auto middle = begin + static_cast<std::ptrdiff_t>(bounds[i + 1]);
+            const auto last = begin + static_cast<std::ptrdiff_t>(bounds[i + 2]);
+
+            threads.emplace_back([first, middle, last, &less]() { std::inplace_merge(first, middle, last, less); });
+        }
+
+        merged.push_back(bounds.back());
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        bounds = merged;
+    }
+}
+
+// Replaces the shared formula with the given index by a formula of its own in
+// each cell of the group.
+void dissolve_shared_formula(xlnt::detail::worksheet_impl &ws, std::uint32_t index)
+{
+    const auto shared = ws.shared_formulae_.at(index);
+    ws.shared_formulae_.erase(index);
+
+    const auto translator = xlnt::formula_translator(shared.formula_, shared.anchor_);
+
+    for_each_existing_cell(ws, shared.range_, [&shared, &translator, index](xlnt::detail::cell_impl &member) {
+        if (!member.shared_formula_.is_set() || member.shared_formula_.get() != index) return;
+
+        const auto here = xlnt::cell_reference(member.column_, member.row_);
+
+        member.shared_formula_.clear();
+        member.formula_ = here == shared.anchor_ ? shared.formula_ : translator.translate(here);
+    });
+}
+
+// Returns reference moved as formulas referring to it are when lines of sheet
+// are inserted or deleted, or false if all of it was deleted.
+bool move_reference(xlnt::range_reference &reference, const std::string &sheet, bool rows,
+    std::uint32_t first, long long offset)
+{
+    const auto translator = xlnt::formula_translator(reference.to_string(), xlnt::cell_reference("A1"));
+    const auto moved = rows ? translator.shift_rows(sheet, true, first, offset)
+                            : translator.shift_columns(sheet, true, first, offset);
+
+    if (moved.find("#REF!") != std::string::npos) return false;
+
+    reference = xlnt::range_reference(moved);
+
+    return true;
+}
+
+// Returns a handler that writes each record of parsed delimited text to the row
+// of writer and moves it to the next row. The format of each kind of date, time
+// or percentage is created for the first such cell and shared by the rest.
+xlnt::detail::csv_parser::block_handler csv_appender(xlnt::row_writer &writer)
+{
+    using kind = xlnt::detail::csv_field::kind;
+    auto formats = std::make_shared<std::vector<std::pair<kind, xlnt::format>>>();
+
+    return [&writer, formats](const xlnt::detail::csv_block &block) {
+        auto field = block.fields.begin();
+
+        for (auto record_end : block.record_ends)
+        {
+            for (const auto last = block.fields.begin() + static_cast<std::ptrdiff_t>(record_end); field != last; ++field)
+            {
+                writer.skip_cells(field->column - writer.column().index);
+                auto cell = writer.next_cell();
+
+                switch (field->type)
+                {
+                case kind::text:
+                    cell.value(block.text(*field));
+                    continue;
+                case kind::formula:
+                    cell.formula(block.text(*field));
+                    continue;
+                case kind::error:
+                    cell.error(block.text(*field));
+                    continue;
+                case kind::boolean:
+                    cell.value(field->number != 0.0);
+                    continue;
+                default:
+                    cell.value(field->number);
+                    break;
+                }
+
+                if (field->type == kind::number) continue;
+
+                const auto type = field->type;
+                const auto existing = std::find_if(formats->begin(), formats->end(),
+                    [type](const std::pair<kind, xlnt::format> &entry) { return entry.first == type; });
+
+                if (existing != formats->end())
+                {
+                    cell.format(existing->second);
+                    continue;
+                }
+
+                cell.number_format(type == kind::percentage
+                        ? xlnt::number_format::percentage()
+                        : type == kind::date
+                            ? xlnt::number_format::date_yyyymmdd2()
+                            : type == kind::date_time ? xlnt::number_format::date_datetime()
+                                                      : xlnt::number_format::date_time6());
+                formats->emplace_back(type, cell.format());
+            }
+
+            writer.next_row();
+        }
+    };
+}
+
 } // namespace
 
 namespace xlnt {
@@ -116,7 +382,7 @@ cell worksheet::operator[](const cell_reference &ref)
 
 std::vector<range_reference> worksheet::merged_ranges() const
 {
-    return d_->merged_cells_;
+    return d_->merged_cells_.ranges();
 }
 
 bool worksheet::has_page_margins() const
@@ -196,32 +462,33 @@ const workbook &worksheet::workbook() const
 
 void worksheet::garbage_collect()
 {
-    auto cell_map_iter = d_->cell_map_.begin();
-
-    while (cell_map_iter != d_->cell_map_.end())
+    for (auto row_index : d_->row_indices())
     {
-        auto cell_iter = cell_map_iter->second.begin();
+        auto &row = d_->mutable_row(row_index);
+        auto cell_iter = row.begin();
 
-        while (cell_iter != cell_map_iter->second.end())
+        while (cell_iter != row.end())
         {
             class cell current_cell(&cell_iter->second);
 
             if (current_cell.garbage_collectible())
             {
-                cell_iter = cell_map_iter->second.erase(cell_iter);
+                cell_iter = row.erase(cell_iter);
                 continue;
             }
 
             cell_iter++;
         }
 
-        if (cell_map_iter->second.empty())
+        if (row.empty())
         {
-            cell_map_iter = d_->cell_map_.erase(cell_map_iter);
-            continue;
-        }
+            d_->cell_map_.erase(row_index);
 
-        cell_map_iter++;
+            if (d_->row_store_)
+            {
+                d_->row_store_->forget(row_index);
+            }
+        }
     }
 }
 
@@ -340,164 +607,987 @@ void worksheet::freeze_panes(const cell_reference &ref)
     }
 }
 
-void worksheet::unfreeze_panes()
-{
-    if (!has_view()) return;
+void worksheet::unfreeze_panes()
+{
+    if (!has_view()) return;
+
+    auto &primary_view = d_->views_.front();
+
+    primary_view.clear_selections();
+    primary_view.clear_pane();
+}
+
+cell worksheet::cell(const cell_reference &reference)
+{
+    d_->create_row(reference.row());
+    auto &row = d_->mutable_row(reference.row());
+
+    if (row.find(reference.column_index()) == row.end())
+    {
+        auto &impl = row[reference.column_index()] = detail::cell_impl();
+        impl.parent_ = d_;
+        impl.column_ = reference.column_index();
+        impl.row_ = reference.row();
+    }
+
+    return xlnt::cell(&row[reference.column_index()]);
+}
+
+const cell worksheet::cell(const cell_reference &reference) const
+{
+    return xlnt::cell(&d_->readable_row(reference.row()).at(reference.column_index()));
+}
+
+cell worksheet::cell(xlnt::column_t column, row_t row)
+{
+    return cell(cell_reference(column, row));
+}
+
+const cell worksheet::cell(xlnt::column_t column, row_t row) const
+{
+    return cell(cell_reference(column, row));
+}
+
+bool worksheet::has_cell(const cell_reference &reference) const
+{
+    const auto row = d_->find_row(reference.row());
+    if (row == nullptr) return false;
+
+    const auto col = (*row)->find(reference.column_index());
+    if (col == (*row)->cend()) return false;
+
+    return true;
+}
+
+void worksheet::shared_formula(const range_reference &reference, const std::string &formula)
+{
+    const auto text = !formula.empty() && formula.front() == '=' ? formula.substr(1) : formula;
+
+    if (text.empty())
+    {
+        throw invalid_parameter();
+    }
+
+    auto index = std::uint32_t(0);
+
+    for (const auto &shared : d_->shared_formulae_)
+    {
+        index = std::max(index, shared.first + 1);
+    }
+
+    d_->shared_formulae_[index] = detail::shared_formula{reference.top_left(), reference, text};
+
+    for (auto row = reference.top_left().row(); row <= reference.bottom_right().row(); ++row)
+    {
+        for (auto column = reference.top_left().column(); column <= reference.bottom_right().column(); ++column)
+        {
+            auto member = cell(cell_reference(column, row));
+
+            unshare_formula(*member.d_);
+            member.d_->formula_.clear();
+            member.d_->shared_formula_ = index;
+            member.data_type(cell::type::number);
+            add_formula_cell(member.reference());
+        }
+    }
+}
+
+std::vector<cell_reference> worksheet::formula_cells() const
+{
+    std::vector<std::uint64_t> keys(d_->formula_cells_.begin(), d_->formula_cells_.end());
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<cell_reference> references;
+    references.reserve(keys.size());
+
+    for (auto key : keys)
+    {
+        references.emplace_back(static_cast<column_t::index_t>(key), static_cast<row_t>(key >> 32));
+    }
+
+    return references;
+}
+
+bool worksheet::has_row_properties(row_t row) const
+{
+    return d_->row_properties_.find(row) != d_->row_properties_.end();
+}
+
+range worksheet::named_range(const std::string &name)
+{
+    if (!workbook().has_named_range(name))
+    {
+        throw key_not_found();
+    }
+
+    if (!has_named_range(name))
+    {
+        throw key_not_found();
+    }
+
+    return range(d_->named_ranges_[name].targets()[0].second);
+}
+
+const range worksheet::named_range(const std::string &name) const
+{
+    if (!workbook().has_named_range(name))
+    {
+        throw key_not_found();
+    }
+
+    if (!has_named_range(name))
+    {
+        throw key_not_found();
+    }
+
+    return range(d_->named_ranges_[name].targets()[0].second);
+}
+
+column_t worksheet::lowest_column() const
+{
+    if (!d_->has_rows())
+    {
+        return constants::min_column();
+    }
+
+    column_t lowest = constants::max_column();
+
+    for (auto &row : d_->cell_map_)
+    {
+        for (auto &c : *row.second)
+        {
+            lowest = std::min(lowest, c.first);
+        }
+    }
+
+    if (d_->row_store_)
+    {
+        for (auto &row : d_->row_store_->spilled())
+        {
+            lowest = std::min(lowest, column_t(row.second.first_column));
+        }
+    }
+
+    return lowest;
+}
+
+row_t worksheet::lowest_row() const
+{
+    if (!d_->has_rows())
+    {
+        return constants::min_row();
+    }
+
+    row_t lowest = constants::max_row();
+
+    for (auto row : d_->row_indices())
+    {
+        lowest = std::min(lowest, row);
+    }
+
+    return lowest;
+}
+
+row_writer worksheet::append_rows()
+{
+    row_t last = 0;
+
+    for (const auto &row : d_->cell_map_)
+    {
+        if (!row.second->empty())
+        {
+            last = std::max(last, row.first);
+        }
+    }
+
+    if (d_->row_store_)
+    {
+        for (const auto &row : d_->row_store_->spilled())
+        {
+            last = std::max(last, row.first);
+        }
+    }
+
+    return row_writer(*this, last + 1);
+}
+
+void worksheet::import_csv(const path &filename, const csv_options &options)
+{
+    auto writer = append_rows();
+    auto parser = detail::csv_parser(options, workbook().base_date());
+    parser.parse(filename, csv_appender(writer));
+}
+
+void worksheet::import_csv(std::istream &stream, const csv_options &options)
+{
+    auto writer = append_rows();
+    auto parser = detail::csv_parser(options, workbook().base_date());
+    parser.parse(stream, csv_appender(writer));
+}
+
+row_t worksheet::highest_row() const
+{
+    row_t highest = constants::min_row();
+
+    for (const auto &row : d_->cell_map_)
+    {
+        highest = std::max(highest, row.first);
+    }
+
+    if (d_->row_store_)
+    {
+        for (const auto &row : d_->row_store_->spilled())
+        {
+            highest = std::max(highest, row.first);
+        }
+    }
+
+    return highest;
+}
+
+column_t worksheet::highest_column() const
+{
+    column_t highest = constants::min_column();
+
+    for (auto &row : d_->cell_map_)
+    {
+        for (auto &c : *row.second)
+        {
+            highest = std::max(highest, c.first);
+        }
+    }
+
+    if (d_->row_store_)
+    {
+        for (auto &row : d_->row_store_->spilled())
+        {
+            highest = std::max(highest, column_t(row.second.last_column));
+        }
+    }
+
+    return highest;
+}
+
+range_reference worksheet::calculate_dimension() const
+{
+    return range_reference(lowest_column(), lowest_row(), highest_column(), highest_row());
+}
+
+range_statistics worksheet::column_stats(column_t column, bool parallel) const
+{
+    return statistics(range_reference(column, 1, column, constants::max_row()), parallel);
+}
+
+range_statistics worksheet::statistics(const range_reference &reference, bool parallel) const
+{
+    const auto first_column = reference.top_left().column();
+    const auto last_column = reference.bottom_right().column();
+    const auto width = static_cast<std::size_t>((last_column - first_column).index + 1);
+
+    auto rows = d_->row_indices();
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&reference](row_t row) {
+        return row < reference.top_left().row() || row > reference.bottom_right().row();
+    }), rows.end());
+    std::sort(rows.begin(), rows.end());
+
+    // numbers are copied out of the rows into a contiguous buffer to be reduced
+    const auto summarize = [this, first_column, last_column, width, &rows](std::size_t begin, std::size_t end) {
+        auto values = std::vector<double>();
+        values.reserve(end - begin);
+
+        for (auto i = begin; i < end; ++i)
+        {
+            auto entry = d_->find_row(rows[i]);
+            if (entry == nullptr) continue;
+
+            const auto &cells = **entry;
+
+            if (width < cells.size())
+            {
+                for (auto column = first_column; column <= last_column; ++column)
+                {
+                    const auto match = cells.find(column);
+
+                    if (match != cells.end() && match->second.type_ == cell::type::number)
+                    {
+                        values.push_back(static_cast<double>(match->second.value_numeric_));
+                    }
+                }
+            }
+            else
+            {
+                for (const auto &cell : cells)
+                {
+                    if (cell.second.type_ == cell::type::number
+                        && cell.first >= first_column && cell.first <= last_column)
+                    {
+                        values.push_back(static_cast<double>(cell.second.value_numeric_));
+                    }
+                }
+            }
+        }
+
+        return range_statistics(values);
+    };
+
+    // rows read back from disk change the sheet, so those are only read by one thread
+    const auto minimum_rows = std::size_t(16384);
+    const auto thread_count = std::min<std::size_t>(std::thread::hardware_concurrency(), rows.size() / minimum_rows);
+
+    if (!parallel || d_->row_store_ || thread_count < 2)
+    {
+        return summarize(0, rows.size());
+    }
+
+    auto partial = std::vector<range_statistics>(thread_count);
+    auto threads = std::vector<std::thread>();
+
+    for (std::size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&summarize, &partial, &rows, thread_count, t]() {
+            partial[t] = summarize(rows.size() * t / thread_count, rows.size() * (t + 1) / thread_count);
+        });
+    }
+
+    auto result = range_statistics();
+
+    for (std::size_t t = 0; t < thread_count; ++t)
+    {
+        threads[t].join();
+        result += partial[t];
+    }
+
+    return result;
+}
+
+std::shared_ptr<const computed_style> worksheet::resolve_style(const detail::format_impl *format) const
+{
+    // the stylesheet fills its cache here, which other sheets may do at the same time while being populated
+    auto lock = d_->population_mutex_ == nullptr
+        ? std::unique_lock<std::recursive_mutex>()
+        : std::unique_lock<std::recursive_mutex>(*d_->population_mutex_);
+
+    if (format != nullptr)
+    {
+        return format->parent->computed(format);
+    }
+
+    const auto &stylesheet = d_->parent_->d_->stylesheet_;
+
+    if (stylesheet == nullptr)
+    {
+        return std::make_shared<const computed_style>();
+    }
+
+    return stylesheet->computed(nullptr);
+}
+
+std::vector<std::shared_ptr<const computed_style>> worksheet::computed_styles(const range_reference &reference) const
+{
+    const auto top = reference.top_left().row();
+    const auto left = reference.top_left().column();
+    const auto right = reference.bottom_right().column();
+    const auto width = static_cast<std::size_t>(right.index - left.index + 1);
+    const auto height = static_cast<std::size_t>(reference.bottom_right().row() - top + 1);
+
+    std::vector<std::shared_ptr<const computed_style>> styles(width * height, resolve_style(nullptr));
+
+    for (auto row : d_->row_indices())
+    {
+        if (row < top || row > reference.bottom_right().row()) continue;
+
+        auto entry = d_->find_row(row);
+        if (entry == nullptr) continue;
+
+        const auto offset = (row - top) * width;
+
+        for (const auto &cell : **entry)
+        {
+            if (cell.first < left || cell.first > right || !cell.second.format_.is_set()) continue;
+
+            styles[offset + (cell.first.index - left.index)] = resolve_style(cell.second.format_.get());
+        }
+    }
+
+    return styles;
+}
+
+void worksheet::sort_rows(const range_reference &reference, const std::vector<sort_key> &keys)
+{
+    const auto top = reference.top_left().row();
+    const auto bottom = reference.bottom_right().row();
+    const auto left = reference.top_left().column();
+    const auto right = reference.bottom_right().column();
+
+    if (keys.empty())
+    {
+        throw invalid_parameter();
+    }
+
+    for (const auto &key : keys)
+    {
+        if (key.column < left || key.column > right)
+        {
+            throw invalid_parameter();
+        }
+    }
+
+    for (const auto &merged : d_->merged_cells_.ranges())
+    {
+        if (merged.top_left().row() <= bottom && merged.bottom_right().row() >= top
+            && merged.top_left().column() <= right && merged.bottom_right().column() >= left)
+        {
+            throw invalid_parameter();
+        }
+    }
+
+    auto rows = d_->row_indices();
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                   [top, bottom](row_t row) { return row < top || row > bottom; }),
+        rows.end());
+
+    if (rows.empty()) return;
+
+    // rows after the last one with cells are empty and stay last
+    const auto count = static_cast<std::size_t>(*std::max_element(rows.begin(), rows.end()) - top + 1);
+    const auto width = keys.size();
+
+    std::vector<sort_value> values(count * width);
+    std::vector<std::string> texts;
+
+    for (auto row : rows)
+    {
+        auto entry = d_->find_row(row);
+        if (entry == nullptr) continue;
+
+        for (std::size_t k = 0; k < width; ++k)
+        {
+            const auto match = (*entry)->find(keys[k].column);
+            if (match == (*entry)->end()) continue;
+
+            const auto &cell = match->second;
+            auto &value = values[(row - top) * width + k];
+            auto text = std::string();
+
+            switch (cell.type_)
+            {
+            case cell::type::empty:
+                continue;
+
+            case cell::type::number:
+            case cell::type::date:
+                value.rank = 0;
+                value.number = cell.value_numeric_;
+                continue;
+
+            case cell::type::boolean:
+                value.rank = 2;
+                value.number = cell.value_numeric_;
+                continue;
+
+            case cell::type::error:
+                value.rank = 3;
+                continue;
+
+            case cell::type::inline_string:
+            case cell::type::formula_string:
+                text = cell.value_text_.plain_text();
+                break;
+
+            case cell::type::shared_string:
+            {
+                const auto index = static_cast<std::size_t>(cell.value_numeric_);
+                text = d_->local_strings_ && d_->local_strings_->contains(index)
+                    ? d_->local_strings_->at(index).plain_text()
+                    : workbook().shared_strings().at(index).plain_text();
+                break;
+            }
+            }
+
+            std::transform(text.begin(), text.end(), text.begin(),
+                [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+
+            value.rank = 1;
+            value.text = texts.size();
+            texts.push_back(std::move(text));
+        }
+    }
+
+    std::vector<std::uint32_t> order(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        order[i] = static_cast<std::uint32_t>(i);
+    }
+
+    parallel_stable_sort(order, [&values, &texts, &keys, width](std::uint32_t a, std::uint32_t b) {
+        for (std::size_t k = 0; k < width; ++k)
+        {
+            const auto &first = values[a * width + k];
+            const auto &second = values[b * width + k];
+            auto comparison = compare_sort_values(first, second, texts);
+
+            // empty cells stay last when sorting in descending order
+            if (!keys[k].ascending && first.rank != 4 && second.rank != 4)
+            {
+                comparison = -comparison;
+            }
+
+            if (comparison != 0) return comparison < 0;
+        }
+
+        return false;
+    });
+
+    bool unchanged = true;
+
+    for (std::size_t i = 0; i < count && unchanged; ++i)
+    {
+        unchanged = order[i] == i;
+    }
+
+    if (unchanged) return;
+
+    // cells derived from a shared formula get their own copy of it, since the
+    // group no longer has the same shape once they move
+    std::vector<cell_reference> shared;
+
+    for_each_existing_cell(*d_, range_reference(left, top, right, bottom), [&shared](detail::cell_impl &cell) {
+        if (cell.shared_formula_.is_set())
+        {
+            shared.emplace_back(cell.column_, cell.row_);
+        }
+    });
+
+    for (const auto &reference : shared)
+    {
+        auto &cell = d_->mutable_row(reference.row()).at(reference.column());
+        if (!cell.shared_formula_.is_set()) continue;
+
+        const auto text = xlnt::cell(&cell).formula();
+        unshare_formula(cell);
+        d_->mutable_row(reference.row()).at(reference.column()).formula_ = text;
+    }
+
+    std::vector<std::vector<detail::cell_impl>> payloads(count);
+
+    for (auto row : rows)
+    {
+        auto &cells = d_->mutable_row(row);
+        auto &payload = payloads[row - top];
+
+        for (auto cell = cells.begin(); cell != cells.end();)
+        {
+            if (cell->first < left || cell->first > right)
+            {
+                ++cell;
+                continue;
+            }
+
+            if (cell->second.formula_.is_set())
+            {
+                d_->formula_cells_.erase(detail::worksheet_impl::cell_key(cell->first, row));
+            }
+
+            payload.push_back(std::move(cell->second));
+            cell = cells.erase(cell);
+        }
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto &payload = payloads[order[i]];
+        if (payload.empty()) continue;
+
+        const auto row = static_cast<row_t>(top + i);
+        d_->create_row(row);
+        auto &cells = d_->mutable_row(row);
+
+        for (auto &cell : payload)
+        {
+            if (cell.formula_.is_set())
+            {
+                if (cell.row_ != row)
+                {
+                    cell.formula_ = formula_translator(cell.formula_.get(), cell_reference(cell.column_, cell.row_))
+                                        .translate(cell_reference(cell.column_, row));
+                }
+
+                d_->formula_cells_.insert(detail::worksheet_impl::cell_key(cell.column_, row));
+            }
+
+            cell.row_ = row;
+            cell.parent_ = d_;
+
+            const auto column = cell.column_;
+            cells.emplace(column, std::move(cell));
+        }
+    }
+
+    if (!d_->row_store_)
+    {
+        for (auto row : rows)
+        {
+            const auto match = d_->cell_map_.find(row);
+
+            if (match != d_->cell_map_.end() && match->second->empty())
+            {
+                d_->cell_map_.erase(match);
+            }
+        }
+    }
+}
+
+void worksheet::move_lines(bool rows, std::uint32_t first, long long offset)
+{
+    if (first < 1)
+    {
+        throw invalid_parameter();
+    }
+
+    if (offset == 0) return;
+
+    if (offset > 0 && d_->has_rows())
+    {
+        const auto last = rows ? highest_row() : highest_column().index;
+        const auto limit = rows ? constants::max_row() : constants::max_column().index;
+
+        if (last >= first && static_cast<long long>(last) + offset > static_cast<long long>(limit))
+        {
+            throw invalid_parameter();
+        }
+    }
+
+    // the last line deleted, or the first line that isn't
+    const auto deleted_end = offset < 0 ? static_cast<long long>(first) - offset : static_cast<long long>(first);
+
+    // where index ends up, or 0 if it's deleted
+    const auto moved = [first, offset, deleted_end](std::uint32_t index) -> std::uint32_t {
+        if (index < first) return index;
+        if (index < deleted_end) return 0;
+
+        return static_cast<std::uint32_t>(static_cast<long long>(index) + offset);
+    };
+
+    auto &wb = *d_->parent_;
+
+    // formulas of any sheet can refer to this one
+    for (auto &impl : wb.d_->worksheets_)
+    {
+        wb.load_deferred_sheet(impl);
+    }
+
+    for (auto &impl : wb.d_->worksheets_)
+    {
+        const auto local = &impl == d_;
+
+        // a shared formula stays shared only if none of its cells or references move
+        std::vector<std::uint32_t> dissolved;
+
+        for (const auto &entry : impl.shared_formulae_)
+        {
+            const auto &shared = entry.second;
+            const auto translator = formula_translator(shared.formula_, shared.anchor_);
+            const auto text = rows ? translator.shift_rows(d_->title_, local, first, offset)
+                                   : translator.shift_columns(d_->title_, local, first, offset);
+            const auto end = rows ? shared.range_.bottom_right().row() : shared.range_.bottom_right().column_index();
+
+            if (text != shared.formula_ || (local && end >= first))
+            {
+                dissolved.push_back(entry.first);
+            }
+        }
+
+        for (auto index : dissolved)
+        {
+            dissolve_shared_formula(impl, index);
+        }
+
+        auto changed = !dissolved.empty();
+
+        for (auto key : std::vector<std::uint64_t>(impl.formula_cells_.begin(), impl.formula_cells_.end()))
+        {
+            const auto row = static_cast<row_t>(key >> 32);
+            auto &cell = impl.mutable_row(row).at(column_t(static_cast<column_t::index_t>(key)));
+            if (!cell.formula_.is_set()) continue;
+
+            const auto translator = formula_translator(cell.formula_.get(), cell_reference(cell.column_, row));
+            auto text = rows ? translator.shift_rows(d_->title_, local, first, offset)
+                             : translator.shift_columns(d_->title_, local, first, offset);
+
+            if (text != cell.formula_.get())
+            {
+                cell.formula_ = std::move(text);
+                changed = true;
+            }
+        }
+
+        for (auto named = impl.named_ranges_.begin(); named != impl.named_ranges_.end();)
+        {
+            auto targets = named->second.targets();
+
+            for (auto target = targets.begin(); target != targets.end();)
+            {
+                if (target->first.d_ == d_ && !move_reference(target->second, d_->title_, rows, first, offset))
+                {
+                    target = targets.erase(target);
+                }
+                else
+                {
+                    ++target;
+                }
+            }
+
+            // a name whose every target was deleted no longer refers to anything
+            if (targets.empty())
+            {
+                named = impl.named_ranges_.erase(named);
+                continue;
+            }
+
+            named->second = xlnt::named_range(named->second.name(), targets);
+            ++named;
+        }
 
-    auto &primary_view = d_->views_.front();
+        if (changed && !local)
+        {
+            impl.source_part_.clear();
+        }
+    }
 
-    primary_view.clear_selections();
-    primary_view.clear_pane();
-}
+    std::unordered_set<std::uint64_t> formula_cells;
+    formula_cells.reserve(d_->formula_cells_.size());
 
-cell worksheet::cell(const cell_reference &reference)
-{
-    if (d_->cell_map_.find(reference.row()) == d_->cell_map_.end())
+    for (auto key : d_->formula_cells_)
     {
-        d_->cell_map_[reference.row()] = std::unordered_map<column_t, detail::cell_impl>();
+        auto row = static_cast<row_t>(key >> 32);
+        auto column = static_cast<column_t::index_t>(key);
+        (rows ? row : column) = moved(rows ? row : column);
+
+        if (row != 0 && column != 0)
+        {
+            formula_cells.insert(detail::worksheet_impl::cell_key(column, row));
+        }
     }
 
-    auto &row = d_->cell_map_[reference.row()];
+    d_->formula_cells_.swap(formula_cells);
 
-    if (row.find(reference.column_index()) == row.end())
+    if (rows)
     {
-        auto &impl = row[reference.column_index()] = detail::cell_impl();
-        impl.parent_ = d_;
-        impl.column_ = reference.column_index();
-        impl.row_ = reference.row();
-    }
+        // rows are renumbered without reading back the ones that were moved out of memory
+        std::vector<row_t> deleted;
 
-    return xlnt::cell(&row[reference.column_index()]);
-}
+        if (static_cast<std::size_t>(deleted_end - first) < d_->cell_map_.size())
+        {
+            for (auto row = static_cast<long long>(first); row < deleted_end; ++row)
+            {
+                deleted.push_back(static_cast<row_t>(row));
+            }
+        }
+        else
+        {
+            deleted = d_->row_indices();
+        }
 
-const cell worksheet::cell(const cell_reference &reference) const
-{
-    return xlnt::cell(&d_->cell_map_.at(reference.row()).at(reference.column_index()));
-}
+        for (auto row : deleted)
+        {
+            if (row >= first && row < deleted_end)
+            {
+                d_->cell_map_.erase(row);
+                if (d_->row_store_) d_->row_store_->erase(row);
+            }
+        }
 
-cell worksheet::cell(xlnt::column_t column, row_t row)
-{
-    return cell(cell_reference(column, row));
-}
+        std::vector<row_t> moving;
 
-const cell worksheet::cell(xlnt::column_t column, row_t row) const
-{
-    return cell(cell_reference(column, row));
-}
+        for (const auto &entry : d_->cell_map_)
+        {
+            if (entry.first >= deleted_end) moving.push_back(entry.first);
+        }
 
-bool worksheet::has_cell(const cell_reference &reference) const
-{
-    const auto row = d_->cell_map_.find(reference.row());
-    if (row == d_->cell_map_.cend()) return false;
+        // rows move into the entries of the rows that moved before them, so only
+        // the entries at either end are created or erased
+        if (offset > 0)
+        {
+            std::sort(moving.begin(), moving.end(), std::greater<row_t>());
+        }
+        else
+        {
+            std::sort(moving.begin(), moving.end());
+        }
 
-    const auto col = row->second.find(reference.column_index());
-    if (col == row->second.cend()) return false;
+        for (auto source : moving)
+        {
+            const auto row = moved(source);
+            auto cells = std::move(d_->cell_map_.at(source));
 
-    return true;
-}
+            if (cells.use_count() > 1)
+            {
+                cells = d_->make_row(*cells);
+            }
 
-bool worksheet::has_row_properties(row_t row) const
-{
-    return d_->row_properties_.find(row) != d_->row_properties_.end();
-}
+            for (auto &cell : *cells)
+            {
+                cell.second.row_ = row;
+                cell.second.parent_ = d_;
+            }
 
-range worksheet::named_range(const std::string &name)
-{
-    if (!workbook().has_named_range(name))
-    {
-        throw key_not_found();
-    }
+            d_->cell_map_[row] = std::move(cells);
+        }
 
-    if (!has_named_range(name))
-    {
-        throw key_not_found();
-    }
+        for (auto source : moving)
+        {
+            const auto match = d_->cell_map_.find(source);
 
-    return range(d_->named_ranges_[name].targets()[0].second);
-}
+            if (match != d_->cell_map_.end() && !match->second)
+            {
+                d_->cell_map_.erase(match);
+            }
+        }
 
-const range worksheet::named_range(const std::string &name) const
-{
-    if (!workbook().has_named_range(name))
-    {
-        throw key_not_found();
-    }
+        if (d_->row_store_)
+        {
+            d_->row_store_->shift(static_cast<row_t>(deleted_end), offset);
+        }
 
-    if (!has_named_range(name))
-    {
-        throw key_not_found();
-    }
+        std::unordered_map<row_t, xlnt::row_properties> properties;
 
-    return range(d_->named_ranges_[name].targets()[0].second);
-}
+        for (const auto &entry : d_->row_properties_)
+        {
+            const auto row = moved(entry.first);
+            if (row != 0) properties.emplace(row, entry.second);
+        }
 
-column_t worksheet::lowest_column() const
-{
-    if (d_->cell_map_.empty())
-    {
-        return constants::min_column();
+        d_->row_properties_.swap(properties);
     }
+    else
+    {
+        for (auto row : d_->row_indices())
+        {
+            if (d_->row_store_ && d_->row_store_->is_spilled(row)
+                && d_->row_store_->spilled().at(row).last_column < first)
+            {
+                continue;
+            }
 
-    column_t lowest = constants::max_column();
+            auto &cells = d_->mutable_row(row);
+            std::vector<detail::cell_impl> shifted;
 
-    for (auto &row : d_->cell_map_)
-    {
-        for (auto &c : row.second)
+            for (auto cell = cells.begin(); cell != cells.end();)
+            {
+                if (cell->first < first)
+                {
+                    ++cell;
+                    continue;
+                }
+
+                if (moved(cell->first.index) != 0)
+                {
+                    shifted.push_back(std::move(cell->second));
+                }
+
+                cell = cells.erase(cell);
+            }
+
+            for (auto &cell : shifted)
+            {
+                cell.column_ = moved(cell.column_.index);
+
+                const auto column = cell.column_;
+                cells.emplace(column, std::move(cell));
+            }
+        }
+
+        std::unordered_map<column_t, xlnt::column_properties> properties;
+
+        for (const auto &entry : d_->column_properties_)
         {
-            lowest = std::min(lowest, c.first);
+            const auto column = moved(entry.first.index);
+            if (column != 0) properties.emplace(column, entry.second);
         }
+
+        d_->column_properties_.swap(properties);
     }
 
-    return lowest;
-}
+    detail::merged_range_index merged_cells;
 
-row_t worksheet::lowest_row() const
-{
-    if (d_->cell_map_.empty())
+    for (auto merged : d_->merged_cells_.ranges())
     {
-        return constants::min_row();
+        if (move_reference(merged, d_->title_, rows, first, offset))
+        {
+            merged_cells.add(merged);
+        }
     }
 
-    row_t lowest = constants::max_row();
+    d_->merged_cells_ = merged_cells;
 
-    for (auto &row : d_->cell_map_)
+    if (d_->auto_filter_.is_set())
     {
-        lowest = std::min(lowest, row.first);
+        auto filter = d_->auto_filter_.get();
+
+        if (move_reference(filter, d_->title_, rows, first, offset))
+        {
+            d_->auto_filter_ = filter;
+        }
+        else
+        {
+            d_->auto_filter_.clear();
+        }
     }
 
-    return lowest;
-}
+    if (d_->print_area_.is_set())
+    {
+        auto area = d_->print_area_.get();
 
-row_t worksheet::highest_row() const
-{
-    row_t highest = constants::min_row();
+        if (move_reference(area, d_->title_, rows, first, offset))
+        {
+            d_->print_area_ = area;
+        }
+        else
+        {
+            d_->print_area_.clear();
+        }
+    }
 
-    for (auto &row : d_->cell_map_)
+    auto &titles = rows ? d_->print_title_rows_ : d_->print_title_cols_;
+
+    if (!titles.empty())
     {
-        highest = std::max(highest, row.first);
+        const auto translator = formula_translator(titles, cell_reference("A1"));
+        titles = rows ? translator.shift_rows(d_->title_, true, first, offset)
+                      : translator.shift_columns(d_->title_, true, first, offset);
+
+        if (titles == "#REF!") titles.clear();
     }
 
-    return highest;
-}
+    if (rows)
+    {
+        std::vector<row_t> breaks;
 
-column_t worksheet::highest_column() const
-{
-    column_t highest = constants::min_column();
+        for (auto row : d_->row_breaks_)
+        {
+            if (moved(row) != 0) breaks.push_back(moved(row));
+        }
 
-    for (auto &row : d_->cell_map_)
+        d_->row_breaks_ = breaks;
+    }
+    else
     {
-        for (auto &c : row.second)
+        std::vector<column_t> breaks;
+
+        for (auto column : d_->column_breaks_)
         {
-            highest = std::max(highest, c.first);
+            if (moved(column.index) != 0) breaks.push_back(moved(column.index));
         }
-    }
 
-    return highest;
-}
+        d_->column_breaks_ = breaks;
+    }
 
-range_reference worksheet::calculate_dimension() const
-{
-    return range_reference(lowest_column(), lowest_row(), highest_column(), highest_row());
+    // what formulas depend on has changed throughout
+    if (wb.d_->formula_evaluator_)
+    {
+        wb.d_->formula_evaluator_ = std::make_shared<detail::formula_evaluator>();
+    }
 }
 
 range worksheet::range(const std::string &reference_string)
@@ -542,57 +1632,62 @@ void worksheet::unmerge_cells(const std::string &reference_string)
 
 void worksheet::merge_cells(const range_reference &reference)
 {
-    d_->merged_cells_.push_back(reference);
-    bool first = true;
+    d_->merged_cells_.add(reference);
 
-    for (auto row : range(reference))
-    {
-        for (auto cell : row)
-        {
-            cell.merged(true);
+    // covered cells are merged implicitly so only existing ones need clearing
+    const auto anchor = reference.top_left();
 
-            if (!first)
-            {
-                if (cell.data_type() == cell::type::shared_string)
-                {
-                    cell.value("");
-                }
-                else
-                {
-                    cell.clear_value();
-                }
-            }
+    for_each_existing_cell(*d_, reference, [anchor](detail::cell_impl &impl) {
+        if (impl.column_ == anchor.column() && impl.row_ == anchor.row()) return;
 
-            first = false;
+        auto covered = xlnt::cell(&impl);
+
+        if (covered.data_type() == cell::type::shared_string)
+        {
+            covered.value("");
         }
-    }
+        else
+        {
+            covered.clear_value();
+        }
+    });
 }
 
 void worksheet::unmerge_cells(const range_reference &reference)
 {
-    auto match = std::find(d_->merged_cells_.begin(), d_->merged_cells_.end(), reference);
-
-    if (match == d_->merged_cells_.end())
+    if (!d_->merged_cells_.remove(reference))
     {
         throw invalid_parameter();
     }
 
-    d_->merged_cells_.erase(match);
+    for_each_existing_cell(*d_, reference, [](detail::cell_impl &impl) { impl.is_merged_ = false; });
+}
 
-    for (auto row : range(reference))
-    {
-        for (auto cell : row)
-        {
-            cell.merged(false);
-        }
-    }
+void worksheet::insert_rows(row_t row, std::uint32_t amount)
+{
+    move_lines(true, row, amount);
+}
+
+void worksheet::insert_columns(column_t column, std::uint32_t amount)
+{
+    move_lines(false, column.index, amount);
+}
+
+void worksheet::delete_rows(row_t row, std::uint32_t amount)
+{
+    move_lines(true, row, -static_cast<long long>(amount));
+}
+
+void worksheet::delete_columns(column_t column, std::uint32_t amount)
+{
+    move_lines(false, column.index, -static_cast<long long>(amount));
 }
 
 row_t worksheet::next_row() const
 {
     auto row = highest_row() + 1;
 
-    if (row == 2 && d_->cell_map_.size() == 0)
+    if (row == 2 && !d_->has_rows())
     {
         row = 1;
     }
@@ -650,22 +1745,26 @@ bool worksheet::compare(const worksheet &other, bool reference) const
 
     if (d_->parent_ != other.d_->parent_) return false;
 
-    for (auto &row : d_->cell_map_)
+    for (auto row_index : d_->row_indices())
     {
-        if (other.d_->cell_map_.find(row.first) == other.d_->cell_map_.end())
+        const auto other_row = other.d_->find_row(row_index);
+
+        if (other_row == nullptr)
         {
             return false;
         }
 
-        for (auto &cell : row.second)
+        for (auto &cell : **d_->find_row(row_index))
         {
-            if (other.d_->cell_map_[row.first].find(cell.first) == other.d_->cell_map_[row.first].end())
+            const auto other_cell_impl = (*other_row)->find(cell.first);
+
+            if (other_cell_impl == (*other_row)->end())
             {
                 return false;
             }
 
             xlnt::cell this_cell(&cell.second);
-            xlnt::cell other_cell(&other.d_->cell_map_[row.first][cell.first]);
+            xlnt::cell other_cell(&other_cell_impl->second);
 
             if (this_cell.data_type() != other_cell.data_type())
             {
@@ -736,6 +1835,26 @@ void worksheet::reserve(std::size_t n)
     d_->cell_map_.reserve(n);
 }
 
+void worksheet::max_resident_cells(std::size_t count)
+{
+    if (d_->row_store_)
+    {
+        d_->row_store_->max_resident_cells(count);
+    }
+    else
+    {
+        d_->row_store_.reset(new detail::row_store(count));
+    }
+
+    for (auto row : d_->row_indices())
+    {
+        if (d_->cell_map_.count(row) > 0)
+        {
+            d_->use_row(row);
+        }
+    }
+}
+
 class header_footer worksheet::header_footer() const
 {
     return d_->header_footer_.get();
@@ -903,9 +2022,50 @@ void worksheet::register_comments_in_manifest()
     workbook().register_worksheet_part(*this, relationship_type::comments);
 }
 
-void worksheet::register_calc_chain_in_manifest()
+void worksheet::add_formula_cell(const cell_reference &reference)
+{
+    auto &formula_cells = d_->formula_cells_;
+    formula_cells.insert(detail::worksheet_impl::cell_key(reference.column(), reference.row()));
+
+    if (formula_cells.size() == 1)
+    {
+        workbook().register_workbook_part(relationship_type::calculation_chain);
+    }
+}
+
+void worksheet::remove_formula_cell(const cell_reference &reference)
+{
+    auto &formula_cells = d_->formula_cells_;
+
+    if (formula_cells.erase(detail::worksheet_impl::cell_key(reference.column(), reference.row())) == 1
+        && formula_cells.empty())
+    {
+        workbook().garbage_collect_formulae();
+    }
+}
+
+void worksheet::unshare_formula(detail::cell_impl &cell)
 {
-    workbook().register_workbook_part(relationship_type::calculation_chain);
+    if (!cell.shared_formula_.is_set()) return;
+
+    const auto index = cell.shared_formula_.get();
+    cell.shared_formula_.clear();
+
+    const auto match = d_->shared_formulae_.find(index);
+    if (match == d_->shared_formulae_.end()) return;
+
+    const auto shared = match->second;
+    if (shared.anchor_ != cell_reference(cell.column_, cell.row_)) return;
+
+    d_->shared_formulae_.erase(match);
+    const auto translator = formula_translator(shared.formula_, shared.anchor_);
+
+    for_each_existing_cell(*d_, shared.range_, [&translator, index](detail::cell_impl &member) {
+        if (!member.shared_formula_.is_set() || member.shared_formula_.get() != index) return;
+
+        member.shared_formula_.clear();
+        member.formula_ = translator.translate(cell_reference(member.column_, member.row_));
+    });
 }
 
 bool worksheet::has_header_footer() const
@@ -972,11 +2132,6 @@ double worksheet::row_height(row_t row) const
     }
 }
 
-void worksheet::garbage_collect_formulae()
-{
-    workbook().garbage_collect_formulae();
-}
-
 void worksheet::parent(xlnt::workbook &wb)
 {
     d_->parent_ = &wb;
@@ -984,7 +2139,23 @@ void worksheet::parent(xlnt::workbook &wb)
 
 conditional_format worksheet::conditional_format(const range_reference &ref, const condition &when)
 {
-	return workbook().d_->stylesheet_.get().add_conditional_format_rule(d_, ref, when);
+	return workbook().modifiable_stylesheet().add_conditional_format_rule(d_, ref, when);
+}
+
+std::vector<std::pair<cell_reference, xlnt::conditional_format>> worksheet::evaluate_conditional_formats() const
+{
+    auto formats = std::vector<std::pair<cell_reference, xlnt::conditional_format>>();
+    const auto &stylesheet = workbook().d_->stylesheet_;
+    if (stylesheet == nullptr) return formats;
+
+    auto evaluator = detail::conditional_format_evaluator(*d_);
+
+    for (const auto &applied : evaluator.evaluate(stylesheet->conditional_format_impls))
+    {
+        formats.emplace_back(applied.first, xlnt::conditional_format(applied.second));
+    }
+
+    return formats;
 }
 
 } // namespace xlnt
@@ -0,0 +1,249 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <iostream>
+
+#include <helpers/test_suite.hpp>
+#include <xlntarrow.hpp>
+
+class xlntarrow_test_suite : public test_suite
+{
+public:
+    xlntarrow_test_suite()
+    {
+        register_test(test_infer_schema);
+        register_test(test_round_trip);
+        register_test(test_column_origin);
+        register_test(test_read_types);
+        register_test(test_dictionary);
+        register_test(test_unsupported_types);
+        register_test(test_threads);
+    }
+
+    void test_infer_schema()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("flag");
+        ws.cell("B1").value("number");
+        ws.cell("C1").value("date");
+        ws.cell("D1").value("name");
+        ws.cell("E1").value("mixed");
+        ws.cell("F1").value("empty");
+
+        ws.cell("A2").value(true);
+        ws.cell("B2").value(1.5);
+        ws.cell("C2").value(xlnt::date(2020, 1, 2));
+        ws.cell("D2").value("a");
+        ws.cell("E2").value("a");
+        ws.cell("E3").value(2);
+
+        auto schema = xlnt::infer_schema(ws);
+
+        xlnt_assert_equals(schema->num_fields(), 6);
+        xlnt_assert_equals(schema->field(0)->name(), "flag");
+        xlnt_assert(schema->field(0)->type()->Equals(*arrow::boolean()));
+        xlnt_assert(schema->field(1)->type()->Equals(*arrow::float64()));
+        xlnt_assert(schema->field(2)->type()->Equals(*arrow::timestamp(arrow::TimeUnit::MILLI)));
+        xlnt_assert_equals(schema->field(3)->type()->id(), arrow::Type::DICTIONARY);
+        xlnt_assert(schema->field(4)->type()->Equals(*arrow::utf8()));
+        xlnt_assert(schema->field(5)->type()->Equals(*arrow::null()));
+    }
+
+    void test_round_trip()
+    {
+        arrow::Int64Builder numbers;
+        numbers.Append(1);
+        numbers.AppendNull();
+        numbers.Append(-3);
+        std::shared_ptr<arrow::Array> number_array;
+        numbers.Finish(&number_array);
+
+        arrow::StringBuilder strings;
+        strings.Append("x");
+        strings.Append("y");
+        strings.AppendNull();
+        std::shared_ptr<arrow::Array> string_array;
+        strings.Finish(&string_array);
+
+        arrow::Date32Builder dates;
+        dates.Append(0);
+        dates.Append(18263);
+        dates.AppendNull();
+        std::shared_ptr<arrow::Array> date_array;
+        dates.Finish(&date_array);
+
+        auto schema = arrow::schema({arrow::field("n", arrow::int64()),
+            arrow::field("s", arrow::utf8()), arrow::field("d", arrow::date32())});
+        auto table = std::make_shared<arrow::Table>(schema, std::vector<std::shared_ptr<arrow::Column>>{
+            std::make_shared<arrow::Column>(schema->field(0), number_array),
+            std::make_shared<arrow::Column>(schema->field(1), string_array),
+            std::make_shared<arrow::Column>(schema->field(2), date_array)});
+
+        xlnt::workbook wb;
+        xlnt::arrow2xlsx(*table, wb.active_sheet());
+
+        xlnt_assert_equals(wb.active_sheet().cell("A1").value<std::string>(), "n");
+        xlnt_assert(wb.active_sheet().cell("C3").is_date());
+
+        auto result = xlnt::xlsx2arrow(wb.active_sheet(), schema);
+
+        xlnt_assert_equals(result->num_rows(), 3);
+        xlnt_assert(result->Equals(*table));
+    }
+
+    void test_column_origin()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        // column A is empty but is still read as the first field
+        ws.cell("B1").value("b");
+        ws.cell("B2").value(2);
+
+        auto table = xlnt::xlsx2arrow(ws);
+
+        xlnt_assert_equals(table->num_columns(), 2);
+        xlnt_assert_equals(table->column(0)->name(), "A");
+        xlnt_assert_equals(table->column(1)->name(), "b");
+
+        xlnt::workbook copy;
+        xlnt::arrow2xlsx(*table, copy.active_sheet());
+
+        xlnt_assert(!copy.active_sheet().cell("A2").has_value());
+        xlnt_assert_equals(copy.active_sheet().cell("B2").value<int>(), 2);
+    }
+
+    void test_read_types()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("value");
+        ws.cell("A2").value(true);
+        ws.cell("A3").value(42);
+        ws.cell("A4").value(xlnt::datetime(1970, 1, 2, 12, 0, 0));
+        ws.cell("A5").value("text");
+
+        auto frozen = wb.freeze();
+        auto sheet = frozen.sheet_by_index(0);
+
+        auto as_int = xlnt::xlsx2arrow(sheet, arrow::schema({arrow::field("value", arrow::int16())}));
+        auto ints = std::static_pointer_cast<arrow::Int16Array>(as_int->column(0)->data()->chunk(0));
+        xlnt_assert_equals(ints->Value(0), 1);
+        xlnt_assert_equals(ints->Value(1), 42);
+        xlnt_assert(ints->IsNull(3));
+
+        auto as_date = xlnt::xlsx2arrow(sheet, arrow::schema({arrow::field("value", arrow::date64())}));
+        auto dates = std::static_pointer_cast<arrow::Date64Array>(as_date->column(0)->data()->chunk(0));
+        xlnt_assert_equals(dates->Value(2), 86400000);
+
+        auto timestamp_type = arrow::timestamp(arrow::TimeUnit::SECOND);
+        auto as_timestamp = xlnt::xlsx2arrow(sheet, arrow::schema({arrow::field("value", timestamp_type)}));
+        auto timestamps = std::static_pointer_cast<arrow::TimestampArray>(as_timestamp->column(0)->data()->chunk(0));
+        xlnt_assert_equals(timestamps->Value(2), 86400 + 43200);
+
+        auto as_text = xlnt::xlsx2arrow(sheet, arrow::schema({arrow::field("value", arrow::utf8())}));
+        auto text = std::static_pointer_cast<arrow::StringArray>(as_text->column(0)->data()->chunk(0));
+        xlnt_assert_equals(text->GetString(0), "TRUE");
+        xlnt_assert_equals(text->GetString(1), "42");
+        xlnt_assert_equals(text->GetString(2), "1970-01-02T12:00:00Z");
+        xlnt_assert_equals(text->GetString(3), "text");
+    }
+
+    void test_dictionary()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("name");
+        ws.cell("A2").value("b");
+        ws.cell("A3").value("a");
+        ws.cell("A4").value("b");
+
+        // strings elsewhere in the workbook aren't part of the column's dictionary
+        wb.create_sheet().cell("A1").value("unrelated");
+
+        auto type = arrow::dictionary(arrow::int8(), std::make_shared<arrow::NullArray>(0));
+        auto table = xlnt::xlsx2arrow(ws, arrow::schema({arrow::field("name", type)}));
+        auto column = std::static_pointer_cast<arrow::DictionaryArray>(table->column(0)->data()->chunk(0));
+        auto values = std::static_pointer_cast<arrow::StringArray>(column->dictionary());
+        auto indices = std::static_pointer_cast<arrow::Int8Array>(column->indices());
+
+        xlnt_assert_equals(values->length(), 2);
+        xlnt_assert_equals(values->GetString(0), "b");
+        xlnt_assert_equals(values->GetString(1), "a");
+        xlnt_assert_equals(indices->Value(0), 0);
+        xlnt_assert_equals(indices->Value(1), 1);
+        xlnt_assert_equals(indices->Value(2), 0);
+    }
+
+    void test_unsupported_types()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("list");
+        ws.cell("A2").value(1);
+
+        auto schema = arrow::schema({arrow::field("list", arrow::list(arrow::int32()))});
+        xlnt_assert_throws(xlnt::xlsx2arrow(ws, schema), xlnt::unsupported);
+
+        arrow::ListBuilder lists(arrow::default_memory_pool(), std::make_shared<arrow::Int32Builder>());
+        lists.AppendNull();
+        std::shared_ptr<arrow::Array> list_array;
+        lists.Finish(&list_array);
+
+        auto table = std::make_shared<arrow::Table>(schema, std::vector<std::shared_ptr<arrow::Column>>{
+            std::make_shared<arrow::Column>(schema->field(0), list_array)});
+
+        xlnt::workbook target;
+        xlnt_assert_throws(xlnt::arrow2xlsx(*table, target.active_sheet()), xlnt::unsupported);
+        xlnt_assert(!target.active_sheet().has_cell("A1"));
+    }
+
+    void test_threads()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (auto column = xlnt::column_t(1); column <= 16; ++column)
+        {
+            ws.cell(column, 1).value(column.column_string());
+
+            for (auto row = xlnt::row_t(2); row <= 200; ++row)
+            {
+                ws.cell(column, row).value(static_cast<int>(row * column.index));
+            }
+        }
+
+        auto single = xlnt::xlsx2arrow(ws, 1);
+        auto parallel = xlnt::xlsx2arrow(ws, 8);
+
+        xlnt_assert_equals(parallel->num_columns(), 16);
+        xlnt_assert_equals(parallel->num_rows(), 199);
+        xlnt_assert(parallel->Equals(*single));
+    }
+};
@@ -66,6 +66,7 @@ public:
         register_test(test_anchor);
         register_test(test_hyperlink);
         register_test(test_comment);
+        register_test(test_computed_style);
     }
 
 private:
@@ -679,4 +680,52 @@ private:
         xlnt_assert(!cell.has_comment());
         xlnt_assert_throws(cell.comment(), xlnt::exception);
     }
+
+    void test_computed_style()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto default_font = wb.format(0).font();
+
+        xlnt_assert_equals(ws.cell("A1").computed_font(), default_font);
+        xlnt_assert_equals(ws.cell("A1").computed_number_format(), xlnt::number_format::general());
+
+        const auto bold = xlnt::font().bold(true);
+        const auto italic = xlnt::font().italic(true);
+        const auto red = xlnt::fill(xlnt::pattern_fill().type(xlnt::pattern_fill_type::solid).foreground(xlnt::color::red()));
+        const auto blue = xlnt::fill(xlnt::pattern_fill().type(xlnt::pattern_fill_type::solid).foreground(xlnt::color::blue()));
+
+        auto heading = wb.create_style("heading");
+        heading.font(italic, true);
+        heading.fill(red, true);
+
+        ws.cell("B1").style(heading);
+
+        xlnt_assert_equals(ws.cell("B1").computed_font(), italic);
+        xlnt_assert_equals(ws.cell("B1").computed_fill(), red);
+
+        ws.cell("B2").style(heading);
+        ws.cell("B2").font(bold);
+
+        xlnt_assert_equals(ws.cell("B2").computed_font(), bold);
+        xlnt_assert_equals(ws.cell("B2").computed_fill(), red);
+
+        heading.fill(blue, true);
+
+        xlnt_assert_equals(ws.cell("B1").computed_fill(), blue);
+
+        ws.cell("C1").value(0.5);
+        ws.cell("C1").number_format(xlnt::number_format::percentage());
+
+        xlnt_assert_equals(ws.cell("C1").to_string(), "50%");
+
+        const auto styles = ws.range("A1:C2").computed_styles();
+
+        xlnt_assert_equals(styles.size(), 6);
+        xlnt_assert_equals(styles[1]->font, italic);
+        xlnt_assert_equals(styles[4]->font, bold);
+        xlnt_assert_equals(styles[2]->number_format, xlnt::number_format::percentage());
+        xlnt_assert_equals(styles[0], styles[3]);
+        xlnt_assert_equals(styles[0]->font, default_font);
+    }
 };
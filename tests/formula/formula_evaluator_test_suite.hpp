@@ -0,0 +1,245 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <iostream>
+
+#include <helpers/test_suite.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+class formula_evaluator_test_suite : public test_suite
+{
+public:
+    formula_evaluator_test_suite()
+    {
+        register_test(test_operators);
+        register_test(test_functions);
+        register_test(test_lookup);
+        register_test(test_incremental);
+        register_test(test_unsupported);
+        register_test(test_save);
+        register_test(test_independent_groups);
+    }
+
+    void test_operators()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").formula("=1+2*3");
+        ws.cell("A2").formula("=-2^2");
+        ws.cell("A3").formula("=(1+2)*3/4");
+        ws.cell("A4").formula("=1/0");
+        ws.cell("A5").formula("=\"a\"&A1&TRUE");
+        ws.cell("A6").formula("=50%");
+        ws.cell("A7").formula("=\"abc\"=\"ABC\"");
+        ws.cell("A8").formula("=A9+1");
+        ws.cell("A10").formula("=A4+1");
+        ws.cell("A11").formula("=\"2\"*3>5");
+
+        xlnt_assert_equals(wb.calculate(), 10);
+
+        xlnt_assert_equals(ws.cell("A1").value<int>(), 7);
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 4);
+        xlnt_assert_equals(ws.cell("A3").value<double>(), 2.25);
+        xlnt_assert_equals(ws.cell("A4").data_type(), xlnt::cell::type::error);
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "#DIV/0!");
+        xlnt_assert_equals(ws.cell("A5").data_type(), xlnt::cell::type::formula_string);
+        xlnt_assert_equals(ws.cell("A5").value<std::string>(), "a7TRUE");
+        xlnt_assert_equals(ws.cell("A6").value<double>(), 0.5);
+        xlnt_assert(ws.cell("A7").value<bool>());
+        xlnt_assert_equals(ws.cell("A8").value<int>(), 1);
+        xlnt_assert_equals(ws.cell("A10").value<std::string>(), "#DIV/0!");
+        xlnt_assert_equals(ws.cell("A11").data_type(), xlnt::cell::type::boolean);
+        xlnt_assert(ws.cell("A11").value<bool>());
+        xlnt_assert(ws.cell("A1").has_formula());
+    }
+
+    void test_functions()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value(4);
+        ws.cell("A2").value("text");
+        ws.cell("A3").value(2);
+        ws.cell("A4").value(true);
+
+        ws.cell("B1").formula("=SUM(A1:A4,10)");
+        ws.cell("B2").formula("=AVERAGE(A:A)");
+        ws.cell("B3").formula("=MIN(A1:A4)");
+        ws.cell("B4").formula("=MAX(A1:A4,\"7\")");
+        ws.cell("B5").formula("=COUNT(A1:A4,\"x\",1)");
+        ws.cell("B6").formula("=IF(A1>3,\"big\",\"small\")");
+        ws.cell("B7").formula("=IF(A3>3,1)");
+        ws.cell("B8").formula("=AVERAGE(C1:C3)");
+
+        wb.calculate();
+
+        xlnt_assert_equals(ws.cell("B1").value<int>(), 16);
+        xlnt_assert_equals(ws.cell("B2").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("B3").value<int>(), 2);
+        xlnt_assert_equals(ws.cell("B4").value<int>(), 7);
+        xlnt_assert_equals(ws.cell("B5").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("B6").value<std::string>(), "big");
+        xlnt_assert_equals(ws.cell("B7").data_type(), xlnt::cell::type::boolean);
+        xlnt_assert(!ws.cell("B7").value<bool>());
+        xlnt_assert_equals(ws.cell("B8").value<std::string>(), "#DIV/0!");
+    }
+
+    void test_lookup()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto table = wb.create_sheet();
+        table.title("Prices List");
+
+        table.cell("A1").value(10);
+        table.cell("B1").value("low");
+        table.cell("A2").value(20);
+        table.cell("B2").value("medium");
+        table.cell("A3").value(30);
+        table.cell("B3").value("high");
+
+        ws.cell("A1").formula("=VLOOKUP(20,'Prices List'!A1:B3,2,FALSE)");
+        ws.cell("A2").formula("=VLOOKUP(25,'Prices List'!A1:B3,2)");
+        ws.cell("A3").formula("=VLOOKUP(5,'Prices List'!A1:B3,2)");
+        ws.cell("A4").formula("=VLOOKUP(25,'Prices List'!A1:B3,2,FALSE)");
+        ws.cell("A5").formula("=VLOOKUP(10,'Prices List'!A1:B3,3,FALSE)");
+        ws.cell("A6").formula("=VLOOKUP(10,Missing!A1:B3,2,FALSE)");
+
+        wb.calculate();
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "medium");
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "medium");
+        xlnt_assert_equals(ws.cell("A3").value<std::string>(), "#N/A");
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "#N/A");
+        xlnt_assert_equals(ws.cell("A5").value<std::string>(), "#REF!");
+        xlnt_assert_equals(ws.cell("A6").value<std::string>(), "#REF!");
+    }
+
+    void test_incremental()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value(1);
+        ws.cell("A2").formula("=A1*2");
+        ws.cell("A3").formula("=A2+1");
+        ws.cell("B1").value(5);
+        ws.cell("B2").formula("=B1*2");
+        ws.cell("C1").formula("=C2");
+        ws.cell("C2").formula("=C1");
+
+        // C1 and C2 refer to each other and are never evaluated
+        xlnt_assert_equals(wb.calculate(), 3);
+        xlnt_assert_equals(wb.calculate(), 0);
+
+        ws.cell("A1").value(10);
+        xlnt_assert_equals(wb.calculate(), 2);
+        xlnt_assert_equals(ws.cell("A3").value<int>(), 21);
+        xlnt_assert_equals(ws.cell("B2").value<int>(), 10);
+
+        ws.cell("A2").formula("=A1*3");
+        xlnt_assert_equals(wb.calculate(), 2);
+        xlnt_assert_equals(ws.cell("A3").value<int>(), 31);
+
+        ws.cell("D1").formula("=SUM(B:B)");
+        xlnt_assert_equals(wb.calculate(), 1);
+        xlnt_assert_equals(ws.cell("D1").value<int>(), 15);
+
+        ws.cell("B10").value(100);
+        xlnt_assert_equals(wb.calculate(), 1);
+        xlnt_assert_equals(ws.cell("D1").value<int>(), 115);
+
+        ws.cell("B2").clear_formula();
+        ws.cell("B2").value(1);
+        xlnt_assert_equals(wb.calculate(), 1);
+        xlnt_assert_equals(ws.cell("D1").value<int>(), 106);
+    }
+
+    void test_unsupported()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").formula("=CONCATENATE(\"a\",\"b\")");
+        ws.cell("A1").value("cached");
+        ws.cell("A2").formula("=A1&\"!\"");
+        ws.cell("A3").formula("=SUM(1,");
+
+        xlnt_assert_equals(wb.calculate(), 1);
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "cached");
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "cached!");
+
+        ws.cell("A1").value("changed");
+        xlnt_assert_equals(wb.calculate(), 1);
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "changed!");
+    }
+
+    void test_save()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value(2);
+        ws.cell("A2").formula("=A1*A1");
+        wb.calculate();
+
+        // once calculated, saving brings the cached values up to date
+        ws.cell("A1").value(3);
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+
+        xlnt_assert_equals(loaded.active_sheet().cell("A2").value<int>(), 9);
+        xlnt_assert_equals(loaded.active_sheet().cell("A2").formula(), "A1*A1");
+    }
+
+    void test_independent_groups()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (auto row = 1; row <= 2000; ++row)
+        {
+            ws.cell(1, static_cast<xlnt::row_t>(row)).value(row);
+            ws.cell(2, static_cast<xlnt::row_t>(row)).formula("=A" + std::to_string(row) + "*2");
+            ws.cell(3, static_cast<xlnt::row_t>(row)).formula("=B" + std::to_string(row) + "+1");
+        }
+
+        xlnt_assert_equals(wb.calculate(), 4000);
+        xlnt_assert_equals(ws.cell("C1").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("C2000").value<int>(), 4001);
+
+        ws.cell("A1000").value(0);
+        xlnt_assert_equals(wb.calculate(), 2);
+        xlnt_assert_equals(ws.cell("C1000").value<int>(), 1);
+    }
+};
@@ -0,0 +1,106 @@
+// Copyright (c) 2014-2017 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <iostream>
+
+#include <helpers/test_suite.hpp>
+#include <xlnt/formula/formula_translator.hpp>
+
+class formula_translator_test_suite : public test_suite
+{
+public:
+    formula_translator_test_suite()
+    {
+        register_test(test_relative_references);
+        register_test(test_absolute_references);
+        register_test(test_ranges);
+        register_test(test_literals_and_names);
+        register_test(test_out_of_range);
+        register_test(test_shift_rows);
+        register_test(test_shift_columns);
+    }
+
+    void test_relative_references()
+    {
+        xlnt::formula_translator translator("A1*2+C3", "B1");
+
+        xlnt_assert_equals(translator.translate("B1"), "A1*2+C3");
+        xlnt_assert_equals(translator.translate("B4"), "A4*2+C6");
+        xlnt_assert_equals(translator.translate("D1"), "C1*2+E3");
+    }
+
+    void test_absolute_references()
+    {
+        xlnt::formula_translator translator("$A$1+$A1+A$1", "B2");
+
+        xlnt_assert_equals(translator.translate("C5"), "$A$1+$A4+B$1");
+    }
+
+    void test_ranges()
+    {
+        xlnt::formula_translator translator("SUM(A1:B2)+SUM(C:C)+SUM(3:4)+Sheet2!A1", "A1");
+
+        xlnt_assert_equals(translator.translate("B3"), "SUM(B3:C4)+SUM(D:D)+SUM(5:6)+Sheet2!B3");
+    }
+
+    void test_literals_and_names()
+    {
+        xlnt::formula_translator translator("IF(A1=\"A1\",LOG10(A1),'My ''A1'' Sheet'!A1)", "A1");
+
+        xlnt_assert_equals(translator.translate("A2"), "IF(A2=\"A1\",LOG10(A2),'My ''A1'' Sheet'!A2)");
+    }
+
+    void test_out_of_range()
+    {
+        xlnt::formula_translator translator("A2+B1", "B2");
+
+        xlnt_assert_equals(translator.translate("A1"), "#REF!+#REF!");
+    }
+
+    void test_shift_rows()
+    {
+        xlnt::formula_translator translator("A2+$B$5+SUM(A1:A10)+SUM(4:6)+Data!A5+'data'!A5+Other!A5+SUM(B:B)", "C1");
+
+        xlnt_assert_equals(translator.shift_rows("Data", false, 3, 2),
+            "A2+$B$5+SUM(A1:A10)+SUM(4:6)+Data!A7+'data'!A7+Other!A5+SUM(B:B)");
+        xlnt_assert_equals(translator.shift_rows("Data", true, 3, 2),
+            "A2+$B$7+SUM(A1:A12)+SUM(6:8)+Data!A7+'data'!A7+Other!A5+SUM(B:B)");
+        xlnt_assert_equals(translator.shift_rows("Other", false, 3, 2),
+            "A2+$B$5+SUM(A1:A10)+SUM(4:6)+Data!A5+'data'!A5+Other!A7+SUM(B:B)");
+
+        xlnt_assert_equals(xlnt::formula_translator("A2+A5+SUM(A1:A10)+SUM(A4:A5)+SUM(4:6)", "C1").shift_rows("Data", true, 4, -2),
+            "A2+#REF!+SUM(A1:A8)+SUM(#REF!)+SUM(4:4)");
+    }
+
+    void test_shift_columns()
+    {
+        xlnt::formula_translator translator("A1+$D$1+SUM(B1:E1)+SUM(C:D)+SUM(2:2)+LOG10(C1)", "A1");
+
+        xlnt_assert_equals(translator.shift_columns("Data", true, 2, 1),
+            "A1+$E$1+SUM(C1:F1)+SUM(D:E)+SUM(2:2)+LOG10(D1)");
+        xlnt_assert_equals(translator.shift_columns("Data", true, 3, -1),
+            "A1+$C$1+SUM(B1:D1)+SUM(C:C)+SUM(2:2)+LOG10(#REF!)");
+    }
+};
@@ -27,6 +27,9 @@
 #include <cell/index_types_test_suite.hpp>
 #include <cell/rich_text_test_suite.hpp>
 
+#include <formula/formula_evaluator_test_suite.hpp>
+#include <formula/formula_translator_test_suite.hpp>
+
 #include <styles/alignment_test_suite.hpp>
 #include <styles/color_test_suite.hpp>
 #include <styles/fill_test_suite.hpp>
@@ -45,6 +48,10 @@
 #include <worksheet/range_test_suite.hpp>
 #include <worksheet/worksheet_test_suite.hpp>
 
+#ifdef XLNT_TEST_ARROW
+#include <arrow/xlntarrow_test_suite.hpp>
+#endif
+
 #include <detail/cryptography/compound_document.hpp>
 
 test_status overall_status;
@@ -78,6 +85,10 @@ int main()
     run_tests<index_types_test_suite>();
     run_tests<rich_text_test_suite>();
 
+    // formula
+    run_tests<formula_evaluator_test_suite>();
+    run_tests<formula_translator_test_suite>();
+
     // styles
     run_tests<alignment_test_suite>();
     run_tests<color_test_suite>();
@@ -100,6 +111,11 @@ int main()
     run_tests<range_test_suite>();
     run_tests<worksheet_test_suite>();
 
+#ifdef XLNT_TEST_ARROW
+    // arrow
+    run_tests<xlntarrow_test_suite>();
+#endif
+
     print_summary();
 
     return static_cast<int>(overall_status.tests_failed);
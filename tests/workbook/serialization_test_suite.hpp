@@ -23,14 +23,18 @@
 
 #pragma once
 
+#include <fstream>
 #include <iostream>
 
 #include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/zstream.hpp>
+#include <detail/cryptography/compound_document.hpp>
 #include <detail/cryptography/xlsx_crypto_consumer.hpp>
 #include <helpers/temporary_file.hpp>
 #include <helpers/test_suite.hpp>
 #include <helpers/path_helper.hpp>
 #include <helpers/xml_helper.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/streaming_workbook_writer.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -50,10 +54,18 @@ public:
         register_test(test_decrypt_libre_office);
         register_test(test_decrypt_standard);
         register_test(test_decrypt_numbers);
+        register_test(test_compound_document_from_buffer);
+        register_test(test_compound_document_truncated);
         register_test(test_read_unicode_filename);
         register_test(test_comments);
         register_test(test_read_hyperlink);
         register_test(test_read_formulae);
+        register_test(test_load_lazy_sheets);
+        register_test(test_load_options);
+        register_test(test_load_lazy_sheets_with_options);
+        register_test(test_load_pooled_memory);
+        register_test(test_save_unmodified_parts);
+        register_test(test_save_default_parts);
         register_test(test_read_headers_and_footers);
         register_test(test_read_custom_properties);
         register_test(test_round_trip_rw);
@@ -262,6 +274,48 @@ public:
         xlnt_assert_throws_nothing(wb.load(path, "secret"));
     }
 
+    void test_compound_document_from_buffer()
+    {
+        std::ifstream file_stream(path_helper::test_file("5_encrypted_agile.xlsx").string(), std::ios::binary);
+        const auto bytes = xlnt::detail::to_vector(file_stream);
+
+        xlnt::detail::vector_istreambuf buffer(bytes);
+        std::istream buffer_stream(&buffer);
+        xlnt::detail::compound_document streamed(buffer_stream);
+        xlnt::detail::compound_document mapped(bytes.data(), bytes.size());
+
+        for (const auto stream_name : { "/EncryptionInfo", "/EncryptedPackage" })
+        {
+            auto &streamed_stream = streamed.open_read_stream(stream_name);
+            std::vector<std::uint8_t> expected(bytes.size(), 0);
+            streamed_stream.read(reinterpret_cast<char *>(expected.data()), static_cast<std::streamsize>(expected.size()));
+            expected.resize(static_cast<std::size_t>(streamed_stream.gcount()));
+
+            auto &mapped_stream = mapped.open_read_stream(stream_name);
+            xlnt_assert(xlnt::detail::to_vector(mapped_stream) == expected);
+
+            mapped_stream.clear();
+            mapped_stream.seekg(static_cast<std::streamoff>(expected.size() / 2));
+            xlnt_assert_equals(mapped_stream.get(), static_cast<int>(expected[expected.size() / 2]));
+        }
+    }
+
+    void test_compound_document_truncated()
+    {
+        std::ifstream file_stream(path_helper::test_file("5_encrypted_agile.xlsx").string(), std::ios::binary);
+        auto bytes = xlnt::detail::to_vector(file_stream);
+
+        // only padding is cut from the last sector
+        bytes.resize(bytes.size() - 1);
+        xlnt::detail::compound_document padded(bytes.data(), bytes.size());
+        xlnt_assert_equals(xlnt::detail::to_vector(padded.open_read_stream("/EncryptionInfo")).size(), 1289);
+
+        // the last sector of /EncryptionInfo is cut short
+        bytes.resize(bytes.size() - 600);
+        xlnt::detail::compound_document truncated(bytes.data(), bytes.size());
+        xlnt_assert_throws(truncated.open_read_stream("/EncryptionInfo"), xlnt::invalid_file);
+    }
+
     void test_read_unicode_filename()
     {
 #ifdef _MSC_VER
@@ -340,6 +394,278 @@ public:
         xlnt_assert_equals(ws2.cell("C3").value<int>(), 3);
     }
 
+    void test_load_lazy_sheets()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::load_options options;
+        options.lazy_sheets = true;
+
+        xlnt::workbook wb;
+        wb.load(path, options);
+        xlnt_assert_equals(wb.sheet_titles(), std::vector<std::string>({ "Sheet1", "Sheet2" }));
+
+        auto ws2 = wb.sheet_by_title("Sheet2");
+        xlnt_assert_equals(ws2.cell("C1").formula(), "C2*C3");
+        xlnt_assert_equals(ws2.cell("A1").comment().plain_text(), "Sheet2 comment");
+
+        auto ws1 = wb.sheet_by_index(0);
+        xlnt_assert_equals(ws1.cell("A4").hyperlink(), "https://microsoft.com/");
+
+        xlnt::workbook from_stream;
+
+        {
+            std::ifstream file_stream(path.string(), std::ios::binary);
+            from_stream.load(file_stream, options);
+        }
+
+        std::vector<std::uint8_t> lazy_bytes, eager_bytes;
+        from_stream.save(lazy_bytes);
+
+        xlnt::workbook eager;
+        eager.load(path);
+        eager.save(eager_bytes);
+
+        xlnt_assert(xml_helper::xlsx_archives_match(lazy_bytes, eager_bytes));
+
+        // a package without a stylesheet
+        xlnt::workbook minimal;
+        minimal.load(path_helper::test_file("2_minimal.xlsx"), options);
+        xlnt_assert_equals(minimal.sheet_count(), 1);
+        xlnt_assert_throws_nothing(minimal.active_sheet().calculate_dimension());
+    }
+
+    void test_load_options()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+
+        xlnt::load_options options;
+        options.sheets = { "Sheet2" };
+        options.columns = { "C" };
+        options.last_row = 2;
+        options.values_only = true;
+
+        xlnt::workbook wb;
+        wb.load(path, options);
+        xlnt_assert_equals(wb.sheet_titles(), std::vector<std::string>({ "Sheet1", "Sheet2" }));
+        xlnt_assert(!wb.sheet_by_title("Sheet1").has_cell("A1"));
+
+        auto ws2 = wb.sheet_by_title("Sheet2");
+        xlnt_assert_equals(ws2.cell("C1").value<int>(), 6);
+        xlnt_assert(!ws2.cell("C1").has_formula());
+        xlnt_assert(!ws2.cell("C1").has_format());
+        xlnt_assert_equals(ws2.cell("C2").value<int>(), 2);
+        xlnt_assert(!ws2.has_cell("C3"));
+        xlnt_assert(!ws2.has_cell("A1"));
+
+        // a workbook loaded without its stylesheet can still be saved
+        std::vector<std::uint8_t> values_bytes;
+        xlnt_assert_throws_nothing(wb.save(values_bytes));
+
+        xlnt::workbook values;
+        values.load(values_bytes);
+        xlnt_assert_equals(values.sheet_titles(), std::vector<std::string>({ "Sheet1", "Sheet2" }));
+        xlnt_assert_equals(values.sheet_by_title("Sheet2").cell("C1").value<int>(), 6);
+        xlnt_assert_equals(values.sheet_by_title("Sheet2").cell("C2").value<int>(), 2);
+        xlnt_assert(!values.sheet_by_title("Sheet2").has_cell("C3"));
+
+        options = xlnt::load_options();
+        options.resolve_shared_strings = false;
+        options.images = false;
+
+        wb.load(path, options);
+        xlnt_assert_equals(wb.sheet_by_index(0).cell("A1").data_type(), xlnt::cell::type::number);
+        xlnt_assert(wb.shared_strings().empty());
+
+        std::vector<std::uint8_t> bytes;
+        xlnt_assert_throws_nothing(wb.save(bytes));
+
+        options = xlnt::load_options();
+        options.sheets = { "Sheet2" };
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(path, options);
+        xlnt_assert_equals(reader.sheet_titles(), std::vector<std::string>({ "Sheet2" }));
+        xlnt_assert(!reader.has_worksheet("Sheet1"));
+    }
+
+    void test_load_lazy_sheets_with_options()
+    {
+        // deferred sheets are read with the options the workbook was loaded with
+        auto projections = std::vector<xlnt::load_options>(6);
+        projections[0].sheets = { "Sheet2" };
+        projections[1].columns = { "A" };
+        projections[2].first_row = 2;
+        projections[3].last_row = 2;
+        projections[4].values_only = true;
+        projections[5].resolve_shared_strings = false;
+
+        for (const auto file : { "4_every_style.xlsx", "10_comments_hyperlinks_formulae.xlsx" })
+        {
+            const auto path = path_helper::test_file(file);
+
+            for (auto options : projections)
+            {
+                xlnt::workbook eager;
+                eager.load(path, options);
+
+                options.lazy_sheets = true;
+                xlnt::workbook lazy;
+                lazy.load(path, options);
+
+                xlnt_assert_equals(lazy.sheet_titles(), eager.sheet_titles());
+
+                for (const auto &title : eager.sheet_titles())
+                {
+                    const auto eager_ws = eager.sheet_by_title(title);
+                    const auto lazy_ws = lazy.sheet_by_title(title);
+                    const auto dimension = eager_ws.calculate_dimension();
+
+                    xlnt_assert_equals(lazy_ws.calculate_dimension(), dimension);
+
+                    for (auto row = dimension.top_left().row(); row <= dimension.bottom_right().row(); ++row)
+                    {
+                        for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
+                        {
+                            const auto reference = xlnt::cell_reference(column, row);
+                            xlnt_assert_equals(lazy_ws.has_cell(reference), eager_ws.has_cell(reference));
+
+                            if (!eager_ws.has_cell(reference)) continue;
+
+                            const auto eager_cell = eager_ws.cell(reference);
+                            const auto lazy_cell = lazy_ws.cell(reference);
+
+                            xlnt_assert_equals(lazy_cell.data_type(), eager_cell.data_type());
+                            xlnt_assert_equals(lazy_cell.to_string(), eager_cell.to_string());
+                            xlnt_assert_equals(lazy_cell.has_formula(), eager_cell.has_formula());
+                            xlnt_assert_equals(lazy_cell.has_format(), eager_cell.has_format());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void test_load_pooled_memory()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+
+        xlnt::load_options options;
+        options.pooled_memory = true;
+
+        xlnt::workbook wb;
+        wb.load(path, options);
+        xlnt_assert_equals(wb.sheet_by_title("Sheet2").cell("C1").formula(), "C2*C3");
+
+        {
+            // the copy shares the pool and rows of wb until it modifies them
+            auto copy = wb;
+            copy.sheet_by_title("Sheet1").cell("A1").value("edited");
+            copy.sheet_by_title("Sheet1").cell("Z100").value(1);
+        }
+
+        auto ws = wb.sheet_by_title("Sheet1");
+        xlnt_assert_differs(ws.cell("A1").value<std::string>(), "edited");
+        xlnt_assert(!ws.has_cell("Z100"));
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+        }
+
+        ws.garbage_collect();
+        ws.cell("B1").value("reused");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+        wb.clear();
+
+        options.lazy_sheets = true;
+        wb.load(bytes, options);
+        xlnt_assert_equals(wb.sheet_by_title("Sheet1").cell("A100").value<int>(), 100);
+        xlnt_assert_equals(wb.sheet_by_title("Sheet1").cell("B1").value<std::string>(), "reused");
+        xlnt_assert_equals(wb.sheet_by_title("Sheet2").cell("C1").formula(), "C2*C3");
+    }
+
+    void test_save_unmodified_parts()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::load_options options;
+        options.lazy_sheets = true;
+
+        xlnt::workbook wb;
+        wb.load(path, options);
+        wb.sheet_by_title("Sheet1").cell("A1").value("edited");
+
+        // freezing loads every sheet but doesn't count as handing them out
+        xlnt_assert_equals(wb.freeze().sheet_by_title("Sheet2").formula("C1"), "C2*C3");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        std::ifstream original_stream(path.string(), std::ios::binary);
+        xlnt::detail::izstream original(original_stream);
+        xlnt::detail::vector_istreambuf saved_buffer(bytes);
+        std::istream saved_stream(&saved_buffer);
+        xlnt::detail::izstream saved(saved_stream);
+
+        for (const auto part : { "xl/worksheets/sheet2.xml", "xl/comments2.xml", "docProps/thumbnail.jpeg" })
+        {
+            xlnt_assert_equals(saved.header(xlnt::path(part)).crc, original.header(xlnt::path(part)).crc);
+            xlnt_assert_equals(saved.header(xlnt::path(part)).compressed_size,
+                original.header(xlnt::path(part)).compressed_size);
+        }
+
+        xlnt_assert_differs(saved.header(xlnt::path("xl/worksheets/sheet1.xml")).crc,
+            original.header(xlnt::path("xl/worksheets/sheet1.xml")).crc);
+
+        xlnt::workbook reloaded;
+        reloaded.load(bytes);
+        xlnt_assert_equals(reloaded.sheet_by_title("Sheet1").cell("A1").value<std::string>(), "edited");
+        xlnt_assert_equals(reloaded.sheet_by_title("Sheet2").cell("C1").formula(), "C2*C3");
+        xlnt_assert_equals(reloaded.sheet_by_title("Sheet2").cell("A1").comment().plain_text(), "Sheet2 comment");
+
+        // worksheets obtained through a const workbook can still be edited
+        wb.load(path, options);
+        const auto &const_wb = wb;
+        xlnt::worksheet ws2 = const_wb.sheet_by_index(1);
+        ws2.cell("C2").value(10);
+        wb.save(bytes);
+        reloaded.load(bytes);
+        xlnt_assert_equals(reloaded.sheet_by_title("Sheet2").cell("C2").value<int>(), 10);
+    }
+
+    void test_save_default_parts()
+    {
+        std::vector<std::uint8_t> default_bytes, report_bytes, styled_bytes;
+        xlnt::workbook().save(default_bytes);
+
+        xlnt::workbook report;
+        report.active_sheet().cell("A1").value(1);
+        report.save(report_bytes);
+
+        xlnt::workbook styled;
+        styled.active_sheet().cell("A1").font(xlnt::font().bold(true));
+        styled.save(styled_bytes);
+
+        auto archive_header = [](const std::vector<std::uint8_t> &bytes, const std::string &part) {
+            xlnt::detail::vector_istreambuf buffer(bytes);
+            std::istream stream(&buffer);
+            return xlnt::detail::izstream(stream).header(xlnt::path(part));
+        };
+
+        for (const auto part : { "xl/styles.xml", "xl/theme/theme1.xml", "docProps/thumbnail.jpeg" })
+        {
+            xlnt_assert_equals(archive_header(report_bytes, part).crc, archive_header(default_bytes, part).crc);
+        }
+
+        xlnt_assert_differs(archive_header(styled_bytes, "xl/styles.xml").crc,
+            archive_header(default_bytes, "xl/styles.xml").crc);
+
+        xlnt::workbook loaded;
+        loaded.load(styled_bytes);
+        xlnt_assert(loaded.active_sheet().cell("A1").font().bold());
+    }
+
     void test_read_headers_and_footers()
     {
         xlnt::workbook wb;
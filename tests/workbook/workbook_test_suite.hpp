@@ -24,7 +24,9 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 #include <helpers/temporary_file.hpp>
 #include <helpers/test_suite.hpp>
@@ -56,6 +58,14 @@ public:
         register_test(test_memory);
         register_test(test_clear);
         register_test(test_comparison);
+        register_test(test_add_shared_string);
+        register_test(test_copy_on_write);
+        register_test(test_copy_styles);
+        register_test(test_default_construction);
+        register_test(test_reset);
+        register_test(test_freeze);
+        register_test(test_concurrent_population);
+        register_test(test_concurrent_population_existing_strings);
     }
 
     void test_active_sheet()
@@ -327,4 +337,318 @@ public:
         wb.style("style1");
         wb_const.style("style1");
     }
+
+    void test_add_shared_string()
+    {
+        xlnt::workbook wb;
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a")), 0);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("b")), 1);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a")), 0);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("a"), true), 2);
+
+        wb.shared_strings().push_back(xlnt::rich_text("c"));
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("c")), 3);
+
+        const xlnt::rich_text bold("a", xlnt::font().bold(true));
+        xlnt_assert_equals(wb.add_shared_string(bold), 4);
+        xlnt_assert_equals(wb.add_shared_string(bold), 4);
+    }
+
+    void test_copy_on_write()
+    {
+        xlnt::workbook original;
+        auto ws = original.active_sheet();
+        ws.cell("A1").value("shared");
+        ws.cell("B2").value(2);
+
+        xlnt::workbook copy(original);
+        copy.active_sheet().cell("A1").value("changed");
+        copy.active_sheet().cell("C3").value(3);
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "shared");
+        xlnt_assert(!ws.has_cell("C3"));
+        xlnt_assert_equals(copy.active_sheet().cell("B2").value<int>(), 2);
+        xlnt_assert_equals(copy.active_sheet().cell("B2").worksheet(), copy.active_sheet());
+
+        ws.cell("B2").value(4);
+        xlnt_assert_equals(copy.active_sheet().cell("B2").value<int>(), 2);
+        xlnt_assert_equals(original.shared_strings().size(), 1);
+        xlnt_assert_equals(copy.shared_strings().size(), 2);
+
+        auto sheet_copy = original.copy_sheet(ws);
+        sheet_copy.cell("B2").value(5);
+        xlnt_assert_equals(ws.cell("B2").value<int>(), 4);
+        xlnt_assert_equals(sheet_copy.cell("A1").value<std::string>(), "shared");
+        xlnt_assert_equals(sheet_copy.cell("A1").worksheet(), sheet_copy);
+
+        // handles obtained before the copy only change their own workbook
+        auto handle = ws.cell("B2");
+        ws.cell("D4").font(xlnt::font().bold(true));
+        xlnt::workbook styled_copy(original);
+        handle.value(5);
+        styled_copy.active_sheet().cell("D4").font(xlnt::font().italic(true));
+        xlnt_assert_equals(ws.cell("B2").value<int>(), 5);
+        xlnt_assert_equals(styled_copy.active_sheet().cell("B2").value<int>(), 4);
+
+        // the copy's cells keep valid formats
+        xlnt_assert(ws.cell("D4").font().bold());
+        xlnt_assert(styled_copy.active_sheet().cell("D4").font().italic());
+
+        const auto &const_copy = styled_copy;
+        xlnt_assert_equals(const_copy.sheet_by_index(0).cell("B2").worksheet(), styled_copy.active_sheet());
+        xlnt_assert_equals(const_copy.sheet_by_index(0).cell("A1").value<std::string>(), "shared");
+
+        std::vector<std::uint8_t> bytes;
+        styled_copy.save(bytes);
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        xlnt_assert(loaded.active_sheet().cell("D4").font().italic());
+    }
+
+    void test_copy_styles()
+    {
+        xlnt::workbook original;
+        auto ws = original.active_sheet();
+        original.create_style("Shared").font(xlnt::font().size(12), true);
+        ws.cell("A1").style("Shared");
+        ws.cell("B1").font(xlnt::font().bold(true));
+        ws.conditional_format(xlnt::range_reference("B1:B2"), xlnt::condition::text_contains("x"));
+        ws.cell("B2").value("x");
+
+        // style and format edits on a copy don't change the original
+        xlnt::workbook copy(original);
+        auto copy_ws = copy.active_sheet();
+        copy.create_style("OnlyInCopy");
+        copy.style("Shared").font(xlnt::font().size(30), true);
+        copy_ws.cell("B1").font(xlnt::font().italic(true));
+        copy_ws.cell("C1").fill(xlnt::fill::solid(xlnt::color::red()));
+
+        xlnt_assert(!original.has_style("OnlyInCopy"));
+        xlnt_assert_equals(original.style("Shared").font().size(), 12);
+        xlnt_assert_equals(ws.cell("A1").computed_font().size(), 12);
+        xlnt_assert(ws.cell("B1").font().bold());
+        xlnt_assert(!ws.cell("B1").font().italic());
+        xlnt_assert(!ws.cell("C1").has_format());
+
+        xlnt_assert(copy.has_style("OnlyInCopy"));
+        xlnt_assert_equals(copy_ws.cell("A1").computed_font().size(), 30);
+        xlnt_assert(copy_ws.cell("B1").font().italic());
+
+        // and edits on the original don't change a copy
+        xlnt::workbook second(original);
+        original.style("Shared").font(xlnt::font().size(8), true);
+        ws.cell("D1").fill(xlnt::fill::solid(xlnt::color::blue()));
+        xlnt_assert_equals(second.active_sheet().cell("A1").computed_font().size(), 12);
+        xlnt_assert(!second.active_sheet().has_cell("D1"));
+        xlnt_assert_equals(copy_ws.cell("A1").computed_font().size(), 30);
+
+        // conditional formats apply to the copied sheets
+        xlnt_assert_equals(copy_ws.evaluate_conditional_formats().size(), 1);
+        xlnt_assert_equals(ws.evaluate_conditional_formats().size(), 1);
+
+        std::vector<std::uint8_t> original_bytes, copy_bytes;
+        original.save(original_bytes);
+        copy.save(copy_bytes);
+
+        xlnt::workbook loaded;
+        loaded.load(copy_bytes);
+        xlnt_assert(loaded.active_sheet().cell("B1").font().italic());
+        xlnt_assert_equals(loaded.active_sheet().cell("C1").fill(), xlnt::fill::solid(xlnt::color::red()));
+        xlnt_assert_equals(loaded.active_sheet().evaluate_conditional_formats().size(), 1);
+
+        loaded.load(original_bytes);
+        xlnt_assert(loaded.active_sheet().cell("B1").font().bold());
+        xlnt_assert(!loaded.active_sheet().cell("B1").font().italic());
+        xlnt_assert(!loaded.active_sheet().has_cell("C1"));
+        xlnt_assert_equals(loaded.active_sheet().cell("D1").fill(), xlnt::fill::solid(xlnt::color::blue()));
+    }
+
+    void test_default_construction()
+    {
+        xlnt::workbook first;
+        first.active_sheet().cell("A1").font(xlnt::font().bold(true));
+        first.active_sheet().title("Changed");
+
+        xlnt::workbook second;
+        xlnt_assert_equals(second.sheet_titles(), std::vector<std::string>({ "Sheet1" }));
+        xlnt_assert_equals(second.active_sheet().workbook(), second);
+        xlnt_assert_equals(second.format(0).font(), xlnt::workbook::empty().format(0).font());
+        xlnt_assert(!second.format(0).font().bold());
+        xlnt_assert_equals(second.thumbnail(), xlnt::workbook::empty().thumbnail());
+        xlnt_assert(second.has_style("Normal"));
+    }
+
+    void test_reset()
+    {
+        xlnt::workbook wb;
+        wb.active_sheet().cell("A1").value("text");
+        wb.active_sheet().cell("B2").font(xlnt::font().italic(true));
+        wb.create_sheet().title("Second");
+
+        wb.reset();
+
+        xlnt_assert_equals(wb.sheet_titles(), std::vector<std::string>({ "Sheet1" }));
+        xlnt_assert(!wb.active_sheet().has_cell("A1"));
+        xlnt_assert(wb.shared_strings().empty());
+        xlnt_assert(!wb.active_sheet().has_cell("B2"));
+        xlnt_assert_equals(wb.format(0).font(), xlnt::workbook::empty().format(0).font());
+        xlnt_assert_equals(wb.active_sheet().workbook(), wb);
+
+        wb.active_sheet().cell("A1").value("again");
+        std::vector<std::uint8_t> bytes;
+        xlnt_assert_throws_nothing(wb.save(bytes));
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<std::string>(), "again");
+    }
+
+    void test_freeze()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B2").value("shared");
+        ws.cell("C3").value(2.5);
+        ws.cell("A10").value(true);
+        ws.cell("D4").formula("=C3*2");
+        ws.cell("D4").value(5);
+        ws.cell("E5").error("#N/A");
+        ws.cell("C4").value(xlnt::date(2020, 1, 2));
+        wb.create_sheet().title("Second");
+
+        const auto frozen = wb.freeze();
+
+        ws.cell("B2").value("changed");
+        ws.cell("F6").value(6);
+        wb.remove_sheet(wb.sheet_by_title("Second"));
+
+        xlnt_assert_equals(frozen.sheet_count(), 2);
+        xlnt_assert_equals(frozen.sheet_titles(), std::vector<std::string>({ "Sheet1", "Second" }));
+        xlnt_assert(frozen.contains("Second"));
+        xlnt_assert_throws(frozen.sheet_by_title("Third"), xlnt::key_not_found);
+        xlnt_assert_throws(frozen.sheet_by_index(2), xlnt::invalid_parameter);
+
+        const auto copy = frozen;
+        auto sheet = copy.sheet_by_title("Sheet1");
+        xlnt_assert_equals(sheet.cell_count(), 6);
+        xlnt_assert(sheet.is_date("C4"));
+        xlnt_assert(!sheet.is_date("C3"));
+        xlnt_assert(!sheet.is_date("Z99"));
+        xlnt_assert_equals(sheet.value<std::string>("B2"), "shared");
+        xlnt_assert_equals(sheet.data_type("B2"), xlnt::cell_type::shared_string);
+        xlnt_assert_equals(sheet.value<double>("C3"), 2.5);
+        xlnt_assert(sheet.value<bool>("A10"));
+        xlnt_assert_equals(sheet.value<int>("D4"), 5);
+        xlnt_assert_equals(sheet.formula("D4"), "C3*2");
+        xlnt_assert(!sheet.has_formula("C3"));
+        xlnt_assert_throws(sheet.formula("C3"), xlnt::invalid_attribute);
+        xlnt_assert_equals(sheet.value<std::string>("E5"), "#N/A");
+        xlnt_assert(!sheet.has_cell("F6"));
+        xlnt_assert_equals(sheet.data_type("F6"), xlnt::cell_type::empty);
+        xlnt_assert_throws(sheet.value<int>("F6"), xlnt::invalid_parameter);
+        xlnt_assert_equals(sheet.calculate_dimension(), xlnt::range_reference("A2:E10"));
+        xlnt_assert_equals(frozen.sheet_by_index(1).cell_count(), 0);
+    }
+
+    void test_concurrent_population()
+    {
+        xlnt::workbook wb;
+
+        for (auto i = 1; i < 4; ++i)
+        {
+            wb.create_sheet();
+        }
+
+        wb.begin_concurrent_population();
+
+        std::vector<std::thread> threads;
+        std::atomic<int> wrong_styles(0);
+
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([&wb, &wrong_styles, i]() {
+                auto ws = wb.sheet_by_index(i);
+
+                for (xlnt::row_t row = 1; row <= 200; ++row)
+                {
+                    ws.cell(1, row).value("common");
+                    ws.cell(2, row).value("sheet " + std::to_string(i));
+                    ws.cell(3, row).value(static_cast<int>(row));
+                    ws.cell(3, row).font(xlnt::font().bold(row % 2 == 0));
+                    ws.cell(4, row).formula("=C" + std::to_string(row) + "*2");
+
+                    // computed styles are cached in the stylesheet all sheets share
+                    if (ws.cell(3, row).computed_font().bold() != (row % 2 == 0)) ++wrong_styles;
+                }
+
+                ws.cell("E1").value(ws.cell("B1"));
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        xlnt_assert_equals(wrong_styles.load(), 0);
+        xlnt_assert_equals(wb.sheet_by_index(2).cell("B7").value<std::string>(), "sheet 2");
+
+        wb.end_concurrent_population();
+
+        xlnt_assert_equals(wb.shared_strings().size(), 5);
+        xlnt_assert_equals(wb.shared_strings().at(0).plain_text(), "common");
+        xlnt_assert_equals(wb.shared_strings().at(4).plain_text(), "sheet 3");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            auto ws = loaded.sheet_by_index(i);
+            xlnt_assert_equals(ws.cell("A200").value<std::string>(), "common");
+            xlnt_assert_equals(ws.cell("B100").value<std::string>(), "sheet " + std::to_string(i));
+            xlnt_assert_equals(ws.cell("E1").value<std::string>(), "sheet " + std::to_string(i));
+            xlnt_assert(ws.cell("C4").font().bold());
+            xlnt_assert(!ws.cell("C5").font().bold());
+            xlnt_assert_equals(ws.cell("D3").formula(), "C3*2");
+        }
+    }
+
+    void test_concurrent_population_existing_strings()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("before");
+        ws.cell("A2").value("shared");
+        wb.create_sheet().cell("A1").value("other");
+
+        wb.begin_concurrent_population();
+
+        ws.cell("B1").value("during");
+        ws.cell("B2").value("shared");
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "before");
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "shared");
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "during");
+        xlnt_assert_equals(wb.sheet_by_index(1).cell("A1").value<std::string>(), "other");
+
+        wb.end_concurrent_population();
+
+        xlnt_assert_equals(wb.shared_strings().size(), 4);
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "before");
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "during");
+        xlnt_assert_equals(ws.cell("B2").value<std::string>(), "shared");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<std::string>(), "before");
+        xlnt_assert_equals(loaded.active_sheet().cell("B1").value<std::string>(), "during");
+        xlnt_assert_equals(loaded.active_sheet().cell("B2").value<std::string>(), "shared");
+        xlnt_assert_equals(loaded.sheet_by_index(1).cell("A1").value<std::string>(), "other");
+    }
 };
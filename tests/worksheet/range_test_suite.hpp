@@ -28,6 +28,7 @@
 #include <helpers/test_suite.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
+#include <xlnt/worksheet/sort_key.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
 class range_test_suite : public test_suite
@@ -36,6 +37,8 @@ public:
     range_test_suite()
     {
         register_test(test_batch_formatting);
+        register_test(test_aggregate);
+        register_test(test_sort);
     }
 
     void test_batch_formatting()
@@ -66,4 +69,151 @@ public:
 
         xlnt_assert(!ws.cell("B2").has_format());
     }
+
+    void test_aggregate()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value(2);
+        ws.cell("A2").value("text");
+        ws.cell("A3").value(4);
+        ws.cell("A4").value(true);
+        ws.cell("A5").formula("=A1");
+        ws.cell("A5").value(9);
+        ws.cell("B1").value(100);
+        ws.cell("A7").value(-3);
+
+        const auto stats = ws.range("A1:A6").aggregate();
+
+        xlnt_assert_equals(stats.count(), 3);
+        xlnt_assert_equals(stats.sum(), 15);
+        xlnt_assert_equals(stats.min(), 2);
+        xlnt_assert_equals(stats.max(), 9);
+        xlnt_assert_equals(stats.mean(), 5);
+        xlnt_assert_delta(stats.standard_deviation(), 3.605551, 1e-6);
+
+        const auto column = ws.column_stats("A");
+
+        xlnt_assert_equals(column.count(), 4);
+        xlnt_assert_equals(column.sum(), 12);
+        xlnt_assert_equals(column.min(), -3);
+
+        const auto empty = ws.range("C1:D4").aggregate();
+
+        xlnt_assert_equals(empty.count(), 0);
+        xlnt_assert_equals(empty.mean(), 0);
+        xlnt_assert_equals(empty.variance(), 0);
+
+        for (xlnt::row_t row = 1; row <= 40000; ++row)
+        {
+            ws.cell(3, row).value(static_cast<int>(row % 10));
+        }
+
+        const auto serial = ws.range("C1:C40000").aggregate();
+        const auto parallel = ws.column_stats("C", true);
+
+        xlnt_assert_equals(parallel.count(), 40000);
+        xlnt_assert_equals(parallel.sum(), 180000);
+        xlnt_assert_equals(parallel.max(), 9);
+        xlnt_assert_delta(parallel.variance(), serial.variance(), 1e-9);
+    }
+
+    void test_sort()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("pear");
+        ws.cell("A2").value(3);
+        ws.cell("A3").value(true);
+        ws.cell("A5").value("Apple");
+        ws.cell("A6").value(-1);
+        ws.cell("B1").value(1);
+        ws.cell("B2").value(2);
+        ws.cell("B3").value(3);
+        ws.cell("B4").value(4);
+        ws.cell("B5").value(5);
+        ws.cell("B6").value(6);
+        ws.cell("B6").hyperlink("http://example.com/");
+        ws.cell("C1").value("stays");
+        ws.cell("D2").formula("=B2*2");
+
+        ws.range("A1:B6").sort("A");
+
+        xlnt_assert_equals(ws.cell("A1").value<int>(), -1);
+        xlnt_assert_equals(ws.cell("B1").value<int>(), 6);
+        xlnt_assert(ws.cell("B1").has_hyperlink());
+        xlnt_assert(!ws.has_cell("B6") || !ws.cell("B6").has_hyperlink());
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("A3").value<std::string>(), "Apple");
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "pear");
+        xlnt_assert_equals(ws.cell("A5").value<bool>(), true);
+        xlnt_assert(!ws.cell("A6").has_value());
+        xlnt_assert_equals(ws.cell("B6").value<int>(), 4);
+        xlnt_assert_equals(ws.cell("C1").value<std::string>(), "stays");
+        xlnt_assert_equals(ws.cell("D2").formula(), "B2*2");
+
+        ws.range("A1:B6").sort("A", false);
+
+        xlnt_assert_equals(ws.cell("A1").value<bool>(), true);
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "pear");
+        xlnt_assert_equals(ws.cell("A5").value<int>(), -1);
+        xlnt_assert_equals(ws.cell("B6").value<int>(), 4);
+
+        // ties on the first key keep their order and are broken by the second
+        xlnt::worksheet keyed = wb.create_sheet();
+
+        const int groups[] = {2, 1, 2, 1, 2};
+        const int scores[] = {5, 7, 5, 3, 9};
+
+        for (xlnt::row_t row = 1; row <= 5; ++row)
+        {
+            keyed.cell(1, row).value(groups[row - 1]);
+            keyed.cell(2, row).value(scores[row - 1]);
+            keyed.cell(3, row).value(static_cast<int>(row));
+            keyed.cell(4, row).formula("=C" + std::to_string(row) + "+1");
+        }
+
+        keyed.range("A1:D5").sort({xlnt::sort_key("A"), xlnt::sort_key("B", false)});
+
+        const int expected[] = {2, 4, 5, 1, 3};
+
+        for (xlnt::row_t row = 1; row <= 5; ++row)
+        {
+            xlnt_assert_equals(keyed.cell(3, row).value<int>(), expected[row - 1]);
+            xlnt_assert_equals(keyed.cell(4, row).formula(), "C" + std::to_string(row) + "+1");
+        }
+
+        xlnt_assert_throws(keyed.range("A1:B5").sort("C"), xlnt::invalid_parameter);
+        xlnt_assert_throws(keyed.range("A1:B5").sort(std::vector<xlnt::sort_key>()), xlnt::invalid_parameter);
+
+        keyed.merge_cells("B2:B3");
+        xlnt_assert_throws(keyed.range("A1:B5").sort("A"), xlnt::invalid_parameter);
+
+        // large ranges are sorted in parallel parts
+        auto large = wb.create_sheet();
+        const xlnt::row_t rows = 100000;
+
+        for (xlnt::row_t row = 1; row <= rows; ++row)
+        {
+            large.cell(1, row).value(static_cast<int>((row * 7919) % 1000));
+            large.cell(2, row).value(static_cast<int>(row));
+        }
+
+        large.range(xlnt::range_reference(1, 1, 2, rows)).sort("A");
+
+        for (xlnt::row_t row = 2; row <= rows; ++row)
+        {
+            const auto previous = large.cell(1, row - 1).value<int>();
+            const auto current = large.cell(1, row).value<int>();
+
+            xlnt_assert(previous <= current);
+
+            if (previous == current)
+            {
+                xlnt_assert(large.cell(2, row - 1).value<int>() < large.cell(2, row).value<int>());
+            }
+        }
+    }
 };
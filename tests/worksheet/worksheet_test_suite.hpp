@@ -23,9 +23,15 @@
 
 #pragma once
 
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <limits>
 
+#include <detail/implementations/row_store.hpp>
+#include <helpers/temporary_file.hpp>
 #include <helpers/test_suite.hpp>
+#include <helpers/xml_helper.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
@@ -62,6 +68,11 @@ public:
         register_test(test_merge_range_string);
         register_test(test_unmerge_bad);
         register_test(test_unmerge_range_string);
+        register_test(test_merge_without_cells);
+        register_test(test_append_rows);
+        register_test(test_max_resident_cells);
+        register_test(test_spilled_rows);
+        register_test(test_row_store_file);
         register_test(test_print_titles_old);
         register_test(test_print_titles_new);
         register_test(test_print_area);
@@ -93,6 +104,13 @@ public:
         register_test(test_get_point_pos);
         register_test(test_named_range_named_cell_reference);
         register_test(test_iteration_skip_empty);
+        register_test(test_formula_cells);
+        register_test(test_shared_formula);
+        register_test(test_insert_delete_rows);
+        register_test(test_insert_delete_columns);
+        register_test(test_delete_named_range_targets);
+        register_test(test_evaluate_conditional_formats);
+        register_test(test_import_csv);
     }
 
     void test_new_worksheet()
@@ -406,6 +424,237 @@ public:
         xlnt_assert_equals(ws.merged_ranges().size(), 0);
     }
 
+    void test_merge_without_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B2").value("kept");
+        ws.cell("C3").value(3);
+        ws.merge_cells("B2:XFD1048576");
+
+        xlnt_assert(!ws.has_cell("XFD1048576"));
+        xlnt_assert(ws.cell("XFD1048576").is_merged());
+        xlnt_assert(!ws.cell("A2").is_merged());
+        xlnt_assert_equals(ws.cell("B2").value<std::string>(), "kept");
+        xlnt_assert(!ws.cell("C3").has_value());
+
+        ws.unmerge_cells("B2:XFD1048576");
+        xlnt_assert(!ws.cell("XFD1048576").is_merged());
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            ws.merge_cells(xlnt::range_reference(1, row, 3, row));
+            ws.merge_cells(xlnt::range_reference(5, row, 6, row + 1));
+        }
+
+        for (xlnt::row_t row = 1; row <= 1000; row += 2)
+        {
+            ws.unmerge_cells(xlnt::range_reference(1, row, 3, row));
+        }
+
+        xlnt_assert_equals(ws.merged_ranges().size(), 1500);
+        xlnt_assert_equals(ws.merged_ranges().front(), "E1:F2");
+        xlnt_assert_equals(ws.merged_ranges().back(), "E1000:F1001");
+        xlnt_assert(!ws.cell("C999").is_merged());
+        xlnt_assert(ws.cell("C1000").is_merged());
+        xlnt_assert(ws.cell("F1001").is_merged());
+        xlnt_assert(!ws.cell("D500").is_merged());
+        xlnt_assert_throws(ws.unmerge_cells("A999:C999"), xlnt::invalid_parameter);
+    }
+
+    void test_append_rows()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B2").value("existing");
+
+        auto writer = ws.append_rows();
+        xlnt_assert_equals(writer.row(), 3);
+
+        writer.append_row({ 1, 2, 3 });
+        writer.append("text").append(4.5).append(true);
+        xlnt_assert_equals(writer.column(), "D");
+        writer.next_row();
+
+        const double values[] = { 0.5, 1.5 };
+        writer.append_row(values, 2);
+
+        const std::vector<std::string> strings = { "a", "b" };
+        writer.append_row(strings.begin(), strings.end());
+
+        xlnt_assert_equals(ws.cell("C3").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "text");
+        xlnt_assert_equals(ws.cell("C4").value<bool>(), true);
+        xlnt_assert_equals(ws.cell("B5").value<double>(), 1.5);
+        xlnt_assert_equals(ws.cell("B6").value<std::string>(), "b");
+        xlnt_assert_equals(ws.calculate_dimension(), "A2:C6");
+
+        // rows shared with a copy are detached before being written
+        writer.append(7);
+        auto copy = wb;
+        writer.append(8).next_row();
+        xlnt_assert_equals(ws.cell("B7").value<int>(), 8);
+        xlnt_assert(copy.active_sheet().has_cell("A7"));
+        xlnt_assert(!copy.active_sheet().has_cell("B7"));
+
+        xlnt_assert_equals(ws.append_rows().row(), 8);
+
+        // writing the last column doesn't wrap around to the start of the row
+        const auto max_column = std::numeric_limits<xlnt::column_t::index_t>::max();
+        auto last = ws.append_rows();
+        last.skip_cells(max_column - 1).append(1);
+        xlnt_assert_equals(ws.cell(max_column, 8).value<int>(), 1);
+        xlnt_assert_throws_nothing(last.skip_cells(0));
+        xlnt_assert_throws(last.column(), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(last.skip_cells(1), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(last.append(2), xlnt::invalid_cell_reference);
+    }
+
+    void test_max_resident_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B1").value("before");
+        ws.max_resident_cells(100);
+
+        auto writer = ws.append_rows();
+
+        for (int row = 2; row <= 200; ++row)
+        {
+            for (int column = 0; column < 10; ++column)
+            {
+                writer.append(row * column);
+            }
+
+            writer.next_row();
+        }
+
+        ws.cell("A2").formula("=B2+C2");
+        ws.cell("A3").hyperlink("http://example.com");
+        ws.cell("A4").number_format(xlnt::number_format::percentage());
+        ws.cell("A5").comment(xlnt::comment("pinned", "author"));
+
+        for (int row = 150; row <= 200; ++row)
+        {
+            ws.cell(xlnt::cell_reference(1, static_cast<xlnt::row_t>(row))).value("text");
+        }
+
+        xlnt_assert(ws.has_cell("J20"));
+        xlnt_assert(!ws.has_cell("K20"));
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "before");
+        xlnt_assert_equals(ws.cell("J20").value<int>(), 180);
+        xlnt_assert_equals(ws.cell("A2").formula(), "B2+C2");
+        xlnt_assert_equals(ws.cell("A3").hyperlink(), "http://example.com");
+        xlnt_assert_equals(ws.cell("A4").number_format(), xlnt::number_format::percentage());
+        xlnt_assert_equals(ws.cell("A5").comment().plain_text(), "pinned");
+        xlnt_assert_equals(ws.cell("A200").value<std::string>(), "text");
+        xlnt_assert_equals(ws.calculate_dimension(), "A1:J200");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        xlnt::workbook reloaded;
+        reloaded.load(bytes);
+        auto reloaded_ws = reloaded.active_sheet();
+        xlnt_assert_equals(reloaded_ws.cell("J20").value<int>(), 180);
+        xlnt_assert_equals(reloaded_ws.cell("A4").number_format(), xlnt::number_format::percentage());
+        xlnt_assert_equals(reloaded_ws.cell("A199").value<std::string>(), "text");
+
+        ws.cell("Z300");
+        ws.garbage_collect();
+        xlnt_assert_equals(ws.calculate_dimension(), "A1:J200");
+    }
+
+    void test_spilled_rows()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.max_resident_cells(2);
+
+        ws.cell("A1").font(xlnt::font().bold(true));
+        ws.cell("A2").font(xlnt::font().italic(true));
+
+        xlnt::rich_text text;
+        text.add_run(xlnt::rich_text_run{ "red", xlnt::optional<xlnt::font>(xlnt::font().color(xlnt::color::red())) });
+        text.add_run(xlnt::rich_text_run{ " plain", xlnt::optional<xlnt::font>() });
+        ws.cell("A3").value(text);
+
+        xlnt::comment note("note", "author");
+        note.show();
+        note.position(10, 20);
+        note.size(300, 100);
+        ws.cell("A4").comment(note);
+
+        for (xlnt::row_t row = 5; row <= 20; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+        }
+
+        // drops the bold format while row 2 is spilled, which renumbers the italic one
+        ws.cell("A1").font(xlnt::font().underline(xlnt::font::underline_style::single));
+
+        for (xlnt::row_t row = 5; row <= 20; ++row)
+        {
+            xlnt_assert_equals(ws.cell(1, row).value<int>(), static_cast<int>(row));
+        }
+
+        xlnt_assert(ws.cell("A2").font().italic());
+        xlnt_assert(!ws.cell("A2").font().bold());
+        xlnt_assert_equals(ws.cell("A3").value<xlnt::rich_text>(), text);
+        xlnt_assert_equals(ws.cell("A4").comment(), note);
+
+        // copies read and write their own spilled rows
+        xlnt::workbook copy = wb;
+        auto copy_ws = copy.active_sheet();
+        copy_ws.cell("A10").value("copy");
+
+        for (xlnt::row_t row = 11; row <= 20; ++row)
+        {
+            copy_ws.cell(1, row).value("copy");
+            ws.cell(2, row).value("original");
+        }
+
+        xlnt_assert_equals(ws.cell("A10").value<int>(), 10);
+        xlnt_assert(!ws.cell("B10").has_value());
+        xlnt_assert_equals(copy_ws.cell("A10").value<std::string>(), "copy");
+        xlnt_assert(!copy_ws.cell("B15").has_value());
+        xlnt_assert_equals(ws.cell("A15").value<int>(), 15);
+        xlnt_assert_equals(ws.cell("B15").value<std::string>(), "original");
+        xlnt_assert_equals(copy_ws.cell("A15").value<std::string>(), "copy");
+    }
+
+    void test_row_store_file()
+    {
+        xlnt::detail::row_store store(0);
+
+        xlnt::detail::cell_row kept;
+        kept[1].value_numeric_ = 1;
+        store.spill(1, kept);
+
+        xlnt::detail::cell_row cycled;
+        cycled[1].value_text_.plain_text(std::string(1000, 'x'));
+
+        // each spill leaves the space of the last one unused, which compaction reclaims
+        for (int i = 0; i < 5000; ++i)
+        {
+            store.spill(2, cycled);
+            cycled.clear();
+            store.restore(2, cycled, nullptr);
+        }
+
+        xlnt_assert(store.file_size() < (3 << 20));
+        xlnt_assert_equals(cycled.at(1).value_text_.plain_text(), std::string(1000, 'x'));
+
+        xlnt::detail::row_store copy(store);
+        store.erase(1);
+        store.spill(2, cycled);
+
+        xlnt::detail::cell_row restored;
+        copy.restore(1, restored, nullptr);
+        xlnt_assert_equals(restored.at(1).value_numeric_, 1);
+        xlnt_assert(!copy.is_spilled(2));
+    }
+
     void test_print_titles_old()
     {
         xlnt::workbook wb;
@@ -1088,4 +1337,385 @@ public:
             xlnt_assert_equals(cells[1].value<std::string>(), "F6");
         }
     }
+
+    void test_formula_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto second = wb.create_sheet();
+        const auto workbook_part = xlnt::path("xl/workbook.xml");
+
+        ws.cell("B2").formula("=A1");
+        ws.cell("A3").formula("=A1");
+        ws.cell("C1").formula("=A1");
+        second.cell("A1").formula("=1");
+        ws.cell("D4").value(ws.cell("C1"));
+        ws.cell("E5").value(4);
+
+        const auto expected = std::vector<xlnt::cell_reference>({ "C1", "B2", "A3", "D4" });
+        xlnt_assert_equals(ws.formula_cells(), expected);
+        xlnt_assert_equals(wb.formula_count(), 5);
+        xlnt_assert(wb.manifest().has_relationship(workbook_part, xlnt::relationship_type::calculation_chain));
+
+        for (auto reference : expected)
+        {
+            ws.cell(reference).clear_formula();
+        }
+
+        xlnt_assert(ws.formula_cells().empty());
+        xlnt_assert(wb.manifest().has_relationship(workbook_part, xlnt::relationship_type::calculation_chain));
+
+        second.cell("A1").value(ws.cell("E5"));
+        xlnt_assert_equals(wb.formula_count(), 0);
+        xlnt_assert(!wb.manifest().has_relationship(workbook_part, xlnt::relationship_type::calculation_chain));
+    }
+
+    void test_shared_formula()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.shared_formula(xlnt::range_reference("B1:B5"), "=A1*2");
+
+        xlnt_assert_equals(ws.cell("B1").formula(), "A1*2");
+        xlnt_assert_equals(ws.cell("B3").formula(), "A3*2");
+        xlnt_assert_equals(ws.formula_cells().size(), 5);
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+
+        xlnt_assert_equals(loaded_ws.cell("B5").formula(), "A5*2");
+
+        loaded_ws.cell("B1").formula("=A1");
+
+        xlnt_assert_equals(loaded_ws.cell("B1").formula(), "A1");
+        xlnt_assert_equals(loaded_ws.cell("B4").formula(), "A4*2");
+
+        loaded_ws.cell("B2").clear_formula();
+
+        xlnt_assert(!loaded_ws.cell("B2").has_formula());
+        xlnt_assert_equals(loaded_ws.cell("B3").formula(), "A3*2");
+        xlnt_assert_equals(loaded_ws.formula_cells().size(), 4);
+    }
+
+    void test_insert_delete_rows()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto other = wb.create_sheet();
+
+        ws.title("Data");
+        ws.max_resident_cells(8);
+
+        for (xlnt::row_t row = 1; row <= 20; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+        }
+
+        ws.cell("B1").formula("=SUM(A1:A20)");
+        ws.cell("B10").formula("=A10*2");
+        ws.cell("B12").comment(xlnt::comment("note", "author"));
+        ws.shared_formula(xlnt::range_reference("C5:C7"), "=A5+1");
+        ws.merge_cells("D4:E6");
+        ws.auto_filter("A1:A20");
+        ws.print_area("A1:B20");
+        ws.add_row_properties(10, xlnt::row_properties());
+        ws.page_break_at_row(15);
+        ws.create_named_range("block", "A8:A9");
+        other.cell("A1").formula("=Data!A10+A10");
+
+        ws.insert_rows(3, 2);
+
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 2);
+        xlnt_assert(!ws.cell("A3").has_value());
+        xlnt_assert_equals(ws.cell("A5").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("A22").value<int>(), 20);
+        xlnt_assert_equals(ws.cell("A22").reference().to_string(), "A22");
+        xlnt_assert_equals(ws.cell("B1").formula(), "SUM(A1:A22)");
+        xlnt_assert_equals(ws.cell("B12").formula(), "A12*2");
+        xlnt_assert(ws.cell("B14").has_comment());
+        xlnt_assert_equals(ws.cell("C8").formula(), "A8+1");
+        xlnt_assert_equals(ws.merged_ranges().front().to_string(), "D6:E8");
+        xlnt_assert_equals(ws.auto_filter().to_string(), "A1:A22");
+        xlnt_assert_equals(ws.print_area().to_string(), "$A$1:$B$22");
+        xlnt_assert(ws.has_row_properties(12));
+        xlnt_assert(!ws.has_row_properties(10));
+        xlnt_assert_equals(ws.page_break_rows().front(), 17);
+        xlnt_assert_equals(ws.named_range("block").reference().to_string(), "A10:A11");
+        xlnt_assert_equals(other.cell("A1").formula(), "Data!A12+A10");
+
+        ws.delete_rows(1, 4);
+
+        xlnt_assert_equals(ws.cell("A1").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("B8").formula(), "A8*2");
+        xlnt_assert_equals(ws.auto_filter().to_string(), "A1:A18");
+        xlnt_assert_equals(other.cell("A1").formula(), "Data!A8+A10");
+        xlnt_assert(!ws.has_cell("B1") || !ws.cell("B1").has_formula());
+        xlnt_assert_equals(ws.highest_row(), 18);
+
+        ws.cell("F1").formula("=A1+A2");
+        ws.delete_rows(2, 1);
+
+        xlnt_assert_equals(ws.cell("F1").formula(), "A1+#REF!");
+        xlnt_assert_equals(ws.formula_cells().size(), 5);
+
+        ws.cell(1, std::numeric_limits<xlnt::row_t>::max()).value(1);
+        xlnt_assert_throws(ws.insert_rows(1, 1), xlnt::invalid_parameter);
+    }
+
+    void test_insert_delete_columns()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::column_t::index_t column = 1; column <= 5; ++column)
+        {
+            ws.cell(column, 1).value(static_cast<int>(column));
+        }
+
+        ws.cell("A2").formula("=SUM(A1:E1)+C1");
+        ws.cell("D2").hyperlink("http://example.com/");
+        ws.column_properties("C").width = 20.0;
+        ws.merge_cells("B3:C3");
+
+        ws.insert_columns("B", 1);
+
+        xlnt_assert_equals(ws.cell("A1").value<int>(), 1);
+        xlnt_assert(!ws.cell("B1").has_value());
+        xlnt_assert_equals(ws.cell("F1").value<int>(), 5);
+        xlnt_assert_equals(ws.cell("A2").formula(), "SUM(A1:F1)+D1");
+        xlnt_assert(ws.cell("E2").has_hyperlink());
+        xlnt_assert(ws.has_column_properties("D"));
+        xlnt_assert_equals(ws.column_properties("D").width.get(), 20.0);
+        xlnt_assert_equals(ws.merged_ranges().front().to_string(), "C3:D3");
+
+        ws.delete_columns("C", 2);
+
+        xlnt_assert_equals(ws.cell("C1").value<int>(), 4);
+        xlnt_assert_equals(ws.cell("A2").formula(), "SUM(A1:D1)+#REF!");
+        xlnt_assert(ws.merged_ranges().empty());
+        xlnt_assert(!ws.has_column_properties("D"));
+        xlnt_assert_equals(ws.highest_column().index, 4);
+    }
+
+    void test_delete_named_range_targets()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 10; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value(static_cast<int>(row));
+        }
+
+        ws.create_named_range("rows", "A3:B4");
+        ws.create_named_range("column", "B1:B10");
+        ws.create_named_range("kept", "A8:A9");
+
+        ws.delete_rows(3, 2);
+
+        xlnt_assert(!ws.has_named_range("rows"));
+        xlnt_assert(!wb.has_named_range("rows"));
+        xlnt_assert_throws(ws.named_range("rows"), xlnt::key_not_found);
+        xlnt_assert_equals(ws.named_range("kept").reference().to_string(), "A6:A7");
+
+        ws.delete_columns("B", 1);
+
+        xlnt_assert(!ws.has_named_range("column"));
+        xlnt_assert(ws.has_named_range("kept"));
+
+        std::vector<std::uint8_t> bytes;
+        xlnt_assert_throws_nothing(wb.save(bytes));
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        xlnt_assert_equals(loaded.active_sheet().cell("A3").value<int>(), 5);
+    }
+
+    void test_evaluate_conditional_formats()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (int row = 1; row <= 6; ++row)
+        {
+            ws.cell(1, static_cast<xlnt::row_t>(row)).value(row);
+        }
+
+        ws.cell("B1").value("apple");
+        ws.cell("B2").value("Banana");
+        ws.cell("B3").value("APPLE");
+        ws.cell("B4").value("cherry");
+        ws.cell("C2").value("x");
+        ws.cell("D1").value(5);
+        ws.cell("D2").value("y");
+
+        auto top = ws.range("A1:A6").conditional_format(xlnt::condition::top(2));
+        auto below = ws.range("A1:A6").conditional_format(xlnt::condition::below_average());
+        auto duplicates = ws.range("B1:B4").conditional_format(xlnt::condition::duplicate_values());
+        auto contains = ws.range("B1:B4").conditional_format(xlnt::condition::text_contains("AN"));
+        auto less = ws.range("C1:C2").conditional_format(xlnt::condition::less_than(1));
+        auto greater = ws.range("D1:D3").conditional_format(xlnt::condition::greater_than(3));
+
+        const auto applied = ws.evaluate_conditional_formats();
+        const std::vector<std::pair<std::string, xlnt::conditional_format>> expected = {
+            {"A1", below}, {"B1", duplicates}, {"C1", less}, {"D1", greater},
+            {"A2", below}, {"B2", contains}, {"D2", greater},
+            {"A3", below}, {"B3", duplicates},
+            {"A5", top},
+            {"A6", top}};
+
+        xlnt_assert_equals(applied.size(), expected.size());
+
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            xlnt_assert_equals(applied[i].first, xlnt::cell_reference(expected[i].first));
+            xlnt_assert(applied[i].second == expected[i].second);
+        }
+
+        ws.cell("A4").value(10);
+        std::vector<xlnt::cell_reference> highest;
+
+        for (const auto &cell : ws.evaluate_conditional_formats())
+        {
+            if (cell.second == top) highest.push_back(cell.first);
+        }
+
+        xlnt_assert_equals(highest.size(), 2);
+        xlnt_assert_equals(highest.front(), xlnt::cell_reference("A4"));
+        xlnt_assert_equals(highest.back(), xlnt::cell_reference("A6"));
+
+        // rules are read back with their formats and in the same order of precedence
+        top.font(xlnt::font().bold(true));
+        contains.fill(xlnt::fill::solid(xlnt::color::red()));
+        wb.create_sheet().range("A1:A2").conditional_format(xlnt::condition::between(1, 2));
+
+        std::vector<std::uint8_t> bytes;
+        xlnt_assert_throws_nothing(wb.save(bytes));
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        const auto original = ws.evaluate_conditional_formats();
+        const auto reloaded = loaded.active_sheet().evaluate_conditional_formats();
+
+        xlnt_assert_equals(reloaded.size(), original.size());
+
+        for (std::size_t i = 0; i < original.size(); ++i)
+        {
+            xlnt_assert_equals(reloaded[i].first, original[i].first);
+            xlnt_assert_equals(reloaded[i].second.has_font(), original[i].second.has_font());
+            xlnt_assert_equals(reloaded[i].second.has_fill(), original[i].second.has_fill());
+        }
+
+        xlnt_assert(reloaded.back().second.font().bold());
+        xlnt_assert_equals(reloaded[5].first, xlnt::cell_reference("B2"));
+        xlnt_assert_equals(reloaded[5].second.fill(), xlnt::fill::solid(xlnt::color::red()));
+
+        std::vector<std::uint8_t> resaved;
+        loaded.save(resaved);
+        xlnt_assert(xml_helper::xlsx_archives_match(bytes, resaved));
+
+        loaded.sheet_by_index(1).cell("A1").value(1);
+        xlnt_assert_equals(loaded.sheet_by_index(1).evaluate_conditional_formats().size(), 1);
+    }
+
+    void test_import_csv()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("existing");
+
+        std::istringstream csv(
+            "\xEF\xBB\xBFname,amount,share,day,at,flag\n"
+            "\"Smith, J\",12.5,50%,2017-03-31,13:45,TRUE\r\n"
+            "\"say \"\"hi\"\"\",-3e2,,2017-03-31T08:30:00,1:02:03,false\n"
+            "\n"
+            "\"two\nlines\",=B3*2,#N/A,0012,1.5.2,x");
+        ws.import_csv(csv);
+
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "name");
+        xlnt_assert_equals(ws.cell("A3").value<std::string>(), "Smith, J");
+        xlnt_assert_equals(ws.cell("B3").value<double>(), 12.5);
+        xlnt_assert_equals(ws.cell("C3").value<double>(), 0.5);
+        xlnt_assert_equals(ws.cell("C3").number_format(), xlnt::number_format::percentage());
+        xlnt_assert(ws.cell("D3").is_date());
+        xlnt_assert_equals(ws.cell("D3").value<xlnt::date>(), xlnt::date(2017, 3, 31));
+        xlnt_assert_equals(ws.cell("E3").value<xlnt::time>(), xlnt::time(13, 45));
+        xlnt_assert_equals(ws.cell("F3").data_type(), xlnt::cell::type::boolean);
+        xlnt_assert(ws.cell("F3").value<bool>());
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "say \"hi\"");
+        xlnt_assert_equals(ws.cell("B4").value<double>(), -300.0);
+        xlnt_assert(!ws.has_cell("C4"));
+        xlnt_assert_equals(ws.cell("D4").value<xlnt::datetime>(), xlnt::datetime(2017, 3, 31, 8, 30));
+        xlnt_assert_equals(ws.cell("E4").value<xlnt::time>(), xlnt::time(1, 2, 3));
+        xlnt_assert(!ws.cell("F4").value<bool>());
+        xlnt_assert(!ws.has_cell("A5"));
+        xlnt_assert_equals(ws.cell("A6").value<std::string>(), "two\nlines");
+        xlnt_assert_equals(ws.cell("B6").formula(), "B3*2");
+        xlnt_assert_equals(ws.cell("C6").data_type(), xlnt::cell::type::error);
+        xlnt_assert_equals(ws.cell("D6").value<double>(), 12.0);
+        xlnt_assert_equals(ws.cell("E6").value<std::string>(), "1.5.2");
+        xlnt_assert_equals(ws.highest_row(), 6);
+
+        // minutes and seconds past 59 aren't read as times
+        std::istringstream clock("12:60,1:02:60,59:59.5\n");
+        auto clock_ws = wb.create_sheet();
+        clock_ws.import_csv(clock);
+        xlnt_assert_equals(clock_ws.cell("A1").value<std::string>(), "12:60");
+        xlnt_assert_equals(clock_ws.cell("B1").value<std::string>(), "1:02:60");
+        xlnt_assert_equals(clock_ws.cell("C1").value<xlnt::time>(), xlnt::time(0, 59, 59, 500000));
+
+        // records split across threads and windows give the same cells as one pass
+        std::string text;
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            text += std::to_string(i) + "\t\"quoted\ttab \"\"" + std::to_string(i) + "\"\"\n\"\t00" + std::to_string(i % 7) + "\n";
+        }
+
+        xlnt::csv_options options;
+        options.delimiter = '\t';
+        options.column_types[xlnt::column_t("C")] = xlnt::csv_options::column_type::text;
+
+        auto whole = wb.create_sheet();
+        std::istringstream whole_stream(text);
+        whole.import_csv(whole_stream, options);
+
+        temporary_file file;
+        {
+            std::ofstream out(file.get_path().string(), std::ios::binary);
+            out << text;
+        }
+
+        options.threads = 4;
+        options.chunk_size = 1000;
+        auto mapped = wb.create_sheet();
+        mapped.import_csv(file.get_path(), options);
+
+        options.memory_map = false;
+        auto streamed = wb.create_sheet();
+        streamed.import_csv(file.get_path(), options);
+
+        xlnt_assert_equals(whole.highest_row(), 2000);
+        xlnt_assert_equals(whole.cell("B2").value<std::string>(), "quoted\ttab \"1\"\n");
+        xlnt_assert_equals(whole.cell("C2").value<std::string>(), "001");
+        xlnt_assert_equals(whole.cell("A2000").value<int>(), 1999);
+
+        for (auto sheet : {mapped, streamed})
+        {
+            xlnt_assert_equals(sheet.highest_row(), 2000);
+
+            for (xlnt::row_t row = 1; row <= 2000; ++row)
+            {
+                xlnt_assert_equals(sheet.cell(1, row).value<int>(), whole.cell(1, row).value<int>());
+                xlnt_assert_equals(sheet.cell(2, row).value<std::string>(), whole.cell(2, row).value<std::string>());
+                xlnt_assert_equals(sheet.cell(3, row).value<std::string>(), whole.cell(3, row).value<std::string>());
+            }
+        }
+    }
 };